@@ -0,0 +1,1268 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: exec agent of container shim, run exec processes in the container without the runtime
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include "exec_agent.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/capability.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <isula_libutils/shim_client_process_state.h>
+
+#include "common.h"
+
+#ifndef CLONE_PIDFD
+#define CLONE_PIDFD 0x00001000
+#endif
+#ifndef CLONE_INTO_CGROUP
+#define CLONE_INTO_CGROUP 0x200000000ULL
+#endif
+#ifndef __NR_clone3
+#define __NR_clone3 435
+#endif
+#ifndef __NR_close_range
+#define __NR_close_range 436
+#endif
+#ifndef PR_CAP_AMBIENT
+#define PR_CAP_AMBIENT 47
+#define PR_CAP_AMBIENT_RAISE 2
+#define PR_CAP_AMBIENT_CLEAR_ALL 4
+#endif
+
+#define EXEC_AGENT_BACKLOG 16
+#define EXEC_AGENT_CGROUP_ROOT "/sys/fs/cgroup"
+#define EXEC_AGENT_MAX_CGROUPS 32
+#define EXEC_AGENT_MAX_FD 65536
+#define EXEC_AGENT_DEFAULT_PATH "/usr/local/sbin:/usr/local/bin:/usr/sbin:/usr/bin:/sbin:/bin"
+#define EXIT_SIGNAL_OFFSET 128
+
+extern int g_log_fd;
+
+// the same layout as struct clone_args of kernel, which may be missing in old headers
+struct exec_agent_clone_args {
+    uint64_t flags;
+    uint64_t pidfd;
+    uint64_t child_tid;
+    uint64_t parent_tid;
+    uint64_t exit_signal;
+    uint64_t stack;
+    uint64_t stack_size;
+    uint64_t tls;
+    uint64_t set_tid;
+    uint64_t set_tid_size;
+    uint64_t cgroup;
+};
+
+struct exec_agent_ns {
+    const char *name;
+    int type;
+};
+
+// user namespace must be joined first, as runc does
+static const struct exec_agent_ns g_namespaces[] = {
+    { "user", CLONE_NEWUSER }, { "ipc", CLONE_NEWIPC }, { "uts", CLONE_NEWUTS }, { "net", CLONE_NEWNET },
+    { "pid", CLONE_NEWPID }, { "mnt", CLONE_NEWNS }, { "cgroup", CLONE_NEWCGROUP },
+};
+
+#define EXEC_AGENT_NS_COUNT (sizeof(g_namespaces) / sizeof(g_namespaces[0]))
+
+struct exec_agent_name_value {
+    const char *name;
+    int value;
+};
+
+static const struct exec_agent_name_value g_capabilities[] = {
+    { "CAP_CHOWN", CAP_CHOWN }, { "CAP_DAC_OVERRIDE", CAP_DAC_OVERRIDE },
+    { "CAP_DAC_READ_SEARCH", CAP_DAC_READ_SEARCH }, { "CAP_FOWNER", CAP_FOWNER }, { "CAP_FSETID", CAP_FSETID },
+    { "CAP_KILL", CAP_KILL }, { "CAP_SETGID", CAP_SETGID }, { "CAP_SETUID", CAP_SETUID },
+    { "CAP_SETPCAP", CAP_SETPCAP }, { "CAP_LINUX_IMMUTABLE", CAP_LINUX_IMMUTABLE },
+    { "CAP_NET_BIND_SERVICE", CAP_NET_BIND_SERVICE }, { "CAP_NET_BROADCAST", CAP_NET_BROADCAST },
+    { "CAP_NET_ADMIN", CAP_NET_ADMIN }, { "CAP_NET_RAW", CAP_NET_RAW }, { "CAP_IPC_LOCK", CAP_IPC_LOCK },
+    { "CAP_IPC_OWNER", CAP_IPC_OWNER }, { "CAP_SYS_MODULE", CAP_SYS_MODULE }, { "CAP_SYS_RAWIO", CAP_SYS_RAWIO },
+    { "CAP_SYS_CHROOT", CAP_SYS_CHROOT }, { "CAP_SYS_PTRACE", CAP_SYS_PTRACE }, { "CAP_SYS_PACCT", CAP_SYS_PACCT },
+    { "CAP_SYS_ADMIN", CAP_SYS_ADMIN }, { "CAP_SYS_BOOT", CAP_SYS_BOOT }, { "CAP_SYS_NICE", CAP_SYS_NICE },
+    { "CAP_SYS_RESOURCE", CAP_SYS_RESOURCE }, { "CAP_SYS_TIME", CAP_SYS_TIME },
+    { "CAP_SYS_TTY_CONFIG", CAP_SYS_TTY_CONFIG }, { "CAP_MKNOD", CAP_MKNOD }, { "CAP_LEASE", CAP_LEASE },
+    { "CAP_AUDIT_WRITE", CAP_AUDIT_WRITE }, { "CAP_AUDIT_CONTROL", CAP_AUDIT_CONTROL },
+    { "CAP_SETFCAP", CAP_SETFCAP }, { "CAP_MAC_OVERRIDE", CAP_MAC_OVERRIDE }, { "CAP_MAC_ADMIN", CAP_MAC_ADMIN },
+    { "CAP_SYSLOG", CAP_SYSLOG }, { "CAP_WAKE_ALARM", CAP_WAKE_ALARM }, { "CAP_BLOCK_SUSPEND", CAP_BLOCK_SUSPEND },
+    { "CAP_AUDIT_READ", CAP_AUDIT_READ },
+#ifdef CAP_PERFMON
+    { "CAP_PERFMON", CAP_PERFMON },
+#endif
+#ifdef CAP_BPF
+    { "CAP_BPF", CAP_BPF },
+#endif
+#ifdef CAP_CHECKPOINT_RESTORE
+    { "CAP_CHECKPOINT_RESTORE", CAP_CHECKPOINT_RESTORE },
+#endif
+};
+
+static const struct exec_agent_name_value g_rlimits[] = {
+    { "RLIMIT_CPU", RLIMIT_CPU }, { "RLIMIT_FSIZE", RLIMIT_FSIZE }, { "RLIMIT_DATA", RLIMIT_DATA },
+    { "RLIMIT_STACK", RLIMIT_STACK }, { "RLIMIT_CORE", RLIMIT_CORE }, { "RLIMIT_RSS", RLIMIT_RSS },
+    { "RLIMIT_NPROC", RLIMIT_NPROC }, { "RLIMIT_NOFILE", RLIMIT_NOFILE }, { "RLIMIT_MEMLOCK", RLIMIT_MEMLOCK },
+    { "RLIMIT_AS", RLIMIT_AS }, { "RLIMIT_LOCKS", RLIMIT_LOCKS }, { "RLIMIT_SIGPENDING", RLIMIT_SIGPENDING },
+    { "RLIMIT_MSGQUEUE", RLIMIT_MSGQUEUE }, { "RLIMIT_NICE", RLIMIT_NICE }, { "RLIMIT_RTPRIO", RLIMIT_RTPRIO },
+    { "RLIMIT_RTTIME", RLIMIT_RTTIME },
+};
+
+#define EXEC_AGENT_RLIMITS_COUNT (sizeof(g_rlimits) / sizeof(g_rlimits[0]))
+
+enum { CAPS_BOUNDING = 0, CAPS_EFFECTIVE, CAPS_PERMITTED, CAPS_INHERITABLE, CAPS_AMBIENT, CAPS_MAX };
+
+struct exec_agent_rlimit {
+    int resource;
+    struct rlimit limit;
+};
+
+/*
+ * Everything the exec process needs is prepared by the agent thread, so that the cloned
+ * children only make system calls: they are copies of a multi-threaded process.
+ */
+typedef struct {
+    int ns_fds[EXEC_AGENT_NS_COUNT];
+    // cgroup v2 directory of the container for CLONE_INTO_CGROUP
+    int cgroup_fd;
+    char *cgroup_procs[EXEC_AGENT_MAX_CGROUPS];
+    size_t cgroup_procs_len;
+    bool join_cgroup;
+    char oom_score_adj[16];
+    char **argv;
+    char **envp;
+    const char *cwd;
+    uid_t uid;
+    gid_t gid;
+    gid_t *gids;
+    size_t gids_len;
+    uint64_t caps[CAPS_MAX];
+    struct exec_agent_rlimit rlimits[EXEC_AGENT_RLIMITS_COUNT];
+    size_t rlimits_len;
+    bool no_new_privs;
+    // written to /proc/self/attr/exec to set the security label of the process
+    char *lsm_attr;
+    int stdio[3];
+    int err_fd;
+    int pid_fd;
+} exec_agent_job;
+
+static pid_t g_agent_ctr_pid = -1;
+static int g_agent_listen_fd = -1;
+static pthread_mutex_t g_agent_conns_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t g_agent_conns = 0;
+
+static size_t exec_agent_msg_append(char *msg, size_t len, const char *str)
+{
+    size_t n = strlen(str);
+
+    if (n > EXEC_AGENT_MSG_LEN - 1 - len) {
+        n = EXEC_AGENT_MSG_LEN - 1 - len;
+    }
+    (void)memcpy(msg + len, str, n);
+    return len + n;
+}
+
+/*
+ * Called by the cloned children only, which are copies of a multi-threaded process: snprintf
+ * and strerror may take locks held by other threads, so the errno number is formatted by hand.
+ */
+static void exec_agent_child_fail(const exec_agent_job *job, const char *what, const char *which)
+{
+    char msg[EXEC_AGENT_MSG_LEN] = { 0 };
+    char num[16] = { 0 };
+    size_t pos = sizeof(num) - 1;
+    size_t len = 0;
+    int err = errno;
+
+    do {
+        num[--pos] = (char)('0' + err % 10);
+        err /= 10;
+    } while (err > 0 && pos > 0);
+
+    len = exec_agent_msg_append(msg, len, what);
+    len = exec_agent_msg_append(msg, len, " ");
+    len = exec_agent_msg_append(msg, len, which != NULL ? which : "");
+    len = exec_agent_msg_append(msg, len, ": errno ");
+    len = exec_agent_msg_append(msg, len, num + pos);
+    (void)write(job->err_fd, msg, len);
+    _exit(EXIT_FAILURE);
+}
+
+static pid_t exec_agent_raw_clone(uint64_t flags, int *pidfd, int cgroup_fd, int exit_signal)
+{
+    struct exec_agent_clone_args args;
+
+    (void)memset(&args, 0, sizeof(args));
+    args.flags = flags;
+    args.pidfd = (uint64_t)(uintptr_t)pidfd;
+    args.exit_signal = (uint64_t)exit_signal;
+    if (cgroup_fd >= 0) {
+        args.cgroup = (uint64_t)cgroup_fd;
+    }
+
+    return (pid_t)syscall(__NR_clone3, &args, sizeof(args));
+}
+
+static void exec_agent_execvpe(const exec_agent_job *job)
+{
+    char full[PATH_MAX] = { 0 };
+    const char *file = job->argv[0];
+    const char *path = EXEC_AGENT_DEFAULT_PATH;
+    const char *dir = NULL;
+    const char *end = NULL;
+    int last_errno = ENOENT;
+    size_t i;
+
+    if (strchr(file, '/') != NULL) {
+        (void)execve(file, job->argv, job->envp);
+        return;
+    }
+
+    for (i = 0; job->envp[i] != NULL; i++) {
+        if (strncmp(job->envp[i], "PATH=", strlen("PATH=")) == 0) {
+            path = job->envp[i] + strlen("PATH=");
+            break;
+        }
+    }
+
+    for (dir = path;; dir = end + 1) {
+        end = strchrnul(dir, ':');
+        // an empty entry means the current directory
+        int nret = (end == dir) ? snprintf(full, sizeof(full), "./%s", file) :
+                   snprintf(full, sizeof(full), "%.*s/%s", (int)(end - dir), dir, file);
+        if (nret > 0 && (size_t)nret < sizeof(full)) {
+            (void)execve(full, job->argv, job->envp);
+            if (errno != ENOENT && errno != ENOTDIR) {
+                last_errno = errno;
+            }
+        }
+        if (*end == '\0') {
+            break;
+        }
+    }
+
+    errno = last_errno;
+}
+
+// close all fds from 3 except keeps, which are sorted in place
+static void exec_agent_close_fds(int *keeps, size_t len)
+{
+    unsigned int first = 3;
+    size_t i, j;
+    int fd;
+    int tmp;
+
+    for (i = 1; i < len; i++) {
+        for (j = i; j > 0 && keeps[j - 1] > keeps[j]; j--) {
+            tmp = keeps[j];
+            keeps[j] = keeps[j - 1];
+            keeps[j - 1] = tmp;
+        }
+    }
+
+    // close the ranges between the keeps, and the one after the last keep
+    for (i = 0; i < len; i++) {
+        if (keeps[i] < (int)first) {
+            continue;
+        }
+        if (keeps[i] > (int)first && syscall(__NR_close_range, first, (unsigned int)keeps[i] - 1, 0) != 0) {
+            goto fallback;
+        }
+        first = (unsigned int)keeps[i] + 1;
+    }
+    if (syscall(__NR_close_range, first, ~0U, 0) == 0) {
+        return;
+    }
+
+fallback:
+    // close_range is missing before linux 5.9
+    for (fd = 3, i = 0; fd < EXEC_AGENT_MAX_FD; fd++) {
+        while (i < len && keeps[i] < fd) {
+            i++;
+        }
+        if (i == len || keeps[i] != fd) {
+            (void)close(fd);
+        }
+    }
+}
+
+static void exec_agent_set_stdio(exec_agent_job *job)
+{
+    int fds[3] = { -1, -1, -1 };
+    int flags = 0;
+    int fd = -1;
+    int i;
+
+    // stdio fds and the error pipe may be lower than 3 if the shim has no stdin, move them out of the way first
+    fd = fcntl(job->err_fd, F_DUPFD_CLOEXEC, 3);
+    if (fd < 0) {
+        exec_agent_child_fail(job, "dup", "error pipe");
+    }
+    job->err_fd = fd;
+
+    for (i = 0; i < 3; i++) {
+        fds[i] = fcntl(job->stdio[i], F_DUPFD_CLOEXEC, 3);
+        if (fds[i] < 0) {
+            exec_agent_child_fail(job, "dup", "stdio");
+        }
+    }
+
+    for (i = 0; i < 3; i++) {
+        if (dup2(fds[i], i) < 0) {
+            exec_agent_child_fail(job, "dup", "stdio");
+        }
+        flags = fcntl(i, F_GETFL);
+        if (flags >= 0 && (flags & O_NONBLOCK) != 0) {
+            (void)fcntl(i, F_SETFL, flags & ~O_NONBLOCK);
+        }
+    }
+
+    /*
+     * Do not leak fds of the shim into the container. They are closed rather than marked
+     * close-on-exec, as the process is already in the container before exec.
+     */
+    exec_agent_close_fds(&job->err_fd, 1);
+}
+
+static void exec_agent_set_capabilities(const exec_agent_job *job)
+{
+    struct __user_cap_header_struct header = { _LINUX_CAPABILITY_VERSION_3, 0 };
+    struct __user_cap_data_struct data[2];
+    int i;
+
+    (void)memset(data, 0, sizeof(data));
+    for (i = 0; i < 2; i++) {
+        data[i].effective = (uint32_t)(job->caps[CAPS_EFFECTIVE] >> (32 * i));
+        data[i].permitted = (uint32_t)(job->caps[CAPS_PERMITTED] >> (32 * i));
+        data[i].inheritable = (uint32_t)(job->caps[CAPS_INHERITABLE] >> (32 * i));
+    }
+    if (syscall(SYS_capset, &header, data) != 0) {
+        exec_agent_child_fail(job, "set", "capabilities");
+    }
+
+    (void)prctl(PR_CAP_AMBIENT, PR_CAP_AMBIENT_CLEAR_ALL, 0, 0, 0);
+    for (i = 0; i < 64; i++) {
+        if ((job->caps[CAPS_AMBIENT] & (1ULL << i)) == 0) {
+            continue;
+        }
+        if (prctl(PR_CAP_AMBIENT, PR_CAP_AMBIENT_RAISE, i, 0, 0) != 0) {
+            exec_agent_child_fail(job, "raise", "ambient capabilities");
+        }
+    }
+}
+
+/*
+ * The exec process, forked inside the pid namespace of the container. The credentials are
+ * changed with raw system calls, as the libc wrappers would try to sync threads not copied.
+ */
+static void exec_agent_exec_process(exec_agent_job *job)
+{
+    sigset_t mask;
+    size_t i;
+    int fd = -1;
+    int sig;
+
+    exec_agent_set_stdio(job);
+
+    (void)sigemptyset(&mask);
+    (void)sigprocmask(SIG_SETMASK, &mask, NULL);
+    for (sig = 1; sig < NSIG; sig++) {
+        (void)signal(sig, SIG_DFL);
+    }
+
+    for (i = 0; i < job->rlimits_len; i++) {
+        if (setrlimit(job->rlimits[i].resource, &job->rlimits[i].limit) != 0) {
+            exec_agent_child_fail(job, "set", "rlimits");
+        }
+    }
+
+    if (job->lsm_attr != NULL) {
+        fd = open("/proc/self/attr/exec", O_WRONLY | O_CLOEXEC);
+        if (fd < 0 || write(fd, job->lsm_attr, strlen(job->lsm_attr)) < 0) {
+            exec_agent_child_fail(job, "set", "security label");
+        }
+        close(fd);
+    }
+
+    if (job->cwd != NULL && chdir(job->cwd) != 0) {
+        exec_agent_child_fail(job, "chdir", job->cwd);
+    }
+
+    for (i = 0; i < 64; i++) {
+        if ((job->caps[CAPS_BOUNDING] & (1ULL << i)) != 0) {
+            continue;
+        }
+        if (prctl(PR_CAPBSET_DROP, i, 0, 0, 0) != 0 && errno != EINVAL) {
+            exec_agent_child_fail(job, "drop", "bounding capabilities");
+        }
+    }
+
+    (void)prctl(PR_SET_KEEPCAPS, 1, 0, 0, 0);
+    if (syscall(SYS_setgroups, job->gids_len, job->gids) != 0) {
+        exec_agent_child_fail(job, "set", "additional gids");
+    }
+    if (syscall(SYS_setresgid, job->gid, job->gid, job->gid) != 0) {
+        exec_agent_child_fail(job, "set", "gid");
+    }
+    if (syscall(SYS_setresuid, job->uid, job->uid, job->uid) != 0) {
+        exec_agent_child_fail(job, "set", "uid");
+    }
+    exec_agent_set_capabilities(job);
+    (void)prctl(PR_SET_KEEPCAPS, 0, 0, 0, 0);
+
+    if (job->no_new_privs && prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0) {
+        exec_agent_child_fail(job, "set", "no new privileges");
+    }
+
+    exec_agent_execvpe(job);
+    exec_agent_child_fail(job, "exec", job->argv[0]);
+}
+
+// cloned into the cgroup of the container, it joins the namespaces and forks the exec process
+static void exec_agent_child(exec_agent_job *job)
+{
+    int keeps[EXEC_AGENT_NS_COUNT + 5];
+    size_t keeps_len = 0;
+    int status = 0;
+    pid_t pid = -1;
+    size_t i;
+    int fd = -1;
+
+    /*
+     * The child lives as long as the exec process. Other fds of the shim, such as stdio of
+     * concurrent execs, must not be held by it, or their readers do not get EOF in time.
+     */
+    keeps[keeps_len++] = job->err_fd;
+    keeps[keeps_len++] = job->pid_fd;
+    for (i = 0; i < 3; i++) {
+        keeps[keeps_len++] = job->stdio[i];
+    }
+    for (i = 0; i < EXEC_AGENT_NS_COUNT; i++) {
+        if (job->ns_fds[i] >= 0) {
+            keeps[keeps_len++] = job->ns_fds[i];
+        }
+    }
+    exec_agent_close_fds(keeps, keeps_len);
+
+    /*
+     * Once in the namespaces, processes of the container must not ptrace it or open its
+     * /proc/<pid>/exe and fds, which belong to the shim. The exec process inherits it until exec.
+     */
+    if (prctl(PR_SET_DUMPABLE, 0, 0, 0, 0) != 0) {
+        exec_agent_child_fail(job, "set", "not dumpable");
+    }
+
+    if (job->join_cgroup) {
+        for (i = 0; i < job->cgroup_procs_len; i++) {
+            fd = open(job->cgroup_procs[i], O_WRONLY | O_CLOEXEC);
+            if (fd < 0 || write(fd, "0", 1) != 1) {
+                exec_agent_child_fail(job, "join cgroup", job->cgroup_procs[i]);
+            }
+            close(fd);
+        }
+    }
+
+    if (job->oom_score_adj[0] != '\0') {
+        fd = open("/proc/self/oom_score_adj", O_WRONLY | O_CLOEXEC);
+        if (fd < 0 || write(fd, job->oom_score_adj, strlen(job->oom_score_adj)) < 0) {
+            exec_agent_child_fail(job, "set", "oom score adj");
+        }
+        close(fd);
+    }
+
+    for (i = 0; i < EXEC_AGENT_NS_COUNT; i++) {
+        if (job->ns_fds[i] >= 0 && setns(job->ns_fds[i], g_namespaces[i].type) != 0) {
+            exec_agent_child_fail(job, "join namespace", g_namespaces[i].name);
+        }
+    }
+
+    pid = exec_agent_raw_clone(0, NULL, -1, SIGCHLD);
+    if (pid == 0) {
+        exec_agent_exec_process(job);
+    }
+    if (pid < 0) {
+        exec_agent_child_fail(job, "fork", "exec process");
+    }
+
+    (void)write(job->pid_fd, &pid, sizeof(pid));
+    close(job->pid_fd);
+    close(job->err_fd);
+
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            _exit(EXIT_FAILURE);
+        }
+    }
+
+    _exit(WIFSIGNALED(status) ? EXIT_SIGNAL_OFFSET + WTERMSIG(status) : WEXITSTATUS(status));
+}
+
+static int exec_agent_seccomp_mode(pid_t pid)
+{
+    char path[PATH_MAX] = { 0 };
+    char *line = NULL;
+    size_t len = 0;
+    FILE *fp = NULL;
+    int mode = 0;
+
+    (void)snprintf(path, sizeof(path), "/proc/%d/status", pid);
+    fp = fopen(path, "re");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    while (getline(&line, &len, fp) != -1) {
+        if (sscanf(line, "Seccomp: %d", &mode) == 1) {
+            break;
+        }
+    }
+
+    free(line);
+    fclose(fp);
+    return mode;
+}
+
+static int exec_agent_open_namespaces(pid_t pid, exec_agent_job *job)
+{
+    char path[PATH_MAX] = { 0 };
+    struct stat ctr_st;
+    struct stat own_st;
+    size_t i;
+
+    for (i = 0; i < EXEC_AGENT_NS_COUNT; i++) {
+        (void)snprintf(path, sizeof(path), "/proc/%d/ns/%s", pid, g_namespaces[i].name);
+        if (stat(path, &ctr_st) != 0) {
+            if (errno == ENOENT && kill(pid, 0) == 0) {
+                // namespace not supported by the kernel
+                continue;
+            }
+            return SHIM_ERR;
+        }
+
+        (void)snprintf(path, sizeof(path), "/proc/self/ns/%s", g_namespaces[i].name);
+        if (stat(path, &own_st) == 0 && own_st.st_dev == ctr_st.st_dev && own_st.st_ino == ctr_st.st_ino) {
+            continue;
+        }
+
+        (void)snprintf(path, sizeof(path), "/proc/%d/ns/%s", pid, g_namespaces[i].name);
+        job->ns_fds[i] = open(path, O_RDONLY | O_CLOEXEC);
+        if (job->ns_fds[i] < 0) {
+            return SHIM_ERR;
+        }
+    }
+
+    return SHIM_OK;
+}
+
+static int exec_agent_add_cgroup(exec_agent_job *job, const char *dir, bool unified)
+{
+    char path[PATH_MAX] = { 0 };
+    int nret = 0;
+
+    if (job->cgroup_procs_len >= EXEC_AGENT_MAX_CGROUPS) {
+        return SHIM_ERR;
+    }
+
+    nret = snprintf(path, sizeof(path), "%s/cgroup.procs", dir);
+    if (nret < 0 || (size_t)nret >= sizeof(path)) {
+        return SHIM_ERR;
+    }
+    job->cgroup_procs[job->cgroup_procs_len] = util_strdup_s(path);
+    if (job->cgroup_procs[job->cgroup_procs_len] == NULL) {
+        return SHIM_ERR;
+    }
+    job->cgroup_procs_len++;
+
+    if (unified) {
+        job->cgroup_fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    }
+
+    return SHIM_OK;
+}
+
+// find the cgroups of the container from its init process, every hierarchy must be joined
+static int exec_agent_find_cgroups(pid_t pid, exec_agent_job *job)
+{
+    char fname[PATH_MAX] = { 0 };
+    char dir[PATH_MAX] = { 0 };
+    char *line = NULL;
+    size_t len = 0;
+    FILE *fp = NULL;
+    bool unified = file_exists(EXEC_AGENT_CGROUP_ROOT "/cgroup.controllers");
+    int ret = SHIM_OK;
+
+    (void)snprintf(fname, sizeof(fname), "/proc/%d/cgroup", pid);
+    fp = fopen(fname, "re");
+    if (fp == NULL) {
+        return SHIM_ERR;
+    }
+
+    while (ret == SHIM_OK && getline(&line, &len, fp) != -1) {
+        char *ctrls = strchr(line, ':');
+        char *cgpath = ctrls != NULL ? strchr(ctrls + 1, ':') : NULL;
+        int nret = 0;
+
+        if (cgpath == NULL) {
+            continue;
+        }
+        *cgpath++ = '\0';
+        ctrls++;
+        cgpath[strcspn(cgpath, "\n")] = '\0';
+        if (strncmp(ctrls, "name=", strlen("name=")) == 0) {
+            ctrls += strlen("name=");
+        }
+
+        if (unified) {
+            nret = snprintf(dir, sizeof(dir), EXEC_AGENT_CGROUP_ROOT "%s", cgpath);
+        } else if (*ctrls == '\0') {
+            // the v2 hierarchy of hybrid mode
+            if (!file_exists(EXEC_AGENT_CGROUP_ROOT "/unified")) {
+                continue;
+            }
+            nret = snprintf(dir, sizeof(dir), EXEC_AGENT_CGROUP_ROOT "/unified%s", cgpath);
+        } else {
+            nret = snprintf(dir, sizeof(dir), EXEC_AGENT_CGROUP_ROOT "/%s%s", ctrls, cgpath);
+        }
+        if (nret < 0 || (size_t)nret >= sizeof(dir) || !file_exists(dir)) {
+            ret = SHIM_ERR;
+            break;
+        }
+
+        ret = exec_agent_add_cgroup(job, dir, unified);
+    }
+
+    free(line);
+    fclose(fp);
+    // without the cgroup v2 directory fd, the child writes itself into cgroup.procs
+    job->join_cgroup = (job->cgroup_fd < 0);
+    return ret;
+}
+
+static void exec_agent_read_oom_score_adj(pid_t pid, exec_agent_job *job)
+{
+    char path[PATH_MAX] = { 0 };
+    ssize_t nread = 0;
+    int fd = -1;
+
+    (void)snprintf(path, sizeof(path), "/proc/%d/oom_score_adj", pid);
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    nread = read_nointr(fd, job->oom_score_adj, sizeof(job->oom_score_adj) - 1);
+    if (nread < 0) {
+        nread = 0;
+    }
+    job->oom_score_adj[nread] = '\0';
+    job->oom_score_adj[strcspn(job->oom_score_adj, "\n")] = '\0';
+    close(fd);
+}
+
+static int exec_agent_lookup(const struct exec_agent_name_value *table, size_t len, const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if (strcasecmp(table[i].name, name) == 0) {
+            return table[i].value;
+        }
+    }
+
+    return -1;
+}
+
+static uint64_t exec_agent_caps_mask(char **names, size_t len)
+{
+    uint64_t mask = 0;
+    size_t i;
+    int cap;
+
+    for (i = 0; i < len; i++) {
+        cap = exec_agent_lookup(g_capabilities, sizeof(g_capabilities) / sizeof(g_capabilities[0]), names[i]);
+        if (cap < 0) {
+            write_message(g_log_fd, WARN_MSG, "exec agent ignores unknown capability %s", names[i]);
+            continue;
+        }
+        mask |= 1ULL << cap;
+    }
+
+    return mask;
+}
+
+static char **exec_agent_null_terminated(char **array, size_t len)
+{
+    char **result = NULL;
+    size_t i;
+
+    result = (char **)util_smart_calloc_s(sizeof(char *), len + 1);
+    if (result == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < len; i++) {
+        result[i] = array[i];
+    }
+
+    return result;
+}
+
+static int exec_agent_set_process(const shim_client_process_state *state, exec_agent_job *job)
+{
+    size_t i;
+    int resource;
+
+    job->argv = exec_agent_null_terminated(state->args, state->args_len);
+    job->envp = exec_agent_null_terminated(state->env, state->env_len);
+    if (job->argv == NULL || job->envp == NULL) {
+        return SHIM_ERR;
+    }
+    job->cwd = state->cwd;
+
+    if (state->user != NULL) {
+        job->uid = (uid_t)state->user->uid;
+        job->gid = (gid_t)state->user->gid;
+        if (state->user->additional_gids_len > 0) {
+            job->gids = (gid_t *)util_smart_calloc_s(sizeof(gid_t), state->user->additional_gids_len);
+            if (job->gids == NULL) {
+                return SHIM_ERR;
+            }
+            for (i = 0; i < state->user->additional_gids_len; i++) {
+                job->gids[i] = (gid_t)state->user->additional_gids[i];
+            }
+            job->gids_len = state->user->additional_gids_len;
+        }
+    }
+
+    if (state->capabilities != NULL) {
+        job->caps[CAPS_BOUNDING] = exec_agent_caps_mask(state->capabilities->bounding,
+                                                        state->capabilities->bounding_len);
+        job->caps[CAPS_EFFECTIVE] = exec_agent_caps_mask(state->capabilities->effective,
+                                                         state->capabilities->effective_len);
+        job->caps[CAPS_PERMITTED] = exec_agent_caps_mask(state->capabilities->permitted,
+                                                         state->capabilities->permitted_len);
+        job->caps[CAPS_INHERITABLE] = exec_agent_caps_mask(state->capabilities->inheritable,
+                                                           state->capabilities->inheritable_len);
+        job->caps[CAPS_AMBIENT] = exec_agent_caps_mask(state->capabilities->ambient,
+                                                       state->capabilities->ambient_len);
+    }
+
+    for (i = 0; i < state->rlimits_len && job->rlimits_len < EXEC_AGENT_RLIMITS_COUNT; i++) {
+        resource = exec_agent_lookup(g_rlimits, EXEC_AGENT_RLIMITS_COUNT, state->rlimits[i]->type);
+        if (resource < 0) {
+            return SHIM_ERR;
+        }
+        job->rlimits[job->rlimits_len].resource = resource;
+        job->rlimits[job->rlimits_len].limit.rlim_cur = (rlim_t)state->rlimits[i]->soft;
+        job->rlimits[job->rlimits_len].limit.rlim_max = (rlim_t)state->rlimits[i]->hard;
+        job->rlimits_len++;
+    }
+
+    job->no_new_privs = state->no_new_privileges;
+
+    // label the process as runc does, if the security module is enabled
+    if (state->apparmor_profile != NULL && state->apparmor_profile[0] != '\0' &&
+        file_exists("/sys/kernel/security/apparmor")) {
+        size_t len = strlen("exec ") + strlen(state->apparmor_profile) + 1;
+        job->lsm_attr = (char *)util_common_calloc_s(len);
+        if (job->lsm_attr == NULL) {
+            return SHIM_ERR;
+        }
+        (void)snprintf(job->lsm_attr, len, "exec %s", state->apparmor_profile);
+    } else if (state->selinux_label != NULL && state->selinux_label[0] != '\0' &&
+               file_exists("/sys/fs/selinux/enforce")) {
+        job->lsm_attr = util_strdup_s(state->selinux_label);
+        if (job->lsm_attr == NULL) {
+            return SHIM_ERR;
+        }
+    }
+
+    return SHIM_OK;
+}
+
+static int exec_agent_build_job(pid_t ctr_pid, const shim_client_process_state *state, exec_agent_job *job,
+                                char *msg, size_t msg_len)
+{
+    int seccomp = 0;
+
+    if (state->terminal) {
+        (void)snprintf(msg, msg_len, "terminal is not supported");
+        return EXEC_AGENT_UNSUPPORTED;
+    }
+
+    if (state->args_len == 0 || state->args[0] == NULL) {
+        (void)snprintf(msg, msg_len, "no command to exec");
+        return EXEC_AGENT_ERROR;
+    }
+
+    // filters of the container can not be copied without ptrace, let the runtime apply them
+    seccomp = exec_agent_seccomp_mode(ctr_pid);
+    if (seccomp < 0) {
+        (void)snprintf(msg, msg_len, "container process %d is gone", ctr_pid);
+        return EXEC_AGENT_ERROR;
+    }
+    if (seccomp > 0) {
+        (void)snprintf(msg, msg_len, "seccomp is not supported");
+        return EXEC_AGENT_UNSUPPORTED;
+    }
+
+    if (exec_agent_open_namespaces(ctr_pid, job) != SHIM_OK) {
+        (void)snprintf(msg, msg_len, "open namespaces of container process failed: %s", strerror(errno));
+        return EXEC_AGENT_ERROR;
+    }
+
+    if (exec_agent_find_cgroups(ctr_pid, job) != SHIM_OK) {
+        (void)snprintf(msg, msg_len, "cgroups of container process are not supported");
+        return EXEC_AGENT_UNSUPPORTED;
+    }
+
+    exec_agent_read_oom_score_adj(ctr_pid, job);
+
+    if (exec_agent_set_process(state, job) != SHIM_OK) {
+        (void)snprintf(msg, msg_len, "invalid process settings");
+        return EXEC_AGENT_UNSUPPORTED;
+    }
+
+    return EXEC_AGENT_OK;
+}
+
+static void exec_agent_job_init(exec_agent_job *job, const int *stdio)
+{
+    size_t i;
+
+    (void)memset(job, 0, sizeof(*job));
+    for (i = 0; i < EXEC_AGENT_NS_COUNT; i++) {
+        job->ns_fds[i] = -1;
+    }
+    job->cgroup_fd = -1;
+    job->err_fd = -1;
+    job->pid_fd = -1;
+    for (i = 0; i < 3; i++) {
+        job->stdio[i] = stdio[i];
+    }
+}
+
+static void exec_agent_close_stdio(exec_agent_job *job)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        close_fd(&job->stdio[i]);
+    }
+}
+
+static void exec_agent_job_free(exec_agent_job *job)
+{
+    size_t i;
+
+    for (i = 0; i < EXEC_AGENT_NS_COUNT; i++) {
+        close_fd(&job->ns_fds[i]);
+    }
+    close_fd(&job->cgroup_fd);
+    for (i = 0; i < job->cgroup_procs_len; i++) {
+        free(job->cgroup_procs[i]);
+    }
+    exec_agent_close_stdio(job);
+    free(job->argv);
+    free(job->envp);
+    free(job->gids);
+    free(job->lsm_attr);
+}
+
+static int64_t exec_agent_now_ms(void)
+{
+    struct timespec ts = { 0 };
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * Wait until the child exits. The exec process is killed when it times out, or when isulad
+ * closes the connection, which means isulad gives up the exec.
+ * Return true if the exec process timed out.
+ */
+static bool exec_agent_wait(int pidfd, int conn, pid_t pid, uint32_t timeout)
+{
+    struct pollfd fds[2] = { { pidfd, POLLIN, 0 }, { conn, POLLIN | POLLRDHUP, 0 } };
+    int64_t deadline = exec_agent_now_ms() + (int64_t)timeout * 1000;
+    bool killed = false;
+    bool timed_out = false;
+    int wait_ms = -1;
+    int nret = 0;
+
+    for (;;) {
+        wait_ms = -1;
+        if (timeout > 0 && !killed) {
+            int64_t remain = deadline - exec_agent_now_ms();
+            if (remain <= 0) {
+                timed_out = true;
+                killed = true;
+                if (pid > 0) {
+                    (void)kill(pid, SIGKILL);
+                }
+                continue;
+            }
+            wait_ms = (int)remain;
+        }
+
+        nret = poll(fds, killed ? 1 : 2, wait_ms);
+        if (nret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // the child is waited anyway
+            break;
+        }
+        if (fds[0].revents != 0) {
+            break;
+        }
+        if (!killed && fds[1].revents != 0) {
+            killed = true;
+            if (pid > 0) {
+                (void)kill(pid, SIGKILL);
+            }
+        }
+    }
+
+    return timed_out;
+}
+
+static int exec_agent_run(exec_agent_job *job, int conn, uint32_t timeout, struct exec_agent_response *resp)
+{
+    int err_pipe[2] = { -1, -1 };
+    int pid_pipe[2] = { -1, -1 };
+    int pidfd = -1;
+    pid_t child = -1;
+    pid_t pid = -1;
+    siginfo_t info;
+    bool timed_out = false;
+    ssize_t nread = 0;
+    int clone_errno = 0;
+    int ret = EXEC_AGENT_ERROR;
+
+    if (pipe2(err_pipe, O_CLOEXEC) != 0 || pipe2(pid_pipe, O_CLOEXEC) != 0) {
+        (void)snprintf(resp->message, sizeof(resp->message), "create pipe failed: %s", strerror(errno));
+        goto out;
+    }
+    job->err_fd = err_pipe[1];
+    job->pid_fd = pid_pipe[1];
+
+    child = exec_agent_raw_clone(CLONE_PIDFD | (job->cgroup_fd >= 0 ? CLONE_INTO_CGROUP : 0), &pidfd,
+                                 job->cgroup_fd, 0);
+    if (child < 0 && job->cgroup_fd >= 0 && (errno == EINVAL || errno == E2BIG)) {
+        // kernel before 5.7, join the cgroup after clone
+        job->join_cgroup = true;
+        child = exec_agent_raw_clone(CLONE_PIDFD, &pidfd, -1, 0);
+    }
+    if (child == 0) {
+        exec_agent_child(job);
+    }
+    clone_errno = errno;
+
+    close_fd(&err_pipe[1]);
+    close_fd(&pid_pipe[1]);
+    // the children hold the stdio now, the readers in isulad get EOF once the exec process exits
+    exec_agent_close_stdio(job);
+
+    if (child < 0) {
+        (void)snprintf(resp->message, sizeof(resp->message), "clone failed: %s", strerror(clone_errno));
+        ret = (clone_errno == ENOSYS) ? EXEC_AGENT_UNSUPPORTED : EXEC_AGENT_ERROR;
+        goto out;
+    }
+
+    if (read_nointr(pid_pipe[0], &pid, sizeof(pid)) != sizeof(pid)) {
+        pid = -1;
+    }
+    resp->pid = pid;
+
+    timed_out = exec_agent_wait(pidfd, conn, pid, timeout);
+
+    (void)memset(&info, 0, sizeof(info));
+    while (waitid(P_PID, (id_t)child, &info, WEXITED | __WCLONE) != 0) {
+        if (errno != EINTR) {
+            break;
+        }
+    }
+
+    nread = read_nointr(err_pipe[0], resp->message, sizeof(resp->message) - 1);
+    if (nread > 0) {
+        resp->message[nread] = '\0';
+        goto out;
+    }
+    resp->message[0] = '\0';
+
+    if (timed_out) {
+        ret = EXEC_AGENT_TIMEOUT;
+        goto out;
+    }
+
+    resp->exit_code = (info.si_code == CLD_EXITED) ? info.si_status : EXIT_SIGNAL_OFFSET + info.si_status;
+    ret = EXEC_AGENT_OK;
+
+out:
+    close_fd(&err_pipe[0]);
+    close_fd(&err_pipe[1]);
+    close_fd(&pid_pipe[0]);
+    close_fd(&pid_pipe[1]);
+    close_fd(&pidfd);
+    return ret;
+}
+
+static int exec_agent_read_full(int fd, void *buf, size_t len)
+{
+    size_t total = 0;
+    ssize_t nread = 0;
+
+    while (total < len) {
+        nread = read_nointr(fd, (char *)buf + total, len - total);
+        if (nread <= 0) {
+            return SHIM_ERR;
+        }
+        total += (size_t)nread;
+    }
+
+    return SHIM_OK;
+}
+
+static int exec_agent_recv_request(int conn, struct exec_agent_request *req, int *stdio)
+{
+    char control[CMSG_SPACE(sizeof(int) * 3)] = { 0 };
+    struct iovec iov = { req, sizeof(*req) };
+    struct msghdr msg;
+    struct cmsghdr *cmsg = NULL;
+    size_t count = 0;
+    size_t i;
+    ssize_t nread = 0;
+
+    (void)memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    do {
+        nread = recvmsg(conn, &msg, MSG_CMSG_CLOEXEC);
+    } while (nread < 0 && errno == EINTR);
+    if (nread <= 0) {
+        return SHIM_ERR;
+    }
+
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (i = 0; i < count && i < 3; i++) {
+            (void)memcpy(&stdio[i], CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+        }
+    }
+    if (count != 3 || (msg.msg_flags & MSG_CTRUNC) != 0) {
+        return SHIM_ERR;
+    }
+
+    if ((size_t)nread < sizeof(*req) &&
+        exec_agent_read_full(conn, (char *)req + nread, sizeof(*req) - (size_t)nread) != SHIM_OK) {
+        return SHIM_ERR;
+    }
+
+    if (req->magic != EXEC_AGENT_MAGIC || req->len == 0 || req->len > EXEC_AGENT_MAX_REQUEST) {
+        return SHIM_ERR;
+    }
+
+    return SHIM_OK;
+}
+
+// every connection has a thread, too many of them would exhaust the memory of shim
+static bool exec_agent_get_conn(void)
+{
+    bool ok = false;
+
+    (void)pthread_mutex_lock(&g_agent_conns_lock);
+    if (g_agent_conns < EXEC_AGENT_MAX_CONNS) {
+        g_agent_conns++;
+        ok = true;
+    }
+    (void)pthread_mutex_unlock(&g_agent_conns_lock);
+
+    return ok;
+}
+
+static void exec_agent_put_conn(void)
+{
+    (void)pthread_mutex_lock(&g_agent_conns_lock);
+    g_agent_conns--;
+    (void)pthread_mutex_unlock(&g_agent_conns_lock);
+}
+
+static void *exec_agent_serve(void *arg)
+{
+    int conn = (int)(intptr_t)arg;
+    int stdio[3] = { -1, -1, -1 };
+    struct exec_agent_request req = { 0 };
+    struct exec_agent_response resp = { 0 };
+    shim_client_process_state *state = NULL;
+    parser_error err = NULL;
+    exec_agent_job job;
+    char *body = NULL;
+
+    resp.magic = EXEC_AGENT_MAGIC;
+    resp.status = EXEC_AGENT_ERROR;
+    resp.pid = -1;
+    exec_agent_job_init(&job, stdio);
+
+    if (exec_agent_recv_request(conn, &req, job.stdio) != SHIM_OK) {
+        write_message(g_log_fd, WARN_MSG, "exec agent received invalid request");
+        goto out;
+    }
+
+    body = (char *)util_common_calloc_s(req.len + 1);
+    if (body == NULL || exec_agent_read_full(conn, body, req.len) != SHIM_OK) {
+        goto out;
+    }
+
+    state = shim_client_process_state_parse_data(body, NULL, &err);
+    if (state == NULL) {
+        (void)snprintf(resp.message, sizeof(resp.message), "parse process failed: %s", err);
+        goto reply;
+    }
+
+    resp.status = exec_agent_build_job(g_agent_ctr_pid, state, &job, resp.message, sizeof(resp.message));
+    if (resp.status == EXEC_AGENT_OK) {
+        resp.status = exec_agent_run(&job, conn, req.timeout, &resp);
+    }
+
+reply:
+    if (write_nointr_in_total(conn, (const char *)&resp, sizeof(resp)) != sizeof(resp)) {
+        write_message(g_log_fd, WARN_MSG, "exec agent send response failed:%d", SHIM_SYS_ERR(errno));
+    }
+
+out:
+    exec_agent_job_free(&job);
+    free_shim_client_process_state(state);
+    free(err);
+    free(body);
+    close(conn);
+    exec_agent_put_conn();
+    return NULL;
+}
+
+// isulad execs the process with a new shim instead, the request is not read
+static void exec_agent_reject(int conn)
+{
+    struct exec_agent_response resp = { 0 };
+
+    resp.magic = EXEC_AGENT_MAGIC;
+    resp.status = EXEC_AGENT_UNSUPPORTED;
+    resp.pid = -1;
+    (void)snprintf(resp.message, sizeof(resp.message), "too many execs in progress");
+    if (write_nointr_in_total(conn, (const char *)&resp, sizeof(resp)) != sizeof(resp)) {
+        write_message(g_log_fd, WARN_MSG, "exec agent send response failed:%d", SHIM_SYS_ERR(errno));
+    }
+    close(conn);
+}
+
+static void *exec_agent_accept_loop(void *arg)
+{
+    pthread_attr_t attr;
+    pthread_t tid;
+    int conn = -1;
+
+    (void)pthread_attr_init(&attr);
+    (void)pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    for (;;) {
+        conn = accept4(g_agent_listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (conn < 0) {
+            if (errno != EINTR && errno != ECONNABORTED) {
+                write_message(g_log_fd, WARN_MSG, "exec agent accept failed:%d", SHIM_SYS_ERR(errno));
+                util_usleep_nointerupt(100000);
+            }
+            continue;
+        }
+
+        if (!exec_agent_get_conn()) {
+            exec_agent_reject(conn);
+            continue;
+        }
+
+        if (pthread_create(&tid, &attr, exec_agent_serve, (void *)(intptr_t)conn) != 0) {
+            write_message(g_log_fd, WARN_MSG, "exec agent create thread failed");
+            close(conn);
+            exec_agent_put_conn();
+        }
+    }
+
+    return NULL;
+}
+
+int exec_agent_start(pid_t ctr_pid)
+{
+    struct sockaddr_un addr;
+    pthread_attr_t attr;
+    pthread_t tid;
+    int fd = -1;
+
+    if (!file_exists(EXEC_AGENT_MARKER)) {
+        return SHIM_OK;
+    }
+
+    // the socket lives in the workdir, which is the current directory of shim
+    (void)unlink(EXEC_AGENT_SOCK);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return SHIM_SYS_ERR(errno);
+    }
+
+    (void)memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    (void)strcpy(addr.sun_path, EXEC_AGENT_SOCK);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || chmod(EXEC_AGENT_SOCK, 0600) != 0 ||
+        listen(fd, EXEC_AGENT_BACKLOG) != 0) {
+        close(fd);
+        (void)unlink(EXEC_AGENT_SOCK);
+        return SHIM_SYS_ERR(errno);
+    }
+
+    g_agent_ctr_pid = ctr_pid;
+    g_agent_listen_fd = fd;
+
+    (void)pthread_attr_init(&attr);
+    (void)pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&tid, &attr, exec_agent_accept_loop, NULL) != 0) {
+        close(fd);
+        g_agent_listen_fd = -1;
+        (void)unlink(EXEC_AGENT_SOCK);
+        return SHIM_ERR;
+    }
+
+    return SHIM_OK;
+}
@@ -0,0 +1,71 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: exec agent of container shim definition
+ ******************************************************************************/
+
+#ifndef CMD_ISULAD_SHIM_EXEC_AGENT_H
+#define CMD_ISULAD_SHIM_EXEC_AGENT_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The exec agent is started only if isulad created this file in the workdir.
+ * The protocol below must be the same as the one in isula_rt_exec_agent.c of isulad.
+ */
+#define EXEC_AGENT_MARKER "exec-agent"
+#define EXEC_AGENT_SOCK "exec-agent.sock"
+
+#define EXEC_AGENT_MAGIC 0x45584147
+#define EXEC_AGENT_MAX_REQUEST (1024 * 1024)
+#define EXEC_AGENT_MSG_LEN 256
+// connections served at the same time, more are answered with EXEC_AGENT_UNSUPPORTED
+#define EXEC_AGENT_MAX_CONNS 32
+
+// request header, sent with stdin, stdout and stderr fds, and followed by process.json of the exec
+struct exec_agent_request {
+    uint32_t magic;
+    // seconds, 0 means no timeout
+    uint32_t timeout;
+    uint32_t len;
+};
+
+enum {
+    EXEC_AGENT_OK = 0,
+    // failed to run the process, message tells why
+    EXEC_AGENT_ERROR,
+    // the agent can not run the process, isulad should exec it with a new shim
+    EXEC_AGENT_UNSUPPORTED,
+    EXEC_AGENT_TIMEOUT,
+};
+
+struct exec_agent_response {
+    uint32_t magic;
+    int32_t status;
+    int32_t pid;
+    int32_t exit_code;
+    char message[EXEC_AGENT_MSG_LEN];
+};
+
+// serve exec requests for the container whose init process is ctr_pid, if enabled by isulad
+int exec_agent_start(pid_t ctr_pid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -25,6 +25,7 @@
 
 #include "common.h"
 #include "process.h"
+#include "exec_agent.h"
 
 extern int g_log_fd;
 
@@ -160,6 +161,14 @@ int main(int argc, char **argv)
 
     released_timeout_exit();
 
+    if (!p->state->exec) {
+        ret = exec_agent_start(p->ctr_pid);
+        if (ret != SHIM_OK) {
+            // isulad execs with a new shim if the agent is missing
+            write_message(g_log_fd, WARN_MSG, "start exec agent failed:%d", ret);
+        }
+    }
+
     ret = process_signal_handle_routine(p, tid_epoll, timeout);
     if (ret == SHIM_ERR) {
         exit(EXIT_FAILURE);
@@ -209,6 +209,21 @@ static int stdin_cb(int fd, uint32_t events, void *cbdata, struct epoll_descr *d
     return EPOLL_LOOP_HANDLE_CONTINUE;
 }
 
+/*
+ * Write the log records later in batch while more data is waiting in fd, so that
+ * they are flushed once fd is drained, even if the last read fills the buffer.
+ */
+static void flush_log_unless_pending(process_t *p, int fd, int r_count)
+{
+    int pending = 0;
+
+    if (r_count == DEFAULT_IO_COPY_BUF && ioctl(fd, FIONREAD, &pending) == 0 && pending > 0) {
+        return;
+    }
+
+    shim_flush_container_log_file(p->terminal);
+}
+
 static int stdout_cb(int fd, uint32_t events, void *cbdata, struct epoll_descr *descr)
 {
     process_t *p = (process_t *)cbdata;
@@ -231,10 +246,12 @@ static int stdout_cb(int fd, uint32_t events, void *cbdata, struct epoll_descr *
         r_count = read(fd, p->buf, DEFAULT_IO_COPY_BUF);
     }
     if (r_count <= 0) {
+        shim_flush_container_log_file(p->terminal);
         return EPOLL_LOOP_HANDLE_CLOSE;
     }
 
     shim_write_container_log_file(p->terminal, STDID_OUT, p->buf, r_count);
+    flush_log_unless_pending(p, fd, r_count);
 
     if (p->isulad_io->out == -1) {
         return EPOLL_LOOP_HANDLE_CONTINUE;
@@ -273,10 +290,12 @@ static int stderr_cb(int fd, uint32_t events, void *cbdata, struct epoll_descr *
         r_count = read(fd, p->buf, DEFAULT_IO_COPY_BUF);
     }
     if (r_count <= 0) {
+        shim_flush_container_log_file(p->terminal);
         return EPOLL_LOOP_HANDLE_CLOSE;
     }
 
     shim_write_container_log_file(p->terminal, STDID_ERR, p->buf, r_count);
+    flush_log_unless_pending(p, fd, r_count);
 
     if (p->isulad_io->err == -1) {
         return EPOLL_LOOP_HANDLE_CONTINUE;
@@ -676,6 +695,9 @@ static void *io_epoll_loop(void *data)
         }
     }
 
+    // no more container output, write the left log records and free the batch
+    shim_close_container_log_file(p->terminal);
+
     return NULL;
 }
 
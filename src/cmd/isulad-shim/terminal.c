@@ -19,8 +19,6 @@
 #include <sys/stat.h>
 #include <limits.h>
 #include <termios.h> // IWYU pragma: keep
-#include <isula_libutils/json_common.h>
-#include <isula_libutils/logger_json_file.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -35,6 +33,12 @@
 #define BUF_CACHE_SIZE (32 * 1024)
 #define STDOUT_STR "stdout"
 #define STDERR_STR "stderr"
+// keys, stream and time of a log record
+#define LOG_RECORD_RESERVED 128
+// a byte is escaped to 6 bytes at most, so the batch holds the longest record
+#define LOG_BATCH_SIZE (6 * BUF_CACHE_SIZE + LOG_RECORD_RESERVED)
+#define LOG_FLUSH_SIZE (64 * 1024)
+#define LOG_RECORD_HEAD "{\"log\":\""
 
 static int shim_rename_old_log_file(log_terminal *terminal)
 {
@@ -127,50 +131,78 @@ static int64_t get_log_file_size(int fd)
     return log_st.st_size;
 }
 
-static int shim_json_data_write(log_terminal *terminal, const char *buf, int read_count)
+/* called with log_terminal_rwlock held */
+static int shim_json_data_write(log_terminal *terminal, const char *buf, size_t len)
 {
-    int ret = 0;
     int nret = 0;
-    int64_t available_space = -1;
-    int64_t file_size;
 
-    (void)pthread_rwlock_wrlock(&terminal->log_terminal_rwlock);
+    if (len == 0) {
+        return SHIM_OK;
+    }
 
+    if (terminal->log_size < 0) {
+        terminal->log_size = get_log_file_size(terminal->fd);
+    }
 
-    file_size = get_log_file_size(terminal->fd);
-    if (file_size < 0) {
-        ret = -1;
-        goto out;
+    nret = write_nointr_in_total(terminal->fd, buf, len);
+    if (nret < 0) {
+        // part of the data may be written, get the size again next time
+        terminal->log_size = -1;
+        return SHIM_ERR;
     }
 
-    available_space = terminal->log_maxsize - file_size;
-    if (read_count <= available_space) {
-        ret = write_nointr_in_total(terminal->fd, buf, read_count);
-        goto out;
+    if (terminal->log_size >= 0) {
+        terminal->log_size += nret;
+    }
+
+    return SHIM_OK;
+}
+
+/* called with log_terminal_rwlock held */
+static void shim_json_data_flush(log_terminal *terminal)
+{
+    (void)shim_json_data_write(terminal, terminal->batch, terminal->batch_len);
+    terminal->batch_len = 0;
+}
+
+/*
+ * Encoded record is at the end of batch, keep it in the batch if it fits in
+ * the log file, otherwise write the records before it and rotate the log file.
+ * Called with log_terminal_rwlock held.
+ */
+static int shim_json_data_append(log_terminal *terminal, size_t record_len)
+{
+    int64_t available_space = -1;
+
+    if (terminal->log_size < 0) {
+        terminal->log_size = get_log_file_size(terminal->fd);
+        if (terminal->log_size < 0) {
+            return SHIM_ERR;
+        }
     }
 
+    available_space = (int64_t)terminal->log_maxsize - terminal->log_size - (int64_t)terminal->batch_len;
+    if ((int64_t)record_len <= available_space) {
+        terminal->batch_len += record_len;
+        return SHIM_OK;
+    }
+
+    (void)shim_json_data_write(terminal, terminal->batch, terminal->batch_len);
+    memmove(terminal->batch, terminal->batch + terminal->batch_len, record_len);
+    terminal->batch_len = 0;
+
     if (shim_dump_log_file(terminal) < 0) {
-        ret = -1;
-        goto out;
+        return SHIM_ERR;
     }
 
     /*
      * Now file is new, then write the max bytes that will be wrote to log file.
-     * We have set the log file min size 16k, so the scenario of log_maxsize < read_count
+     * We have set the log file min size 16k, so the scenario of log_maxsize < record_len
      * shouldn't happen, otherwise, discard some last bytes.
      */
-    nret = write_nointr_in_total(terminal->fd, buf,
-                                 terminal->log_maxsize < read_count ? terminal->log_maxsize : read_count);
-    if (nret < 0) {
-        ret = -1;
-        goto out;
-    }
-
-    ret = read_count - nret;
+    terminal->batch_len = terminal->log_maxsize < record_len ? terminal->log_maxsize : record_len;
 
-out:
-    (void)pthread_rwlock_unlock(&terminal->log_terminal_rwlock);
-    return ret;
+    return SHIM_OK;
 }
 
 static bool util_get_time_buffer(struct timespec *timestamp, char *timebuffer, size_t maxsize)
@@ -212,53 +244,161 @@ static bool util_get_now_time_buffer(char *timebuffer, size_t maxsize)
     return util_get_time_buffer(&ts, timebuffer, maxsize);
 }
 
-static ssize_t shim_logger_write(log_terminal *terminal, const char *type, const char *buf, int read_count)
+/* escape like the json generator of log records, which does not validate utf8 */
+static size_t shim_json_escape(char *dst, const char *src, size_t len)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    unsigned char c;
+    size_t i;
+    size_t n = 0;
+
+    for (i = 0; i < len; i++) {
+        c = (unsigned char)src[i];
+        switch (c) {
+            case '"':
+                dst[n++] = '\\';
+                dst[n++] = '"';
+                break;
+            case '\\':
+                dst[n++] = '\\';
+                dst[n++] = '\\';
+                break;
+            case '\n':
+                dst[n++] = '\\';
+                dst[n++] = 'n';
+                break;
+            case '\r':
+                dst[n++] = '\\';
+                dst[n++] = 'r';
+                break;
+            case '\t':
+                dst[n++] = '\\';
+                dst[n++] = 't';
+                break;
+            case '\b':
+                dst[n++] = '\\';
+                dst[n++] = 'b';
+                break;
+            case '\f':
+                dst[n++] = '\\';
+                dst[n++] = 'f';
+                break;
+            default:
+                if (c < 0x20) {
+                    dst[n++] = '\\';
+                    dst[n++] = 'u';
+                    dst[n++] = '0';
+                    dst[n++] = '0';
+                    dst[n++] = hex[c >> 4];
+                    dst[n++] = hex[c & 0xf];
+                } else {
+                    dst[n++] = (char)c;
+                }
+                break;
+        }
+    }
+
+    return n;
+}
+
+/* encode a log record as logger_json_file json followed by a newline, return the length */
+static int shim_logger_encode(char *dst, size_t size, const char *type, const char *buf, size_t len)
 {
-    logger_json_file *msg = NULL;
-    ssize_t ret = -1;
-    size_t len;
-    char *json = NULL;
     char timebuffer[64] = { 0 };
-    parser_error err = NULL;
-    struct parser_context ctx = { OPT_GEN_SIMPLIFY | OPT_GEN_NO_VALIDATE_UTF8, stderr };
+    size_t n = 0;
+    int nret = 0;
+
+    if (6 * len + LOG_RECORD_RESERVED > size) {
+        return SHIM_ERR;
+    }
+
+    (void)util_get_now_time_buffer(timebuffer, sizeof(timebuffer));
+
+    n = strlen(LOG_RECORD_HEAD);
+    memcpy(dst, LOG_RECORD_HEAD, n);
+    n += shim_json_escape(dst + n, buf, len);
+    nret = snprintf(dst + n, size - n, "\",\"stream\":\"%s\",\"time\":\"%s\"}\n", type, timebuffer);
+    if (nret < 0 || (size_t)nret >= size - n) {
+        return SHIM_ERR;
+    }
+
+    return (int)(n + (size_t)nret);
+}
+
+static ssize_t shim_logger_write(log_terminal *terminal, const char *type, const char *buf, int read_count)
+{
+    ssize_t ret = SHIM_ERR;
+    int record_len = 0;
 
     if (read_count < 0 || read_count >= INT_MAX) {
         return SHIM_ERR;
     }
 
-    msg = calloc(sizeof(logger_json_file), 1);
-    if (msg == NULL) {
+    if (terminal->fd < 0) {
         return SHIM_ERR;
     }
 
-    msg->log = calloc(read_count, 1);
-    if (!msg->log) {
-        goto cleanup;
+    (void)pthread_rwlock_wrlock(&terminal->log_terminal_rwlock);
+
+    // allocated once and reused by all records
+    if (terminal->batch == NULL) {
+        terminal->batch = calloc(LOG_BATCH_SIZE, 1);
+        if (terminal->batch == NULL) {
+            goto out;
+        }
     }
-    memcpy(msg->log, buf, read_count);
-    msg->log_len = read_count;
-    msg->stream = type ? safe_strdup(type) : safe_strdup("stdout");
 
-    util_get_now_time_buffer(timebuffer, sizeof(timebuffer));
-    msg->time = safe_strdup(timebuffer);
-    json = logger_json_file_generate_json(msg, &ctx, &err);
-    if (!json) {
-        goto cleanup;
+    if (terminal->batch_len + 6 * (size_t)read_count + LOG_RECORD_RESERVED > LOG_BATCH_SIZE) {
+        shim_json_data_flush(terminal);
     }
-    len = strlen(json);
-    json[len] = '\n';
-    if (terminal->fd < 0) {
-        goto cleanup;
+
+    record_len = shim_logger_encode(terminal->batch + terminal->batch_len, LOG_BATCH_SIZE - terminal->batch_len,
+                                    type != NULL ? type : STDOUT_STR, buf, (size_t)read_count);
+    if (record_len < 0) {
+        goto out;
     }
 
-    ret = shim_json_data_write(terminal, json, len + 1);
-cleanup:
-    free(json);
-    free_logger_json_file(msg);
-    free(err);
+    if (shim_json_data_append(terminal, (size_t)record_len) != SHIM_OK) {
+        goto out;
+    }
+
+    if (terminal->batch_len >= LOG_FLUSH_SIZE) {
+        shim_json_data_flush(terminal);
+    }
+    ret = record_len;
+
+out:
+    (void)pthread_rwlock_unlock(&terminal->log_terminal_rwlock);
     return ret;
 }
 
+void shim_flush_container_log_file(log_terminal *terminal)
+{
+    if (terminal == NULL || terminal->fd < 0) {
+        return;
+    }
+
+    (void)pthread_rwlock_wrlock(&terminal->log_terminal_rwlock);
+    shim_json_data_flush(terminal);
+    (void)pthread_rwlock_unlock(&terminal->log_terminal_rwlock);
+}
+
+void shim_close_container_log_file(log_terminal *terminal)
+{
+    if (terminal == NULL) {
+        return;
+    }
+
+    (void)pthread_rwlock_wrlock(&terminal->log_terminal_rwlock);
+    if (terminal->fd >= 0) {
+        shim_json_data_flush(terminal);
+    }
+    free(terminal->batch);
+    terminal->batch = NULL;
+    terminal->batch_len = 0;
+    (void)pthread_rwlock_unlock(&terminal->log_terminal_rwlock);
+}
+
 // BUF_CACHE_SIZE must be larger than read_count of buf readed
 static char cache_out[BUF_CACHE_SIZE] = { 0 };
 static char cache_err[BUF_CACHE_SIZE] = { 0 };
@@ -327,6 +467,7 @@ void shim_write_container_log_file(log_terminal *terminal, int type, char *buf,
             *size = 0;
         }
         if (buf == NULL) {
+            shim_flush_container_log_file(terminal);
             return;
         }
     }
@@ -353,5 +494,8 @@ int shim_create_container_log_file(log_terminal *terminal)
         return SHIM_ERR;
     }
 
+    // the size is tracked in memory from now on
+    terminal->log_size = get_log_file_size(terminal->fd);
+
     return SHIM_OK;
 }
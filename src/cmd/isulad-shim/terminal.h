@@ -32,11 +32,22 @@ typedef struct {
     int fd;
     unsigned int log_maxfile;
     pthread_rwlock_t log_terminal_rwlock;
+    // size of log file tracked in memory, -1 if unknown
+    int64_t log_size;
+    // encoded log records not written to log file yet
+    char *batch;
+    size_t batch_len;
 } log_terminal;
 
 void shim_write_container_log_file(log_terminal *terminal, int type, char *buf,
                                    int bytes_read);
 
+// write the buffered log records to log file
+void shim_flush_container_log_file(log_terminal *terminal);
+
+// write the buffered log records to log file and free the batch
+void shim_close_container_log_file(log_terminal *terminal);
+
 int shim_create_container_log_file(log_terminal *terminal);
 
 #ifdef __cplusplus
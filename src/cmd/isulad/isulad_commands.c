@@ -411,6 +411,23 @@ out:
     return ret;
 }
 
+static int check_max_concurrent_downloads(const struct service_arguments *args)
+{
+    if (args->max_concurrent_downloads == 0) {
+        COMMAND_ERROR("Invalid max concurrent downloads: it must be greater than 0");
+        ERROR("Invalid max concurrent downloads: it must be greater than 0");
+        return -1;
+    }
+
+    if (args->max_concurrent_downloads_per_registry == 0) {
+        COMMAND_ERROR("Invalid max concurrent downloads per registry: it must be greater than 0");
+        ERROR("Invalid max concurrent downloads per registry: it must be greater than 0");
+        return -1;
+    }
+
+    return 0;
+}
+
 int check_args(struct service_arguments *args)
 {
     int ret = 0;
@@ -471,6 +488,11 @@ int check_args(struct service_arguments *args)
         goto out;
     }
 
+    if (check_max_concurrent_downloads(args) != 0) {
+        ret = -1;
+        goto out;
+    }
+
 out:
     return ret;
 }
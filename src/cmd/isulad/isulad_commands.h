@@ -308,6 +308,20 @@ int command_default_ulimit_append(command_option_t *option, const char *arg);
       &(cmdargs)->json_confs->websocket_server_listening_port,                                                    \
       "CRI websocket streaming service listening port (default 10350)",                                           \
       command_convert_uint },                                                                                     \
+    { CMD_OPT_TYPE_CALLBACK,                                                                                      \
+      false,                                                                                                      \
+      "max-concurrent-downloads",                                                                                 \
+      0,                                                                                                          \
+      &(cmdargs)->max_concurrent_downloads,                                                                       \
+      "Max concurrent layer downloads of all pulls (default 10)",                                                 \
+      command_convert_uint },                                                                                     \
+    { CMD_OPT_TYPE_CALLBACK,                                                                                      \
+      false,                                                                                                      \
+      "max-concurrent-downloads-per-registry",                                                                    \
+      0,                                                                                                          \
+      &(cmdargs)->max_concurrent_downloads_per_registry,                                                          \
+      "Max concurrent layer downloads from one registry (default 5)",                                             \
+      command_convert_uint },                                                                                     \
     METRICS_PORT_OPT(cmdargs)                                                                                     \
     USERNS_REMAP_OPT(cmdargs)                                                                                     \
     { CMD_OPT_TYPE_BOOL,                                                                                          \
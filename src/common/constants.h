@@ -86,6 +86,9 @@ extern "C" {
 
 #define DEFAULT_WEBSOCKET_SERVER_LISTENING_PORT 10350
 
+#define DEFAULT_MAX_CONCURRENT_DOWNLOADS 10
+#define DEFAULT_MAX_CONCURRENT_DOWNLOADS_PER_REGISTRY 5
+
 #define CONTAINER_LOG_CONFIG_JSON_FILE_DRIVER "json-file"
 #define CONTAINER_LOG_CONFIG_SYSLOG_DRIVER "syslog"
 
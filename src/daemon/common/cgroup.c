@@ -603,6 +603,37 @@ int common_get_cgroup_version(void)
     return CGROUP_VERSION_1;
 }
 
+int common_cgroup_get_key_value(const char *content, const char *key, uint64_t *value)
+{
+    const char *line = NULL;
+    const char *end = NULL;
+    size_t key_len = 0;
+    size_t len = 0;
+    char num[ISULAD_NUMSTRLEN64] = { 0 };
+
+    if (content == NULL || key == NULL || value == NULL) {
+        return -1;
+    }
+
+    key_len = strlen(key);
+    for (line = content; line != NULL && *line != '\0'; line = (end != NULL) ? end + 1 : NULL) {
+        end = strchr(line, '\n');
+        if (strncmp(line, key, key_len) != 0 || line[key_len] != ' ') {
+            continue;
+        }
+
+        line += key_len + 1;
+        len = (end != NULL) ? (size_t)(end - line) : strlen(line);
+        if (len == 0 || len >= sizeof(num)) {
+            return -1;
+        }
+        (void)memcpy(num, line, len);
+        return util_safe_uint64(util_trim_space(num), value);
+    }
+
+    return -1;
+}
+
 static int cgroup2_enable_all()
 {
     int ret = 0;
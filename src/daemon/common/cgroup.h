@@ -35,6 +35,9 @@ int common_get_cgroup_version(void);
 
 int common_find_cgroup_mnt_and_root(const char *subsystem, char **mountpoint, char **root);
 
+// get value of key from flat keyed content, such as memory.stat and cpu.stat
+int common_cgroup_get_key_value(const char *content, const char *key, uint64_t *value);
+
 static inline void common_cgroup_do_log(bool quiet, bool do_log, const char *msg)
 {
     if (!quiet && do_log) {
@@ -130,63 +130,17 @@ static int get_value_ull(const char *content, const cgfile_callback_args_t *args
 
 static int get_match_value_ull(const char *content, const cgfile_callback_args_t *args, void *result)
 {
-    int ret = 0;
-    uint64_t llu_result = 0;
-    char *llu_string = NULL;
-    char *match_with_space = NULL;
-    char **lines = NULL;
-    char **worker = NULL;
-
     if (args == NULL || args->match == NULL || strlen(args->match) == 0) {
         ERROR("Invalid arguments");
         return -1;
     }
 
-    // match full string
-    match_with_space = util_string_append(" ", args->match);
-    if (match_with_space == NULL) {
-        ERROR("Failed to append string");
+    if (common_cgroup_get_key_value(content, args->match, (uint64_t *)result) != 0) {
+        ERROR("Cannot find match value of %s", args->match);
         return -1;
     }
 
-    lines = util_string_split(content, '\n');
-    if (lines == NULL) {
-        ERROR("Failed to split content %s", content);
-        ret = -1;
-        goto out;
-    }
-
-    for (worker = lines; worker && *worker; worker++) {
-        if (util_has_prefix(*worker, match_with_space)) {
-            break;
-        }
-    }
-    if (*worker == NULL) {
-        ERROR("Cannot find match string %s", args->match);
-        ret = -1;
-        goto out;
-    }
-
-    llu_string = util_sub_string(*worker, strlen(match_with_space), strlen(*worker) - strlen(match_with_space));
-    if (llu_string == NULL) {
-        ERROR("Failed to sub string");
-        ret = -1;
-        goto out;
-    }
-    llu_string = util_trim_space(llu_string);
-
-    ret = util_safe_uint64(llu_string, &llu_result);
-    if (ret != 0) {
-        ERROR("Failed to convert %s to uint64", llu_string);
-    } else {
-        *(uint64_t *)result = llu_result;
-    }
-
-out:
-    free(match_with_space);
-    free(llu_string);
-    util_free_array(lines);
-    return ret;
+    return 0;
 }
 
 static int get_value_string(const char *content, const cgfile_callback_args_t *args, void *result)
@@ -0,0 +1,291 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide latency tracing of container operation phases
+ ******************************************************************************/
+#include "phase_trace.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "isula_libutils/log.h"
+#include "utils_timestamp.h"
+
+/*
+ * Latencies are kept in log-linear histograms like HdrHistogram: each power of two range
+ * is split into PHASE_HIST_SUB_COUNT buckets, so quantiles are within 1/PHASE_HIST_SUB_COUNT
+ * of the real value, from 1us to 2^PHASE_HIST_MAX_EXP us (about 19 hours).
+ */
+#define PHASE_HIST_SUB_BITS 3
+#define PHASE_HIST_SUB_COUNT (1 << PHASE_HIST_SUB_BITS)
+#define PHASE_HIST_MAX_EXP 36
+#define PHASE_HIST_BUCKETS ((PHASE_HIST_MAX_EXP - PHASE_HIST_SUB_BITS + 2) * PHASE_HIST_SUB_COUNT)
+
+// length of the debug trace line of one operation
+#define PHASE_TRACE_LOG_LEN 1024
+
+struct phase_histogram {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[PHASE_HIST_BUCKETS];
+};
+
+struct phase_desc {
+    phase_trace_op op;
+    const char *name;
+};
+
+static const char * const g_op_names[PHASE_TRACE_OP_MAX] = {
+    [PHASE_TRACE_CREATE] = "create",
+    [PHASE_TRACE_START] = "start",
+    [PHASE_TRACE_STOP] = "stop",
+};
+
+static const phase_trace_phase g_op_totals[PHASE_TRACE_OP_MAX] = {
+    [PHASE_TRACE_CREATE] = PHASE_CREATE_TOTAL,
+    [PHASE_TRACE_START] = PHASE_START_TOTAL,
+    [PHASE_TRACE_STOP] = PHASE_STOP_TOTAL,
+};
+
+static const struct phase_desc g_phases[PHASE_TRACE_MAX] = {
+    [PHASE_CREATE_PREPARE] = { PHASE_TRACE_CREATE, "prepare" },
+    [PHASE_CREATE_SPEC] = { PHASE_TRACE_CREATE, "spec" },
+    [PHASE_CREATE_NETWORK_CONFS] = { PHASE_TRACE_CREATE, "network_confs" },
+    [PHASE_CREATE_ROOTFS] = { PHASE_TRACE_CREATE, "rootfs" },
+    [PHASE_CREATE_MERGE_IMAGE_CONFIG] = { PHASE_TRACE_CREATE, "merge_image_config" },
+    [PHASE_CREATE_VERIFY_CONFIG] = { PHASE_TRACE_CREATE, "verify_config" },
+    [PHASE_CREATE_OCI_CONFIG] = { PHASE_TRACE_CREATE, "oci_config" },
+    [PHASE_CREATE_MERGE_NETWORK] = { PHASE_TRACE_CREATE, "merge_network" },
+    [PHASE_CREATE_PLUGIN] = { PHASE_TRACE_CREATE, "plugin_pre_create" },
+    [PHASE_CREATE_HOST_CHANNEL] = { PHASE_TRACE_CREATE, "host_channel" },
+    [PHASE_CREATE_VERIFY_SETTINGS] = { PHASE_TRACE_CREATE, "verify_settings" },
+    [PHASE_CREATE_SAVE_OCI_CONFIG] = { PHASE_TRACE_CREATE, "save_oci_config" },
+    [PHASE_CREATE_REGISTER] = { PHASE_TRACE_CREATE, "register" },
+    [PHASE_CREATE_TOTAL] = { PHASE_TRACE_CREATE, "total" },
+
+    [PHASE_START_LOCK] = { PHASE_TRACE_START, "lock" },
+    [PHASE_START_NETWORK] = { PHASE_TRACE_START, "network" },
+    [PHASE_START_PREPARE] = { PHASE_TRACE_START, "prepare" },
+    [PHASE_START_LOAD_OCI_CONFIG] = { PHASE_TRACE_START, "load_oci_config" },
+    [PHASE_START_MOUNT_ROOTFS] = { PHASE_TRACE_START, "mount_rootfs" },
+    [PHASE_START_MOUNTS] = { PHASE_TRACE_START, "mounts" },
+    [PHASE_START_OCI_CONFIG] = { PHASE_TRACE_START, "oci_config" },
+    [PHASE_START_PLUGIN] = { PHASE_TRACE_START, "plugin_pre_start" },
+    [PHASE_START_RUNTIME_CREATE] = { PHASE_TRACE_START, "runtime_create" },
+    [PHASE_START_RUNTIME_START] = { PHASE_TRACE_START, "runtime_start" },
+    [PHASE_START_POST] = { PHASE_TRACE_START, "post_start" },
+    [PHASE_START_TOTAL] = { PHASE_TRACE_START, "total" },
+
+    [PHASE_STOP_LOCK] = { PHASE_TRACE_STOP, "lock" },
+    [PHASE_STOP_HEALTH_CHECKS] = { PHASE_TRACE_STOP, "health_checks" },
+    [PHASE_STOP_SIGNAL] = { PHASE_TRACE_STOP, "signal" },
+    [PHASE_STOP_WAIT] = { PHASE_TRACE_STOP, "wait" },
+    [PHASE_STOP_FORCE_KILL] = { PHASE_TRACE_STOP, "force_kill" },
+    [PHASE_STOP_TOTAL] = { PHASE_TRACE_STOP, "total" },
+};
+
+static struct phase_histogram g_histograms[PHASE_TRACE_MAX];
+static pthread_mutex_t g_histograms_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int64_t phase_trace_now(void)
+{
+    struct timespec ts = { 0 };
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        return 0;
+    }
+
+    return (int64_t)ts.tv_sec * Time_Second + ts.tv_nsec;
+}
+
+size_t phase_hist_index(uint64_t value)
+{
+    int exp = 0;
+
+    if (value < PHASE_HIST_SUB_COUNT) {
+        return (size_t)value;
+    }
+
+    exp = 63 - __builtin_clzll(value);
+    if (exp > PHASE_HIST_MAX_EXP) {
+        return PHASE_HIST_BUCKETS - 1;
+    }
+
+    return (size_t)(exp - PHASE_HIST_SUB_BITS + 1) * PHASE_HIST_SUB_COUNT +
+           ((value >> (exp - PHASE_HIST_SUB_BITS)) & (PHASE_HIST_SUB_COUNT - 1));
+}
+
+uint64_t phase_hist_value(size_t index)
+{
+    int exp = 0;
+    uint64_t sub = 0;
+
+    if (index < PHASE_HIST_SUB_COUNT) {
+        return (uint64_t)index;
+    }
+
+    exp = (int)(index / PHASE_HIST_SUB_COUNT) + PHASE_HIST_SUB_BITS - 1;
+    sub = index % PHASE_HIST_SUB_COUNT;
+
+    return ((PHASE_HIST_SUB_COUNT + sub + 1) << (exp - PHASE_HIST_SUB_BITS)) - 1;
+}
+
+void phase_trace_record(phase_trace_phase phase, uint64_t value)
+{
+    struct phase_histogram *hist = NULL;
+
+    if (phase >= PHASE_TRACE_MAX) {
+        return;
+    }
+
+    hist = &g_histograms[phase];
+    (void)pthread_mutex_lock(&g_histograms_lock);
+    hist->count++;
+    hist->sum += value;
+    if (value > hist->max) {
+        hist->max = value;
+    }
+    hist->buckets[phase_hist_index(value)]++;
+    (void)pthread_mutex_unlock(&g_histograms_lock);
+}
+
+static uint64_t phase_hist_quantile(const struct phase_histogram *hist, double quantile)
+{
+    size_t i;
+    uint64_t seen = 0;
+    uint64_t rank = (uint64_t)(quantile * (double)hist->count + 0.5);
+
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    for (i = 0; i < PHASE_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            // the bucket may be wider than the max value recorded
+            return phase_hist_value(i) < hist->max ? phase_hist_value(i) : hist->max;
+        }
+    }
+
+    return hist->max;
+}
+
+void phase_trace_begin(phase_trace_t *trace, phase_trace_op op, const char *id)
+{
+    if (trace == NULL) {
+        return;
+    }
+
+    (void)memset(trace, 0, sizeof(*trace));
+    trace->op = op;
+    trace->id = id;
+    trace->begin = phase_trace_now();
+    trace->last = trace->begin;
+}
+
+void phase_trace_mark(phase_trace_t *trace, phase_trace_phase phase)
+{
+    int64_t now = 0;
+    int64_t duration = 0;
+
+    if (trace == NULL || phase >= PHASE_TRACE_MAX || g_phases[phase].op != trace->op) {
+        return;
+    }
+
+    now = phase_trace_now();
+    duration = (now - trace->last) / Time_Micro;
+    trace->last = now;
+    trace->reached |= 1ULL << phase;
+    trace->durations[phase] += duration;
+
+    phase_trace_record(phase, (uint64_t)(duration > 0 ? duration : 0));
+}
+
+static void phase_trace_log(const phase_trace_t *trace, int64_t total)
+{
+    char buf[PHASE_TRACE_LOG_LEN] = { 0 };
+    size_t len = 0;
+    int nret = 0;
+    int i;
+
+    for (i = 0; i < PHASE_TRACE_MAX; i++) {
+        if ((trace->reached & (1ULL << i)) == 0) {
+            continue;
+        }
+        nret = snprintf(buf + len, sizeof(buf) - len, " %s=%lldus", g_phases[i].name,
+                        (long long)trace->durations[i]);
+        if (nret < 0 || (size_t)nret >= sizeof(buf) - len) {
+            break;
+        }
+        len += (size_t)nret;
+    }
+
+    DEBUG("Trace %s %s took %lldus:%s", g_op_names[trace->op], trace->id != NULL ? trace->id : "",
+          (long long)total, buf);
+}
+
+void phase_trace_end(phase_trace_t *trace, bool success)
+{
+    int64_t total = 0;
+
+    if (trace == NULL || trace->op >= PHASE_TRACE_OP_MAX) {
+        return;
+    }
+
+    total = (phase_trace_now() - trace->begin) / Time_Micro;
+    // failed operations end at different phases, only phases reached are recorded for them
+    if (success) {
+        phase_trace_record(g_op_totals[trace->op], (uint64_t)(total > 0 ? total : 0));
+    }
+
+    phase_trace_log(trace, total);
+}
+
+const char *phase_trace_op_name(phase_trace_phase phase)
+{
+    if (phase >= PHASE_TRACE_MAX) {
+        return NULL;
+    }
+
+    return g_op_names[g_phases[phase].op];
+}
+
+const char *phase_trace_phase_name(phase_trace_phase phase)
+{
+    if (phase >= PHASE_TRACE_MAX) {
+        return NULL;
+    }
+
+    return g_phases[phase].name;
+}
+
+void phase_trace_get_summary(phase_trace_phase phase, phase_latency_summary_t *summary)
+{
+    struct phase_histogram *hist = NULL;
+
+    if (phase >= PHASE_TRACE_MAX || summary == NULL) {
+        return;
+    }
+
+    hist = &g_histograms[phase];
+    (void)pthread_mutex_lock(&g_histograms_lock);
+    summary->count = hist->count;
+    summary->sum = hist->sum;
+    summary->max = hist->max;
+    summary->p50 = hist->count > 0 ? phase_hist_quantile(hist, 0.5) : 0;
+    summary->p90 = hist->count > 0 ? phase_hist_quantile(hist, 0.9) : 0;
+    summary->p99 = hist->count > 0 ? phase_hist_quantile(hist, 0.99) : 0;
+    (void)pthread_mutex_unlock(&g_histograms_lock);
+}
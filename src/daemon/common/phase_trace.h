@@ -0,0 +1,116 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide latency tracing of container operation phases definition
+ ******************************************************************************/
+#ifndef DAEMON_COMMON_PHASE_TRACE_H
+#define DAEMON_COMMON_PHASE_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { PHASE_TRACE_CREATE = 0, PHASE_TRACE_START, PHASE_TRACE_STOP, PHASE_TRACE_OP_MAX } phase_trace_op;
+
+typedef enum {
+    PHASE_CREATE_PREPARE = 0,
+    PHASE_CREATE_SPEC,
+    PHASE_CREATE_NETWORK_CONFS,
+    PHASE_CREATE_ROOTFS,
+    PHASE_CREATE_MERGE_IMAGE_CONFIG,
+    PHASE_CREATE_VERIFY_CONFIG,
+    PHASE_CREATE_OCI_CONFIG,
+    PHASE_CREATE_MERGE_NETWORK,
+    PHASE_CREATE_PLUGIN,
+    PHASE_CREATE_HOST_CHANNEL,
+    PHASE_CREATE_VERIFY_SETTINGS,
+    PHASE_CREATE_SAVE_OCI_CONFIG,
+    PHASE_CREATE_REGISTER,
+    PHASE_CREATE_TOTAL,
+
+    PHASE_START_LOCK,
+    PHASE_START_NETWORK,
+    PHASE_START_PREPARE,
+    PHASE_START_LOAD_OCI_CONFIG,
+    PHASE_START_MOUNT_ROOTFS,
+    PHASE_START_MOUNTS,
+    PHASE_START_OCI_CONFIG,
+    PHASE_START_PLUGIN,
+    PHASE_START_RUNTIME_CREATE,
+    PHASE_START_RUNTIME_START,
+    PHASE_START_POST,
+    PHASE_START_TOTAL,
+
+    PHASE_STOP_LOCK,
+    PHASE_STOP_HEALTH_CHECKS,
+    PHASE_STOP_SIGNAL,
+    PHASE_STOP_WAIT,
+    PHASE_STOP_FORCE_KILL,
+    PHASE_STOP_TOTAL,
+
+    PHASE_TRACE_MAX
+} phase_trace_phase;
+
+// trace of one operation, it lives on the stack of the operation
+typedef struct {
+    phase_trace_op op;
+    const char *id;
+    int64_t begin;
+    int64_t last;
+    // bit of phases reached by the operation
+    uint64_t reached;
+    // time in micros spent in each reached phase
+    int64_t durations[PHASE_TRACE_MAX];
+} phase_trace_t;
+
+typedef struct {
+    uint64_t count;
+    // all times in micros
+    uint64_t sum;
+    uint64_t max;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+} phase_latency_summary_t;
+
+void phase_trace_begin(phase_trace_t *trace, phase_trace_op op, const char *id);
+
+// record the time since the last mark, or since begin, as the duration of phase
+void phase_trace_mark(phase_trace_t *trace, phase_trace_phase phase);
+
+// record the total time of a succeeded operation, and log the phases of it at debug level
+void phase_trace_end(phase_trace_t *trace, bool success);
+
+// record a latency in micros of phase
+void phase_trace_record(phase_trace_phase phase, uint64_t value);
+
+const char *phase_trace_op_name(phase_trace_phase phase);
+
+const char *phase_trace_phase_name(phase_trace_phase phase);
+
+void phase_trace_get_summary(phase_trace_phase phase, phase_latency_summary_t *summary);
+
+// bucket of value in the latency histograms
+size_t phase_hist_index(uint64_t value);
+
+// highest value falls in bucket index
+uint64_t phase_hist_value(size_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_COMMON_PHASE_TRACE_H
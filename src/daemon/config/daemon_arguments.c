@@ -166,6 +166,8 @@ int service_arguments_init(struct service_arguments *args)
     args->default_ulimit = NULL;
     args->default_ulimit_len = 0;
     args->json_confs->websocket_server_listening_port = DEFAULT_WEBSOCKET_SERVER_LISTENING_PORT;
+    args->max_concurrent_downloads = DEFAULT_MAX_CONCURRENT_DOWNLOADS;
+    args->max_concurrent_downloads_per_registry = DEFAULT_MAX_CONCURRENT_DOWNLOADS_PER_REGISTRY;
     args->json_confs->selinux_enabled = false;
     args->json_confs->default_runtime = util_strdup_s(DEFAULT_RUNTIME_NAME);
     args->json_confs->cri_runtimes = (json_map_string_string *)util_common_calloc_s(sizeof(json_map_string_string));
@@ -53,6 +53,11 @@ struct service_arguments {
         unsigned int start_timeout;
     };
 
+    struct { /* image download configs, not in isulad_daemon_configs */
+        unsigned int max_concurrent_downloads;
+        unsigned int max_concurrent_downloads_per_registry;
+    };
+
     struct { /* daemon log configs */
         unsigned int log_file_mode;
         char *logpath;
@@ -28,6 +28,7 @@
 #include <isula_libutils/json_common.h>
 #include <isula_libutils/oci_runtime_spec.h>
 #include <isula_libutils/log.h>
+#include <yajl/yajl_tree.h>
 
 #include "constants.h"
 #include "utils.h"
@@ -1281,6 +1282,54 @@ out:
     return port;
 }
 
+/* conf get max concurrent layer downloads of the whole daemon */
+unsigned int conf_get_max_concurrent_downloads()
+{
+    unsigned int num = DEFAULT_MAX_CONCURRENT_DOWNLOADS;
+    struct service_arguments *conf = NULL;
+
+    if (isulad_server_conf_rdlock() != 0) {
+        return num;
+    }
+
+    conf = conf_get_server_conf();
+    if (conf == NULL) {
+        goto out;
+    }
+
+    if (conf->max_concurrent_downloads > 0) {
+        num = conf->max_concurrent_downloads;
+    }
+
+out:
+    (void)isulad_server_conf_unlock();
+    return num;
+}
+
+/* conf get max concurrent layer downloads from one registry */
+unsigned int conf_get_max_concurrent_downloads_per_registry()
+{
+    unsigned int num = DEFAULT_MAX_CONCURRENT_DOWNLOADS_PER_REGISTRY;
+    struct service_arguments *conf = NULL;
+
+    if (isulad_server_conf_rdlock() != 0) {
+        return num;
+    }
+
+    conf = conf_get_server_conf();
+    if (conf == NULL) {
+        goto out;
+    }
+
+    if (conf->max_concurrent_downloads_per_registry > 0) {
+        num = conf->max_concurrent_downloads_per_registry;
+    }
+
+out:
+    (void)isulad_server_conf_unlock();
+    return num;
+}
+
 /* save args to conf */
 int save_args_to_conf(struct service_arguments *args)
 {
@@ -1601,6 +1650,63 @@ static int merge_default_ulimits_conf_into_global(struct service_arguments *args
     return 0;
 }
 
+static int get_json_conf_uint(yajl_val tree, const char *key, unsigned int *value)
+{
+    const char *path[] = { key, NULL };
+    yajl_val node = NULL;
+
+    node = yajl_tree_get(tree, path, yajl_t_any);
+    if (node == NULL) {
+        return 0;
+    }
+
+    if (!YAJL_IS_INTEGER(node) || YAJL_GET_INTEGER(node) <= 0 || YAJL_GET_INTEGER(node) > UINT_MAX) {
+        COMMAND_ERROR("Invalid %s in %s, it must be a positive integer", key, ISULAD_DAEMON_JSON_CONF_FILE);
+        return -1;
+    }
+
+    *value = (unsigned int)YAJL_GET_INTEGER(node);
+    return 0;
+}
+
+// download configs are owned by isulad rather than isulad_daemon_configs, read them from daemon.json directly
+static int merge_download_confs_into_global(struct service_arguments *args)
+{
+    char *content = NULL;
+    yajl_val tree = NULL;
+    char errbuf[BUFSIZ] = { 0 };
+    int ret = 0;
+
+    if (!util_file_exists(ISULAD_DAEMON_JSON_CONF_FILE)) {
+        return 0;
+    }
+
+    content = util_read_text_file(ISULAD_DAEMON_JSON_CONF_FILE);
+    if (content == NULL) {
+        COMMAND_ERROR("Failed to read %s", ISULAD_DAEMON_JSON_CONF_FILE);
+        return -1;
+    }
+
+    tree = yajl_tree_parse(content, errbuf, sizeof(errbuf));
+    if (tree == NULL) {
+        COMMAND_ERROR("Failed to parse %s: %s", ISULAD_DAEMON_JSON_CONF_FILE, errbuf);
+        ret = -1;
+        goto out;
+    }
+
+    if (get_json_conf_uint(tree, "max-concurrent-downloads", &args->max_concurrent_downloads) != 0 ||
+        get_json_conf_uint(tree, "max-concurrent-downloads-per-registry",
+                           &args->max_concurrent_downloads_per_registry) != 0) {
+        ret = -1;
+        goto out;
+    }
+
+out:
+    yajl_tree_free(tree);
+    free(content);
+    return ret;
+}
+
 int merge_json_confs_into_global(struct service_arguments *args)
 {
     isulad_daemon_configs *tmp_json_confs;
@@ -1686,6 +1792,11 @@ int merge_json_confs_into_global(struct service_arguments *args)
         args->json_confs->websocket_server_listening_port = tmp_json_confs->websocket_server_listening_port;
     }
 
+    if (merge_download_confs_into_global(args) != 0) {
+        ret = -1;
+        goto out;
+    }
+
     override_bool_pointer_value(&args->json_confs->use_decrypted_key, &tmp_json_confs->use_decrypted_key);
 
     if (tmp_json_confs->insecure_skip_verify_enforce) {
@@ -62,6 +62,9 @@ char *conf_get_cni_conf_dir();
 int conf_get_cni_bin_dir(char ***dst);
 int32_t conf_get_websocket_server_listening_port();
 
+unsigned int conf_get_max_concurrent_downloads();
+unsigned int conf_get_max_concurrent_downloads_per_registry();
+
 int save_args_to_conf(struct service_arguments *args);
 
 int set_unix_socket_group(const char *socket, const char *group);
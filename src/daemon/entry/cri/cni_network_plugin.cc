@@ -21,6 +21,9 @@
 #include <set>
 #include <utility>
 #include <vector>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
 
 #include <isula_libutils/log.h>
 #include <isula_libutils/cni_anno_port_mappings.h>
@@ -77,19 +80,10 @@ void CniNetworkPlugin::PlatformInit(Errors &error)
 
 void CniNetworkPlugin::SyncNetworkConfig()
 {
-    Errors err;
-    WLockNetworkMap(err);
-    if (err.NotEmpty()) {
-        return;
-    }
-
+    // network module loads configs without lock, and replaces them as a whole,
+    // so pods in setup or teardown are not blocked by the reloading
     if (network_module_update(NETWOKR_API_TYPE_CRI) != 0) {
-        err.SetError("update cni conf list failed");
-    }
-
-    UnlockNetworkMap(err);
-    if (err.NotEmpty()) {
-        WARN("Unable to update cni config: %s", err.GetCMessage());
+        WARN("Unable to update cni config: update cni conf list failed");
     }
 }
 
@@ -107,7 +101,7 @@ void CniNetworkPlugin::Init(const std::string &hairpinMode, const std::string &n
 
     SyncNetworkConfig();
 
-    // start a thread to sync network config from confDir periodically to detect network config updates in every 5 seconds
+    // start a thread to sync network config when files in confDir changed
     m_syncThread = std::thread([&]() {
         UpdateDefaultNetwork();
     });
@@ -818,21 +812,90 @@ void CniNetworkPlugin::UnlockNetworkMap(Errors &error)
     }
 }
 
+// Read all pending events of inotify fd, return whether any event is read.
+// watchLost is set if the watched conf dir is removed or moved.
+static auto ReadConfDirEvents(int fd, bool &watchLost) -> bool
+{
+    alignas(struct inotify_event) char buf[4096];
+    bool got = false;
+
+    while (true) {
+        ssize_t len = read(fd, buf, sizeof(buf));
+        if (len <= 0) {
+            if (len < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        got = true;
+        for (char *ptr = buf; ptr < buf + len;) {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(ptr);
+            if ((event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) != 0) {
+                watchLost = true;
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    return got;
+}
+
 void CniNetworkPlugin::UpdateDefaultNetwork()
 {
-    const int defaultSyncConfigCnt = 5;
-    const int defaultSyncConfigPeriod = 1000;
+    // check m_needFinish in every second
+    const int waitPeriod = 1000;
+    // resync periodically, in case of the conf dir cannot be watched or events are missed;
+    // it only stats the conf files, and parses the changed ones
+    const auto watchedSyncPeriod = std::chrono::seconds(60);
+    const auto unwatchedSyncPeriod = std::chrono::seconds(5);
+    const uint32_t watchMask = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_ATTRIB |
+                               IN_DELETE_SELF | IN_MOVE_SELF;
+    int wd = -1;
+    auto lastSync = std::chrono::steady_clock::now();
 
     pthread_setname_np(pthread_self(), "CNIUpdater");
 
-    while (true) {
-        for (int i = 0; i < defaultSyncConfigCnt; i++) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(defaultSyncConfigPeriod));
-            if (m_needFinish) {
-                return;
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        WARN("Failed to init inotify: %s, sync cni config periodically", strerror(errno));
+    }
+
+    while (!m_needFinish) {
+        bool needSync = false;
+
+        if (fd >= 0 && wd < 0 && !m_confDir.empty()) {
+            wd = inotify_add_watch(fd, m_confDir.c_str(), watchMask);
+            if (wd >= 0) {
+                // files may be changed before watching
+                needSync = true;
             }
         }
+
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int nret = poll(&pfd, fd >= 0 ? 1 : 0, waitPeriod);
+        if (nret > 0) {
+            bool watchLost = false;
+            needSync = ReadConfDirEvents(fd, watchLost) || needSync;
+            if (watchLost && wd >= 0) {
+                (void)inotify_rm_watch(fd, wd);
+                wd = -1;
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSync >= (wd >= 0 ? watchedSyncPeriod : unwatchedSyncPeriod)) {
+            needSync = true;
+        }
+        if (!needSync) {
+            continue;
+        }
+
         SyncNetworkConfig();
+        lastSync = now;
+    }
+
+    if (fd >= 0) {
+        close(fd);
     }
 }
 
@@ -1361,27 +1361,55 @@ auto PodSandboxManagerService::GetNsenterPath(Errors &error) -> std::string
     return path;
 }
 
-void PodSandboxManagerService::GetPodSandboxNetworkMetrics(const container_inspect *inspectData,
-                                                           std::map<std::string, std::string> &annotations,
-                                                           std::vector<Network::NetworkInterfaceStats> &netMetrics,
-                                                           Errors &error)
+void PodSandboxManagerService::GetInterfaceNetworkStats(
+    const std::string &netnsPath, const std::string &interfaceName,
+    const std::map<std::string, Network::NetworkInterfaceStats> &allStats, bool netlinkOK,
+    Network::NetworkInterfaceStats &netStats, Errors &error)
 {
-    Errors tmpErr;
+    if (netlinkOK) {
+        auto iter = allStats.find(interfaceName);
+        if (iter == allStats.end()) {
+            error.Errorf("Interface %s not found", interfaceName.c_str());
+            return;
+        }
+        netStats = iter->second;
+        return;
+    }
 
+    Errors tmpErr;
     auto nsenterPath = GetNsenterPath(tmpErr);
     if (tmpErr.NotEmpty()) {
         error.Errorf("Failed to get nsenter: %s", tmpErr.GetCMessage());
         return;
     }
 
+    Network::GetPodNetworkStats(nsenterPath, netnsPath, interfaceName, netStats, error);
+}
+
+void PodSandboxManagerService::GetPodSandboxNetworkMetrics(const container_inspect *inspectData,
+                                                           std::map<std::string, std::string> &annotations,
+                                                           std::vector<Network::NetworkInterfaceStats> &netMetrics,
+                                                           Errors &error)
+{
+    Errors tmpErr;
+
     std::string netnsPath = GetSandboxKey(inspectData);
     if (netnsPath.size() == 0) {
         error.SetError("Failed to get network namespace path");
         return;
     }
 
+    // stats of all interfaces with one netlink dump, run ip command for each interface if it fails
+    std::map<std::string, Network::NetworkInterfaceStats> allStats;
+    Network::GetPodAllNetworkStats(netnsPath, allStats, tmpErr);
+    bool netlinkOK = tmpErr.Empty();
+    if (!netlinkOK) {
+        WARN("Failed to get network stats by netlink: %s", tmpErr.GetCMessage());
+        tmpErr.Clear();
+    }
+
     Network::NetworkInterfaceStats netStats;
-    Network::GetPodNetworkStats(nsenterPath, netnsPath, Network::DEFAULT_NETWORK_INTERFACE_NAME, netStats, tmpErr);
+    GetInterfaceNetworkStats(netnsPath, Network::DEFAULT_NETWORK_INTERFACE_NAME, allStats, netlinkOK, netStats, tmpErr);
     if (tmpErr.NotEmpty()) {
         error.Errorf("Failed to get network stats: %s", tmpErr.GetCMessage());
         return;
@@ -1404,7 +1432,8 @@ void PodSandboxManagerService::GetPodSandboxNetworkMetrics(const container_inspe
         }
 
         Network::NetworkInterfaceStats netStats;
-        Network::GetPodNetworkStats(nsenterPath, netnsPath, std::string(networks->items[i]->interface), netStats, tmpErr);
+        GetInterfaceNetworkStats(netnsPath, std::string(networks->items[i]->interface), allStats, netlinkOK, netStats,
+                                 tmpErr);
         if (tmpErr.NotEmpty()) {
             WARN("Failed to get network stats: %s", tmpErr.GetCMessage());
             tmpErr.Clear();
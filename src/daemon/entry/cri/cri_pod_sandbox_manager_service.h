@@ -138,6 +138,9 @@ private:
     auto GetAvailableBytes(const uint64_t &memoryLimit, const uint64_t &workingSetBytes) -> uint64_t;
     void GetPodSandboxCgroupMetrics(const container_inspect *inspectData, cgroup_metrics_t &cgroupMetrics,
                                     Errors &error);
+    void GetInterfaceNetworkStats(const std::string &netnsPath, const std::string &interfaceName,
+                                  const std::map<std::string, Network::NetworkInterfaceStats> &allStats,
+                                  bool netlinkOK, Network::NetworkInterfaceStats &netStats, Errors &error);
     void GetPodSandboxNetworkMetrics(const container_inspect *inspectData,
                                      std::map<std::string, std::string> &annotations,
                                      std::vector<Network::NetworkInterfaceStats> &netMetrics, Errors &error);
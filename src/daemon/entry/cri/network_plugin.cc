@@ -21,6 +21,7 @@
 #include <unistd.h>
 
 #include "utils_network.h"
+#include "network_namespace.h"
 #include "utils.h"
 #include "cxxutils.h"
 #include "isula_libutils/log.h"
@@ -705,4 +706,28 @@ free_out:
     util_free_array(args);
 }
 
+void GetPodAllNetworkStats(const std::string &netnsPath, std::map<std::string, struct NetworkInterfaceStats> &stats,
+                           Errors &error)
+{
+    struct netns_link_stats *links { nullptr };
+    size_t len { 0 };
+
+    if (get_network_namespace_link_stats(netnsPath.c_str(), &links, &len) != 0) {
+        error.Errorf("Failed to get link stats of network namespace %s", netnsPath.c_str());
+        return;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        struct NetworkInterfaceStats one;
+        one.name = links[i].name;
+        one.rxBytes = links[i].rx_bytes;
+        one.rxErrors = links[i].rx_errors;
+        one.txBytes = links[i].tx_bytes;
+        one.txErrors = links[i].tx_errors;
+        stats[one.name] = one;
+    }
+
+    free(links);
+}
+
 } // namespace Network
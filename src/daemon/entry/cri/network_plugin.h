@@ -232,6 +232,10 @@ struct NetworkInterfaceStats {
 
 void GetPodNetworkStats(const std::string &nsenterPath, const std::string &netnsPath, const std::string &interfaceName,
                         struct NetworkInterfaceStats &stats, Errors &error);
+
+// get stats of all interfaces in the pod network namespace at once, without running commands
+void GetPodAllNetworkStats(const std::string &netnsPath, std::map<std::string, struct NetworkInterfaceStats> &stats,
+                           Errors &error);
 } // namespace Network
 
 #endif
@@ -261,7 +261,7 @@ out:
 
 static int prepare_start_io(container_t *cont, const container_start_request *request, char **fifopath, char *fifos[],
                             int stdinfd, struct io_write_wrapper *stdout_handler,
-                            struct io_write_wrapper *stderr_handler, int *sync_fd, pthread_t *thread_id)
+                            struct io_write_wrapper *stderr_handler, int *sync_fd, io_copy_session **io_session)
 {
     int ret = 0;
     char *id = NULL;
@@ -283,7 +283,7 @@ static int prepare_start_io(container_t *cont, const container_start_request *re
         }
 
         if (ready_copy_io_data(*sync_fd, false, request->stdin, request->stdout, request->stderr, stdinfd,
-                               stdout_handler, stderr_handler, (const char **)fifos, thread_id)) {
+                               stdout_handler, stderr_handler, (const char **)fifos, io_session)) {
             ret = -1;
             goto out;
         }
@@ -440,7 +440,7 @@ static int cpurt_controller_init(const char *id, const host_config *host_spec)
 
 static int container_start_prepare(container_t *cont, const container_start_request *request, int stdinfd,
                                    struct io_write_wrapper *stdout_handler, struct io_write_wrapper *stderr_handler,
-                                   char **fifopath, char *fifos[], int *sync_fd, pthread_t *thread_id)
+                                   char **fifopath, char *fifos[], int *sync_fd, io_copy_session **io_session)
 {
     const char *id = cont->common_config->id;
 
@@ -463,21 +463,19 @@ static int container_start_prepare(container_t *cont, const container_start_requ
         return -1;
     }
 
-    if (prepare_start_io(cont, request, fifopath, fifos, stdinfd, stdout_handler, stderr_handler, sync_fd, thread_id) !=
-        0) {
+    if (prepare_start_io(cont, request, fifopath, fifos, stdinfd, stdout_handler, stderr_handler, sync_fd,
+                         io_session) != 0) {
         return -1;
     }
 
     return 0;
 }
 
-static void handle_start_io_thread_by_cc(uint32_t cc, int sync_fd, pthread_t thread_id)
+static void handle_start_io_thread_by_cc(uint32_t cc, int sync_fd, io_copy_session *io_session)
 {
     if (cc == ISULAD_SUCCESS) {
-        if (thread_id > 0) {
-            if (pthread_detach(thread_id) != 0) {
-                SYSERROR("Failed to detach 0x%lx", thread_id);
-            }
+        if (io_session != NULL) {
+            io_copy_session_detach(io_session);
         }
         if (sync_fd >= 0) {
             close(sync_fd);
@@ -488,10 +486,8 @@ static void handle_start_io_thread_by_cc(uint32_t cc, int sync_fd, pthread_t thr
                 ERROR("Failed to write eventfd: %s", strerror(errno));
             }
         }
-        if (thread_id > 0) {
-            if (pthread_join(thread_id, NULL) != 0) {
-                ERROR("Failed to join thread: 0x%lx", thread_id);
-            }
+        if (io_session != NULL) {
+            io_copy_session_wait(io_session, NULL);
         }
         if (sync_fd >= 0) {
             close(sync_fd);
@@ -508,7 +504,7 @@ static int container_start_cb(const container_start_request *request, container_
     char *fifopath = NULL;
     container_t *cont = NULL;
     int sync_fd = -1;
-    pthread_t thread_id = 0;
+    io_copy_session *io_session = NULL;
 
     DAEMON_CLEAR_ERRMSG();
 
@@ -550,7 +546,7 @@ static int container_start_cb(const container_start_request *request, container_
     }
 
     if (container_start_prepare(cont, request, stdinfd, stdout_handler, stderr_handler, &fifopath, fifos, &sync_fd,
-                                &thread_id) != 0) {
+                                &io_session) != 0) {
         cc = ISULAD_ERR_EXEC;
         goto pack_response;
     }
@@ -564,7 +560,7 @@ static int container_start_cb(const container_start_request *request, container_
     (void)isulad_monitor_send_container_event(id, START, -1, 0, NULL, NULL);
 
 pack_response:
-    handle_start_io_thread_by_cc(cc, sync_fd, thread_id);
+    handle_start_io_thread_by_cc(cc, sync_fd, io_session);
     delete_daemon_fifos(fifopath, (const char **)fifos);
     free(fifos[0]);
     free(fifos[1]);
@@ -39,6 +39,7 @@
 #include "specs_api.h"
 #include "verify.h"
 #include "container_api.h"
+#include "container_journal.h"
 #include "execution_network.h"
 #include "plugin_api.h"
 #include "image_api.h"
@@ -57,6 +58,7 @@
 #include "utils_verify.h"
 #include "selinux_label.h"
 #include "opt_log.h"
+#include "phase_trace.h"
 #include "runtime_api.h"
 
 static int create_request_check(const container_create_request *request)
@@ -925,6 +927,8 @@ static int delete_container_root_dir(const char *id, const char *runtime_root)
         goto out;
     }
 
+    container_journal_forget(runtime_root, id);
+
     ret = util_recursive_rmdir(container_root, 0);
     if (ret != 0) {
         ERROR("Failed to delete container's state directory %s", container_root);
@@ -1346,6 +1350,7 @@ int container_create_cb(const container_create_request *request, container_creat
     container_config_v2_common_config *v2_spec = NULL;
     host_config_host_channel *host_channel = NULL;
     container_network_settings *network_settings = NULL;
+    phase_trace_t trace;
     int ret = 0;
 
     DAEMON_CLEAR_ERRMSG();
@@ -1354,9 +1359,12 @@ int container_create_cb(const container_create_request *request, container_creat
         return -1;
     }
 
+    phase_trace_begin(&trace, PHASE_TRACE_CREATE, NULL);
+
     if (get_request_container_info(request, &id, &name, &cc) != 0) {
         goto pack_response;
     }
+    trace.id = id;
 
     if (get_request_image_info(request, &image_type, &image_name) != 0) {
         cc = ISULAD_ERR_EXEC;
@@ -1367,6 +1375,8 @@ int container_create_cb(const container_create_request *request, container_creat
         goto clean_nameindex;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_PREPARE);
+
     if (get_basic_spec(request, &host_spec, &container_spec) != 0) {
         cc = ISULAD_ERR_INPUT;
         goto clean_container_root_dir;
@@ -1396,12 +1406,16 @@ int container_create_cb(const container_create_request *request, container_creat
         goto clean_container_root_dir;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_SPEC);
+
     if (init_container_network_confs(id, runtime_root, host_spec, v2_spec) != 0) {
         ERROR("Init Network files failed");
         cc = ISULAD_ERR_INPUT;
         goto clean_container_root_dir;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_NETWORK_CONFS);
+
     ret = do_image_create_container_roofs_layer(id, image_type, image_name, v2_spec->mount_label, request->rootfs,
                                                 host_spec->storage_opt, &real_rootfs);
     if (ret != 0) {
@@ -1410,6 +1424,8 @@ int container_create_cb(const container_create_request *request, container_creat
         goto clean_container_root_dir;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_ROOTFS);
+
     ret = im_merge_image_config(image_type, image_name, v2_spec->config);
     if (ret != 0) {
         ERROR("Can not merge container_spec with image config");
@@ -1429,11 +1445,15 @@ int container_create_cb(const container_create_request *request, container_creat
         goto clean_rootfs;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_MERGE_IMAGE_CONFIG);
+
     if (verify_container_config(v2_spec->config) != 0) {
         cc = ISULAD_ERR_EXEC;
         goto clean_rootfs;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_VERIFY_CONFIG);
+
     oci_spec = generate_oci_config(host_spec, real_rootfs, v2_spec);
     if (oci_spec == NULL) {
         cc = ISULAD_ERR_EXEC;
@@ -1453,6 +1473,8 @@ int container_create_cb(const container_create_request *request, container_creat
         goto umount_shm;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_OCI_CONFIG);
+
     // merge hostname, resolv.conf, hosts, required for all container
     if (merge_network(host_spec, request->rootfs, runtime_root, id, container_spec->hostname) != 0) {
         ERROR("Failed to merge network config");
@@ -1460,6 +1482,8 @@ int container_create_cb(const container_create_request *request, container_creat
         goto umount_shm;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_MERGE_NETWORK);
+
     /* modify oci_spec by plugin. */
     if (plugin_event_container_pre_create(id, oci_spec) != 0) {
         ERROR("Plugin event pre create failed");
@@ -1468,6 +1492,8 @@ int container_create_cb(const container_create_request *request, container_creat
         goto umount_shm;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_PLUGIN);
+
     host_channel = dup_host_channel(host_spec->host_channel);
     if (prepare_host_channel(host_channel, host_spec->user_remap)) {
         ERROR("Failed to prepare host channel");
@@ -1475,6 +1501,8 @@ int container_create_cb(const container_create_request *request, container_creat
         goto umount_shm;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_HOST_CHANNEL);
+
     if (verify_container_settings(oci_spec) != 0) {
         ERROR("Failed to verify container settings");
         cc = ISULAD_ERR_EXEC;
@@ -1487,12 +1515,16 @@ int container_create_cb(const container_create_request *request, container_creat
         goto umount_channel;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_VERIFY_SETTINGS);
+
     if (save_oci_config(id, runtime_root, oci_spec) != 0) {
         ERROR("Failed to save container settings");
         cc = ISULAD_ERR_EXEC;
         goto umount_channel;
     }
 
+    phase_trace_mark(&trace, PHASE_CREATE_SAVE_OCI_CONFIG);
+
     if (register_new_container(id, image_id, runtime, host_spec, v2_spec, network_settings)) {
         ERROR("Failed to register new container");
         cc = ISULAD_ERR_EXEC;
@@ -1501,6 +1533,7 @@ int container_create_cb(const container_create_request *request, container_creat
     host_spec = NULL;
     v2_spec = NULL;
     network_settings = NULL;
+    phase_trace_mark(&trace, PHASE_CREATE_REGISTER);
 
     EVENT("Event: {Object: %s, Type: Created %s}", id, name);
     (void)isulad_monitor_send_container_event(id, CREATE, -1, 0, NULL, NULL);
@@ -1524,6 +1557,7 @@ clean_nameindex:
 
 pack_response:
     pack_create_response(*response, id, cc);
+    phase_trace_end(&trace, cc == ISULAD_SUCCESS);
     free(runtime);
     free(oci_config_data);
     free(runtime_root);
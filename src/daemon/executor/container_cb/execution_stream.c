@@ -20,7 +20,6 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/stat.h>
-#include <sys/inotify.h>
 #include <sys/eventfd.h>
 #include <isula_libutils/container_attach_request.h>
 #include <isula_libutils/container_attach_response.h>
@@ -38,7 +37,6 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/prctl.h>
 #include <time.h>
 #include <inttypes.h>
 
@@ -56,6 +54,7 @@
 #include "events_sender_api.h"
 #include "service_container_api.h"
 #include "io_handler.h"
+#include "log_tailer.h"
 #include "err_msg.h"
 #include "event_type.h"
 #include "stream_wrapper.h"
@@ -63,38 +62,6 @@
 #include "utils_file.h"
 #include "utils_verify.h"
 
-#if defined (__ANDROID__) || defined(__MUSL__)
-#define SIG_CANCEL_SIGNAL     SIGUSR1
-#define PTHREAD_CANCEL_ENABLE    1
-#define PTHREAD_CANCEL_DISABLE    0
-
-#if defined __ANDROID__
-typedef long pthread_t;
-#endif
-
-static int pthread_setcancelstate(int state, int *oldstate)
-{
-    sigset_t new = {0};
-    sigset_t old = {0};
-    int ret = 0;
-
-    sigemptyset(&new);
-    sigaddset(&new, SIG_CANCEL_SIGNAL);
-
-    ret = pthread_sigmask(state == PTHREAD_CANCEL_ENABLE ? SIG_BLOCK : SIG_UNBLOCK, &new, &old);
-    if (oldstate != NULL) {
-        *oldstate = sigismember(&old, SIG_CANCEL_SIGNAL) == 0 ? PTHREAD_CANCEL_DISABLE : PTHREAD_CANCEL_ENABLE;
-    }
-
-    return ret;
-}
-
-static inline int pthread_cancel(pthread_t thread)
-{
-    return pthread_kill(thread, SIG_CANCEL_SIGNAL);
-}
-#endif
-
 struct container_log_config {
     char *driver;
     char *path;
@@ -250,7 +217,7 @@ out:
 
 static int attach_prepare_console(const container_t *cont, const container_attach_request *request, int stdinfd,
                                   struct io_write_wrapper *stdout_handler, struct io_write_wrapper *stderr_handler,
-                                  char **fifos, char **fifopath, int *sync_fd, pthread_t *tid)
+                                  char **fifos, char **fifopath, int *sync_fd, io_copy_session **io_session)
 {
     int ret = 0;
     const char *id = cont->common_config->id;
@@ -270,7 +237,7 @@ static int attach_prepare_console(const container_t *cont, const container_attac
         }
 
         if (ready_copy_io_data(*sync_fd, false, request->stdin, request->stdout, request->stderr, stdinfd,
-                               stdout_handler, stderr_handler, (const char **)fifos, tid)) {
+                               stdout_handler, stderr_handler, (const char **)fifos, io_session)) {
             ret = -1;
             goto out;
         }
@@ -280,13 +247,11 @@ out:
     return ret;
 }
 
-static void handle_attach_io_thread_by_cc(uint32_t cc, int sync_fd, pthread_t thread_id)
+static void handle_attach_io_thread_by_cc(uint32_t cc, int sync_fd, io_copy_session *io_session)
 {
     if (cc == ISULAD_SUCCESS) {
-        if (thread_id > 0) {
-            if (pthread_detach(thread_id) != 0) {
-                SYSERROR("Failed to detach 0x%lx", thread_id);
-            }
+        if (io_session != NULL) {
+            io_copy_session_detach(io_session);
         }
         if (sync_fd >= 0) {
             close(sync_fd);
@@ -297,10 +262,8 @@ static void handle_attach_io_thread_by_cc(uint32_t cc, int sync_fd, pthread_t th
                 ERROR("Failed to write eventfd: %s", strerror(errno));
             }
         }
-        if (thread_id > 0) {
-            if (pthread_join(thread_id, NULL) != 0) {
-                ERROR("Failed to join thread: 0x%lx", thread_id);
-            }
+        if (io_session != NULL) {
+            io_copy_session_wait(io_session, NULL);
         }
         if (sync_fd >= 0) {
             close(sync_fd);
@@ -317,7 +280,7 @@ static int container_attach_cb(const container_attach_request *request, containe
     char *fifos[3] = { NULL, NULL, NULL };
     char *fifopath = NULL;
     int syncfd = -1;
-    pthread_t tid = 0;
+    io_copy_session *io_session = NULL;
     container_t *cont = NULL;
     rt_attach_params_t params = { 0 };
 
@@ -339,7 +302,7 @@ static int container_attach_cb(const container_attach_request *request, containe
     }
 
     if (attach_prepare_console(cont, request, stdinfd, stdout_handler, stderr_handler, fifos, &fifopath, &syncfd,
-                               &tid) != 0) {
+                               &io_session) != 0) {
         cc = ISULAD_ERR_EXEC;
         goto pack_response;
     }
@@ -358,7 +321,7 @@ static int container_attach_cb(const container_attach_request *request, containe
     }
 
 pack_response:
-    handle_attach_io_thread_by_cc(cc, syncfd, tid);
+    handle_attach_io_thread_by_cc(cc, syncfd, io_session);
     if (*response != NULL) {
         (*response)->cc = cc;
         if (g_isulad_errmsg != NULL) {
@@ -1326,187 +1289,39 @@ out:
     return ret;
 }
 
-struct follow_args {
-    const char *path;
-    stream_func_wrapper *stream;
-    bool *finish;
-    long last_file_pos;
-    int last_file_index;
-};
-
-static int handle_rotate(int fd, int wd, const char *path)
-{
-    int watch_fd = -1;
-    int retries = 0;
-
-    INFO("Do rotate...");
-    if (inotify_rm_watch(fd, wd) < 0) {
-        WARN("Rm watch failed");
-    }
-
-    for (; retries < LOG_MAX_RETRIES; retries++) {
-        watch_fd = inotify_add_watch(fd, path, IN_MODIFY | IN_DELETE | IN_MOVED_FROM | IN_MOVE_SELF);
-        if (watch_fd >= 0) {
-            break;
-        }
-        util_usleep_nointerupt(1000);
-    }
-    if (watch_fd < 0) {
-        SYSERROR("Add watch %s failed", path);
-    }
-    return watch_fd;
-}
-
-static void cleanup_handler(void *arg)
-{
-    int *fds = (int *)arg;
-
-    if (fds[0] < 0) {
-        return;
-    }
-
-    if (fds[1] >= 0 && inotify_rm_watch(fds[0], fds[1]) < 0) {
-        SYSERROR("Rm watch failed");
-    }
-    close(fds[0]);
-}
-
-static int hanlde_events(int fd, const struct follow_args *farg)
-{
-    int write_cnt, rename_cnt;
-    int watch_fd = 0;
-    int ret = -1;
-    size_t i = 0;
-    ssize_t len = 0;
-    struct inotify_event *c_event = NULL;
-    char buf[MAXLINE] __attribute__((aligned(__alignof__(struct inotify_event)))) = { 0 };
-    int clean_fds[2] = { fd, -1 };
-
-    struct last_log_file_position last_pos = {
-        .file_index = farg->last_file_index,
-        .pos = farg->last_file_pos,
-    };
-
-    pthread_cleanup_push(cleanup_handler, clean_fds);
-
-    watch_fd = inotify_add_watch(fd, farg->path, IN_MODIFY | IN_DELETE | IN_MOVED_FROM | IN_MOVE_SELF);
-    if (watch_fd < 0) {
-        SYSERROR("Add watch %s failed", farg->path);
-        goto out;
-    }
-    clean_fds[1] = watch_fd;
-
-    for (;;) {
-        if (pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL) != 0) {
-            ERROR("set cancel state failed");
-        }
-        len = util_read_nointr(fd, buf, sizeof(buf));
-        if (len < 0) {
-            SYSERROR("Read inotify event failed");
-            goto out;
-        }
-        if (pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL) != 0) {
-            ERROR("set cancel state failed");
-        }
-
-        write_cnt = 0;
-        rename_cnt = 0;
-        for (i = 0; i < (size_t)len; i += (sizeof(struct inotify_event) + c_event->len)) {
-            c_event = (struct inotify_event *)(&buf[i]);
-            if (c_event->mask & IN_MODIFY) {
-                write_cnt++;
-            } else if (c_event->mask & (IN_DELETE | IN_MOVED_FROM | IN_MOVE_SELF)) {
-                rename_cnt++;
-            }
-        }
-        if (rename_cnt == 0 && write_cnt == 0) {
-            continue;
-        }
-
-        last_pos.file_index = rename_cnt;
-        if (do_read_all_container_logs(write_cnt, farg->path, farg->stream, &last_pos) != 0) {
-            ERROR("Read all new logs failed");
-            goto out;
-        }
-        if (rename_cnt > 0) {
-            watch_fd = handle_rotate(fd, watch_fd, farg->path);
-            if (watch_fd < 0) {
-                goto out;
-            }
-            /* if terminal log file rotated and index of last_pos is not 0,
-             * this mean we reach end of console.log.1. We need change last_pos
-             * to begin of console.log.
-             * */
-            if (last_pos.file_index > 0) {
-                last_pos.pos = 0;
-                last_pos.file_index = 0;
-            }
-        }
-    }
-
-out:
-    pthread_cleanup_pop(1);
-    return ret;
-}
-
-static void *follow_thread_func(void *arg)
-{
-    int inotify_fd = 0;
-    struct follow_args *farg = (struct follow_args *)arg;
-
-    prctl(PR_SET_NAME, "logs-worker");
-
-    INFO("Get args, path: %s, last pos: %ld, last file: %d", farg->path, farg->last_file_pos, farg->last_file_index);
-
-    inotify_fd = inotify_init1(IN_CLOEXEC);
-    if (inotify_fd < 0) {
-        SYSERROR("Init inotify failed");
-        goto set_flag;
-    }
-
-    if (hanlde_events(inotify_fd, farg) != 0) {
-        ERROR("Handle inotify event failed");
-    }
-
-set_flag:
-    *(farg->finish) = true;
-    DAEMON_CLEAR_ERRMSG();
-    return NULL;
-}
-
 static int do_follow_log_file(const char *cid, stream_func_wrapper *stream, struct last_log_file_position *last_pos,
                               const char *path)
 {
+#define LOG_FOLLOW_WAIT_MS 100
     int ret = 0;
-    bool finish = false;
-    bool *finish_pointer = &finish;
-    pthread_t thread = 0;
-
-    struct follow_args arg = {
-        .path = path,
-        .last_file_pos = last_pos->pos,
-        .last_file_index = last_pos->file_index,
-        .stream = stream,
-        .finish = finish_pointer,
-    };
+    int64_t pos = 0;
+    log_follower *follower = NULL;
     container_t *cont = NULL;
 
-    ret = pthread_create(&thread, NULL, follow_thread_func, &arg);
-    if (ret != 0) {
-        ERROR("Thread create failed");
-        return -1;
-    }
-
     cont = containers_store_get(cid);
     if (cont == NULL) {
         ERROR("No such container:%s", cid);
+        return -1;
+    }
+
+    /* tail stops in a rotated file, the current file is new for client */
+    if (last_pos->file_index == 0) {
+        pos = (int64_t)last_pos->pos;
+    }
+
+    INFO("Follow log, path: %s, last pos: %ld, last file: %d", path, last_pos->pos, last_pos->file_index);
+
+    /* records are read and decoded once by tailer shared by all followers of the container */
+    follower = log_tailer_follow(cid, path, pos);
+    if (follower == NULL) {
+        ERROR("Follow log file %s failed", path);
         ret = -1;
         goto out;
     }
 
     /* check whether need finish */
     while (true) {
-        if (finish) {
+        if (log_follower_send(follower, LOG_FOLLOW_WAIT_MS, stream) < 0) {
             ret = -1;
             break;
         }
@@ -1517,18 +1332,10 @@ static int do_follow_log_file(const char *cid, stream_func_wrapper *stream, stru
             ret = -1;
             break;
         }
-        util_usleep_nointerupt(10000);
     }
 
 out:
-    if (pthread_cancel(thread) != 0) {
-        ERROR("cancel log work thread failed");
-        ret = -1;
-    }
-    if (pthread_join(thread, NULL) != 0) {
-        ERROR("Joint log work failed");
-        ret = -1;
-    }
+    log_tailer_unfollow(follower);
     container_unref(cont);
     return ret;
 }
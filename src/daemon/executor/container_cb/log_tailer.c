@@ -0,0 +1,823 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide shared container log tailer functions
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "log_tailer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <isula_libutils/log.h>
+#include <isula_libutils/logger_json_file.h>
+
+#include "constants.h"
+#include "linked_list.h"
+#include "map.h"
+#include "utils.h"
+#include "utils_file.h"
+
+// max length of one json record in log file, longer records are truncated
+#define LOG_TAILER_LINE_MAX (16 * MAXLINE)
+// bytes kept from the end of a long record, which hold the fields after the log
+#define LOG_TAILER_TAIL_MAX MAXLINE
+#define LOG_RECORD_HEAD "{\"log\":\""
+#define LOG_RECORD_STREAM "\",\"stream\":"
+// interval to check rotation which inotify may miss
+#define LOG_TAILER_CHECK_INTERVAL_MS 1000
+
+#define LOG_TAILER_WATCH_MASK (IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF)
+
+struct log_record {
+    logger_json_file *entry;
+    // which file of the path the record read from, increased on rotation
+    uint64_t generation;
+    // offset of the record in the file
+    int64_t offset;
+};
+
+typedef struct {
+    char *id;
+    char *path;
+    pthread_t thread;
+    bool thread_started;
+    // wake up the tailer thread to stop
+    int stop_fd;
+    int inotify_fd;
+    int watch_fd;
+    int fd;
+    ino_t ino;
+    // partial record read from fd
+    char *buf;
+    size_t buf_len;
+    // offset of buf in the file
+    int64_t buf_offset;
+    // skipping a record longer than LOG_TAILER_LINE_MAX, it is sent truncated
+    bool discarding;
+    // first LOG_TAILER_LINE_MAX bytes of the long record
+    char *long_head;
+    // offset of the long record in the file
+    int64_t long_offset;
+    // last bytes of the long record read so far
+    char long_tail[LOG_TAILER_TAIL_MAX];
+    size_t long_tail_len;
+
+    // protect fields below
+    pthread_mutex_t mutex;
+    // signaled when new records arrive or the tailer failed
+    pthread_cond_t readable;
+    // signaled when followers consume records or leave
+    pthread_cond_t writable;
+    // ring buffer, record of seq is records[seq % LOG_TAILER_BUFFER_LEN]
+    struct log_record records[LOG_TAILER_BUFFER_LEN];
+    uint64_t next_seq;
+    uint64_t generation;
+    // offset the current file is read from
+    int64_t generation_start;
+    // offset after the last complete record
+    int64_t offset;
+    struct linked_list followers;
+    bool failed;
+    bool stopping;
+} log_tailer;
+
+struct log_follower {
+    log_tailer *tailer;
+    struct linked_list *node;
+    // seq of the next record to send
+    uint64_t cursor;
+    // the tailer is behind the follower, skip records already sent by it
+    uint64_t skip_generation;
+    int64_t skip_before;
+};
+
+static pthread_mutex_t g_tailers_mutex = PTHREAD_MUTEX_INITIALIZER;
+// container id -> log_tailer, protected by g_tailers_mutex
+static map_t *g_tailers = NULL;
+
+static void tailers_map_kvfree(void *key, void *value)
+{
+    // tailers are freed by their last follower
+    free(key);
+}
+
+// must be called with tailer->mutex held
+static uint64_t min_follower_cursor(const log_tailer *tailer)
+{
+    struct linked_list *it = NULL;
+    struct linked_list *next = NULL;
+    const struct log_follower *follower = NULL;
+    uint64_t min = tailer->next_seq;
+
+    linked_list_for_each_safe(it, &tailer->followers, next) {
+        follower = (const struct log_follower *)it->elem;
+        if (follower->cursor < min) {
+            min = follower->cursor;
+        }
+    }
+
+    return min;
+}
+
+static int push_record(log_tailer *tailer, logger_json_file *entry, int64_t offset, int64_t end)
+{
+    struct log_record *record = NULL;
+
+    (void)pthread_mutex_lock(&tailer->mutex);
+    // backpressure, wait for the slowest follower
+    while (!tailer->stopping && tailer->next_seq - min_follower_cursor(tailer) >= LOG_TAILER_BUFFER_LEN) {
+        (void)pthread_cond_wait(&tailer->writable, &tailer->mutex);
+    }
+    if (tailer->stopping) {
+        (void)pthread_mutex_unlock(&tailer->mutex);
+        free_logger_json_file(entry);
+        return -1;
+    }
+
+    record = &tailer->records[tailer->next_seq % LOG_TAILER_BUFFER_LEN];
+    free_logger_json_file(record->entry);
+    record->entry = entry;
+    record->generation = tailer->generation;
+    record->offset = offset;
+    tailer->next_seq++;
+    tailer->offset = end;
+    (void)pthread_cond_broadcast(&tailer->readable);
+    (void)pthread_mutex_unlock(&tailer->mutex);
+
+    return 0;
+}
+
+static int decode_record(log_tailer *tailer, char *line, int64_t offset, int64_t end)
+{
+    parser_error jerr = NULL;
+    logger_json_file *entry = NULL;
+    struct parser_context ctx = { OPT_GEN_SIMPLIFY | OPT_GEN_NO_VALIDATE_UTF8, stderr };
+
+    entry = logger_json_file_parse_data(line, &ctx, &jerr);
+    if (entry == NULL) {
+        ERROR("parse logentry: %s, failed: %s", line, jerr);
+        free(jerr);
+        // skip the broken record
+        (void)pthread_mutex_lock(&tailer->mutex);
+        tailer->offset = end;
+        (void)pthread_mutex_unlock(&tailer->mutex);
+        return 0;
+    }
+
+    return push_record(tailer, entry, offset, end);
+}
+
+static void append_long_tail(log_tailer *tailer, const char *data, size_t len)
+{
+    size_t keep = tailer->long_tail_len;
+
+    if (len >= LOG_TAILER_TAIL_MAX) {
+        (void)memcpy(tailer->long_tail, data + len - LOG_TAILER_TAIL_MAX, LOG_TAILER_TAIL_MAX);
+        tailer->long_tail_len = LOG_TAILER_TAIL_MAX;
+        return;
+    }
+
+    if (keep + len > LOG_TAILER_TAIL_MAX) {
+        keep = LOG_TAILER_TAIL_MAX - len;
+    }
+    (void)memmove(tailer->long_tail, tailer->long_tail + tailer->long_tail_len - keep, keep);
+    (void)memcpy(tailer->long_tail + keep, data, len);
+    tailer->long_tail_len = keep + len;
+}
+
+// length of the head of a long record which ends with a complete character of the log, 0 if none
+static size_t truncated_log_len(const char *head, size_t len)
+{
+    size_t i = strlen(LOG_RECORD_HEAD);
+    size_t step = 0;
+
+    if (len < i || memcmp(head, LOG_RECORD_HEAD, i) != 0) {
+        return 0;
+    }
+
+    while (i < len) {
+        if (head[i] == '"') {
+            // the log is not what makes the record long
+            return 0;
+        }
+        step = 1;
+        if (head[i] == '\\') {
+            step = (i + 1 < len && head[i + 1] == 'u') ? 6 : 2;
+        }
+        if (i + step > len) {
+            break;
+        }
+        i += step;
+    }
+
+    return i;
+}
+
+// send the long record with the log truncated, the other fields are taken from its tail
+static int decode_long_record(log_tailer *tailer, int64_t end)
+{
+    const char *fields = NULL;
+    const char *found = NULL;
+    const char *tail_end = tailer->long_tail + tailer->long_tail_len;
+    char *line = NULL;
+    size_t head_len = 0;
+    size_t fields_len = 0;
+    int ret = 0;
+
+    found = memmem(tailer->long_tail, tailer->long_tail_len, LOG_RECORD_STREAM, strlen(LOG_RECORD_STREAM));
+    while (found != NULL) {
+        fields = found;
+        found = memmem(found + 1, (size_t)(tail_end - found - 1), LOG_RECORD_STREAM, strlen(LOG_RECORD_STREAM));
+    }
+    if (tailer->long_head != NULL) {
+        head_len = truncated_log_len(tailer->long_head, LOG_TAILER_LINE_MAX);
+    }
+    if (fields == NULL || head_len == 0) {
+        ERROR("Log record of %s is longer than %d, skip it", tailer->id, LOG_TAILER_LINE_MAX);
+        (void)pthread_mutex_lock(&tailer->mutex);
+        tailer->offset = end;
+        (void)pthread_mutex_unlock(&tailer->mutex);
+        return 0;
+    }
+
+    fields_len = (size_t)(tail_end - fields);
+    line = util_common_calloc_s(head_len + fields_len + 1);
+    if (line == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    (void)memcpy(line, tailer->long_head, head_len);
+    (void)memcpy(line + head_len, fields, fields_len);
+
+    WARN("Log record of %s is longer than %d, truncate it", tailer->id, LOG_TAILER_LINE_MAX);
+    ret = decode_record(tailer, line, tailer->long_offset, end);
+    free(line);
+    return ret;
+}
+
+static void start_long_record(log_tailer *tailer)
+{
+    if (tailer->long_head == NULL) {
+        tailer->long_head = util_common_calloc_s(LOG_TAILER_LINE_MAX);
+    }
+    if (tailer->long_head != NULL) {
+        (void)memcpy(tailer->long_head, tailer->buf, LOG_TAILER_LINE_MAX);
+    }
+    tailer->long_offset = tailer->buf_offset;
+    tailer->long_tail_len = 0;
+    tailer->discarding = true;
+}
+
+// split complete records from buffer, keep the partial one
+static int consume_buffer(log_tailer *tailer)
+{
+    char *start = tailer->buf;
+    char *newline = NULL;
+    size_t left = tailer->buf_len;
+    int64_t len = 0;
+    int ret = 0;
+
+    while (left > 0 && (newline = memchr(start, '\n', left)) != NULL) {
+        *newline = '\0';
+        len = newline - start + 1;
+        if (tailer->discarding) {
+            append_long_tail(tailer, start, (size_t)len - 1);
+            tailer->discarding = false;
+            ret = decode_long_record(tailer, tailer->buf_offset + len);
+        } else {
+            ret = decode_record(tailer, start, tailer->buf_offset, tailer->buf_offset + len);
+        }
+        if (ret != 0) {
+            return -1;
+        }
+        tailer->buf_offset += len;
+        start = newline + 1;
+        left -= (size_t)len;
+    }
+
+    if (left == LOG_TAILER_LINE_MAX) {
+        if (!tailer->discarding) {
+            start_long_record(tailer);
+        }
+        append_long_tail(tailer, tailer->buf, left);
+        tailer->buf_offset += (int64_t)left;
+        left = 0;
+    }
+
+    if (left > 0 && start != tailer->buf) {
+        (void)memmove(tailer->buf, start, left);
+    }
+    tailer->buf_len = left;
+
+    return 0;
+}
+
+// read and decode new records until end of file
+static int read_new_records(log_tailer *tailer)
+{
+    ssize_t nret = 0;
+
+    for (;;) {
+        nret = util_read_nointr(tailer->fd, tailer->buf + tailer->buf_len, LOG_TAILER_LINE_MAX - tailer->buf_len);
+        if (nret < 0) {
+            SYSERROR("Read log file %s failed", tailer->path);
+            return -1;
+        }
+        if (nret == 0) {
+            return 0;
+        }
+        tailer->buf_len += (size_t)nret;
+        if (consume_buffer(tailer) != 0) {
+            return -1;
+        }
+    }
+}
+
+static int watch_log_file(log_tailer *tailer)
+{
+    if (tailer->watch_fd >= 0 && inotify_rm_watch(tailer->inotify_fd, tailer->watch_fd) < 0) {
+        DEBUG("Rm watch of %s failed", tailer->path);
+    }
+
+    tailer->watch_fd = inotify_add_watch(tailer->inotify_fd, tailer->path, LOG_TAILER_WATCH_MASK);
+    if (tailer->watch_fd < 0) {
+        SYSERROR("Add watch %s failed", tailer->path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int open_log_file(log_tailer *tailer, int64_t pos)
+{
+    int fd = -1;
+    int retries = 0;
+    struct stat st = { 0 };
+
+    for (retries = 0; retries <= LOG_MAX_RETRIES; retries++) {
+        fd = util_open(tailer->path, O_RDONLY | O_CLOEXEC, 0);
+        if (fd >= 0 || errno != ENOENT) {
+            break;
+        }
+        /* open is too fast, need wait rename operator finish */
+        util_usleep_nointerupt(1000);
+    }
+    if (fd < 0) {
+        SYSERROR("Open log file %s failed", tailer->path);
+        return -1;
+    }
+
+    if (fstat(fd, &st) != 0 || (pos > 0 && lseek(fd, (off_t)pos, SEEK_SET) < 0)) {
+        SYSERROR("Seek log file %s to %ld failed", tailer->path, (long)pos);
+        close(fd);
+        return -1;
+    }
+
+    if (tailer->fd >= 0) {
+        close(tailer->fd);
+    }
+    tailer->fd = fd;
+    tailer->ino = st.st_ino;
+    tailer->buf_len = 0;
+    tailer->buf_offset = pos;
+    tailer->discarding = false;
+
+    (void)pthread_mutex_lock(&tailer->mutex);
+    tailer->generation++;
+    tailer->generation_start = pos;
+    tailer->offset = pos;
+    (void)pthread_mutex_unlock(&tailer->mutex);
+
+    return watch_log_file(tailer);
+}
+
+// the file kept open is rotated or truncated
+static int check_rotation(log_tailer *tailer)
+{
+    struct stat st = { 0 };
+
+    if (stat(tailer->path, &st) != 0) {
+        // rotating, the new file is not created yet
+        return 0;
+    }
+
+    if (st.st_ino != tailer->ino) {
+        // read records written to the rotated file before it is moved
+        if (read_new_records(tailer) != 0) {
+            return -1;
+        }
+        INFO("Log file %s rotated", tailer->path);
+        return open_log_file(tailer, 0);
+    }
+
+    if (st.st_size < tailer->buf_offset + (int64_t)tailer->buf_len) {
+        INFO("Log file %s truncated", tailer->path);
+        return open_log_file(tailer, 0);
+    }
+
+    return 0;
+}
+
+static void drain_inotify_events(log_tailer *tailer)
+{
+    char buf[MAXLINE] __attribute__((aligned(__alignof__(struct inotify_event)))) = { 0 };
+
+    // events only wake up the tailer, rotation is checked by inode
+    while (util_read_nointr(tailer->inotify_fd, buf, sizeof(buf)) > 0) {
+    }
+}
+
+static void *tailer_routine(void *arg)
+{
+    log_tailer *tailer = (log_tailer *)arg;
+    struct pollfd fds[2] = { 0 };
+    int nret = 0;
+
+    prctl(PR_SET_NAME, "log-tailer");
+
+    fds[0].fd = tailer->stop_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = tailer->inotify_fd;
+    fds[1].events = POLLIN;
+
+    for (;;) {
+        // records left in the file are always read, even if it is moved
+        if (read_new_records(tailer) != 0) {
+            break;
+        }
+
+        nret = poll(fds, 2, LOG_TAILER_CHECK_INTERVAL_MS);
+        if (nret < 0 && errno != EINTR) {
+            SYSERROR("Poll log file %s failed", tailer->path);
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            drain_inotify_events(tailer);
+        }
+
+        if (read_new_records(tailer) != 0) {
+            break;
+        }
+        if (check_rotation(tailer) != 0) {
+            break;
+        }
+    }
+
+    (void)pthread_mutex_lock(&tailer->mutex);
+    if (!tailer->stopping) {
+        ERROR("Stop tailing log file %s for failure", tailer->path);
+    }
+    tailer->failed = true;
+    (void)pthread_cond_broadcast(&tailer->readable);
+    (void)pthread_mutex_unlock(&tailer->mutex);
+
+    return NULL;
+}
+
+static void tailer_free(log_tailer *tailer)
+{
+    size_t i = 0;
+
+    if (tailer == NULL) {
+        return;
+    }
+
+    if (tailer->fd >= 0) {
+        close(tailer->fd);
+    }
+    if (tailer->inotify_fd >= 0) {
+        close(tailer->inotify_fd);
+    }
+    if (tailer->stop_fd >= 0) {
+        close(tailer->stop_fd);
+    }
+    for (i = 0; i < LOG_TAILER_BUFFER_LEN; i++) {
+        free_logger_json_file(tailer->records[i].entry);
+    }
+    pthread_cond_destroy(&tailer->writable);
+    pthread_cond_destroy(&tailer->readable);
+    pthread_mutex_destroy(&tailer->mutex);
+    free(tailer->long_head);
+    free(tailer->buf);
+    free(tailer->path);
+    free(tailer->id);
+    free(tailer);
+}
+
+static void tailer_stop(log_tailer *tailer)
+{
+    uint64_t val = 1;
+
+    (void)pthread_mutex_lock(&tailer->mutex);
+    tailer->stopping = true;
+    (void)pthread_cond_broadcast(&tailer->writable);
+    (void)pthread_mutex_unlock(&tailer->mutex);
+
+    if (util_write_nointr(tailer->stop_fd, &val, sizeof(val)) < 0) {
+        SYSERROR("Wake up log tailer of %s failed", tailer->id);
+    }
+
+    if (tailer->thread_started && pthread_join(tailer->thread, NULL) != 0) {
+        ERROR("Join log tailer of %s failed", tailer->id);
+    }
+
+    tailer_free(tailer);
+}
+
+static log_tailer *tailer_new(const char *id, const char *path, int64_t pos)
+{
+    log_tailer *tailer = NULL;
+
+    tailer = util_common_calloc_s(sizeof(log_tailer));
+    if (tailer == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    tailer->fd = -1;
+    tailer->inotify_fd = -1;
+    tailer->watch_fd = -1;
+    tailer->stop_fd = -1;
+    (void)pthread_mutex_init(&tailer->mutex, NULL);
+    (void)pthread_cond_init(&tailer->readable, NULL);
+    (void)pthread_cond_init(&tailer->writable, NULL);
+    linked_list_init(&tailer->followers);
+
+    tailer->id = util_strdup_s(id);
+    tailer->path = util_strdup_s(path);
+    tailer->buf = util_common_calloc_s(LOG_TAILER_LINE_MAX + 1);
+    if (tailer->buf == NULL) {
+        ERROR("Out of memory");
+        goto err_out;
+    }
+
+    tailer->stop_fd = eventfd(0, EFD_CLOEXEC);
+    tailer->inotify_fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (tailer->stop_fd < 0 || tailer->inotify_fd < 0) {
+        SYSERROR("Init log tailer fds failed");
+        goto err_out;
+    }
+
+    if (open_log_file(tailer, pos) != 0) {
+        goto err_out;
+    }
+
+    return tailer;
+
+err_out:
+    tailer_free(tailer);
+    return NULL;
+}
+
+// must be called with g_tailers_mutex held, after the first follower is added
+static void tailer_start(log_tailer *tailer)
+{
+    if (tailer->thread_started) {
+        return;
+    }
+
+    if (pthread_create(&tailer->thread, NULL, tailer_routine, tailer) != 0) {
+        ERROR("Thread create failed");
+        (void)pthread_mutex_lock(&tailer->mutex);
+        tailer->failed = true;
+        (void)pthread_mutex_unlock(&tailer->mutex);
+        return;
+    }
+    tailer->thread_started = true;
+}
+
+// must be called with g_tailers_mutex held
+static log_tailer *get_or_new_tailer(const char *id, const char *path, int64_t pos)
+{
+    log_tailer *tailer = NULL;
+    bool failed = false;
+
+    if (g_tailers == NULL) {
+        g_tailers = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, tailers_map_kvfree);
+        if (g_tailers == NULL) {
+            ERROR("Out of memory");
+            return NULL;
+        }
+    }
+
+    tailer = map_search(g_tailers, (void *)id);
+    if (tailer != NULL) {
+        (void)pthread_mutex_lock(&tailer->mutex);
+        failed = tailer->failed;
+        (void)pthread_mutex_unlock(&tailer->mutex);
+        if (!failed) {
+            return tailer;
+        }
+    }
+
+    // started by log_tailer_follow
+    tailer = tailer_new(id, path, pos);
+    if (tailer == NULL) {
+        return NULL;
+    }
+
+    // a failed tailer is freed by its followers
+    if (!map_replace(g_tailers, (void *)id, tailer)) {
+        ERROR("Failed to save log tailer of %s", id);
+        tailer_stop(tailer);
+        return NULL;
+    }
+
+    return tailer;
+}
+
+/*
+ * Must be called with tailer->mutex held, start from the first record after pos.
+ * Return false if some records after pos are not kept by the tailer any more.
+ */
+static bool init_follower_cursor(const log_tailer *tailer, struct log_follower *follower, int64_t pos)
+{
+    uint64_t oldest = tailer->next_seq > LOG_TAILER_BUFFER_LEN ? tailer->next_seq - LOG_TAILER_BUFFER_LEN : 0;
+    const struct log_record *record = NULL;
+
+    follower->cursor = tailer->next_seq;
+
+    if (tailer->offset < pos) {
+        follower->skip_generation = tailer->generation;
+        follower->skip_before = pos;
+        return true;
+    }
+
+    while (follower->cursor > oldest) {
+        record = &tailer->records[(follower->cursor - 1) % LOG_TAILER_BUFFER_LEN];
+        if (record->generation != tailer->generation) {
+            return tailer->generation_start <= pos;
+        }
+        if (record->offset < pos) {
+            return true;
+        }
+        follower->cursor--;
+    }
+
+    // nothing read from the current file is overwritten
+    return follower->cursor == 0 && tailer->generation_start <= pos;
+}
+
+log_follower *log_tailer_follow(const char *id, const char *path, int64_t pos)
+{
+    log_tailer *tailer = NULL;
+    struct log_follower *follower = NULL;
+
+    if (id == NULL || path == NULL) {
+        ERROR("Invalid input arguments");
+        return NULL;
+    }
+
+    follower = util_common_calloc_s(sizeof(struct log_follower));
+    if (follower == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    follower->node = util_common_calloc_s(sizeof(struct linked_list));
+    if (follower->node == NULL) {
+        ERROR("Out of memory");
+        free(follower);
+        return NULL;
+    }
+
+    (void)pthread_mutex_lock(&g_tailers_mutex);
+    tailer = get_or_new_tailer(id, path, pos);
+    if (tailer == NULL) {
+        (void)pthread_mutex_unlock(&g_tailers_mutex);
+        free(follower->node);
+        free(follower);
+        return NULL;
+    }
+
+    (void)pthread_mutex_lock(&tailer->mutex);
+    if (!init_follower_cursor(tailer, follower, pos)) {
+        (void)pthread_mutex_unlock(&tailer->mutex);
+        // records after pos are dropped by the shared tailer, read them with a tailer of its own
+        DEBUG("Shared log tailer of %s is far ahead of %ld", id, (long)pos);
+        tailer = tailer_new(id, path, pos);
+        if (tailer == NULL) {
+            (void)pthread_mutex_unlock(&g_tailers_mutex);
+            free(follower->node);
+            free(follower);
+            return NULL;
+        }
+        (void)pthread_mutex_lock(&tailer->mutex);
+        (void)init_follower_cursor(tailer, follower, pos);
+    }
+    follower->tailer = tailer;
+    linked_list_add_elem(follower->node, follower);
+    linked_list_add_tail(&tailer->followers, follower->node);
+    (void)pthread_mutex_unlock(&tailer->mutex);
+    // new tailers start reading after the follower is added, so no record is overwritten before it
+    tailer_start(tailer);
+    (void)pthread_mutex_unlock(&g_tailers_mutex);
+
+    return follower;
+}
+
+int log_follower_send(log_follower *follower, int timeout_ms, const stream_func_wrapper *stream)
+{
+    log_tailer *tailer = NULL;
+    struct timespec deadline = { 0 };
+    const struct log_record *record = NULL;
+    uint64_t end = 0;
+    uint64_t seq = 0;
+    int sent = 0;
+    int ret = 0;
+
+    if (follower == NULL || stream == NULL || stream->write_func == NULL) {
+        ERROR("Invalid input arguments");
+        return -1;
+    }
+    tailer = follower->tailer;
+
+    (void)pthread_mutex_lock(&tailer->mutex);
+    if (follower->cursor == tailer->next_seq && !tailer->failed && clock_gettime(CLOCK_REALTIME, &deadline) == 0) {
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        (void)pthread_cond_timedwait(&tailer->readable, &tailer->mutex, &deadline);
+    }
+    if (follower->cursor == tailer->next_seq && tailer->failed) {
+        (void)pthread_mutex_unlock(&tailer->mutex);
+        return -1;
+    }
+    end = tailer->next_seq;
+    (void)pthread_mutex_unlock(&tailer->mutex);
+
+    // records not consumed by all followers are never overwritten, send them without lock
+    for (seq = follower->cursor; seq < end; seq++) {
+        record = &tailer->records[seq % LOG_TAILER_BUFFER_LEN];
+        if (record->generation == follower->skip_generation && record->offset < follower->skip_before) {
+            continue;
+        }
+        if (!stream->write_func(stream->writer, record->entry)) {
+            ERROR("Send log to client failed");
+            ret = -1;
+            break;
+        }
+        sent++;
+    }
+
+    (void)pthread_mutex_lock(&tailer->mutex);
+    follower->cursor = seq;
+    (void)pthread_cond_signal(&tailer->writable);
+    (void)pthread_mutex_unlock(&tailer->mutex);
+
+    return ret != 0 ? ret : sent;
+}
+
+void log_tailer_unfollow(log_follower *follower)
+{
+    log_tailer *tailer = NULL;
+    bool last = false;
+
+    if (follower == NULL) {
+        return;
+    }
+    tailer = follower->tailer;
+
+    (void)pthread_mutex_lock(&g_tailers_mutex);
+    (void)pthread_mutex_lock(&tailer->mutex);
+    linked_list_del(follower->node);
+    last = linked_list_empty(&tailer->followers);
+    (void)pthread_cond_signal(&tailer->writable);
+    (void)pthread_mutex_unlock(&tailer->mutex);
+    if (last && map_search(g_tailers, (void *)tailer->id) == tailer) {
+        (void)map_remove(g_tailers, (void *)tailer->id);
+    }
+    (void)pthread_mutex_unlock(&g_tailers_mutex);
+
+    if (last) {
+        tailer_stop(tailer);
+    }
+
+    free(follower->node);
+    free(follower);
+}
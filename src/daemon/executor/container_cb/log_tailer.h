@@ -0,0 +1,53 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide shared container log tailer definition
+ ******************************************************************************/
+#ifndef DAEMON_EXECUTOR_CONTAINER_CB_LOG_TAILER_H
+#define DAEMON_EXECUTOR_CONTAINER_CB_LOG_TAILER_H
+
+#include <stdint.h>
+
+#include "stream_wrapper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// max decoded records buffered by one tailer, the tailer stops reading when the slowest follower is this far behind
+#define LOG_TAILER_BUFFER_LEN 1024
+
+typedef struct log_follower log_follower;
+
+/*
+ * Follow the json log file of container id from offset pos of path. All followers of
+ * the same container share one tailer, which reads and decodes every new record once.
+ * A follower gets a tailer of its own if the records after pos are dropped by the shared one.
+ */
+log_follower *log_tailer_follow(const char *id, const char *path, int64_t pos);
+
+/*
+ * Wait at most timeout_ms for new records and send all available records to stream.
+ * return:
+ *      <  0, mean the tailer failed or send to client failed
+ *      >= 0, mean count of records sent
+ */
+int log_follower_send(log_follower *follower, int timeout_ms, const stream_func_wrapper *stream);
+
+// stop following, the tailer is stopped with its last follower
+void log_tailer_unfollow(log_follower *follower);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_EXECUTOR_CONTAINER_CB_LOG_TAILER_H
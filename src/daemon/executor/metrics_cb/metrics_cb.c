@@ -19,7 +19,11 @@
 #include <stdlib.h>
 
 #include "callback.h"
+#include "container_api.h"
+#include "image_api.h"
+#include "phase_trace.h"
 #include "utils.h"
+#include "utils_timestamp.h"
 #include "isula_libutils/log.h"
 
 typedef enum {
@@ -58,6 +62,9 @@ typedef struct isula_metrics {
 #define ISULA_CONT_CPU_STAT     ISULA_PREFIX "container_cpu_stat"
 #define ISULA_CONT_PIDS         ISULA_PREFIX "container_pids"
 #define DAEMON_CALLOC_TOTAL     ISULA_PREFIX "daemon_calloced_memory_total"
+#define ISULA_HEALTH_CHECK_STAT ISULA_PREFIX "health_check_stat"
+#define ISULA_CONT_PHASE_LATENCY ISULA_PREFIX "container_phase_latency"
+#define ISULA_IMAGE_CACHE_STAT  ISULA_PREFIX "image_info_cache"
 
 /* metric help info */
 static const char g_isula_daemon_mem_desc[] = "is isula daemon memory occupied";
@@ -66,6 +73,9 @@ static const char g_cpu_stat_desc[] = "is containers's cpu stats";
 static const char g_req_count_desc[] = "is metrics server accepted request count";
 static const char g_cont_pids_desc[] = "is containers's pid count";
 static const char g_daemon_calloc_desc[] = "is isula deamon calloced total";
+static const char g_health_check_desc[] = "is health check probe latency and queue lag in milliseconds";
+static const char g_phase_latency_desc[] = "is latency of container create, start and stop phases in milliseconds";
+static const char g_image_cache_desc[] = "is image info cache lookup count";
 
 static unsigned long long g_mem_alloced_total;
 
@@ -290,6 +300,81 @@ static int metrics_daemon_alloced_mem_total(const char *name, char *buffer, int
     return len;
 }
 
+static int metrics_health_check_stats(const char *name, char *buffer, int size)
+{
+    health_check_stats_t stats = { 0 };
+
+    container_get_health_check_stats(&stats);
+
+    return snprintf(buffer, size,
+                    "%s{section=\"probes\"} %llu\n"
+                    "%s{section=\"probe_latency_sum\"} %lld\n"
+                    "%s{section=\"probe_latency_max\"} %lld\n"
+                    "%s{section=\"queue_lag_sum\"} %lld\n"
+                    "%s{section=\"queue_lag_max\"} %lld\n",
+                    name, (unsigned long long)stats.probes,
+                    name, (long long)(stats.probe_latency_sum / Time_Milli),
+                    name, (long long)(stats.probe_latency_max / Time_Milli),
+                    name, (long long)(stats.queue_lag_sum / Time_Milli),
+                    name, (long long)(stats.queue_lag_max / Time_Milli));
+}
+
+static int metrics_phase_latency(const char *name, char *buffer, int size)
+{
+    int ret = 0;
+    int len = 0;
+    int i = 0;
+    phase_latency_summary_t summary = { 0 };
+    const char *op = NULL;
+    const char *phase = NULL;
+
+    for (i = 0; i < PHASE_TRACE_MAX; i++) {
+        phase_trace_get_summary((phase_trace_phase)i, &summary);
+        if (summary.count == 0) {
+            continue;
+        }
+
+        op = phase_trace_op_name((phase_trace_phase)i);
+        phase = phase_trace_phase_name((phase_trace_phase)i);
+        len = snprintf(buffer + ret, size - ret,
+                       "%s{op=\"%s\",phase=\"%s\",quantile=\"0.5\"} %.3f\n"
+                       "%s{op=\"%s\",phase=\"%s\",quantile=\"0.9\"} %.3f\n"
+                       "%s{op=\"%s\",phase=\"%s\",quantile=\"0.99\"} %.3f\n"
+                       "%s{op=\"%s\",phase=\"%s\",quantile=\"1\"} %.3f\n"
+                       "%s_sum{op=\"%s\",phase=\"%s\"} %.3f\n"
+                       "%s_count{op=\"%s\",phase=\"%s\"} %llu\n",
+                       name, op, phase, (double)summary.p50 / 1000,
+                       name, op, phase, (double)summary.p90 / 1000,
+                       name, op, phase, (double)summary.p99 / 1000,
+                       name, op, phase, (double)summary.max / 1000,
+                       name, op, phase, (double)summary.sum / 1000,
+                       name, op, phase, (unsigned long long)summary.count);
+        if (len < 0 || len >= size - ret) {
+            break;
+        }
+
+        ret += len;
+    }
+
+    return ret;
+}
+
+static int metrics_image_cache_stats(const char *name, char *buffer, int size)
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    if (im_get_image_cache_stats(IMAGE_TYPE_OCI, &hits, &misses) != 0) {
+        return 0;
+    }
+
+    return snprintf(buffer, size,
+                    "%s{result=\"hit\"} %llu\n"
+                    "%s{result=\"miss\"} %llu\n",
+                    name, (unsigned long long)hits,
+                    name, (unsigned long long)misses);
+}
+
 static isula_metrics_t g_metrics[] = {
     {NULL, METRICS_REQUEST_COUNT, COUNTER, g_req_count_desc, metrics_http_req_count_info}, /* export default */
     {"sys", ISULA_DAEMON_MEM_STAT, GAUGE, g_isula_daemon_mem_desc, metrics_get_isulad_mem_stat},
@@ -297,6 +382,9 @@ static isula_metrics_t g_metrics[] = {
     {"cpu", ISULA_CONT_CPU_STAT, GAUGE, g_cpu_stat_desc, metrics_containers_cpu_stats},
     {"pids", ISULA_CONT_PIDS, GAUGE, g_cont_pids_desc, metrics_containers_pids},
     {"sys", DAEMON_CALLOC_TOTAL, COUNTER, g_daemon_calloc_desc, metrics_daemon_alloced_mem_total},
+    {"health", ISULA_HEALTH_CHECK_STAT, GAUGE, g_health_check_desc, metrics_health_check_stats},
+    {"phase", ISULA_CONT_PHASE_LATENCY, SUMMARY, g_phase_latency_desc, metrics_phase_latency},
+    {"image", ISULA_IMAGE_CACHE_STAT, COUNTER, g_image_cache_desc, metrics_image_cache_stats},
 };
 
 static int metrics_msg_get_by_type(const char *url, char **metrics, int *len)
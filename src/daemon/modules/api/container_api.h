@@ -54,6 +54,16 @@ typedef struct health_check_manager {
     bool monitor_exist;
 } health_check_manager_t;
 
+typedef struct {
+    uint64_t probes;
+    // time in nanos spent running the probes
+    int64_t probe_latency_sum;
+    int64_t probe_latency_max;
+    // time in nanos the due probes waited for a free probe worker
+    int64_t queue_lag_sum;
+    int64_t queue_lag_max;
+} health_check_stats_t;
+
 typedef struct _container_state_t_ {
     pthread_mutex_t mutex;
     container_state *state;
@@ -278,6 +288,7 @@ extern int container_exit_fifo_open(const char *cont_exit_fifo);
 
 void container_init_health_monitor(const char *id);
 void container_stop_health_checks(container_t *cont);
+void container_get_health_check_stats(health_check_stats_t *stats);
 
 bool container_is_in_gc_progress(const char *id);
 
@@ -25,11 +25,6 @@
 extern "C" {
 #endif
 
-struct context_lists {
-    pthread_mutex_t context_mutex;
-    struct linked_list context_list;
-};
-
 void events_handler(struct monitord_msg *msg);
 
 int add_monitor_client(char *name, const types_timestamp_t *since, const types_timestamp_t *until,
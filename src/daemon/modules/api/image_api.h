@@ -342,6 +342,9 @@ void free_im_fs_info_response(im_fs_info_response *ptr);
 
 size_t im_get_image_count(const im_image_count_request *request);
 
+// get hit and miss count of the image info cache, return -1 if the image type has no cache
+int im_get_image_cache_stats(const char *image_type, uint64_t *hits, uint64_t *misses);
+
 void free_im_image_count_request(im_image_count_request *ptr);
 
 int im_container_export(const im_export_request *request);
@@ -16,8 +16,8 @@
 #ifndef DAEMON_MODULES_API_IO_HANDLER_H
 #define DAEMON_MODULES_API_IO_HANDLER_H
 
-#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "io_wrapper.h"
 
@@ -25,6 +25,15 @@
 extern "C" {
 #endif
 
+// copy of stdio of one container process, served by the shared io copy workers
+typedef struct io_copy_session io_copy_session;
+
+struct io_copy_stats {
+    uint64_t stdin_bytes;
+    uint64_t stdout_bytes;
+    uint64_t stderr_bytes;
+};
+
 int create_daemon_fifos(const char *id, const char *runtime, bool attach_stdin, bool attach_stdout, bool attach_stderr,
                         const char *operation, char *fifos[], char **fifopath);
 
@@ -32,7 +41,16 @@ void delete_daemon_fifos(const char *fifopath, const char *fifos[]);
 
 int ready_copy_io_data(int sync_fd, bool detach, const char *fifoin, const char *fifoout, const char *fifoerr,
                        int stdin_fd, struct io_write_wrapper *stdout_handler, struct io_write_wrapper *stderr_handler,
-                       const char *fifos[], pthread_t *tid);
+                       const char *fifos[], io_copy_session **session);
+
+// wait for the session to finish and free it, stats is optional
+void io_copy_session_wait(io_copy_session *session, struct io_copy_stats *stats);
+
+// the session is freed after it finished
+void io_copy_session_detach(io_copy_session *session);
+
+// bytes copied so far by the session
+void io_copy_session_stats(io_copy_session *session, struct io_copy_stats *stats);
 
 #ifdef __cplusplus
 }
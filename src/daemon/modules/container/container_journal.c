@@ -0,0 +1,747 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide container metadata journal functions
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "container_journal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "isula_libutils/log.h"
+#include "constants.h"
+#include "map.h"
+#include "utils.h"
+#include "utils_array.h"
+#include "utils_file.h"
+
+/*
+ * Config files of containers are appended to one journal file instead of being rewritten one by one.
+ * The journal is synced by a background thread in batch, and compacted into config files when it
+ * grows too large or has been dirty for a while. Compaction renames the journal to CONTAINER_JOURNAL_OLD,
+ * so writes during compaction go to a new journal, and the old journal is replayed before the new one
+ * if the daemon crashed during compaction.
+ */
+#define CONTAINER_JOURNAL_FILE "containers.journal"
+#define CONTAINER_JOURNAL_OLD CONTAINER_JOURNAL_FILE ".old"
+#define CONTAINER_JOURNAL_TMP CONTAINER_JOURNAL_FILE ".tmp"
+
+#define JOURNAL_RECORD_MAGIC 0x6a726e6cU
+#define JOURNAL_SYNC_INTERVAL_MS 200
+#define JOURNAL_COMPACT_SIZE (4 * 1024 * 1024)
+#define JOURNAL_COMPACT_INTERVAL_SEC 10
+
+// a forget record drops earlier records of files whose path starts with its path
+typedef enum { JOURNAL_RECORD_WRITE = 1, JOURNAL_RECORD_FORGET } journal_record_type;
+
+struct journal_record_header {
+    uint32_t magic;
+    uint32_t type;
+    uint32_t path_len;
+    uint32_t data_len;
+    uint32_t checksum;
+};
+
+struct container_journal {
+    // protect fields below, and order of records in journal
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int fd;
+    // path -> latest content of config files not compacted yet
+    map_t *dirty;
+    uint64_t size;
+    bool unsynced;
+    // a stale record can not be dropped by a tombstone, compact it away as soon as possible
+    bool compact_now;
+    time_t last_compact;
+
+    // held while config files are rewritten, so a removed container is not rewritten by compaction
+    pthread_mutex_t compact_mutex;
+    char *path;
+    char *old_path;
+    char *tmp_path;
+    int rootfd;
+    bool enabled;
+};
+
+static struct container_journal g_journal = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .fd = -1,
+    .compact_mutex = PTHREAD_MUTEX_INITIALIZER,
+    .rootfd = -1,
+};
+
+static uint32_t journal_checksum(const char *path, size_t path_len, const char *data, size_t data_len)
+{
+    // FNV-1a, only used to find torn records at tail of journal
+    uint32_t hash = 2166136261U;
+    size_t i;
+
+    for (i = 0; i < path_len; i++) {
+        hash = (hash ^ (uint8_t)path[i]) * 16777619U;
+    }
+    for (i = 0; i < data_len; i++) {
+        hash = (hash ^ (uint8_t)data[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+static int journal_append_record(int fd, uint64_t *size, journal_record_type type, const char *path,
+                                 const char *data, size_t data_len)
+{
+    int ret = 0;
+    size_t path_len = strlen(path);
+    size_t total = 0;
+    char *buf = NULL;
+    struct journal_record_header header = { 0 };
+
+    if (path_len > UINT32_MAX || data_len > UINT32_MAX ||
+        data_len > SIZE_MAX - path_len - sizeof(struct journal_record_header)) {
+        ERROR("Too large journal record for %s", path);
+        return -1;
+    }
+
+    header.magic = JOURNAL_RECORD_MAGIC;
+    header.type = (uint32_t)type;
+    header.path_len = (uint32_t)path_len;
+    header.data_len = (uint32_t)data_len;
+    header.checksum = journal_checksum(path, path_len, data, data_len);
+
+    total = sizeof(header) + path_len + data_len;
+    buf = util_common_calloc_s(total);
+    if (buf == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    (void)memcpy(buf, &header, sizeof(header));
+    (void)memcpy(buf + sizeof(header), path, path_len);
+    if (data_len > 0) {
+        (void)memcpy(buf + sizeof(header) + path_len, data, data_len);
+    }
+
+    if (util_write_nointr_in_total(fd, buf, total) != (ssize_t)total) {
+        SYSERROR("Failed to append journal record for %s", path);
+        // cut the torn record, otherwise records after it are lost when replaying
+        if (ftruncate(fd, (off_t)*size) != 0) {
+            SYSERROR("Failed to truncate journal");
+        }
+        ret = -1;
+        goto out;
+    }
+    *size += total;
+
+out:
+    free(buf);
+    return ret;
+}
+
+static void journal_drop_prefix(map_t *map, const char *prefix)
+{
+    size_t i;
+    size_t prefix_len = strlen(prefix);
+    char **keys = NULL;
+    map_itor *itor = NULL;
+
+    itor = map_itor_new(map);
+    if (itor == NULL) {
+        ERROR("Out of memory");
+        return;
+    }
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        const char *key = map_itor_key(itor);
+        if (strncmp(key, prefix, prefix_len) == 0 && util_array_append(&keys, key) != 0) {
+            ERROR("Out of memory");
+            break;
+        }
+    }
+    map_itor_free(itor);
+
+    for (i = 0; keys != NULL && keys[i] != NULL; i++) {
+        (void)map_remove(map, keys[i]);
+    }
+    util_free_array(keys);
+}
+
+static int journal_read_file(const char *path, char **content, size_t *len)
+{
+    int ret = 0;
+    int fd = -1;
+    ssize_t nret = 0;
+    struct stat st = { 0 };
+
+    fd = util_open(path, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return 0;
+        }
+        SYSERROR("Failed to open journal %s", path);
+        return -1;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        SYSERROR("Failed to stat journal %s", path);
+        ret = -1;
+        goto out;
+    }
+    if (st.st_size == 0) {
+        goto out;
+    }
+
+    *content = util_common_calloc_s((size_t)st.st_size);
+    if (*content == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto out;
+    }
+    while (*len < (size_t)st.st_size) {
+        nret = util_read_nointr(fd, *content + *len, (size_t)st.st_size - *len);
+        if (nret < 0) {
+            SYSERROR("Failed to read journal %s", path);
+            free(*content);
+            *content = NULL;
+            *len = 0;
+            ret = -1;
+            goto out;
+        }
+        if (nret == 0) {
+            break;
+        }
+        *len += (size_t)nret;
+    }
+
+out:
+    close(fd);
+    return ret;
+}
+
+static char *journal_dup_field(const char *field, size_t len)
+{
+    char *dup = util_common_calloc_s(len + 1);
+
+    if (dup != NULL && len > 0) {
+        (void)memcpy(dup, field, len);
+    }
+    return dup;
+}
+
+static int journal_apply_record(map_t *map, const struct journal_record_header *header, const char *payload)
+{
+    int ret = 0;
+    char *path = NULL;
+    char *data = NULL;
+
+    path = journal_dup_field(payload, header->path_len);
+    data = journal_dup_field(payload + header->path_len, header->data_len);
+    if (path == NULL || data == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto out;
+    }
+
+    if (header->type == JOURNAL_RECORD_WRITE) {
+        if (!map_replace(map, path, data)) {
+            ERROR("Failed to replay journal record of %s", path);
+            ret = -1;
+        }
+    } else if (header->type == JOURNAL_RECORD_FORGET) {
+        journal_drop_prefix(map, path);
+    } else {
+        WARN("Unknown journal record type %u of %s", header->type, path);
+    }
+
+out:
+    free(path);
+    free(data);
+    return ret;
+}
+
+// read the latest content of config files from journal into map
+static int journal_replay_file(const char *path, map_t *map)
+{
+    int ret = 0;
+    char *content = NULL;
+    size_t len = 0;
+    size_t off = 0;
+    struct journal_record_header header = { 0 };
+
+    if (journal_read_file(path, &content, &len) != 0) {
+        return -1;
+    }
+
+    while (off < len) {
+        const char *payload = NULL;
+
+        if (len - off < sizeof(header)) {
+            break;
+        }
+        (void)memcpy(&header, content + off, sizeof(header));
+        payload = content + off + sizeof(header);
+        if (header.magic != JOURNAL_RECORD_MAGIC ||
+            (uint64_t)header.path_len + header.data_len > len - off - sizeof(header) ||
+            header.checksum != journal_checksum(payload, header.path_len, payload + header.path_len,
+                                                header.data_len)) {
+            break;
+        }
+
+        if (journal_apply_record(map, &header, payload) != 0) {
+            ret = -1;
+            goto out;
+        }
+        off += sizeof(header) + header.path_len + header.data_len;
+    }
+
+    if (off < len) {
+        WARN("Journal %s is torn at offset %zu of %zu, ignore records after it", path, off, len);
+    }
+
+out:
+    free(content);
+    return ret;
+}
+
+static bool journal_container_exists(const char *path)
+{
+    bool ret = false;
+    char *dir = util_path_dir(path);
+
+    ret = dir != NULL && util_dir_exists(dir);
+    free(dir);
+    return ret;
+}
+
+static void journal_sync_dir(const char *dir)
+{
+    int fd = -1;
+
+    fd = util_open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        // the container is removed after its file was written
+        if (errno != ENOENT) {
+            SYSERROR("Failed to open %s", dir);
+        }
+        return;
+    }
+    if (fsync(fd) != 0) {
+        SYSERROR("Failed to sync %s", dir);
+    }
+    close(fd);
+}
+
+/*
+ * Rewrite config files with content in map, and sync them and their directories to disk.
+ * Files which failed to be written are kept in failed, files of removed containers are skipped.
+ */
+static void journal_write_files(map_t *map, map_t *failed)
+{
+    bool val = true;
+    map_t *dirs = NULL;
+    map_itor *itor = NULL;
+
+    dirs = map_new(MAP_STR_BOOL, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    itor = map_itor_new(map);
+    if (dirs == NULL || itor == NULL) {
+        ERROR("Out of memory");
+        goto out;
+    }
+
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        const char *path = map_itor_key(itor);
+        const char *content = map_itor_value(itor);
+        char *dir = NULL;
+
+        if (util_atomic_write_file(path, content, strlen(content), CONFIG_FILE_MODE, true) == 0) {
+            // renames of files in the same directory are synced together
+            dir = util_path_dir(path);
+            if (dir == NULL || !map_replace(dirs, dir, &val)) {
+                ERROR("Failed to record directory of %s", path);
+            }
+            free(dir);
+            continue;
+        }
+        if (!journal_container_exists(path)) {
+            DEBUG("Skip config file %s of removed container", path);
+            continue;
+        }
+        ERROR("Failed to write config file %s", path);
+        if (!map_replace(failed, (void *)path, (void *)content)) {
+            ERROR("Failed to keep failed config file %s", path);
+        }
+    }
+    map_itor_free(itor);
+
+    itor = map_itor_new(dirs);
+    if (itor == NULL) {
+        ERROR("Out of memory");
+        goto out;
+    }
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        journal_sync_dir(map_itor_key(itor));
+    }
+
+out:
+    map_itor_free(itor);
+    map_free(dirs);
+}
+
+// append files failed to be written to journal again, unless they are written again after compaction
+static void journal_requeue_locked(map_t *failed)
+{
+    map_itor *itor = NULL;
+
+    if (map_size(failed) == 0) {
+        return;
+    }
+
+    itor = map_itor_new(failed);
+    if (itor == NULL) {
+        ERROR("Out of memory");
+        return;
+    }
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        const char *path = map_itor_key(itor);
+        const char *content = map_itor_value(itor);
+
+        if (map_search(g_journal.dirty, (void *)path) != NULL) {
+            continue;
+        }
+        if (journal_append_record(g_journal.fd, &g_journal.size, JOURNAL_RECORD_WRITE, path, content,
+                                  strlen(content)) != 0 ||
+            !map_replace(g_journal.dirty, (void *)path, (void *)content)) {
+            ERROR("Failed to requeue config file %s", path);
+        }
+    }
+    map_itor_free(itor);
+
+    if (fdatasync(g_journal.fd) != 0) {
+        SYSERROR("Failed to sync journal");
+    }
+}
+
+static void journal_compact(void)
+{
+    int fd = -1;
+    int old_fd = -1;
+    map_t *dirty = NULL;
+    map_t *old = NULL;
+    map_t *failed = NULL;
+
+    dirty = map_new(MAP_STR_STR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    failed = map_new(MAP_STR_STR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (dirty == NULL || failed == NULL) {
+        ERROR("Out of memory");
+        map_free(dirty);
+        map_free(failed);
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_journal.compact_mutex);
+    (void)pthread_mutex_lock(&g_journal.mutex);
+    g_journal.last_compact = time(NULL);
+    g_journal.compact_now = false;
+    if (g_journal.size == 0) {
+        (void)pthread_mutex_unlock(&g_journal.mutex);
+        goto out;
+    }
+
+    // start a new journal, the old one is removed after its files are synced
+    if (rename(g_journal.path, g_journal.old_path) != 0) {
+        SYSERROR("Failed to rotate journal %s", g_journal.path);
+        (void)pthread_mutex_unlock(&g_journal.mutex);
+        goto out;
+    }
+    fd = util_open(g_journal.path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, SECURE_CONFIG_FILE_MODE);
+    if (fd < 0) {
+        SYSERROR("Failed to create journal %s", g_journal.path);
+        if (rename(g_journal.old_path, g_journal.path) != 0) {
+            SYSERROR("Failed to restore journal %s", g_journal.path);
+        }
+        (void)pthread_mutex_unlock(&g_journal.mutex);
+        goto out;
+    }
+    old_fd = g_journal.fd;
+    old = g_journal.dirty;
+    g_journal.fd = fd;
+    g_journal.dirty = dirty;
+    dirty = NULL;
+    g_journal.size = 0;
+    g_journal.unsynced = false;
+    (void)pthread_mutex_unlock(&g_journal.mutex);
+
+    close(old_fd);
+    journal_write_files(old, failed);
+
+    (void)pthread_mutex_lock(&g_journal.mutex);
+    journal_requeue_locked(failed);
+    (void)pthread_mutex_unlock(&g_journal.mutex);
+
+    if (unlink(g_journal.old_path) != 0) {
+        SYSERROR("Failed to remove journal %s", g_journal.old_path);
+    }
+    DEBUG("Compacted %zu config files from journal", map_size(old));
+
+out:
+    (void)pthread_mutex_unlock(&g_journal.compact_mutex);
+    map_free(dirty);
+    map_free(old);
+    map_free(failed);
+}
+
+static void *journal_flush_thread(void *arg)
+{
+    struct timespec deadline = { 0 };
+    bool need_sync = false;
+    bool need_compact = false;
+    int fd = -1;
+
+    (void)prctl(PR_SET_NAME, "CtrJournal");
+
+    for (;;) {
+        (void)clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += (long)JOURNAL_SYNC_INTERVAL_MS * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        (void)pthread_mutex_lock(&g_journal.mutex);
+        (void)pthread_cond_timedwait(&g_journal.cond, &g_journal.mutex, &deadline);
+        // only this thread replaces the journal fd, so it is safe to sync it without lock
+        fd = g_journal.fd;
+        need_sync = g_journal.unsynced;
+        g_journal.unsynced = false;
+        need_compact = g_journal.compact_now || g_journal.size >= JOURNAL_COMPACT_SIZE ||
+                       (g_journal.size > 0 && time(NULL) - g_journal.last_compact >= JOURNAL_COMPACT_INTERVAL_SEC);
+        (void)pthread_mutex_unlock(&g_journal.mutex);
+
+        // all records appended in the interval are synced together
+        if (need_sync && fdatasync(fd) != 0) {
+            SYSERROR("Failed to sync journal");
+        }
+        if (need_compact) {
+            journal_compact();
+        }
+    }
+
+    return NULL;
+}
+
+static int journal_init_paths(const char *rootdir)
+{
+    char path[PATH_MAX] = { 0 };
+    int nret;
+
+    nret = snprintf(path, sizeof(path), "%s/%s", rootdir, CONTAINER_JOURNAL_FILE);
+    if (nret < 0 || (size_t)nret >= sizeof(path)) {
+        ERROR("Failed to print string");
+        return -1;
+    }
+    g_journal.path = util_strdup_s(path);
+
+    nret = snprintf(path, sizeof(path), "%s/%s", rootdir, CONTAINER_JOURNAL_OLD);
+    if (nret < 0 || (size_t)nret >= sizeof(path)) {
+        ERROR("Failed to print string");
+        return -1;
+    }
+    g_journal.old_path = util_strdup_s(path);
+
+    nret = snprintf(path, sizeof(path), "%s/%s", rootdir, CONTAINER_JOURNAL_TMP);
+    if (nret < 0 || (size_t)nret >= sizeof(path)) {
+        ERROR("Failed to print string");
+        return -1;
+    }
+    g_journal.tmp_path = util_strdup_s(path);
+
+    return 0;
+}
+
+// replay journals of last run, and start a new journal with files failed to be written only
+static int journal_recover(void)
+{
+    int ret = 0;
+    int fd = -1;
+    map_t *replayed = NULL;
+    map_t *failed = NULL;
+
+    replayed = map_new(MAP_STR_STR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    failed = map_new(MAP_STR_STR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    g_journal.dirty = map_new(MAP_STR_STR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (replayed == NULL || failed == NULL || g_journal.dirty == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto out;
+    }
+
+    if (journal_replay_file(g_journal.old_path, replayed) != 0 ||
+        journal_replay_file(g_journal.path, replayed) != 0) {
+        ERROR("Failed to replay container journal");
+        ret = -1;
+        goto out;
+    }
+    if (map_size(replayed) > 0) {
+        INFO("Replay %zu config files from container journal", map_size(replayed));
+        journal_write_files(replayed, failed);
+    }
+
+    fd = util_open(g_journal.tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, SECURE_CONFIG_FILE_MODE);
+    if (fd < 0) {
+        SYSERROR("Failed to create journal %s", g_journal.tmp_path);
+        ret = -1;
+        goto out;
+    }
+    g_journal.fd = fd;
+    g_journal.size = 0;
+    journal_requeue_locked(failed);
+
+    if (rename(g_journal.tmp_path, g_journal.path) != 0) {
+        SYSERROR("Failed to rename journal %s", g_journal.tmp_path);
+        ret = -1;
+        goto out;
+    }
+    // the new journal must survive a crash before the old one is removed
+    if (fsync(g_journal.rootfd) != 0) {
+        SYSERROR("Failed to sync journal directory");
+    }
+    if (unlink(g_journal.old_path) != 0 && errno != ENOENT) {
+        SYSERROR("Failed to remove journal %s", g_journal.old_path);
+    }
+
+out:
+    map_free(replayed);
+    map_free(failed);
+    return ret;
+}
+
+int container_journal_init(const char *rootdir)
+{
+    pthread_t tid;
+
+    if (rootdir == NULL) {
+        return -1;
+    }
+
+    if (journal_init_paths(rootdir) != 0) {
+        return -1;
+    }
+
+    g_journal.rootfd = util_open(rootdir, O_RDONLY | O_DIRECTORY | O_CLOEXEC, 0);
+    if (g_journal.rootfd < 0) {
+        SYSERROR("Failed to open %s", rootdir);
+        return -1;
+    }
+
+    if (journal_recover() != 0) {
+        return -1;
+    }
+    g_journal.last_compact = time(NULL);
+
+    if (pthread_create(&tid, NULL, journal_flush_thread, NULL) != 0) {
+        ERROR("Failed to create container journal thread");
+        return -1;
+    }
+    (void)pthread_detach(tid);
+
+    g_journal.enabled = true;
+    return 0;
+}
+
+bool container_journal_enabled(void)
+{
+    return g_journal.enabled;
+}
+
+int container_journal_write(const char *path, const char *content, size_t len)
+{
+    int ret = 0;
+
+    if (path == NULL || content == NULL) {
+        return -1;
+    }
+
+    if (!g_journal.enabled) {
+        return util_atomic_write_file(path, content, len, CONFIG_FILE_MODE, false);
+    }
+
+    (void)pthread_mutex_lock(&g_journal.mutex);
+    if (journal_append_record(g_journal.fd, &g_journal.size, JOURNAL_RECORD_WRITE, path, content, len) == 0) {
+        if (!map_replace(g_journal.dirty, (void *)path, (void *)content)) {
+            ERROR("Failed to record config file %s", path);
+            ret = -1;
+        }
+        g_journal.unsynced = true;
+        if (g_journal.size >= JOURNAL_COMPACT_SIZE) {
+            (void)pthread_cond_signal(&g_journal.cond);
+        }
+        (void)pthread_mutex_unlock(&g_journal.mutex);
+        return ret;
+    }
+    (void)pthread_mutex_unlock(&g_journal.mutex);
+
+    // writes of the same container are serialized by container lock, so the file is written
+    // directly, and the stale content in journal is dropped
+    (void)pthread_mutex_lock(&g_journal.compact_mutex);
+    ret = util_atomic_write_file(path, content, len, CONFIG_FILE_MODE, false);
+    (void)pthread_mutex_lock(&g_journal.mutex);
+    if (map_search(g_journal.dirty, (void *)path) != NULL) {
+        (void)map_remove(g_journal.dirty, (void *)path);
+        // otherwise the stale record overwrites the file when replaying
+        if (journal_append_record(g_journal.fd, &g_journal.size, JOURNAL_RECORD_FORGET, path, NULL, 0) == 0) {
+            g_journal.unsynced = true;
+        } else {
+            g_journal.compact_now = true;
+            (void)pthread_cond_signal(&g_journal.cond);
+        }
+    }
+    (void)pthread_mutex_unlock(&g_journal.mutex);
+    (void)pthread_mutex_unlock(&g_journal.compact_mutex);
+
+    return ret;
+}
+
+void container_journal_forget(const char *rootpath, const char *id)
+{
+    char prefix[PATH_MAX] = { 0 };
+    int nret;
+
+    if (!g_journal.enabled || rootpath == NULL || id == NULL) {
+        return;
+    }
+
+    nret = snprintf(prefix, sizeof(prefix), "%s/%s/", rootpath, id);
+    if (nret < 0 || (size_t)nret >= sizeof(prefix)) {
+        ERROR("Failed to print string");
+        return;
+    }
+
+    // wait for running compaction, which may be writing files of the container
+    (void)pthread_mutex_lock(&g_journal.compact_mutex);
+    (void)pthread_mutex_lock(&g_journal.mutex);
+    journal_drop_prefix(g_journal.dirty, prefix);
+    // records of the container before it are dropped when replaying
+    if (journal_append_record(g_journal.fd, &g_journal.size, JOURNAL_RECORD_FORGET, prefix, NULL, 0) == 0) {
+        g_journal.unsynced = true;
+    }
+    (void)pthread_mutex_unlock(&g_journal.mutex);
+    (void)pthread_mutex_unlock(&g_journal.compact_mutex);
+}
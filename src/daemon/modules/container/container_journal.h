@@ -0,0 +1,46 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide container metadata journal definition
+ ******************************************************************************/
+#ifndef DAEMON_MODULES_CONTAINER_CONTAINER_JOURNAL_H
+#define DAEMON_MODULES_CONTAINER_CONTAINER_JOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/*
+ * Replay the journal left in rootdir by last run into the config files of containers,
+ * then start to journal writes of config files. It must be called before containers are loaded.
+ */
+int container_journal_init(const char *rootdir);
+
+bool container_journal_enabled(void);
+
+/*
+ * Append content of config file path to the journal. The file itself is rewritten
+ * later by compaction, with the latest content of all writes in between.
+ */
+int container_journal_write(const char *path, const char *content, size_t len);
+
+// drop pending writes of container id, it must be called before the root dir of container is removed
+void container_journal_forget(const char *rootpath, const char *id);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif // DAEMON_MODULES_CONTAINER_CONTAINER_JOURNAL_H
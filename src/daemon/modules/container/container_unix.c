@@ -34,10 +34,12 @@
 #include "restartmanager.h"
 #include "utils.h"
 #include "container_events_handler.h"
+#include "container_journal.h"
 #include "health_check.h"
 #include "containers_gc.h"
 #include "supervisor.h"
 #include "restore.h"
+#include "isulad_config.h"
 #include "err_msg.h"
 #include "util_atomic.h"
 #include "utils_array.h"
@@ -520,7 +522,7 @@ static int save_json_config_file(const char *id, const char *rootpath, const cha
         goto out;
     }
 
-    nret = util_atomic_write_file(filename, json_data, strlen(json_data), CONFIG_FILE_MODE, false);
+    nret = container_journal_write(filename, json_data, strlen(json_data));
     if (nret != 0) {
         ERROR("Write file %s failed: %s", filename, strerror(errno));
         isulad_set_error_message("Write file '%s' failed: %s", filename, strerror(errno));
@@ -1511,6 +1513,8 @@ bool container_has_mount_for(container_t *cont, const char *mpath)
 
 int container_module_init()
 {
+    char *rootdir = NULL;
+
     if (new_gchandler()) {
         ERROR("Create garbage handler thread failed");
         return -1;
@@ -1521,6 +1525,15 @@ int container_module_init()
         return -1;
     }
 
+    // config files must be recovered from journal before containers are restored
+    rootdir = conf_get_isulad_rootdir();
+    if (container_journal_init(rootdir) != 0) {
+        ERROR("Failed to init container journal");
+        free(rootdir);
+        return -1;
+    }
+    free(rootdir);
+
     containers_restore();
 
     if (start_gchandler()) {
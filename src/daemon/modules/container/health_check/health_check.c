@@ -25,6 +25,7 @@
 #include <isula_libutils/defs.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 
 #include "isula_libutils/log.h"
 #include "utils.h"
@@ -35,6 +36,7 @@
 #include "io_wrapper.h"
 #include "utils_array.h"
 #include "utils_timestamp.h"
+#include "linked_list.h"
 
 /* container state lock */
 static void container_health_check_lock(health_check_manager_t *health)
@@ -167,6 +169,87 @@ static bool get_monitor_exist_flag(health_check_manager_t *health)
     return ret;
 }
 
+#define HEALTH_CHECK_PROBE_WORKERS 8
+
+/* a container being monitored, owned by the scheduler or a probe worker */
+typedef struct {
+    container_t *cont;
+    int64_t probe_interval;
+    // monotonic time in nanos when the next probe is due
+    int64_t due;
+} health_check_task_t;
+
+/*
+ * One scheduler thread waits for the earliest due probe and hands it to a few
+ * probe workers, instead of a polling thread for each monitored container.
+ */
+static pthread_mutex_t g_health_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_timer_cond;
+static pthread_cond_t g_probe_cond = PTHREAD_COND_INITIALIZER;
+/* broadcast when a monitor exits, waited with g_health_lock */
+static pthread_cond_t g_exit_cond = PTHREAD_COND_INITIALIZER;
+/* g_timer_cond and the lists are initialized, protected by g_health_lock */
+static bool g_scheduler_inited = false;
+static bool g_scheduler_started = false;
+/* protected by g_health_lock */
+static int g_probe_workers = 0;
+/* tasks waiting for their next probe, sorted by due time, protected by g_health_lock */
+static struct linked_list g_timer_list;
+/* tasks whose probe is due, protected by g_health_lock */
+static struct linked_list g_probe_queue;
+/* protected by g_health_lock */
+static health_check_stats_t g_health_stats;
+
+static int64_t monotonic_now_nanos(void)
+{
+    struct timespec ts = { 0 };
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        ERROR("Failed to get monotonic time");
+        return 0;
+    }
+
+    return (int64_t)ts.tv_sec * Time_Second + (int64_t)ts.tv_nsec;
+}
+
+/* called with g_health_lock held */
+static void add_to_timer_list(struct linked_list *node)
+{
+    struct linked_list *it = NULL;
+    health_check_task_t *task = node->elem;
+    health_check_task_t *other = NULL;
+
+    linked_list_for_each(it, &g_timer_list) {
+        other = it->elem;
+        if (other->due > task->due) {
+            break;
+        }
+    }
+    // insert before the first later task, or at the end
+    linked_list_add_tail(it, node);
+    (void)pthread_cond_signal(&g_timer_cond);
+}
+
+/*
+ * make the stopped monitor of container due now, so that it exits without waiting for the interval,
+ * called with g_health_lock held
+ */
+static void wakeup_health_check_task(const health_check_manager_t *health)
+{
+    struct linked_list *it = NULL;
+    health_check_task_t *task = NULL;
+
+    linked_list_for_each(it, &g_timer_list) {
+        task = it->elem;
+        if (task->cont->health_check == health) {
+            linked_list_del(it);
+            task->due = 0;
+            add_to_timer_list(it);
+            break;
+        }
+    }
+}
+
 static void close_health_check_monitor(container_t *cont)
 {
     if (cont == NULL || cont->health_check == NULL) {
@@ -174,10 +257,17 @@ static void close_health_check_monitor(container_t *cont)
     }
 
     set_monitor_stop_status(cont->health_check);
-    // ensure that the monitor process exits
-    while (get_monitor_exist_flag(cont->health_check)) {
-        util_usleep_nointerupt(500);
+
+    (void)pthread_mutex_lock(&g_health_lock);
+    // no monitor exists before the scheduler is initialized
+    if (g_scheduler_inited) {
+        wakeup_health_check_task(cont->health_check);
+        // ensure that the monitor exits
+        while (get_monitor_exist_flag(cont->health_check)) {
+            (void)pthread_cond_wait(&g_exit_cond, &g_health_lock);
+        }
     }
+    (void)pthread_mutex_unlock(&g_health_lock);
 }
 
 // Called when the container is being stopped (whether because the health check is
@@ -736,127 +826,282 @@ out:
     return bret;
 }
 
-static int do_monitor_interval(const char *container_id, health_check_manager_t *health_check,
-                               types_timestamp_t *start_timestamp)
+static void finish_health_check_task(struct linked_list *node)
 {
-    int ret = 0;
+    health_check_task_t *task = node->elem;
+    container_t *cont = task->cont;
+
+    DEBUG("Stop healthcheck monitoring for container %s", cont->common_config->id);
+    //  unhealthy when the monitor has stopped for compatibility reasons
+    set_health_status(cont, UNHEALTHY);
+    // indicating that the minitor has exited
+    (void)pthread_mutex_lock(&g_health_lock);
+    set_monitor_exist_flag(cont->health_check, false);
+    (void)pthread_cond_broadcast(&g_exit_cond);
+    (void)pthread_mutex_unlock(&g_health_lock);
+    container_unref(cont);
+    free(task);
+    free(node);
+    DAEMON_CLEAR_ERRMSG();
+}
+
+static void schedule_health_check_task(struct linked_list *node)
+{
+    health_check_task_t *task = node->elem;
+
+    (void)pthread_mutex_lock(&g_health_lock);
+    // stopped after the probe, wakeup_health_check_task may have missed it
+    if (get_health_check_monitor_state(task->cont->health_check) == MONITOR_STOP) {
+        task->due = 0;
+    }
+    add_to_timer_list(node);
+    (void)pthread_mutex_unlock(&g_health_lock);
+}
+
+/* the probe of task is due, hand it to the probe workers */
+static void dispatch_health_check_task(struct linked_list *node)
+{
+    health_check_task_t *task = node->elem;
+    container_t *cont = task->cont;
 
-    if (!valid_container_status_for_health_check(container_id)) {
+    if (get_health_check_monitor_state(cont->health_check) == MONITOR_STOP) {
+        finish_health_check_task(node);
+        return;
+    }
+
+    if (!valid_container_status_for_health_check(cont->common_config->id)) {
         ERROR("Invalid container status for health check");
-        ret = -1;
-        goto out;
+        finish_health_check_task(node);
+        return;
     }
 
-    health_check_run(container_id);
+    if (transfer_monitor_interval_timeout_status(cont->health_check) != 0) {
+        finish_health_check_task(node);
+        return;
+    }
 
-    if (transfer_monitor_idle_status(health_check) != 0) {
-        ret = -1;
-        goto out;
+    (void)pthread_mutex_lock(&g_health_lock);
+    linked_list_add_tail(&g_probe_queue, node);
+    (void)pthread_cond_signal(&g_probe_cond);
+    (void)pthread_mutex_unlock(&g_health_lock);
+}
+
+static void *health_check_scheduler(void *arg)
+{
+    struct linked_list *node = NULL;
+    health_check_task_t *task = NULL;
+    struct timespec ts = { 0 };
+
+    if (pthread_detach(pthread_self()) != 0) {
+        ERROR("Failed to detach the health check scheduler thread");
+    }
+
+    prctl(PR_SET_NAME, "HealthCheck");
+
+    (void)pthread_mutex_lock(&g_health_lock);
+    for (;;) {
+        if (linked_list_empty(&g_timer_list)) {
+            (void)pthread_cond_wait(&g_timer_cond, &g_health_lock);
+            continue;
+        }
+
+        node = linked_list_first_node(&g_timer_list);
+        task = node->elem;
+        if (task->due > monotonic_now_nanos()) {
+            ts.tv_sec = (time_t)(task->due / Time_Second);
+            ts.tv_nsec = (long)(task->due % Time_Second);
+            (void)pthread_cond_timedwait(&g_timer_cond, &g_health_lock, &ts);
+            continue;
+        }
+
+        linked_list_del(node);
+        (void)pthread_mutex_unlock(&g_health_lock);
+        dispatch_health_check_task(node);
+        (void)pthread_mutex_lock(&g_health_lock);
     }
-    if (util_get_now_time_stamp(start_timestamp) == false) {
-        ERROR("Failed to get time stamp");
+    (void)pthread_mutex_unlock(&g_health_lock);
+
+    return NULL;
+}
+
+/* called with g_health_lock held */
+static void record_probe_stats(int64_t lag, int64_t latency)
+{
+    g_health_stats.probes++;
+    g_health_stats.queue_lag_sum += lag;
+    if (lag > g_health_stats.queue_lag_max) {
+        g_health_stats.queue_lag_max = lag;
+    }
+    g_health_stats.probe_latency_sum += latency;
+    if (latency > g_health_stats.probe_latency_max) {
+        g_health_stats.probe_latency_max = latency;
+    }
+}
+
+static void *health_check_probe_worker(void *arg)
+{
+    struct linked_list *node = NULL;
+    health_check_task_t *task = NULL;
+    container_t *cont = NULL;
+    int64_t start = 0;
+    int64_t end = 0;
+
+    if (pthread_detach(pthread_self()) != 0) {
+        ERROR("Failed to detach the health check probe thread");
+    }
+
+    prctl(PR_SET_NAME, "HealthProbe");
+
+    for (;;) {
+        (void)pthread_mutex_lock(&g_health_lock);
+        while (linked_list_empty(&g_probe_queue)) {
+            (void)pthread_cond_wait(&g_probe_cond, &g_health_lock);
+        }
+        node = linked_list_first_node(&g_probe_queue);
+        linked_list_del(node);
+        (void)pthread_mutex_unlock(&g_health_lock);
+
+        task = node->elem;
+        cont = task->cont;
+        if (get_health_check_monitor_state(cont->health_check) == MONITOR_STOP) {
+            finish_health_check_task(node);
+            continue;
+        }
+
+        start = monotonic_now_nanos();
+        health_check_run(cont->common_config->id);
+        end = monotonic_now_nanos();
+
+        (void)pthread_mutex_lock(&g_health_lock);
+        record_probe_stats(start > task->due ? start - task->due : 0, end - start);
+        (void)pthread_mutex_unlock(&g_health_lock);
+
+        if (transfer_monitor_idle_status(cont->health_check) != 0) {
+            finish_health_check_task(node);
+            continue;
+        }
+
+        // the interval starts when the probe finishes
+        task->due = end + task->probe_interval;
+        schedule_health_check_task(node);
+        DAEMON_CLEAR_ERRMSG();
+    }
+
+    return NULL;
+}
+
+/* called with g_health_lock held, initialize only once even if starting the threads fails */
+static int init_health_check_scheduler(void)
+{
+    pthread_condattr_t attr;
+    int ret = 0;
+
+    if (g_scheduler_inited) {
+        return 0;
+    }
+
+    if (pthread_condattr_init(&attr) != 0) {
+        ERROR("Failed to init health check scheduler condition attr");
+        return -1;
+    }
+
+    if (pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) != 0 || pthread_cond_init(&g_timer_cond, &attr) != 0) {
+        ERROR("Failed to init health check scheduler condition");
         ret = -1;
         goto out;
     }
 
+    linked_list_init(&g_timer_list);
+    linked_list_init(&g_probe_queue);
+    g_scheduler_inited = true;
+
 out:
+    (void)pthread_condattr_destroy(&attr);
     return ret;
 }
 
-static int do_monitor_default(const char *container_id, int64_t probe_interval, health_check_manager_t *health_check,
-                              const types_timestamp_t *start_timestamp, types_timestamp_t *last_timestamp)
+/* called with g_health_lock held, threads failed to start last time are started again */
+static int start_health_check_scheduler(void)
 {
-    int64_t time_interval = 0;
+    pthread_t tid = 0;
 
-    if (!valid_container_status_for_health_check(container_id)) {
-        ERROR("Invalid container status for health check");
-        return -1;
-    }
-
-    if (util_get_now_time_stamp(last_timestamp) == false) {
-        ERROR("Failed to get time stamp");
+    if (init_health_check_scheduler() != 0) {
         return -1;
     }
 
-    if (util_get_time_interval(*start_timestamp, *last_timestamp, &time_interval)) {
-        ERROR("Failed to get time interval");
-        return -1;
+    if (!g_scheduler_started) {
+        if (pthread_create(&tid, NULL, health_check_scheduler, NULL) != 0) {
+            ERROR("Failed to create health check scheduler thread");
+            return -1;
+        }
+        g_scheduler_started = true;
     }
 
-    if (time_interval >= probe_interval && transfer_monitor_interval_timeout_status(health_check) != 0) {
-        return -1;
+    // probes wait for the workers which are started
+    for (; g_probe_workers < HEALTH_CHECK_PROBE_WORKERS; g_probe_workers++) {
+        if (pthread_create(&tid, NULL, health_check_probe_worker, NULL) != 0) {
+            ERROR("Failed to create health check probe thread");
+            break;
+        }
     }
-    util_usleep_nointerupt(500);
 
-    return 0;
+    return g_probe_workers > 0 ? 0 : -1;
 }
 
-// Run the container's monitoring thread until notified via "stop".
-// There is never more than one monitor thread running per container at a time.
-static void *health_check_monitor(void *arg)
+// Start monitoring the container, there is never more than one task per container at a time.
+static int start_health_check_task(const char *container_id)
 {
-    char *container_id = NULL;
-    int64_t probe_interval = 0;
+    struct linked_list *node = NULL;
+    health_check_task_t *task = NULL;
     container_t *cont = NULL;
-    types_timestamp_t start_timestamp = { 0 };
-    types_timestamp_t last_timestamp = { 0 };
 
-    if ((char *)arg == NULL) {
-        ERROR("Container id is empty");
-        return NULL;
+    node = util_common_calloc_s(sizeof(struct linked_list));
+    task = util_common_calloc_s(sizeof(health_check_task_t));
+    if (node == NULL || task == NULL) {
+        ERROR("Out of memory");
+        goto err_out;
     }
 
-    container_id = (char *)arg;
-
-    prctl(PR_SET_NAME, "HealthCheck");
-
     cont = containers_store_get(container_id);
     if (cont == NULL) {
         ERROR("Failed to get container info");
-        free(container_id);
-        return NULL;
+        goto err_out;
     }
-    set_monitor_exist_flag(cont->health_check, true);
-    if (util_get_now_time_stamp(&start_timestamp) == false) {
-        ERROR("Failed to monitor start time stamp");
-        goto out;
-    }
-    probe_interval = (cont->common_config->config->healthcheck->interval == 0) ?
-                     DEFAULT_PROBE_INTERVAL :
-                     cont->common_config->config->healthcheck->interval;
-
-    while (true) {
-        switch (get_health_check_monitor_state(cont->health_check)) {
-            case MONITOR_STOP:
-                DEBUG("Stop healthcheck monitoring for container %s (received while idle)", cont->common_config->id);
-                goto out;
-            /* fall-through */
-            case MONITOR_INTERVAL:
-                if (do_monitor_interval(container_id, cont->health_check, &start_timestamp) != 0) {
-                    goto out;
-                }
-                break;
-            case MONITOR_IDLE:
-            /* fall-through */
-            default:
-                if (do_monitor_default(container_id, probe_interval, cont->health_check, &start_timestamp,
-                                       &last_timestamp) != 0) {
-                    goto out;
-                }
-                break;
-        }
+
+    task->cont = cont;
+    task->probe_interval = (cont->common_config->config->healthcheck->interval == 0) ?
+                           DEFAULT_PROBE_INTERVAL :
+                           cont->common_config->config->healthcheck->interval;
+    task->due = monotonic_now_nanos() + task->probe_interval;
+    linked_list_add_elem(node, task);
+
+    (void)pthread_mutex_lock(&g_health_lock);
+    if (start_health_check_scheduler() != 0) {
+        (void)pthread_mutex_unlock(&g_health_lock);
+        goto err_out;
     }
+    set_monitor_exist_flag(cont->health_check, true);
+    add_to_timer_list(node);
+    (void)pthread_mutex_unlock(&g_health_lock);
 
-out:
-    free(container_id);
-    container_id = NULL;
-    //  unhealthy when the monitor has stopped for compatibility reasons
-    set_health_status(cont, UNHEALTHY);
-    // post semaphore, indicating that the minitor process has exited
-    set_monitor_exist_flag(cont->health_check, false);
+    return 0;
+
+err_out:
     container_unref(cont);
-    DAEMON_CLEAR_ERRMSG();
-    return NULL;
+    free(task);
+    free(node);
+    return -1;
+}
+
+void container_get_health_check_stats(health_check_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_health_lock);
+    *stats = g_health_stats;
+    (void)pthread_mutex_unlock(&g_health_lock);
 }
 
 // Ensure the health-check monitor is running or not, depending on the current
@@ -887,18 +1132,11 @@ void container_update_health_monitor(const char *container_id)
 
     want_running = container_is_running(cont->state) && !container_is_paused(cont->state) && probe != HEALTH_NONE;
     if (want_running) {
-        pthread_t monitor_tid = { 0 };
-        char *cid = util_strdup_s(container_id);
         // ensured that the health check monitor process is stopped
         close_health_check_monitor(cont);
         init_monitor_idle_status(cont->health_check);
-        if (pthread_create(&monitor_tid, NULL, health_check_monitor, (void *)cid)) {
-            free(cid);
-            ERROR("Failed to create thread to monitor health check...");
-            goto out;
-        }
-        if (pthread_detach(monitor_tid)) {
-            ERROR("Failed to detach the health check monitor thread");
+        if (start_health_check_task(container_id) != 0) {
+            ERROR("Failed to start to monitor health check...");
             goto out;
         }
     } else {
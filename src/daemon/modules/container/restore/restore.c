@@ -26,6 +26,7 @@
 #include "isulad_config.h"
 #include "isula_libutils/log.h"
 #include "container_api.h"
+#include "container_journal.h"
 #include "supervisor.h"
 #include "containers_gc.h"
 #include "container_unix.h"
@@ -334,6 +335,8 @@ static int remove_invalid_container(const container_t *cont, const char *runtime
         goto out;
     }
 
+    container_journal_forget(root, id);
+
     ret = util_recursive_rmdir(container_root, 0);
     if (ret != 0) {
         ERROR("Failed to delete container's state directory %s", container_state);
@@ -430,25 +433,72 @@ unlock_continue:
     return;
 }
 
+// max threads to load containers at startup
+#define RESTORE_CONTAINER_WORKERS 8
+
+struct restore_load_result {
+    container_t *cont;
+    bool valid;
+};
+
+struct restore_load_context {
+    const char *runtime;
+    const char *rootpath;
+    const char *statepath;
+    const char **subdir;
+    struct restore_load_result *results;
+};
+
+// load container and check its image, it runs in parallel for different containers, so it only parses
+// files of the container and reads image store; runtime calls, gc posts and writes of state are left
+// to restore_state, which is called serially afterwards
+static void load_container_in_parallel(size_t idx, void *context)
+{
+    struct restore_load_context *ctx = (struct restore_load_context *)context;
+    struct restore_load_result *result = &ctx->results[idx];
+    const char *id = ctx->subdir[idx];
+
+    result->cont = container_load(ctx->runtime, ctx->rootpath, ctx->statepath, id);
+    if (result->cont == NULL) {
+        ERROR("Failed to load subdir:%s", id);
+        return;
+    }
+
+    if (check_container_image_exist(result->cont) != 0) {
+        ERROR("Failed to restore container:%s due to image not exist", id);
+        return;
+    }
+
+    result->valid = true;
+}
+
 /* scan dir to add store */
 static void scan_dir_to_add_store(const char *runtime, const char *rootpath, const char *statepath,
                                   const size_t subdir_num, const char **subdir)
 {
     size_t i = 0;
     container_t *cont = NULL;
+    struct restore_load_context ctx = { 0 };
+
+    ctx.runtime = runtime;
+    ctx.rootpath = rootpath;
+    ctx.statepath = statepath;
+    ctx.subdir = subdir;
+    ctx.results = util_smart_calloc_s(sizeof(struct restore_load_result), subdir_num);
+    if (ctx.results == NULL) {
+        ERROR("Out of memory");
+        return;
+    }
+
+    // configs of containers are parsed by several threads, then states are restored
+    // and containers are added into store in order of dirs
+    util_parallel_for(subdir_num, RESTORE_CONTAINER_WORKERS, load_container_in_parallel, &ctx);
 
     for (i = 0; i < subdir_num; i++) {
-        cont = NULL;
+        cont = ctx.results[i].cont;
         bool aret = false;
         bool index_flag = false;
-        cont = container_load(runtime, rootpath, statepath, subdir[i]);
-        if (cont == NULL) {
-            ERROR("Failed to load subdir:%s", subdir[i]);
-            goto error_load;
-        }
-
-        if (check_container_image_exist(cont) != 0) {
-            ERROR("Failed to restore container:%s due to image not exist", subdir[i]);
+        if (!ctx.results[i].valid) {
             goto error_load;
         }
 
@@ -484,6 +534,8 @@ error_load:
         container_unref(cont);
         continue;
     }
+
+    free(ctx.results);
 }
 
 /* restore container by runtime */
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/prctl.h>
+#include <time.h>
 
 #include "isula_libutils/log.h"
 #include "utils.h"
@@ -38,18 +39,47 @@
 #include "container_api.h"
 #include "event_type.h"
 #include "utils_file.h"
+#include "utils_timestamp.h"
+#include "linked_list.h"
 
 pthread_mutex_t g_supervisor_lock = PTHREAD_MUTEX_INITIALIZER;
 struct epoll_descr g_supervisor_descr;
 
+/*
+ * Cleaning resources mostly waits for the runtime processes it forks, so the
+ * workers grow with the queued containers up to CLEAN_RESOURCES_MAX_WORKERS,
+ * and workers idle for CLEAN_RESOURCES_IDLE_SECONDS exit until
+ * CLEAN_RESOURCES_MIN_WORKERS are left.
+ */
+#define CLEAN_RESOURCES_MIN_WORKERS 2
+#define CLEAN_RESOURCES_MAX_WORKERS 64
+#define CLEAN_RESOURCES_IDLE_SECONDS 30
+#define CLEAN_RESOURCES_MAX_RETRY 10
+#define CLEAN_RESOURCES_RETRY_INTERVAL_MS 100
+
 struct supervisor_handler_data {
     int fd;
     int exit_code;
     char *name;
     char *runtime;
     pid_ppid_info_t pid_info;
+    int retry_count;
+    // monotonic time in nanos to check the process again
+    int64_t due;
 };
 
+/* exited containers are cleaned by a pool of workers instead of a thread for each */
+static pthread_mutex_t g_clean_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_clean_cond;
+/* containers can be cleaned now, protected by g_clean_lock */
+static struct linked_list g_clean_ready;
+static size_t g_clean_ready_len;
+/* running workers and workers waiting for jobs, protected by g_clean_lock */
+static size_t g_clean_workers;
+static size_t g_clean_idle;
+/* containers whose process is killed and to be checked again, protected by g_clean_lock */
+static struct linked_list g_clean_delayed;
+
 /* supervisor handler lock */
 static void supervisor_handler_lock()
 {
@@ -155,26 +185,27 @@ static void supervisor_handler_data_free(struct supervisor_handler_data *data)
     free(data);
 }
 
-/* clean resources thread */
-static void *clean_resources_thread(void *arg)
+static int64_t monotonic_now_nanos(void)
+{
+    struct timespec ts = { 0 };
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        ERROR("Failed to get monotonic time");
+        return 0;
+    }
+
+    return (int64_t)ts.tv_sec * Time_Second + (int64_t)ts.tv_nsec;
+}
+
+/* clean resources of one exited container, return true if done, false to try again later */
+static bool clean_resources_once(struct supervisor_handler_data *data)
 {
     int ret = 0;
-    struct supervisor_handler_data *data = arg;
     char *name = data->name;
     char *runtime = data->runtime;
     unsigned long long start_time = data->pid_info.start_time;
     pid_t pid = data->pid_info.pid;
-    int retry_count = 0;
-    int max_retry = 10;
-
-    ret = pthread_detach(pthread_self());
-    if (ret != 0) {
-        CRIT("Set thread detach fail");
-    }
-
-    prctl(PR_SET_NAME, "Clean resource");
 
-retry:
     if (false == util_process_alive(pid, start_time)) {
         ret = clean_container_resource(name, runtime, pid);
         // clean_container_resource failed, do not log error message,
@@ -188,10 +219,9 @@ retry:
             ERROR("Can not kill process (pid=%d) with SIGKILL for container %s", pid, name);
         }
 
-        if (retry_count < max_retry) {
-            util_usleep_nointerupt(100 * 1000); /* 100 millisecond */
-            retry_count++;
-            goto retry;
+        if (data->retry_count < CLEAN_RESOURCES_MAX_RETRY) {
+            data->retry_count++;
+            return false;
         }
 
         ret = gc_add_container(name, runtime, &data->pid_info);
@@ -202,25 +232,218 @@ retry:
 
     (void)isulad_monitor_send_container_event(name, STOPPED, (int)pid, data->exit_code, NULL, NULL);
 
-    supervisor_handler_data_free(data);
+    return true;
+}
+
+static void *clean_resources_worker(void *arg);
+
+/* called with g_clean_lock held, start a worker if the idle ones can not take all ready jobs */
+static void clean_workers_grow(void)
+{
+    pthread_t worker;
+
+    if (g_clean_ready_len <= g_clean_idle || g_clean_workers >= CLEAN_RESOURCES_MAX_WORKERS) {
+        return;
+    }
+
+    if (pthread_create(&worker, NULL, clean_resources_worker, NULL) != 0) {
+        ERROR("Create clean resource worker failed");
+        return;
+    }
+    g_clean_workers++;
+}
+
+/* called with g_clean_lock held */
+static void clean_queue_add(struct linked_list *queue, struct linked_list *node)
+{
+    linked_list_add_tail(queue, node);
+    if (queue == &g_clean_ready) {
+        g_clean_ready_len++;
+        clean_workers_grow();
+    }
+    if (pthread_cond_signal(&g_clean_cond) != 0) {
+        ERROR("Failed to signal clean resources workers");
+    }
+}
+
+/* called with g_clean_lock held, move the retries which are due to the ready queue */
+static void clean_queue_move_due(int64_t now)
+{
+    struct linked_list *node = NULL;
+    struct supervisor_handler_data *data = NULL;
+
+    // all retries wait the same interval, so the delayed queue is sorted by due time
+    while (!linked_list_empty(&g_clean_delayed)) {
+        node = linked_list_first_node(&g_clean_delayed);
+        data = node->elem;
+        if (data->due > now) {
+            break;
+        }
+        linked_list_del(node);
+        linked_list_add_tail(&g_clean_ready, node);
+        g_clean_ready_len++;
+    }
+    clean_workers_grow();
+}
+
+/*
+ * wait for a container whose resources can be cleaned now, set retire if the
+ * worker was idle for too long and should exit.
+ */
+static struct linked_list *clean_queue_get(bool *retire)
+{
+    struct linked_list *node = NULL;
+    struct supervisor_handler_data *data = NULL;
+    struct timespec ts = { 0 };
+    int64_t now = 0;
+    int64_t idle_deadline = 0;
+    int64_t wait_until = 0;
+
+    if (pthread_mutex_lock(&g_clean_lock) != 0) {
+        ERROR("Failed to lock clean resources queue");
+        return NULL;
+    }
+
+    g_clean_idle++;
+    idle_deadline = monotonic_now_nanos() + CLEAN_RESOURCES_IDLE_SECONDS * Time_Second;
+    for (;;) {
+        now = monotonic_now_nanos();
+        clean_queue_move_due(now);
+        if (!linked_list_empty(&g_clean_ready)) {
+            node = linked_list_first_node(&g_clean_ready);
+            linked_list_del(node);
+            g_clean_ready_len--;
+            break;
+        }
+
+        if (now >= idle_deadline && g_clean_workers > CLEAN_RESOURCES_MIN_WORKERS) {
+            g_clean_workers--;
+            *retire = true;
+            break;
+        }
+
+        wait_until = idle_deadline;
+        if (!linked_list_empty(&g_clean_delayed)) {
+            data = linked_list_first_elem(&g_clean_delayed);
+            if (data->due < wait_until) {
+                wait_until = data->due;
+            }
+        }
+        ts.tv_sec = (time_t)(wait_until / Time_Second);
+        ts.tv_nsec = (long)(wait_until % Time_Second);
+        (void)pthread_cond_timedwait(&g_clean_cond, &g_clean_lock, &ts);
+    }
+    g_clean_idle--;
+
+    if (pthread_mutex_unlock(&g_clean_lock) != 0) {
+        ERROR("Failed to unlock clean resources queue");
+    }
+
+    return node;
+}
+
+/* clean resources worker */
+static void *clean_resources_worker(void *arg)
+{
+    struct linked_list *node = NULL;
+    struct supervisor_handler_data *data = NULL;
+    bool retire = false;
+
+    if (pthread_detach(pthread_self()) != 0) {
+        CRIT("Set thread detach fail");
+    }
+
+    prctl(PR_SET_NAME, "Clean resource");
+
+    for (;;) {
+        node = clean_queue_get(&retire);
+        if (retire) {
+            break;
+        }
+        if (node == NULL) {
+            util_usleep_nointerupt(CLEAN_RESOURCES_RETRY_INTERVAL_MS * 1000);
+            continue;
+        }
+        data = node->elem;
+
+        if (!clean_resources_once(data)) {
+            // process still alive after SIGKILL, check it again later without holding the worker
+            data->due = monotonic_now_nanos() + CLEAN_RESOURCES_RETRY_INTERVAL_MS * Time_Milli;
+            (void)pthread_mutex_lock(&g_clean_lock);
+            clean_queue_add(&g_clean_delayed, node);
+            (void)pthread_mutex_unlock(&g_clean_lock);
+            DAEMON_CLEAR_ERRMSG();
+            continue;
+        }
+
+        free(node);
+        supervisor_handler_data_free(data);
+        DAEMON_CLEAR_ERRMSG();
+    }
 
     DAEMON_CLEAR_ERRMSG();
     return NULL;
 }
 
-/* new clean resources thread */
-int new_clean_resources_thread(struct supervisor_handler_data *data)
+/* start the minimum clean resources workers, more are started when containers queue up */
+static int start_clean_resources_workers(void)
 {
-    int ret = 0;
-    pthread_t clean_thread;
+    pthread_condattr_t attr;
+    pthread_t worker;
+    int i;
 
-    if (pthread_create(&clean_thread, NULL, clean_resources_thread, data)) {
-        ERROR("Create clean resource thread failed");
+    if (pthread_condattr_init(&attr) != 0 || pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) != 0 ||
+        pthread_cond_init(&g_clean_cond, &attr) != 0) {
+        ERROR("Failed to init clean resources condition");
+        return -1;
+    }
+    (void)pthread_condattr_destroy(&attr);
+
+    linked_list_init(&g_clean_ready);
+    linked_list_init(&g_clean_delayed);
+
+    for (i = 0; i < CLEAN_RESOURCES_MIN_WORKERS; i++) {
+        if (pthread_mutex_lock(&g_clean_lock) != 0) {
+            ERROR("Failed to lock clean resources queue");
+            return -1;
+        }
+        if (pthread_create(&worker, NULL, clean_resources_worker, NULL) != 0) {
+            ERROR("Create clean resource worker failed");
+            (void)pthread_mutex_unlock(&g_clean_lock);
+            return -1;
+        }
+        g_clean_workers++;
+        (void)pthread_mutex_unlock(&g_clean_lock);
+    }
+
+    return 0;
+}
+
+/* queue the exited container to the clean resources workers */
+static int add_clean_resources_job(struct supervisor_handler_data *data)
+{
+    struct linked_list *node = NULL;
+
+    node = util_common_calloc_s(sizeof(struct linked_list));
+    if (node == NULL) {
+        ERROR("Out of memory");
         supervisor_handler_data_free(data);
-        ret = -1;
+        return -1;
     }
+    linked_list_add_elem(node, data);
 
-    return ret;
+    if (pthread_mutex_lock(&g_clean_lock) != 0) {
+        ERROR("Failed to lock clean resources queue");
+        free(node);
+        supervisor_handler_data_free(data);
+        return -1;
+    }
+    clean_queue_add(&g_clean_ready, node);
+    if (pthread_mutex_unlock(&g_clean_lock) != 0) {
+        ERROR("Failed to unlock clean resources queue");
+    }
+
+    return 0;
 }
 
 /* supervisor exit cb */
@@ -243,7 +466,7 @@ static int supervisor_exit_cb(int fd, uint32_t events, void *cbdata, struct epol
     epoll_loop_del_handler(&g_supervisor_descr, fd);
     supervisor_handler_unlock();
 
-    (void)new_clean_resources_thread(data);
+    (void)add_clean_resources_job(data);
 
     return EPOLL_LOOP_HANDLE_CONTINUE;
 }
@@ -339,6 +562,11 @@ int new_supervisor()
         goto out;
     }
 
+    ret = start_clean_resources_workers();
+    if (ret != 0) {
+        goto out;
+    }
+
     if (pthread_create(&supervisor_thread, NULL, supervisor, NULL) != 0) {
         ERROR("Create supervisor thread failed");
         ret = -1;
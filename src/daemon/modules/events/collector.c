@@ -18,13 +18,10 @@
 #include <string.h>
 #include <unistd.h>
 #include <sys/time.h>
-#include <sys/prctl.h>
-#include <regex.h>
 #include <isula_libutils/container_config.h>
 #include <isula_libutils/container_config_v2.h>
 #include <isula_libutils/json_common.h>
 #include <pthread.h>
-#include <semaphore.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <time.h>
@@ -39,70 +36,58 @@
 #include "constants.h"
 #include "events_format.h"
 #include "linked_list.h"
+#include "map.h"
 #include "stream_wrapper.h"
 #include "utils.h"
+#include "util_atomic.h"
 #include "utils_array.h"
 #include "utils_timestamp.h"
 
-static struct context_lists g_context_lists;
-
-struct events_lists {
-    unsigned int size;
-    pthread_mutex_t event_mutex;
-    struct linked_list event_list;
-};
-static struct events_lists g_events_buffer;
-
+// max events kept to replay for new 'events' clients
 #define EVENTSLIMIT 64
+// max events waiting to be sent to one 'events' client, the client is closed if more are waiting
+#define CLIENT_EVENTS_LIMIT 256
+
+// event shared by the history and the queues of clients, it is never modified after published
+typedef struct {
+    struct isulad_events_format *event;
+    uint64_t refcnt;
+} shared_event;
+
+// ring buffer of the latest events in arrival order, events posted concurrently may be out of timestamp order
+struct events_history {
+    pthread_mutex_t mutex;
+    shared_event *events[EVENTSLIMIT];
+    // index of the oldest event
+    size_t head;
+    size_t len;
+};
+static struct events_history g_events_history;
 
 struct context_elem {
     stream_func_wrapper stream;
     char *name;
-    sem_t context_sem;
     const types_timestamp_t *since;
     const types_timestamp_t *until;
+    // protect the queue below, the queue is filled by events_forward and consumed by client thread
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    shared_event *queue[CLIENT_EVENTS_LIMIT];
+    size_t head;
+    size_t len;
+    // the queue was full, later events are dropped and the stream is closed once the queue is sent
+    bool overflowed;
+    size_t dropped;
 };
 
-/* get idreg */
-static bool get_idreg(regex_t *preg, const char *id)
-{
-    char *regexp = NULL;
-    size_t len = 0;
-    int nret = 0;
-    bool ret = false;
-
-    if (id == NULL) {
-        ERROR("Invalid event id");
-        return false;
-    }
-
-    len = strlen(id) + 3;
-    regexp = util_common_calloc_s(len);
-    if (regexp == NULL) {
-        ERROR("failed to allocate memory");
-        return false;
-    }
-
-    nret = snprintf(regexp, len, "^%s$", id);
-    if ((size_t)nret >= len || nret < 0) {
-        ERROR("Failed to print string");
-        goto error;
-    }
-
-    nret = regcomp(preg, regexp, REG_NOSUB | REG_EXTENDED);
-    if (nret != 0) {
-        char buffer[EVENT_ARGS_MAX] = { 0 };
-        regerror(nret, preg, buffer, EVENT_ARGS_MAX);
-        ERROR("failed to compile the regex '%s'", buffer);
-        goto error;
-    }
-
-    ret = true;
-
-error:
-    free(regexp);
-    return ret;
-}
+struct subscribers {
+    pthread_mutex_t mutex;
+    // container id -> struct linked_list of context_elem subscribing events of the container
+    map_t *by_name;
+    // context_elem subscribing all events
+    struct linked_list all;
+};
+static struct subscribers g_subscribers;
 
 static container_events_type_t lcrsta2Evetype(int value)
 {
@@ -510,61 +495,64 @@ out:
     return ret;
 }
 
-/* events append */
-static void events_append(const struct isulad_events_format *event)
+static shared_event *shared_event_new(struct isulad_events_format *event)
 {
-    struct isulad_events_format *tmpevent = NULL;
-    struct linked_list *newnode = NULL;
-    struct linked_list *firstnode = NULL;
+    shared_event *se = NULL;
 
-    if (pthread_mutex_lock(&g_events_buffer.event_mutex)) {
-        WARN("Failed to lock");
+    se = util_common_calloc_s(sizeof(shared_event));
+    if (se == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    se->event = event;
+    se->refcnt = 1;
+
+    return se;
+}
+
+static void shared_event_ref(shared_event *se)
+{
+    (void)atomic_int_inc(&se->refcnt);
+}
+
+static void shared_event_unref(shared_event *se)
+{
+    if (se == NULL) {
         return;
     }
 
-    if (g_events_buffer.size < EVENTSLIMIT) {
-        newnode = util_common_calloc_s(sizeof(struct linked_list));
-        if (newnode == NULL) {
-            CRIT("Memory allocation error.");
-            goto unlock;
-        }
+    if (!atomic_int_dec_test(&se->refcnt)) {
+        return;
+    }
 
-        tmpevent = util_common_calloc_s(sizeof(struct isulad_events_format));
-        if (tmpevent == NULL) {
-            CRIT("Memory allocation error.");
-            free(newnode);
-            goto unlock;
-        }
+    isulad_events_format_free(se->event);
+    free(se);
+}
 
-        if (event_copy(event, tmpevent) != 0) {
-            CRIT("Failed to copy event.");
-            isulad_events_format_free(tmpevent);
-            free(newnode);
-            goto unlock;
-        }
+/* events append */
+static void events_append(shared_event *se)
+{
+    size_t tail = 0;
 
-        linked_list_add_elem(newnode, tmpevent);
-        linked_list_add_tail(&g_events_buffer.event_list, newnode);
-        g_events_buffer.size++;
-    } else {
-        firstnode = linked_list_first_node(&g_events_buffer.event_list);
-        if (firstnode != NULL) {
-            linked_list_del(firstnode);
-
-            tmpevent = (struct isulad_events_format *)firstnode->elem;
-            if (event_copy(event, tmpevent) != 0) {
-                CRIT("Failed to copy event.");
-                goto unlock;
-            }
+    if (pthread_mutex_lock(&g_events_history.mutex)) {
+        WARN("Failed to lock");
+        return;
+    }
 
-            linked_list_add_tail(&g_events_buffer.event_list, firstnode);
-        }
+    shared_event_ref(se);
+    tail = (g_events_history.head + g_events_history.len) % EVENTSLIMIT;
+    if (g_events_history.len < EVENTSLIMIT) {
+        g_events_history.events[tail] = se;
+        g_events_history.len++;
+    } else {
+        // overwrite the oldest one
+        shared_event_unref(g_events_history.events[tail]);
+        g_events_history.events[tail] = se;
+        g_events_history.head = (g_events_history.head + 1) % EVENTSLIMIT;
     }
 
-unlock:
-    if (pthread_mutex_unlock(&g_events_buffer.event_mutex)) {
+    if (pthread_mutex_unlock(&g_events_history.mutex)) {
         WARN("Failed to unlock");
-        return;
     }
 }
 
@@ -586,74 +574,55 @@ out:
     return ret;
 }
 
-static int check_since_time(const types_timestamp_t *since, const struct isulad_events_format *event)
+static bool timestamp_is_set(const types_timestamp_t *t)
 {
-    if (since != NULL && (since->has_seconds || since->has_nanos)) {
-        if (util_types_timestamp_cmp(&event->timestamp, since) < 0) {
-            return -1;
-        }
-    }
-    return 0;
-}
-
-static int check_util_time(const types_timestamp_t *until, const struct isulad_events_format *event)
-{
-    if (until != NULL && (until->has_seconds || until->has_nanos)) {
-        if (util_types_timestamp_cmp(&event->timestamp, until) > 0) {
-            return -1;
-        }
-    }
-    return 0;
+    return t != NULL && (t->has_seconds || t->has_nanos);
 }
 
 static int do_subscribe(const char *name, const types_timestamp_t *since, const types_timestamp_t *until,
                         const stream_func_wrapper *stream)
 {
-    bool regflag = false;
     int ret = 0;
-    regex_t preg;
-    struct linked_list *it = NULL;
-    struct linked_list *next = NULL;
-    struct isulad_events_format *c_event = NULL;
+    size_t i = 0;
+    size_t matched_len = 0;
+    shared_event *matched[EVENTSLIMIT] = { 0 };
+    shared_event *se = NULL;
 
-    if (pthread_mutex_lock(&g_events_buffer.event_mutex)) {
+    if (pthread_mutex_lock(&g_events_history.mutex)) {
         WARN("Failed to lock");
         return -1;
     }
 
-    linked_list_for_each_safe(it, &g_events_buffer.event_list, next) {
-        c_event = (struct isulad_events_format *)it->elem;
+    // the history is small and not sorted by timestamp, check every event
+    for (i = 0; i < g_events_history.len; i++) {
+        se = g_events_history.events[(g_events_history.head + i) % EVENTSLIMIT];
 
-        if (check_since_time(since, c_event) != 0) {
+        if (timestamp_is_set(since) && util_types_timestamp_cmp(&se->event->timestamp, since) < 0) {
             continue;
         }
 
-        if (check_util_time(until, c_event) != 0) {
-            break;
-        }
-
-        if (regflag) {
-            regfree(&preg);
+        if (timestamp_is_set(until) && util_types_timestamp_cmp(&se->event->timestamp, until) > 0) {
+            continue;
         }
-        regflag = get_idreg(&preg, c_event->id);
 
-        if (name != NULL && regflag) {
-            if (regexec(&preg, name, 0, NULL, 0)) {
-                continue;
-            }
+        if (name != NULL && (se->event->id == NULL || strcmp(se->event->id, name) != 0)) {
+            continue;
         }
 
-        ret = do_write_events(stream, c_event);
-        if (ret != 0) {
-            break;
-        }
+        shared_event_ref(se);
+        matched[matched_len++] = se;
     }
 
-    if (pthread_mutex_unlock(&g_events_buffer.event_mutex)) {
+    if (pthread_mutex_unlock(&g_events_history.mutex)) {
         WARN("Failed to unlock");
     }
-    if (regflag) {
-        regfree(&preg);
+
+    // do not block new events while writing to a slow client
+    for (i = 0; i < matched_len; i++) {
+        if (ret == 0) {
+            ret = do_write_events(stream, matched[i]->event);
+        }
+        shared_event_unref(matched[i]);
     }
 
     return ret;
@@ -672,8 +641,7 @@ int events_subscribe(const char *name, const types_timestamp_t *since, const typ
         return 0;
     }
 
-    if (since != NULL && (since->has_seconds || since->has_nanos) && until != NULL &&
-        (until->has_seconds || until->has_nanos)) {
+    if (timestamp_is_set(since) && timestamp_is_set(until)) {
         if (util_types_timestamp_cmp(since, until) > 0) {
             ERROR("'since' time cannot be after 'until' time");
             return -1;
@@ -683,134 +651,75 @@ int events_subscribe(const char *name, const types_timestamp_t *since, const typ
     return do_subscribe(name, since, until, stream);
 }
 
-/* events forward */
-static void events_forward(struct isulad_events_format *r)
+// queue event for client, it never blocks on the client
+static void queue_event_to_client(struct context_elem *context_info, shared_event *se)
 {
-    struct linked_list *it = NULL;
-    struct linked_list *next = NULL;
-    struct context_elem *context_info = NULL;
-    char *name = NULL;
-    regex_t preg;
-    bool regflag = false;
-
-    events_append(r);
-    regflag = get_idreg(&preg, r->id);
+    if (context_info->since != NULL) {
+        if (util_types_timestamp_cmp(&se->event->timestamp, context_info->since) < 0) {
+            return;
+        }
+    }
 
-    if (pthread_mutex_lock(&g_context_lists.context_mutex)) {
+    if (pthread_mutex_lock(&context_info->mutex)) {
         WARN("Failed to lock");
         return;
     }
 
-    linked_list_for_each_safe(it, &g_context_lists.context_list, next) {
-        context_info = (struct context_elem *)it->elem;
-        name = context_info->name;
-
-        if (context_info->since != NULL) {
-            if (util_types_timestamp_cmp(&r->timestamp, context_info->since) < 0) {
-                continue;
-            }
+    // do not leave a gap in the stream, drop all events after the first dropped one
+    if (context_info->overflowed || context_info->len == CLIENT_EVENTS_LIMIT) {
+        if (!context_info->overflowed) {
+            WARN("Events client is too slow, drop events and close it");
+            context_info->overflowed = true;
+            (void)pthread_cond_signal(&context_info->cond);
         }
-
-        if (name != NULL && regflag) {
-            if (regexec(&preg, name, 0, NULL, 0)) {
-                continue;
-            }
-        }
-
-        if (context_info->stream.write_func == NULL || context_info->stream.writer == NULL) {
-            INFO("Unimplemented write function");
-            goto delete_and_continue;
-        }
-        if (!context_info->stream.write_func(context_info->stream.writer, r)) {
-            INFO("Failed to send exit event for 'events' client");
-            goto delete_and_continue;
-        }
-
-        continue;
-
-delete_and_continue:
-        linked_list_del(it);
-        sem_post(&context_info->context_sem);
-        continue;
+        context_info->dropped++;
+        goto unlock;
     }
 
-    if (pthread_mutex_unlock(&g_context_lists.context_mutex)) {
-        WARN("Failed to unlock");
-    }
+    shared_event_ref(se);
+    context_info->queue[(context_info->head + context_info->len) % CLIENT_EVENTS_LIMIT] = se;
+    context_info->len++;
+    (void)pthread_cond_signal(&context_info->cond);
 
-    if (regflag) {
-        regfree(&preg);
+unlock:
+    if (pthread_mutex_unlock(&context_info->mutex)) {
+        WARN("Failed to unlock");
     }
 }
 
-/* event should exit */
-static void *event_should_exit(void *arg)
+static void queue_event_to_list(struct linked_list *list, shared_event *se)
 {
-    int res = 0;
-    int err = 0;
-
-    res = pthread_detach(pthread_self());
-    if (res != 0) {
-        CRIT("Set thread detach fail");
-        goto error;
-    }
-
-    prctl(PR_SET_NAME, "Clients_checker");
-
     struct linked_list *it = NULL;
     struct linked_list *next = NULL;
-    struct context_elem *context_info = NULL;
-    struct timespec ts_now = { 0 };
-    types_timestamp_t t_now = { 0 };
-
-    for (;;) {
-        if (pthread_mutex_lock(&g_context_lists.context_mutex)) {
-            WARN("Failed to lock");
-            continue;
-        }
 
-        linked_list_for_each_safe(it, &g_context_lists.context_list, next) {
-            context_info = (struct context_elem *)it->elem;
-
-            if (context_info->stream.is_cancelled(context_info->stream.context)) {
-                DEBUG("Client has exited, stop sending events");
-                linked_list_del(it);
-                sem_post(&context_info->context_sem);
-                continue;
-            }
-
-            if (context_info->until == NULL ||
-                (context_info->until->has_seconds == 0 && context_info->until->has_nanos == 0)) {
-                continue;
-            }
+    linked_list_for_each_safe(it, list, next) {
+        queue_event_to_client((struct context_elem *)it->elem, se);
+    }
+}
 
-            err = clock_gettime(CLOCK_REALTIME, &ts_now);
-            if (err != 0) {
-                ERROR("Failed to get time");
-                continue;
-            }
+/* events forward */
+static void events_forward(shared_event *se)
+{
+    struct linked_list *subscribed = NULL;
 
-            t_now.has_seconds = true;
-            t_now.seconds = ts_now.tv_sec;
-            t_now.has_nanos = true;
-            t_now.nanos = (int32_t)ts_now.tv_nsec;
+    events_append(se);
 
-            if (util_types_timestamp_cmp(&t_now, context_info->until) > 0) {
-                INFO("Finish response for RPC, client should exit");
-                linked_list_del(it);
-                sem_post(&context_info->context_sem);
-                continue;
-            }
-        }
+    if (pthread_mutex_lock(&g_subscribers.mutex)) {
+        WARN("Failed to lock");
+        return;
+    }
 
-        if (pthread_mutex_unlock(&g_context_lists.context_mutex)) {
-            WARN("Failed to unlock");
+    if (se->event->id != NULL) {
+        subscribed = map_search(g_subscribers.by_name, (void *)se->event->id);
+        if (subscribed != NULL) {
+            queue_event_to_list(subscribed, se);
         }
+    }
+    queue_event_to_list(&g_subscribers.all, se);
 
-        sleep(1);
+    if (pthread_mutex_unlock(&g_subscribers.mutex)) {
+        WARN("Failed to unlock");
     }
-error:
-    return NULL;
 }
 
 /* post event to events hander */
@@ -841,6 +750,7 @@ out:
 void events_handler(struct monitord_msg *msg)
 {
     struct isulad_events_format *events = NULL;
+    shared_event *se = NULL;
 
     if (msg == NULL) {
         ERROR("Invalid input arguments");
@@ -864,16 +774,197 @@ void events_handler(struct monitord_msg *msg)
         goto out;
     }
 
+    se = shared_event_new(events);
+    if (se == NULL) {
+        goto out;
+    }
+    events = NULL;
+
     /* forward events to grpc clients */
-    events_forward(events);
+    events_forward(se);
 
     /* log event into isulad.log */
-    (void)write_events_log(events);
+    (void)write_events_log(se->event);
 
 out:
+    shared_event_unref(se);
     isulad_events_format_free(events);
 }
 
+static bool client_should_exit(const struct context_elem *context_info)
+{
+    struct timespec ts_now = { 0 };
+    types_timestamp_t t_now = { 0 };
+
+    if (context_info->stream.is_cancelled(context_info->stream.context)) {
+        DEBUG("Client has exited, stop sending events");
+        return true;
+    }
+
+    if (!timestamp_is_set(context_info->until)) {
+        return false;
+    }
+
+    if (clock_gettime(CLOCK_REALTIME, &ts_now) != 0) {
+        ERROR("Failed to get time");
+        return false;
+    }
+
+    t_now.has_seconds = true;
+    t_now.seconds = ts_now.tv_sec;
+    t_now.has_nanos = true;
+    t_now.nanos = (int32_t)ts_now.tv_nsec;
+
+    if (util_types_timestamp_cmp(&t_now, context_info->until) > 0) {
+        INFO("Finish response for RPC, client should exit");
+        return true;
+    }
+
+    return false;
+}
+
+// wait for next event of client, return NULL if no event arrived in one second or the queue overflowed
+static shared_event *pop_client_event(struct context_elem *context_info, bool *overflowed)
+{
+    shared_event *se = NULL;
+    struct timespec deadline = { 0 };
+
+    if (pthread_mutex_lock(&context_info->mutex)) {
+        WARN("Failed to lock");
+        return NULL;
+    }
+
+    if (context_info->len == 0 && !context_info->overflowed && clock_gettime(CLOCK_REALTIME, &deadline) == 0) {
+        deadline.tv_sec += 1;
+        (void)pthread_cond_timedwait(&context_info->cond, &context_info->mutex, &deadline);
+    }
+
+    if (context_info->len > 0) {
+        se = context_info->queue[context_info->head];
+        context_info->queue[context_info->head] = NULL;
+        context_info->head = (context_info->head + 1) % CLIENT_EVENTS_LIMIT;
+        context_info->len--;
+    }
+    *overflowed = context_info->overflowed;
+
+    if (pthread_mutex_unlock(&context_info->mutex)) {
+        WARN("Failed to unlock");
+    }
+
+    return se;
+}
+
+/* send events to client until it exits, run in the thread of client */
+static int serve_monitor_client(struct context_elem *context_info)
+{
+    shared_event *se = NULL;
+    bool overflowed = false;
+    bool ok = false;
+
+    for (;;) {
+        se = pop_client_event(context_info, &overflowed);
+        if (se == NULL && overflowed) {
+            // events queued before the overflow are sent, tell the client it missed the later ones
+            ERROR("Events client is too slow, close it");
+            isulad_set_error_message("Too many events are waiting to be received, events are dropped");
+            return -1;
+        }
+        if (se == NULL) {
+            if (client_should_exit(context_info)) {
+                return 0;
+            }
+            continue;
+        }
+
+        if (timestamp_is_set(context_info->until) &&
+            util_types_timestamp_cmp(&se->event->timestamp, context_info->until) > 0) {
+            INFO("Finish response for RPC, client should exit");
+            shared_event_unref(se);
+            return 0;
+        }
+
+        ok = do_write_events(&context_info->stream, se->event) == 0;
+        shared_event_unref(se);
+        if (!ok) {
+            INFO("Failed to send event for 'events' client");
+            return 0;
+        }
+    }
+}
+
+static int register_monitor_client(struct context_elem *context_info, struct linked_list *node)
+{
+    int ret = 0;
+    struct linked_list *subscribed = &g_subscribers.all;
+
+    if (pthread_mutex_lock(&g_subscribers.mutex)) {
+        ERROR("Failed to lock");
+        return -1;
+    }
+
+    if (context_info->name != NULL) {
+        subscribed = map_search(g_subscribers.by_name, (void *)context_info->name);
+    }
+
+    if (subscribed == NULL) {
+        subscribed = util_common_calloc_s(sizeof(struct linked_list));
+        if (subscribed == NULL) {
+            ERROR("Out of memory");
+            ret = -1;
+            goto unlock;
+        }
+        linked_list_init(subscribed);
+        if (!map_insert(g_subscribers.by_name, (void *)context_info->name, subscribed)) {
+            ERROR("Failed to index events client of %s", context_info->name);
+            free(subscribed);
+            ret = -1;
+            goto unlock;
+        }
+    }
+
+    linked_list_add_elem(node, context_info);
+    linked_list_add_tail(subscribed, node);
+
+unlock:
+    if (pthread_mutex_unlock(&g_subscribers.mutex)) {
+        WARN("Failed to unlock");
+    }
+    return ret;
+}
+
+static void unregister_monitor_client(struct context_elem *context_info, struct linked_list *node)
+{
+    struct linked_list *subscribed = NULL;
+
+    if (pthread_mutex_lock(&g_subscribers.mutex)) {
+        ERROR("Failed to lock");
+        return;
+    }
+
+    linked_list_del(node);
+    if (context_info->name != NULL) {
+        subscribed = map_search(g_subscribers.by_name, (void *)context_info->name);
+        if (subscribed != NULL && linked_list_empty(subscribed)) {
+            (void)map_remove(g_subscribers.by_name, (void *)context_info->name);
+        }
+    }
+
+    if (pthread_mutex_unlock(&g_subscribers.mutex)) {
+        WARN("Failed to unlock");
+    }
+
+    // no more events will be queued after unregistered
+    while (context_info->len > 0) {
+        shared_event_unref(context_info->queue[context_info->head]);
+        context_info->head = (context_info->head + 1) % CLIENT_EVENTS_LIMIT;
+        context_info->len--;
+    }
+
+    if (context_info->dropped > 0) {
+        WARN("Dropped %zu events for slow 'events' client", context_info->dropped);
+    }
+}
+
 /* add monitor client */
 int add_monitor_client(char *name, const types_timestamp_t *since, const types_timestamp_t *until,
                        const stream_func_wrapper *stream)
@@ -900,12 +991,18 @@ int add_monitor_client(char *name, const types_timestamp_t *since, const types_t
         goto free_out;
     }
 
-    if (sem_init(&context_info->context_sem, 0, 0)) {
-        ERROR("Semaphore initialization failed");
+    if (pthread_mutex_init(&context_info->mutex, NULL) != 0) {
+        ERROR("Mutex initialization failed");
         ret = -1;
         goto free_out;
     }
 
+    if (pthread_cond_init(&context_info->cond, NULL) != 0) {
+        ERROR("Condition initialization failed");
+        ret = -1;
+        goto mutex_free;
+    }
+
     context_info->name = name;
     context_info->since = since;
     context_info->until = until;
@@ -914,26 +1011,19 @@ int add_monitor_client(char *name, const types_timestamp_t *since, const types_t
     context_info->stream.write_func = stream->write_func;
     context_info->stream.writer = stream->writer;
 
-    if (pthread_mutex_lock(&g_context_lists.context_mutex)) {
-        ERROR("Failed to lock");
+    if (register_monitor_client(context_info, newnode) != 0) {
         ret = -1;
-        goto sem_free;
+        goto cond_free;
     }
 
-    linked_list_add_elem(newnode, context_info);
-    linked_list_add_tail(&g_context_lists.context_list, newnode);
+    ret = serve_monitor_client(context_info);
 
-    if (pthread_mutex_unlock(&g_context_lists.context_mutex)) {
-        WARN("Failed to unlock");
-        ret = -1;
-        goto sem_free;
-    }
-
-    sem_wait(&context_info->context_sem);
-
-sem_free:
-    sem_destroy(&context_info->context_sem);
+    unregister_monitor_client(context_info, newnode);
 
+cond_free:
+    pthread_cond_destroy(&context_info->cond);
+mutex_free:
+    pthread_mutex_destroy(&context_info->mutex);
 free_out:
     free(context_info);
     free(newnode);
@@ -944,35 +1034,37 @@ free_out:
 static int newcollector()
 {
     int ret = -1;
-    pthread_t exit_thread;
 
-    linked_list_init(&(g_context_lists.context_list));
-    linked_list_init(&(g_events_buffer.event_list));
-    g_events_buffer.size = 0;
+    linked_list_init(&(g_subscribers.all));
+    g_events_history.head = 0;
+    g_events_history.len = 0;
 
-    ret = pthread_mutex_init(&(g_context_lists.context_mutex), NULL);
-    if (ret != 0) {
-        CRIT("Mutex initialization failed");
+    g_subscribers.by_name = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (g_subscribers.by_name == NULL) {
+        CRIT("Out of memory");
         goto out;
     }
 
-    ret = pthread_mutex_init(&(g_events_buffer.event_mutex), NULL);
+    ret = pthread_mutex_init(&(g_subscribers.mutex), NULL);
     if (ret != 0) {
         CRIT("Mutex initialization failed");
-        pthread_mutex_destroy(&(g_context_lists.context_mutex));
-        goto out;
+        goto free_map;
     }
 
-    INFO("Starting collector...");
-    ret = pthread_create(&exit_thread, NULL, event_should_exit, NULL);
+    ret = pthread_mutex_init(&(g_events_history.mutex), NULL);
     if (ret != 0) {
-        CRIT("Thread creation failed");
-        pthread_mutex_destroy(&(g_context_lists.context_mutex));
-        pthread_mutex_destroy(&(g_events_buffer.event_mutex));
-        goto out;
+        CRIT("Mutex initialization failed");
+        pthread_mutex_destroy(&(g_subscribers.mutex));
+        goto free_map;
     }
 
+    INFO("Starting collector...");
     ret = 0;
+    goto out;
+
+free_map:
+    map_free(g_subscribers.by_name);
+    g_subscribers.by_name = NULL;
 out:
     return ret;
 }
@@ -1014,7 +1106,7 @@ out:
 int events_module_init()
 {
     if (newcollector()) {
-        ERROR("Create collector thread failed");
+        ERROR("Create collector failed");
         return -1;
     }
 
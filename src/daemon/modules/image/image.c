@@ -67,6 +67,9 @@ struct bim_ops {
     /* get count of images */
     size_t (*get_image_count)(void);
 
+    /* get hit and miss count of the image info cache */
+    void (*get_image_cache_stats)(uint64_t *hits, uint64_t *misses);
+
     /* remove image */
     int (*rm_image)(const im_rmi_request *request);
 
@@ -148,6 +151,7 @@ static const struct bim_ops g_embedded_ops = {
 
     .list_ims = embedded_list_images,
     .get_image_count = NULL,
+    .get_image_cache_stats = NULL,
     .rm_image = embedded_remove_image,
     .inspect_image = embedded_inspect_image,
     .resolve_image_name = embedded_resolve_image_name,
@@ -187,6 +191,7 @@ static const struct bim_ops g_oci_ops = {
 
     .list_ims = oci_list_images,
     .get_image_count = oci_get_images_count,
+    .get_image_cache_stats = oci_get_image_cache_stats,
     .rm_image = oci_rmi,
     .inspect_image = oci_inspect_image,
     .resolve_image_name = oci_resolve_image_name,
@@ -225,6 +230,7 @@ static const struct bim_ops g_ext_ops = {
 
     .list_ims = ext_list_images,
     .get_image_count = NULL,
+    .get_image_cache_stats = NULL,
     .rm_image = ext_remove_image,
     .inspect_image = ext_inspect_image,
     .resolve_image_name = ext_resolve_image_name,
@@ -1762,6 +1768,27 @@ out:
     return ret;
 }
 
+int im_get_image_cache_stats(const char *image_type, uint64_t *hits, uint64_t *misses)
+{
+    const struct bim_type *q = NULL;
+
+    if (image_type == NULL || hits == NULL || misses == NULL) {
+        ERROR("Invalid input arguments");
+        return -1;
+    }
+
+    q = get_bim_by_type(image_type);
+    if (q == NULL || q->ops->get_image_cache_stats == NULL) {
+        return -1;
+    }
+
+    *hits = 0;
+    *misses = 0;
+    q->ops->get_image_cache_stats(hits, misses);
+
+    return 0;
+}
+
 void free_im_image_count_request(im_image_count_request *ptr)
 {
     if (ptr == NULL) {
@@ -401,6 +401,11 @@ size_t oci_get_images_count(void)
     return storage_get_img_count();
 }
 
+void oci_get_image_cache_stats(uint64_t *hits, uint64_t *misses)
+{
+    storage_get_img_cache_stats(hits, misses);
+}
+
 int oci_summary_image(im_summary_request *request, im_summary_response *response)
 {
     int ret = 0;
@@ -558,7 +563,7 @@ int oci_image_conf_merge_into_spec(const char *image_name, container_config *con
 {
     int ret = 0;
     char *resolved_name = NULL;
-    imagetool_image *image_info = NULL;
+    image_info_ref *image_info = NULL;
 
     if (container_spec == NULL || image_name == NULL) {
         ERROR("invalid NULL param");
@@ -572,14 +577,14 @@ int oci_image_conf_merge_into_spec(const char *image_name, container_config *con
         goto out;
     }
 
-    image_info = storage_img_get(resolved_name);
+    image_info = storage_img_get_ref(resolved_name);
     if (image_info == NULL) {
         ERROR("Get image from image store failed, image name is %s", resolved_name);
         ret = -1;
         goto out;
     }
 
-    ret = oci_image_merge_config(image_info, container_spec);
+    ret = oci_image_merge_config(image_info->info, container_spec);
     if (ret != 0) {
         ERROR("Failed to merge oci config for image %s", resolved_name);
         ret = -1;
@@ -588,6 +593,6 @@ int oci_image_conf_merge_into_spec(const char *image_name, container_config *con
 
 out:
     free(resolved_name);
-    free_imagetool_image(image_info);
+    storage_img_put_ref(image_info);
     return ret;
 }
@@ -43,6 +43,9 @@ int oci_image_conf_merge_into_spec(const char *image_name, container_config *con
 int oci_summary_image(im_summary_request *request, im_summary_response *response);
 
 size_t oci_get_images_count(void);
+
+void oci_get_image_cache_stats(uint64_t *hits, uint64_t *misses);
+
 #ifdef __cplusplus
 }
 #endif
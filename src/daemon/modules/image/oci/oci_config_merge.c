@@ -319,7 +319,7 @@ out:
     return ret;
 }
 
-static void oci_image_merge_image_ref(imagetool_image *image_conf, container_config *container_spec)
+static void oci_image_merge_image_ref(const imagetool_image *image_conf, container_config *container_spec)
 {
     if (image_conf->repo_digests_len > 0) {
         container_spec->image_ref = util_strdup_s(image_conf->repo_digests[0]);
@@ -328,7 +328,7 @@ static void oci_image_merge_image_ref(imagetool_image *image_conf, container_con
     }
 }
 
-static int oci_image_merge_port_mappings(oci_image_spec_config *img_spec, container_config *container_spec)
+static int oci_image_merge_port_mappings(const oci_image_spec_config *img_spec, container_config *container_spec)
 {
     defs_map_string_object *work = NULL;
     size_t new_len, i;
@@ -341,10 +341,10 @@ static int oci_image_merge_port_mappings(oci_image_spec_config *img_spec, contai
         return 0;
     }
 
+    // image_conf may be shared by other readers, copy the ports instead of moving them
     if (container_spec->exposed_ports == NULL) {
-        container_spec->exposed_ports = img_spec->exposed_ports;
-        img_spec->exposed_ports = NULL;
-        return 0;
+        container_spec->exposed_ports = dup_map_string_empty_object(img_spec->exposed_ports);
+        return container_spec->exposed_ports != NULL ? 0 : -1;
     }
 
     port_table = map_new(MAP_STR_BOOL, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
@@ -408,10 +408,8 @@ static int oci_image_merge_port_mappings(oci_image_spec_config *img_spec, contai
             ret = -1;
             goto out;
         }
-        work->keys[work->len] = img_spec->exposed_ports->keys[i];
-        img_spec->exposed_ports->keys[i] = NULL;
-        work->values[work->len] = img_spec->exposed_ports->values[i];
-        img_spec->exposed_ports->values[i] = NULL;
+        work->keys[work->len] = util_strdup_s(img_spec->exposed_ports->keys[i]);
+        work->values[work->len] = NULL;
         work->len += 1;
     }
 
@@ -425,7 +423,7 @@ out:
     return ret;
 }
 
-int oci_image_merge_config(imagetool_image *image_conf, container_config *container_spec)
+int oci_image_merge_config(const imagetool_image *image_conf, container_config *container_spec)
 {
     int ret = 0;
 
@@ -24,7 +24,8 @@
 extern "C" {
 #endif
 
-int oci_image_merge_config(imagetool_image *image_conf, container_config *container_spec);
+// image_conf is only read, so a shared cached image info can be merged from
+int oci_image_merge_config(const imagetool_image *image_conf, container_config *container_spec);
 
 #ifdef __cplusplus
 }
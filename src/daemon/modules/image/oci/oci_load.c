@@ -41,10 +41,20 @@
 #include "utils_file.h"
 #include "utils_verify.h"
 #include "oci_image.h"
+#include "map.h"
+#include "path.h"
 
 #define MANIFEST_BIG_DATA_KEY "manifest"
 #define OCI_SCHEMA_VERSION 2
 
+#define LOAD_MANIFEST_NAME "manifest.json"
+// manifest and image configs are json files not larger than this, so are json members kept by the first walk in total
+#define LOAD_METADATA_MAX_SIZE (64 * 1024 * 1024)
+#define LOAD_METADATA_SUFFIX ".json"
+// max levels of links followed when resolve a member of archive
+#define LOAD_MEMBER_MAX_LINKS 16
+#define LOAD_COPY_BUFFER_SIZE (1024 * 1024)
+
 static image_manifest_items_element **load_manifest(const char *fname, size_t *length)
 {
     image_manifest_items_container *tmp_items = NULL;
@@ -89,50 +99,441 @@ static oci_image_spec *load_image_config(const char *fname)
     return config;
 }
 
-static ssize_t load_image_archive_io_read(void *context, void *buf, size_t buf_len)
+typedef struct {
+    // file the member is extracted to
+    char *fpath;
+    // calculated while layers are extracted
+    char *diff_id;
+    char *compressed_digest;
+    // the walk of archive which extracts the member
+    size_t walk;
+    bool extracted;
+} load_member_t;
+
+typedef struct {
+    int fd;
+    const char *dstdir;
+    // member name -> name of member it links to, recorded by the first walk
+    map_t *links;
+    // member name -> load_member_t of manifest and image configs
+    map_t *metadata;
+    // member name -> load_member_t of layers not exist in storage
+    map_t *layers;
+    // number of walks done, members wanted since the last walk are extracted by the next one
+    size_t walks;
+    bool wanted;
+    // number of files extracted, used to name them
+    size_t files;
+    // size of json members kept by the first walk before they are wanted
+    size_t kept_size;
+    char *buf;
+} load_archive_t;
+
+static void load_member_kvfree(void *key, void *value)
 {
-    int *read_fd = (int *)context;
+    load_member_t *m = (load_member_t *)value;
 
-    return util_read_nointr(*read_fd, buf, buf_len);
+    free(key);
+    if (m == NULL) {
+        return;
+    }
+    free(m->fpath);
+    free(m->diff_id);
+    free(m->compressed_digest);
+    free(m);
 }
 
-static int load_image_archive_io_close(void *context, char **err)
+static int load_archive_init(load_archive_t *archive, const char *file, const char *dstdir)
 {
-    int *read_fd = (int *)context;
+    archive->dstdir = dstdir;
+    archive->fd = util_open(file, O_RDONLY, 0);
+    if (archive->fd < 0) {
+        SYSERROR("Failed to open image archive %s", file);
+        return -1;
+    }
+
+    archive->links = map_new(MAP_STR_STR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    archive->metadata = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, load_member_kvfree);
+    archive->layers = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, load_member_kvfree);
+    archive->buf = util_common_calloc_s(LOAD_COPY_BUFFER_SIZE);
+    if (archive->links == NULL || archive->metadata == NULL || archive->layers == NULL || archive->buf == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
 
-    close(*read_fd);
-    free(read_fd);
     return 0;
 }
 
-static int file_read_wrapper(const char *image_data_path, struct io_read_wrapper *reader)
+static void load_archive_fini(load_archive_t *archive)
+{
+    if (archive->fd >= 0) {
+        close(archive->fd);
+        archive->fd = -1;
+    }
+    map_free(archive->links);
+    archive->links = NULL;
+    map_free(archive->metadata);
+    archive->metadata = NULL;
+    map_free(archive->layers);
+    archive->layers = NULL;
+    free(archive->buf);
+    archive->buf = NULL;
+}
+
+// clean member name, it is relative to dir, or to the root of archive if dir is NULL or name is absolute
+static char *load_member_name(const char *dir, const char *name)
+{
+    char path[PATH_MAX] = { 0 };
+    char cleaned[PATH_MAX] = { 0 };
+    int nret = 0;
+
+    if (dir == NULL || name[0] == '/') {
+        nret = snprintf(path, sizeof(path), "/%s", name);
+    } else {
+        nret = snprintf(path, sizeof(path), "/%s/%s", dir, name);
+    }
+    if (nret < 0 || (size_t)nret >= sizeof(path)) {
+        ERROR("Member name %s is too long", name);
+        return NULL;
+    }
+
+    if (util_clean_path(path, cleaned, sizeof(cleaned)) == NULL) {
+        ERROR("Failed to clean member name %s", name);
+        return NULL;
+    }
+
+    return util_strdup_s(cleaned + 1);
+}
+
+static char *load_resolve_member(const load_archive_t *archive, const char *name)
+{
+    char *resolved = NULL;
+    const char *target = NULL;
+    int i;
+
+    resolved = load_member_name(NULL, name);
+    for (i = 0; resolved != NULL && i < LOAD_MEMBER_MAX_LINKS; i++) {
+        target = map_search(archive->links, (void *)resolved);
+        if (target == NULL) {
+            return resolved;
+        }
+        free(resolved);
+        resolved = util_strdup_s(target);
+    }
+
+    if (resolved != NULL) {
+        ERROR("Too many levels of links when resolve member %s", name);
+        free(resolved);
+    }
+    return NULL;
+}
+
+static int load_record_link(load_archive_t *archive, const char *name, const struct archive_member *member)
+{
+    char *dir = NULL;
+    char *slash = NULL;
+    char *target = NULL;
+    int ret = 0;
+
+    // hard links are relative to the root of archive, and symbolic links to the directory of themselves
+    if (!member->hardlink) {
+        dir = util_strdup_s(name);
+        slash = strrchr(dir, '/');
+        if (slash != NULL) {
+            *slash = '\0';
+        } else {
+            dir[0] = '\0';
+        }
+    }
+
+    target = load_member_name(dir, member->linkname);
+    if (target == NULL) {
+        ret = -1;
+        goto out;
+    }
+
+    if (!map_replace(archive->links, (void *)name, (void *)target)) {
+        ERROR("Failed to record link %s of archive", name);
+        ret = -1;
+    }
+
+out:
+    free(dir);
+    free(target);
+    return ret;
+}
+
+static char *load_new_file(load_archive_t *archive)
+{
+    char fname[PATH_MAX] = { 0 };
+    int nret = 0;
+
+    nret = snprintf(fname, sizeof(fname), "%s/%zu", archive->dstdir, archive->files++);
+    if (nret < 0 || (size_t)nret >= sizeof(fname)) {
+        ERROR("Path is too long");
+        return NULL;
+    }
+
+    return util_strdup_s(fname);
+}
+
+// save the member to fpath, and update the digests with the data if they are not NULL
+static int load_save_member(const struct io_read_wrapper *data, char *buf, const char *fpath, sha256_stream *digest,
+                            sha256_stream *diff_id)
+{
+    size_t len = 0;
+    ssize_t nread = 0;
+    int ret = -1;
+    int fd = -1;
+
+    fd = util_open(fpath, O_WRONLY | O_CREAT | O_TRUNC, DEFAULT_SECURE_FILE_MODE);
+    if (fd < 0) {
+        SYSERROR("Failed to create file %s", fpath);
+        return -1;
+    }
+
+    for (;;) {
+        nread = data->read(data->context, buf, LOAD_COPY_BUFFER_SIZE);
+        if (nread < 0) {
+            goto out;
+        }
+        if (nread == 0) {
+            break;
+        }
+        len = (size_t)nread;
+
+        if (util_write_nointr_in_total(fd, buf, len) != (ssize_t)len) {
+            SYSERROR("Failed to write file %s", fpath);
+            goto out;
+        }
+        if ((digest != NULL && sha256_stream_update(digest, buf, len) != 0) ||
+            (diff_id != NULL && sha256_stream_update(diff_id, buf, len) != 0)) {
+            ERROR("Failed to calc digest of %s", fpath);
+            goto out;
+        }
+    }
+
+    ret = 0;
+
+out:
+    close(fd);
+    return ret;
+}
+
+static load_member_t *load_new_member(load_archive_t *archive, map_t *members, const char *name)
+{
+    load_member_t *m = NULL;
+
+    m = util_common_calloc_s(sizeof(load_member_t));
+    if (m == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    m->walk = archive->walks;
+    m->fpath = load_new_file(archive);
+    if (m->fpath == NULL || !map_insert(members, (void *)name, (void *)m)) {
+        ERROR("Failed to record member %s of archive", name);
+        load_member_kvfree(NULL, m);
+        return NULL;
+    }
+
+    return m;
+}
+
+// image configs are json files in archive, they are kept by the first walk while manifest.json is not read yet,
+// so that no more walk is needed for them. It is bounded by LOAD_METADATA_MAX_SIZE in total.
+static load_member_t *load_keep_json_member(load_archive_t *archive, const char *name,
+                                            const struct archive_member *member)
+{
+    load_member_t *m = NULL;
+
+    if (archive->walks != 0 || !util_has_suffix(name, LOAD_METADATA_SUFFIX) || member->size < 0 ||
+        (uint64_t)member->size > LOAD_METADATA_MAX_SIZE - archive->kept_size) {
+        return NULL;
+    }
+
+    m = load_new_member(archive, archive->metadata, name);
+    if (m != NULL) {
+        archive->kept_size += (size_t)member->size;
+    }
+    return m;
+}
+
+// extract the members wanted, the first walk records links of archive and keeps small json members meanwhile
+static int load_extract_member(const struct archive_member *member, const struct io_read_wrapper *data,
+                               void *context)
 {
+    load_archive_t *archive = (load_archive_t *)context;
+    load_member_t *m = NULL;
+    sha256_stream *digest = NULL;
+    sha256_stream *diff_id = NULL;
+    bool is_layer = false;
+    char *name = NULL;
     int ret = 0;
-    int *fd_ptr = NULL;
 
-    fd_ptr = util_common_calloc_s(sizeof(int));
-    if (fd_ptr == NULL) {
-        ERROR("Memory out");
+    name = load_member_name(NULL, member->name);
+    if (name == NULL) {
         return -1;
     }
 
-    *fd_ptr = util_open(image_data_path, O_RDONLY, 0);
-    if (*fd_ptr == -1) {
-        ERROR("Failed to open layer data %s", image_data_path);
+    if (member->linkname != NULL) {
+        if (archive->walks == 0) {
+            ret = load_record_link(archive, name, member);
+        }
+        goto out;
+    }
+
+    if (!member->regular) {
+        goto out;
+    }
+
+    m = map_search(archive->layers, (void *)name);
+    is_layer = (m != NULL);
+    if (m == NULL) {
+        m = map_search(archive->metadata, (void *)name);
+    }
+    if (m == NULL) {
+        m = load_keep_json_member(archive, name, member);
+    }
+    // members not wanted are skipped, so are the ones extracted by former walks
+    if (m == NULL || m->walk != archive->walks) {
+        goto out;
+    }
+
+    if (!is_layer && member->size > LOAD_METADATA_MAX_SIZE) {
+        ERROR("Member %s of archive is too large", name);
+        isulad_try_set_error_message("%s is too large", name);
         ret = -1;
         goto out;
     }
 
-    reader->context = fd_ptr;
-    fd_ptr = NULL;
-    reader->read = load_image_archive_io_read;
-    reader->close = load_image_archive_io_close;
+    if (is_layer) {
+        digest = sha256_stream_new(false);
+        diff_id = sha256_stream_new(true);
+        if (digest == NULL || diff_id == NULL) {
+            ERROR("Out of memory");
+            ret = -1;
+            goto out;
+        }
+    }
+
+    // the later one wins if the member appears more than once, as with extracting the whole archive
+    ret = load_save_member(data, archive->buf, m->fpath, digest, diff_id);
+    if (ret != 0) {
+        ERROR("Failed to extract member %s of archive", name);
+        goto out;
+    }
+    m->extracted = true;
+
+    if (is_layer) {
+        free(m->compressed_digest);
+        m->compressed_digest = sha256_stream_full_digest(digest);
+        free(m->diff_id);
+        m->diff_id = sha256_stream_full_digest(diff_id);
+        if (m->compressed_digest == NULL || m->diff_id == NULL) {
+            ERROR("Calc layer %s digest failed", name);
+            ret = -1;
+        }
+    }
 
 out:
-    free(fd_ptr);
+    sha256_stream_free(digest);
+    sha256_stream_free(diff_id);
+    free(name);
+    return ret;
+}
+
+// walk the archive if any member is wanted since the last walk, or links are not recorded yet
+static int load_extract_wanted(load_archive_t *archive)
+{
+    if (archive->walks > 0 && !archive->wanted) {
+        return 0;
+    }
+
+    if (archive_foreach_member(archive->fd, load_extract_member, archive) != 0) {
+        return -1;
+    }
+
+    archive->walks++;
+    archive->wanted = false;
+    return 0;
+}
+
+// mark member to be extracted by the next walk, name is resolved already
+static load_member_t *load_want_member(load_archive_t *archive, map_t *members, const char *name)
+{
+    load_member_t *m = NULL;
+
+    m = map_search(members, (void *)name);
+    if (m != NULL) {
+        return m;
+    }
+
+    m = load_new_member(archive, members, name);
+    if (m != NULL) {
+        archive->wanted = true;
+    }
+    return m;
+}
+
+static int load_want_metadata(load_archive_t *archive, const char *member)
+{
+    char *name = NULL;
+    int ret = 0;
+
+    name = load_resolve_member(archive, member);
+    if (name == NULL || load_want_member(archive, archive->metadata, name) == NULL) {
+        ret = -1;
+    }
+
+    free(name);
     return ret;
 }
 
+// return file of the metadata member extracted
+static char *load_metadata_file(const load_archive_t *archive, const char *member)
+{
+    char *name = NULL;
+    const load_member_t *m = NULL;
+    char *fpath = NULL;
+
+    name = load_resolve_member(archive, member);
+    if (name == NULL) {
+        return NULL;
+    }
+
+    m = map_search(archive->metadata, (void *)name);
+    if (m == NULL || !m->extracted) {
+        ERROR("%s not found in archive", member);
+        isulad_try_set_error_message("%s no such file", member);
+    } else {
+        fpath = util_strdup_s(m->fpath);
+    }
+
+    free(name);
+    return fpath;
+}
+
+// mark the layer member to be extracted, and set the name and file of it to layer
+static int load_want_layer(load_archive_t *archive, const char *member, load_layer_blob_t *layer)
+{
+    load_member_t *m = NULL;
+
+    layer->member = load_resolve_member(archive, member);
+    if (layer->member == NULL) {
+        return -1;
+    }
+
+    m = load_want_member(archive, archive->layers, layer->member);
+    if (m == NULL) {
+        ERROR("Failed to record layer %s of archive", member);
+        return -1;
+    }
+
+    layer->fpath = util_strdup_s(m->fpath);
+    return 0;
+}
+
 static void oci_load_free_layer(load_layer_blob_t *l)
 {
     if (l == NULL) {
@@ -158,6 +559,9 @@ static void oci_load_free_layer(load_layer_blob_t *l)
         free(l->fpath);
         l->fpath = NULL;
     }
+
+    free(l->member);
+    l->member = NULL;
     free(l);
 }
 
@@ -631,55 +1035,53 @@ out:
     return ret;
 }
 
-static int check_and_set_digest_from_tarball(load_layer_blob_t *layer, const char *conf_diff_id)
+static int check_and_set_digest_from_archive(load_layer_blob_t *layer, const load_archive_t *archive)
 {
-    int ret = 0;
-    bool gzip = false;
+    load_member_t *m = NULL;
 
-    if (layer == NULL || conf_diff_id == NULL) {
+    if (layer == NULL || layer->member == NULL) {
         ERROR("Invalid input param");
         return -1;
     }
 
-    if (!util_file_exists(layer->fpath)) {
-        ERROR("Layer data file:%s is not exist", layer->fpath);
-        isulad_try_set_error_message("%s no such file", layer->fpath);
-        ret = -1;
-        goto out;
+    m = map_search(archive->layers, (void *)layer->member);
+    if (m == NULL || m->diff_id == NULL) {
+        ERROR("Layer data file:%s is not exist", layer->member);
+        isulad_try_set_error_message("%s no such file", layer->member);
+        return -1;
     }
 
-    layer->alread_exist = false;
-    layer->diff_id = oci_calc_diffid(layer->fpath);
-    if (layer->diff_id == NULL) {
-        ERROR("Calc layer:%s diff id failed", layer->fpath);
-        ret = -1;
-        goto out;
+    // diff id of layer is from image config
+    if (strcmp(m->diff_id, layer->diff_id) != 0) {
+        ERROR("invalid diff id for layer:%s: expected %s, got %s", layer->chain_id, layer->diff_id, m->diff_id);
+        return -1;
     }
 
-    if (util_gzip_compressed(layer->fpath, &gzip) != 0) {
-        ERROR("Judge layer file gzip attr err");
-        ret = -1;
-        goto out;
-    }
+    free(layer->compressed_digest);
+    layer->compressed_digest = util_strdup_s(m->compressed_digest);
 
-    layer->compressed_digest = gzip ? sha256_full_file_digest(layer->fpath) : util_strdup_s(layer->diff_id);
-    if (layer->compressed_digest == NULL) {
-        ERROR("Calc layer %s compressed digest failed", layer->fpath);
-        ret = -1;
-        goto out;
-    }
+    return 0;
+}
 
-    if (strcmp(layer->diff_id, conf_diff_id) != 0) {
-        ERROR("invalid diff id for layer:%s: expected %s, got %s", layer->chain_id, conf_diff_id, layer->diff_id);
-        ret = -1;
-        goto out;
+static int oci_load_check_layers(load_image_t *im, const load_archive_t *archive)
+{
+    size_t i;
+
+    for (i = 0; i < im->layers_len; i++) {
+        if (im->layers[i]->alread_exist) {
+            continue;
+        }
+        if (check_and_set_digest_from_archive(im->layers[i], archive) != 0) {
+            ERROR("Check layer digest failed");
+            return -1;
+        }
     }
 
-out:
-    return ret;
+    return 0;
 }
 
-static int oci_load_set_layers_info(load_image_t *im, const image_manifest_items_element *manifest, const char *dstdir)
+static int oci_load_set_layers_info(load_image_t *im, const image_manifest_items_element *manifest,
+                                    load_archive_t *archive)
 {
     int ret = 0;
     size_t i = 0;
@@ -688,7 +1090,7 @@ static int oci_load_set_layers_info(load_image_t *im, const image_manifest_items
     char *id = NULL;
     char *parent_chain_id = NULL;
 
-    if (im == NULL || manifest == NULL || dstdir == NULL) {
+    if (im == NULL || manifest == NULL || archive == NULL) {
         ERROR("Invalid input params image or manifest is null");
         return -1;
     }
@@ -723,12 +1125,6 @@ static int oci_load_set_layers_info(load_image_t *im, const image_manifest_items
             goto out;
         }
 
-        im->layers[i]->fpath = util_path_join(dstdir, manifest->layers[i]);
-        if (im->layers[i]->fpath == NULL) {
-            ERROR("Path join failed");
-            ret = -1;
-            goto out;
-        }
         // The format is sha256:xxx
         im->layers[i]->chain_id = oci_load_calc_chain_id(parent_chain_id_sha256, conf->rootfs->diff_ids[i]);
         if (im->layers[i]->chain_id == NULL) {
@@ -739,6 +1135,13 @@ static int oci_load_set_layers_info(load_image_t *im, const image_manifest_items
         }
         parent_chain_id_sha256 = im->layers[i]->chain_id;
 
+        im->layers[i]->diff_id = util_strdup_s(conf->rootfs->diff_ids[i]);
+        if (im->layers[i]->diff_id == NULL) {
+            ERROR("Dup layer diff id:%s from conf failed", conf->rootfs->diff_ids[i]);
+            ret = -1;
+            goto out;
+        }
+
         id = oci_load_without_sha256_prefix(im->layers[i]->chain_id);
         if (id == NULL) {
             ERROR("Wipe out sha256 prefix failed from layer with chain id : %s", im->layers[i]->chain_id);
@@ -755,19 +1158,15 @@ static int oci_load_set_layers_info(load_image_t *im, const image_manifest_items
                 goto out;
             }
 
-            im->layers[i]->diff_id = util_strdup_s(conf->rootfs->diff_ids[i]);
-            if (im->layers[i]->diff_id == NULL) {
-                ERROR("Dup layer diff id:%s from conf failed", conf->rootfs->diff_ids[i]);
-                ret = -1;
-                goto out;
-            }
             im->layers[i]->alread_exist = true;
+            im->layers[i]->fpath = util_strdup_s(manifest->layers[i]);
             parent_chain_id = id;
             continue;
         }
 
-        if (check_and_set_digest_from_tarball(im->layers[i], conf->rootfs->diff_ids[i]) != 0) {
-            ERROR("Check layer digest failed");
+        // layers not exist are extracted after all images in archive are processed, and checked then
+        if (load_want_layer(archive, manifest->layers[i], im->layers[i]) != 0) {
+            ERROR("Failed to find layer %s in archive", manifest->layers[i]);
             ret = -1;
             goto out;
         }
@@ -778,7 +1177,7 @@ out:
     return ret;
 }
 
-static load_image_t *oci_load_process_manifest(const image_manifest_items_element *manifest, const char *dstdir)
+static load_image_t *oci_load_process_manifest(const image_manifest_items_element *manifest, load_archive_t *archive)
 {
     int ret = 0;
     char *config_fpath = NULL;
@@ -793,10 +1192,10 @@ static load_image_t *oci_load_process_manifest(const image_manifest_items_elemen
         goto out;
     }
 
-    config_fpath = util_path_join(dstdir, manifest->config);
+    config_fpath = load_metadata_file(archive, manifest->config);
     if (config_fpath == NULL) {
         ret = -1;
-        ERROR("Path:%s join failed", manifest->config);
+        ERROR("Image config %s not found in archive", manifest->config);
         goto out;
     }
 
@@ -820,7 +1219,7 @@ static load_image_t *oci_load_process_manifest(const image_manifest_items_elemen
     im->repo_tags_len = manifest->repo_tags_len;
     im->repo_tags = manifest->repo_tags_len == 0 ? NULL : str_array_copy(manifest->repo_tags, manifest->repo_tags_len);
 
-    if (oci_load_set_layers_info(im, manifest, dstdir) != 0) {
+    if (oci_load_set_layers_info(im, manifest, archive) != 0) {
         ret = -1;
         ERROR("Image load set layers info err");
         goto out;
@@ -1059,15 +1458,13 @@ int oci_do_load(const im_load_request *request)
 {
     int ret = 0;
     size_t i = 0;
-    struct archive_options options = { 0 };
-    struct io_read_wrapper reader = { 0 };
+    load_archive_t archive = { .fd = -1 };
     char *manifest_fpath = NULL;
     image_manifest_items_element **manifest = NULL;
     size_t manifest_len = 0;
-    load_image_t *im = NULL;
+    load_image_t **ims = NULL;
     char *digest = NULL;
     char *dstdir = NULL;
-    char *err = NULL;
 
     if (request == NULL || request->file == NULL) {
         ERROR("Invalid input arguments, cannot load image");
@@ -1081,25 +1478,32 @@ int oci_do_load(const im_load_request *request)
         goto out;
     }
 
-    if (file_read_wrapper(request->file, &reader) != 0) {
-        ERROR("Failed to fill layer read wrapper");
-        isulad_try_set_error_message("Failed to fill layer read wrapper");
+    if (load_archive_init(&archive, request->file, dstdir) != 0) {
+        ERROR("Failed to open image archive %s", request->file);
+        isulad_try_set_error_message("Failed to open image archive %s", request->file);
         ret = -1;
         goto out;
     }
 
-    options.whiteout_format = NONE_WHITEOUT_FORMATE;
-    if (archive_unpack(&reader, dstdir, &options, &err) != 0) {
-        ERROR("Failed to unpack to %s: %s", dstdir, err);
-        isulad_try_set_error_message("Failed to unpack to %s: %s", dstdir, err);
+    /*
+     * Members are extracted by name: manifest.json, then the image configs it refers to, then the
+     * layers not exist in storage. Other members are skipped, seeked over if archive is not compressed.
+     * The first walk records links and keeps small json members too, manifest.json is wanted again in
+     * case it is a link. Image configs are usually kept by the first walk, so the archive is walked twice
+     * only, which matters for compressed archives that can not be seeked over.
+     */
+    if (load_want_metadata(&archive, LOAD_MANIFEST_NAME) != 0 || load_extract_wanted(&archive) != 0 ||
+        load_want_metadata(&archive, LOAD_MANIFEST_NAME) != 0 || load_extract_wanted(&archive) != 0) {
+        ERROR("Failed to read image archive %s", request->file);
+        isulad_try_set_error_message("Failed to read image archive %s", request->file);
         ret = -1;
         goto out;
     }
 
-    manifest_fpath = util_path_join(dstdir, "manifest.json");
+    manifest_fpath = load_metadata_file(&archive, LOAD_MANIFEST_NAME);
     if (manifest_fpath == NULL) {
-        ERROR("Failed to join manifest.json path:%s", dstdir);
-        isulad_try_set_error_message("Failed to join manifest.json path:%s", dstdir);
+        ERROR("Failed to find manifest.json file in archive %s", request->file);
+        isulad_try_set_error_message("Failed to find manifest.json file in archive %s", request->file);
         ret = -1;
         goto out;
     }
@@ -1127,30 +1531,69 @@ int oci_do_load(const im_load_request *request)
         goto out;
     }
 
-    for (; i < manifest_len; i++) {
-        im = oci_load_process_manifest(manifest[i], dstdir);
-        if (im == NULL) {
+    ims = util_smart_calloc_s(sizeof(load_image_t *), manifest_len);
+    if (ims == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto out;
+    }
+
+    for (i = 0; i < manifest_len; i++) {
+        if (manifest[i]->config == NULL || load_want_metadata(&archive, manifest[i]->config) != 0) {
+            ERROR("Invalid image config of image %zu in manifest", i);
+            isulad_try_set_error_message("Invalid image config in manifest");
+            ret = -1;
+            goto out;
+        }
+    }
+
+    if (load_extract_wanted(&archive) != 0) {
+        ERROR("Failed to extract image configs from image archive %s", request->file);
+        isulad_try_set_error_message("Failed to extract image configs from image archive %s", request->file);
+        ret = -1;
+        goto out;
+    }
+
+    // layers already exist in storage are held until images are registered
+    for (i = 0; i < manifest_len; i++) {
+        ims[i] = oci_load_process_manifest(manifest[i], &archive);
+        if (ims[i] == NULL) {
             ret = -1;
             isulad_try_set_error_message("process manifest failed");
             goto out;
         }
+    }
+
+    if (load_extract_wanted(&archive) != 0) {
+        ERROR("Failed to extract layers from image archive %s", request->file);
+        isulad_try_set_error_message("Failed to extract layers from image archive %s", request->file);
+        ret = -1;
+        goto out;
+    }
+
+    for (i = 0; i < manifest_len; i++) {
+        if (oci_load_check_layers(ims[i], &archive) != 0) {
+            ERROR("Image %s check layers err", ims[i]->im_id);
+            ret = -1;
+            goto out;
+        }
 
-        if (oci_load_set_manifest_info(im) != 0) {
-            ERROR("Image %s set manifest info err", im->im_id);
+        if (oci_load_set_manifest_info(ims[i]) != 0) {
+            ERROR("Image %s set manifest info err", ims[i]->im_id);
             ret = -1;
             goto out;
         }
 
-        im->manifest_digest = util_strdup_s(digest);
-        if (oci_load_register_image(im, request->tag) != 0) {
-            ERROR("error register image %s to store", im->im_id);
-            isulad_try_set_error_message("error register image %s to store", im->im_id);
+        ims[i]->manifest_digest = util_strdup_s(digest);
+        if (oci_load_register_image(ims[i], request->tag) != 0) {
+            ERROR("error register image %s to store", ims[i]->im_id);
+            isulad_try_set_error_message("error register image %s to store", ims[i]->im_id);
             ret = -1;
             goto out;
         }
 
-        do_free_load_image(im);
-        im = NULL;
+        do_free_load_image(ims[i]);
+        ims[i] = NULL;
     }
 
 out:
@@ -1160,20 +1603,19 @@ out:
     free(manifest_fpath);
     free(digest);
     for (i = 0; i < manifest_len; i++) {
+        if (ims != NULL) {
+            do_free_load_image(ims[i]);
+        }
         free_image_manifest_items_element(manifest[i]);
     }
+    free(ims);
     free(manifest);
 
-    do_free_load_image(im);
+    load_archive_fini(&archive);
 
-    if (reader.close != NULL) {
-        reader.close(reader.context, NULL);
-    }
-
-    if (util_recursive_rmdir(dstdir, 0)) {
+    if (dstdir != NULL && util_recursive_rmdir(dstdir, 0)) {
         WARN("failed to remove directory %s", dstdir);
     }
     free(dstdir);
-    free(err);
     return ret;
 }
@@ -36,6 +36,8 @@ typedef struct {
     // with "sha256:" prefix
     char *chain_id;
     char *fpath;
+    // name of the layer in the archive
+    char *member;
     // layer already exist in storage
     bool alread_exist;
 } load_layer_blob_t;
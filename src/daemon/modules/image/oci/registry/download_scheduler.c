@@ -0,0 +1,348 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide daemon wide layer download scheduler functions
+ ******************************************************************************/
+#define _GNU_SOURCE /* See feature_test_macros(7) */
+#include "download_scheduler.h"
+
+#include <pthread.h>
+#include <sys/prctl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <isula_libutils/log.h>
+
+#include "utils.h"
+#include "utils_timestamp.h"
+#include "map.h"
+#include "linked_list.h"
+
+/*
+ * Tasks are run in order of their deadline, which is the submit time plus the time to download
+ * the blob at this rate. Smaller blobs go first, but a big blob waits at most as long as its own
+ * download would take before newly submitted small ones, so it is never starved.
+ */
+#define DOWNLOAD_AGING_BYTES_PER_SECOND (10 * 1024 * 1024)
+#define DOWNLOAD_LOCK_RETRY_INTERVAL_US (100 * 1000)
+
+typedef struct {
+    char *registry;
+    size_t size;
+    int64_t deadline;
+    download_task_func func;
+    void *arg;
+} download_task;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    // waiting tasks sorted by deadline
+    struct linked_list queue;
+    size_t queued;
+    size_t running;
+    unsigned int max_downloads;
+    unsigned int max_per_registry;
+    // registry -> number of running tasks
+    map_t *registry_running;
+    uint64_t completed;
+    uint64_t bytes;
+    // time with at least one task running, used to calc throughput
+    int64_t busy_nanos;
+    int64_t busy_since;
+} download_scheduler;
+
+static download_scheduler *g_scheduler = NULL;
+
+static void free_download_task(download_task *task)
+{
+    if (task == NULL) {
+        return;
+    }
+    free(task->registry);
+    task->registry = NULL;
+    free(task);
+}
+
+static int registry_running_num(const char *registry)
+{
+    int *num = map_search(g_scheduler->registry_running, (void *)registry);
+
+    return num != NULL ? *num : 0;
+}
+
+static void registry_running_update(const char *registry, int delta)
+{
+    int num = registry_running_num(registry) + delta;
+
+    if (num <= 0) {
+        (void)map_remove(g_scheduler->registry_running, (void *)registry);
+        return;
+    }
+
+    if (!map_replace(g_scheduler->registry_running, (void *)registry, &num)) {
+        ERROR("Failed to update running downloads of registry %s", registry);
+    }
+}
+
+// pick the earliest task whose registry is not at its limit, called with mutex held
+static download_task *pick_task(void)
+{
+    struct linked_list *item = NULL;
+    struct linked_list *next = NULL;
+    download_task *task = NULL;
+
+    if (g_scheduler->running >= g_scheduler->max_downloads) {
+        return NULL;
+    }
+
+    linked_list_for_each_safe(item, &g_scheduler->queue, next) {
+        task = (download_task *)item->elem;
+        if (registry_running_num(task->registry) >= (int)g_scheduler->max_per_registry) {
+            continue;
+        }
+        linked_list_del(item);
+        free(item);
+        g_scheduler->queued--;
+        return task;
+    }
+
+    return NULL;
+}
+
+static void task_started(download_task *task)
+{
+    if (g_scheduler->running == 0) {
+        g_scheduler->busy_since = util_get_now_time_nanos();
+    }
+    g_scheduler->running++;
+    registry_running_update(task->registry, 1);
+}
+
+static void task_finished(download_task *task)
+{
+    g_scheduler->running--;
+    registry_running_update(task->registry, -1);
+    g_scheduler->completed++;
+    g_scheduler->bytes += task->size;
+    if (g_scheduler->running == 0) {
+        g_scheduler->busy_nanos += util_get_now_time_nanos() - g_scheduler->busy_since;
+    }
+}
+
+static void *download_worker(void *arg)
+{
+    download_task *task = NULL;
+
+    if (pthread_detach(pthread_self()) != 0) {
+        ERROR("Set thread detach fail");
+    }
+
+    prctl(PR_SET_NAME, "download_layer");
+
+    for (;;) {
+        if (pthread_mutex_lock(&g_scheduler->mutex) != 0) {
+            // back off instead of spinning, the lock is not expected to fail
+            ERROR("Failed to lock download scheduler");
+            util_usleep_nointerupt(DOWNLOAD_LOCK_RETRY_INTERVAL_US);
+            continue;
+        }
+        task = pick_task();
+        while (task == NULL) {
+            if (pthread_cond_wait(&g_scheduler->cond, &g_scheduler->mutex) != 0) {
+                ERROR("Failed to wait download task");
+            }
+            task = pick_task();
+        }
+        task_started(task);
+        (void)pthread_mutex_unlock(&g_scheduler->mutex);
+
+        task->func(task->arg);
+
+        (void)pthread_mutex_lock(&g_scheduler->mutex);
+        task_finished(task);
+        // tasks blocked by the registry limit may be runnable now
+        (void)pthread_cond_broadcast(&g_scheduler->cond);
+        (void)pthread_mutex_unlock(&g_scheduler->mutex);
+
+        free_download_task(task);
+        task = NULL;
+    }
+
+    return NULL;
+}
+
+int download_scheduler_init(unsigned int max_downloads, unsigned int max_per_registry)
+{
+    unsigned int i = 0;
+    pthread_t tid = 0;
+
+    if (g_scheduler != NULL) {
+        return 0;
+    }
+
+    if (max_downloads == 0 || max_per_registry == 0) {
+        ERROR("Invalid download concurrency, global %u, per registry %u", max_downloads, max_per_registry);
+        return -1;
+    }
+
+    g_scheduler = util_common_calloc_s(sizeof(download_scheduler));
+    if (g_scheduler == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    if (pthread_mutex_init(&g_scheduler->mutex, NULL) != 0) {
+        ERROR("Failed to init mutex for download scheduler");
+        goto free_out;
+    }
+
+    if (pthread_cond_init(&g_scheduler->cond, NULL) != 0) {
+        ERROR("Failed to init cond for download scheduler");
+        goto destroy_mutex;
+    }
+
+    g_scheduler->registry_running = map_new(MAP_STR_INT, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (g_scheduler->registry_running == NULL) {
+        ERROR("Out of memory");
+        goto destroy_cond;
+    }
+
+    linked_list_init(&g_scheduler->queue);
+    g_scheduler->max_downloads = max_downloads;
+    g_scheduler->max_per_registry = max_per_registry;
+
+    // Workers never exit, g_scheduler can not be freed once any worker started.
+    for (i = 0; i < max_downloads; i++) {
+        if (pthread_create(&tid, NULL, download_worker, NULL) != 0) {
+            ERROR("Failed to start download worker %u", i);
+            if (i == 0) {
+                goto free_map;
+            }
+            g_scheduler->max_downloads = i;
+            break;
+        }
+    }
+
+    INFO("Download scheduler started, max downloads %u, max downloads per registry %u",
+         g_scheduler->max_downloads, max_per_registry);
+    return 0;
+
+free_map:
+    map_free(g_scheduler->registry_running);
+destroy_cond:
+    (void)pthread_cond_destroy(&g_scheduler->cond);
+destroy_mutex:
+    (void)pthread_mutex_destroy(&g_scheduler->mutex);
+free_out:
+    free(g_scheduler);
+    g_scheduler = NULL;
+    return -1;
+}
+
+static int64_t task_deadline(size_t size)
+{
+    uint64_t rate = DOWNLOAD_AGING_BYTES_PER_SECOND;
+    // split to avoid overflow of size * Time_Second
+    int64_t delay = (int64_t)(size / rate) * Time_Second + (int64_t)((size % rate) * Time_Second / rate);
+
+    return util_get_now_time_nanos() + delay;
+}
+
+// insert task before the first task with later deadline, so tasks with the same
+// deadline are kept in FIFO order, called with mutex held
+static void insert_task(struct linked_list *node, download_task *task)
+{
+    struct linked_list *item = NULL;
+
+    linked_list_for_each(item, &g_scheduler->queue) {
+        if (((download_task *)item->elem)->deadline > task->deadline) {
+            break;
+        }
+    }
+    // add node before item, item is the list head if no bigger task found
+    linked_list_add_tail(item, node);
+}
+
+int download_scheduler_submit(const char *registry, size_t size, download_task_func func, void *arg)
+{
+    download_task *task = NULL;
+    struct linked_list *node = NULL;
+
+    if (func == NULL) {
+        ERROR("Invalid NULL download task");
+        return -1;
+    }
+
+    if (g_scheduler == NULL) {
+        ERROR("Download scheduler not initialized");
+        return -1;
+    }
+
+    task = util_common_calloc_s(sizeof(download_task));
+    node = util_common_calloc_s(sizeof(struct linked_list));
+    if (task == NULL || node == NULL) {
+        ERROR("Out of memory");
+        free(task);
+        free(node);
+        return -1;
+    }
+    task->registry = util_strdup_s(registry != NULL ? registry : "");
+    task->size = size;
+    task->deadline = task_deadline(size);
+    task->func = func;
+    task->arg = arg;
+    linked_list_add_elem(node, task);
+
+    if (pthread_mutex_lock(&g_scheduler->mutex) != 0) {
+        ERROR("Failed to lock download scheduler");
+        free_download_task(task);
+        free(node);
+        return -1;
+    }
+    insert_task(node, task);
+    g_scheduler->queued++;
+    DEBUG("Queued download task of %zu bytes from %s, %zu tasks queued", size, task->registry, g_scheduler->queued);
+    (void)pthread_cond_signal(&g_scheduler->cond);
+    (void)pthread_mutex_unlock(&g_scheduler->mutex);
+
+    return 0;
+}
+
+void download_scheduler_get_stats(download_scheduler_stats *stats)
+{
+    int64_t busy_nanos = 0;
+
+    if (stats == NULL) {
+        return;
+    }
+
+    (void)memset(stats, 0, sizeof(download_scheduler_stats));
+    if (g_scheduler == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_scheduler->mutex);
+    stats->queued = g_scheduler->queued;
+    stats->running = g_scheduler->running;
+    stats->completed = g_scheduler->completed;
+    stats->bytes = g_scheduler->bytes;
+    busy_nanos = g_scheduler->busy_nanos;
+    if (g_scheduler->running != 0) {
+        busy_nanos += util_get_now_time_nanos() - g_scheduler->busy_since;
+    }
+    (void)pthread_mutex_unlock(&g_scheduler->mutex);
+
+    if (busy_nanos > 0) {
+        stats->throughput = (uint64_t)((double)stats->bytes * Time_Second / busy_nanos);
+    }
+}
@@ -0,0 +1,54 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide daemon wide layer download scheduler definition
+ ******************************************************************************/
+#ifndef DAEMON_MODULES_IMAGE_OCI_REGISTRY_DOWNLOAD_SCHEDULER_H
+#define DAEMON_MODULES_IMAGE_OCI_REGISTRY_DOWNLOAD_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*download_task_func)(void *arg);
+
+typedef struct {
+    // tasks waiting for a download worker
+    size_t queued;
+    // tasks being downloaded
+    size_t running;
+    // tasks completed since daemon started
+    uint64_t completed;
+    // blob bytes of completed tasks
+    uint64_t bytes;
+    // bytes per second while any download is running
+    uint64_t throughput;
+} download_scheduler_stats;
+
+// Start the workers shared by all pulls. max_downloads limits the downloads of
+// the whole daemon, and max_per_registry limits the downloads from one registry.
+int download_scheduler_init(unsigned int max_downloads, unsigned int max_per_registry);
+
+// Queue a download task of blob with size from registry, tasks of smaller blobs are run
+// first, unless bigger ones waited too long. func is always called exactly once if submit succeeded.
+int download_scheduler_submit(const char *registry, size_t size, download_task_func func, void *arg);
+
+void download_scheduler_get_stats(download_scheduler_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_MODULES_IMAGE_OCI_REGISTRY_DOWNLOAD_SCHEDULER_H
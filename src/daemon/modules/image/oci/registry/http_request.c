@@ -702,7 +702,7 @@ static int xfer(void *p, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultota
 }
 
 int http_request_file(pull_descriptor *desc, const char *url, const char **custom_headers, char *file,
-                      resp_data_type type, CURLcode *errcode)
+                      resp_data_type type, CURLcode *errcode, write_hook_func hook, void *hook_data)
 {
     int ret = 0;
     struct http_get_options *options = NULL;
@@ -733,6 +733,8 @@ int http_request_file(pull_descriptor *desc, const char *url, const char **custo
     options->progress_info_op = progress;
     options->xferinfo = &desc->cancel;
     options->xferinfo_op = xfer;
+    options->write_hook = hook_data;
+    options->write_hook_op = hook;
     options->timeout = true;
 
     ret = setup_common_options(desc, options, url, custom_headers);
@@ -17,6 +17,7 @@
 
 #include <curl/curl.h>
 #include "registry_type.h"
+#include "http.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,8 +32,9 @@ typedef enum {
 
 int http_request_buf(pull_descriptor *desc, const char *url, const char **custom_headers, char **output,
                      resp_data_type type);
+// hook can be NULL, if set, it's called with every chunk of body written to file
 int http_request_file(pull_descriptor *desc, const char *url, const char **custom_headers, char *file,
-                      resp_data_type type, CURLcode *errcode);
+                      resp_data_type type, CURLcode *errcode, write_hook_func hook, void *hook_data);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,209 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide functions to keep data of failed blob downloads for resume
+ ******************************************************************************/
+#include "partial_blob.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <isula_libutils/log.h>
+
+#include "utils.h"
+#include "utils_file.h"
+#include "utils_verify.h"
+
+typedef struct {
+    char *path;
+    int64_t size;
+    time_t mtime;
+} partial_blob_entry;
+
+char *partial_blob_path(const char *dir, char *digest)
+{
+    if (dir == NULL || !util_valid_digest(digest)) {
+        return NULL;
+    }
+
+    return util_path_join(dir, util_without_sha256_prefix(digest));
+}
+
+// Layers with the same digest are not downloaded at the same time, see add_fetch_task.
+bool partial_blob_restore(const char *partial, const char *file, size_t blob_size)
+{
+    int64_t size = 0;
+
+    if (partial == NULL || file == NULL) {
+        return false;
+    }
+
+    if (rename(partial, file) != 0) {
+        if (errno != ENOENT) {
+            WARN("Failed to move partial blob %s to %s: %s", partial, file, strerror(errno));
+        }
+        return false;
+    }
+
+    // nothing left to request if size is not less than blob size, download it again
+    size = util_file_size(file);
+    if (size <= 0 || (blob_size != 0 && (uint64_t)size >= blob_size)) {
+        return false;
+    }
+
+    INFO("Resume downloading %s from %lld bytes", file, (long long)size);
+    return true;
+}
+
+void partial_blob_save(const char *dir, const char *file, const char *partial)
+{
+    int64_t size = 0;
+
+    if (partial == NULL || file == NULL) {
+        return;
+    }
+
+    size = util_file_size(file);
+    if (size <= 0) {
+        return;
+    }
+
+    if (rename(file, partial) != 0) {
+        WARN("Failed to keep partial blob %s: %s", file, strerror(errno));
+        return;
+    }
+
+    INFO("Keep %lld bytes downloaded to %s for resume", (long long)size, partial);
+
+    // only failed downloads add partial blobs, collect them here to bound the space used
+    partial_blob_gc(dir, PARTIAL_BLOB_MAX_AGE_SECONDS, PARTIAL_BLOB_MAX_TOTAL_SIZE);
+}
+
+static int compare_entry_mtime(const void *a, const void *b)
+{
+    const partial_blob_entry *ea = (const partial_blob_entry *)a;
+    const partial_blob_entry *eb = (const partial_blob_entry *)b;
+
+    if (ea->mtime < eb->mtime) {
+        return -1;
+    }
+    return ea->mtime > eb->mtime ? 1 : 0;
+}
+
+// partial blob may be restored by other pulls meanwhile, it is not an error if it is gone
+static void remove_partial_blob(const char *path, const char *reason)
+{
+    if (unlink(path) != 0 && errno != ENOENT) {
+        WARN("Failed to remove partial blob %s: %s", path, strerror(errno));
+        return;
+    }
+    DEBUG("Removed partial blob %s, %s", path, reason);
+}
+
+static int append_entry(partial_blob_entry **entries, size_t *len, size_t *cap, char *path, const struct stat *st)
+{
+    partial_blob_entry *new_entries = NULL;
+    size_t new_cap = 0;
+
+    if (*len == *cap) {
+        new_cap = *cap == 0 ? 16 : *cap * 2;
+        if (util_mem_realloc((void **)&new_entries, new_cap * sizeof(partial_blob_entry), *entries,
+                             *cap * sizeof(partial_blob_entry)) != 0) {
+            ERROR("Out of memory");
+            return -1;
+        }
+        *entries = new_entries;
+        *cap = new_cap;
+    }
+
+    (*entries)[*len].path = path;
+    (*entries)[*len].size = (int64_t)st->st_size;
+    (*entries)[*len].mtime = st->st_mtime;
+    (*len)++;
+    return 0;
+}
+
+void partial_blob_gc(const char *dir, int64_t max_age, int64_t max_size)
+{
+    DIR *dp = NULL;
+    struct dirent *de = NULL;
+    struct stat st = { 0 };
+    partial_blob_entry *entries = NULL;
+    size_t len = 0;
+    size_t cap = 0;
+    size_t i = 0;
+    int64_t total = 0;
+    char *path = NULL;
+    time_t now = time(NULL);
+
+    if (dir == NULL) {
+        return;
+    }
+
+    dp = opendir(dir);
+    if (dp == NULL) {
+        if (errno != ENOENT) {
+            WARN("Failed to open partial blob directory %s: %s", dir, strerror(errno));
+        }
+        return;
+    }
+
+    for (de = readdir(dp); de != NULL; de = readdir(dp)) {
+        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) {
+            continue;
+        }
+
+        path = util_path_join(dir, de->d_name);
+        if (path == NULL) {
+            ERROR("Failed to join path of partial blob %s", de->d_name);
+            goto out;
+        }
+        if (lstat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+            free(path);
+            continue;
+        }
+
+        if (now - st.st_mtime > max_age) {
+            remove_partial_blob(path, "expired");
+            free(path);
+            continue;
+        }
+
+        if (append_entry(&entries, &len, &cap, path, &st) != 0) {
+            free(path);
+            goto out;
+        }
+        total += (int64_t)st.st_size;
+    }
+
+    if (total <= max_size) {
+        goto out;
+    }
+
+    qsort(entries, len, sizeof(partial_blob_entry), compare_entry_mtime);
+    for (i = 0; i < len && total > max_size; i++) {
+        remove_partial_blob(entries[i].path, "too much space used");
+        total -= entries[i].size;
+    }
+
+out:
+    for (i = 0; i < len; i++) {
+        free(entries[i].path);
+    }
+    free(entries);
+    closedir(dp);
+}
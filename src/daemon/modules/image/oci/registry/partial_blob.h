@@ -0,0 +1,49 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide functions to keep data of failed blob downloads for resume
+ ******************************************************************************/
+#ifndef DAEMON_MODULES_IMAGE_OCI_REGISTRY_PARTIAL_BLOB_H
+#define DAEMON_MODULES_IMAGE_OCI_REGISTRY_PARTIAL_BLOB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// partial blobs not resumed for this long are removed
+#define PARTIAL_BLOB_MAX_AGE_SECONDS (24 * 60 * 60)
+// the oldest partial blobs are removed if all of them take more space than this
+#define PARTIAL_BLOB_MAX_TOTAL_SIZE (2LL * 1024 * 1024 * 1024)
+
+// Partial blob in dir is named by its digest, return NULL if dir is NULL or digest is invalid.
+char *partial_blob_path(const char *dir, char *digest);
+
+// Move partial blob left by a former pull to file, return true if download should resume
+// from the end of file, that is, file is not empty and smaller than blob_size.
+bool partial_blob_restore(const char *partial, const char *file, size_t blob_size);
+
+// Keep data of failed download in file as partial, then collect old partial blobs in dir.
+void partial_blob_save(const char *dir, const char *file, const char *partial);
+
+// Remove partial blobs in dir not modified for max_age seconds, then the oldest ones
+// until the total size of those left is not more than max_size.
+void partial_blob_gc(const char *dir, int64_t max_age, int64_t max_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_MODULES_IMAGE_OCI_REGISTRY_PARTIAL_BLOB_H
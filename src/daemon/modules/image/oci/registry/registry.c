@@ -33,6 +33,7 @@
 #include "utils.h"
 #include "registry_apiv2.h"
 #include "registry_apiv1.h"
+#include "download_scheduler.h"
 #include "certs.h"
 #include "auths.h"
 #include "isula_libutils/registry_manifest_schema2.h"
@@ -58,12 +59,21 @@
 #include "oci_image.h"
 
 #define MANIFEST_BIG_DATA_KEY "manifest"
-#define MAX_CONCURRENT_DOWNLOAD_NUM 5
 #define DEFAULT_WAIT_TIMEOUT 15
+#define REGISTRY_PARTIAL_BLOB_DIR "registry-partial"
+// max threads to unpack downloaded layers of one image before they are registered
+#define STAGE_LAYER_WORKERS 4
 #ifdef ENABLE_IMAGE_SEARCH
 #define INDEX_PREFIX "index."
 #endif
 
+typedef enum {
+    LAYER_STAGE_NONE = 0,
+    LAYER_STAGE_RUNNING,
+    // staged, or taken by register thread to unpack when registering
+    LAYER_STAGE_DONE,
+} layer_stage_state;
+
 typedef struct {
     pull_descriptor *desc;
     size_t index;
@@ -72,6 +82,8 @@ typedef struct {
     bool use;
     bool notified;
     char *diffid;
+    layer_stage_state stage;
+    char *staged_diff;
 } thread_fetch_info;
 
 typedef struct {
@@ -264,7 +276,9 @@ static int parse_manifest_ociv1(pull_descriptor *desc)
     }
 
     for (i = 0; i < manifest->layers_len; i++) {
+        // zstd layers are decompressed by libarchive when applied
         if (strcmp(manifest->layers[i]->media_type, OCI_IMAGE_LAYER_TAR_GZIP) &&
+            strcmp(manifest->layers[i]->media_type, OCI_IMAGE_LAYER_TAR_ZSTD) &&
             strcmp(manifest->layers[i]->media_type, OCI_IMAGE_LAYER_TAR) &&
             strcmp(manifest->layers[i]->media_type, OCI_IMAGE_LAYER_ND_TAR) &&
             strcmp(manifest->layers[i]->media_type, OCI_IMAGE_LAYER_ND_TAR_GZIP)) {
@@ -585,7 +599,7 @@ static int set_cached_info_to_desc(thread_fetch_info *info)
     return 0;
 }
 
-static int register_layer(pull_descriptor *desc, size_t i)
+static int register_layer(pull_descriptor *desc, size_t i, const char *staged_diff)
 {
     struct layer *l = NULL;
     char *id = NULL;
@@ -635,6 +649,7 @@ static int register_layer(pull_descriptor *desc, size_t i)
         .compressed_digest = desc->layers[i].digest,
         .writable = false,
         .layer_data_path = desc->layers[i].file,
+        .staged_diff = staged_diff,
     };
     if (storage_layer_create(id, &copts) != 0) {
         ERROR("create layer %s failed, parent %s, file %s", id, desc->parent_layer_id, desc->layers[i].file);
@@ -1166,6 +1181,17 @@ static void register_layer_notify(pull_descriptor *desc)
     mutex_unlock(&desc->mutex);
 }
 
+// queue downloaded layer for stagers if they are running, called with desc->mutex held
+static void queue_stage_layer(thread_fetch_info *info)
+{
+    pull_descriptor *desc = info->desc;
+
+    if (!desc->staging || info->stage != LAYER_STAGE_NONE || desc->stage_queue_len >= desc->layers_len) {
+        return;
+    }
+    desc->stage_queue[desc->stage_queue_len++] = info->index;
+}
+
 static void notify_cached_descs(char *blob_digest)
 {
     cached_layer *cache = NULL;
@@ -1183,39 +1209,80 @@ static void notify_cached_descs(char *blob_digest)
     linked_list_for_each_safe(item, &cache->file_list, next) {
         info = ((file_elem *)item->elem)->info;
         info->notified = true;
-        register_layer_notify(info->desc);
+        mutex_lock(&info->desc->mutex);
+        if (cache->result == 0) {
+            queue_stage_layer(info);
+        }
+        if (pthread_cond_broadcast(&info->desc->cond)) {
+            ERROR("Failed to broadcast");
+        }
+        mutex_unlock(&info->desc->mutex);
+    }
+}
+
+/*
+ * The fetch task of a blob is shared by all pulls waiting for it. Run it for the submitter if it
+ * is not cancelled, or for another waiter instead, NULL if every waiter is cancelled. Called with
+ * g_shared->mutex held, pulls in the file list wait for the task to notify them.
+ */
+static thread_fetch_info *pick_fetch_runner(thread_fetch_info *info)
+{
+    cached_layer *cache = NULL;
+    struct linked_list *item = NULL;
+    thread_fetch_info *waiter = NULL;
+
+    if (!info->desc->cancel) {
+        return info;
+    }
+
+    cache = (cached_layer *)map_search(g_shared->cached_layers, info->blob_digest);
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    linked_list_for_each(item, &cache->file_list) {
+        waiter = ((file_elem *)item->elem)->info;
+        if (!waiter->desc->cancel) {
+            return waiter;
+        }
     }
+
+    return NULL;
 }
 
-static void *fetch_layer_in_thread(void *arg)
+static void fetch_layer_task(void *arg)
 {
     thread_fetch_info *info = (thread_fetch_info *)arg;
+    thread_fetch_info *runner = NULL;
     pull_descriptor *desc = info->desc;
     int ret = 0;
     char *diffid = NULL;
 
-    ret = pthread_detach(pthread_self());
-    if (ret != 0) {
-        ERROR("Set thread detach fail");
-        goto out;
-    }
-
-    prctl(PR_SET_NAME, "fetch_layer");
-
-    if (fetch_layer(desc, info->index) != 0) {
-        ERROR("fetch layer %zu failed", info->index);
+    // pulls may be cancelled while the task is queued, abort only if no one waits for the blob
+    mutex_lock(&g_shared->mutex);
+    runner = pick_fetch_runner(info);
+    mutex_unlock(&g_shared->mutex);
+    if (runner == NULL) {
         ret = -1;
         goto out;
     }
+    desc = runner->desc;
 
     // calc diffid only if it's schema v1. schema v1 have
     // no diff id so we need to calc it. schema v2 have
     // diff id in config and we do not want to calc it again
     // as it cost too much time.
-    if (is_manifest_schemav1(desc->manifest.media_type)) {
-        diffid = oci_calc_diffid(info->file);
+    if (fetch_layer(desc, runner->index, is_manifest_schemav1(desc->manifest.media_type) ? &diffid : NULL) != 0) {
+        ERROR("fetch layer %zu failed", runner->index);
+        ret = -1;
+        goto out;
+    }
+
+    // diffid is calculated while downloading in most cases, calc it from file if not
+    if (is_manifest_schemav1(desc->manifest.media_type) && diffid == NULL) {
+        diffid = oci_calc_diffid(runner->file);
         if (diffid == NULL) {
-            ERROR("calc diffid for layer %zu failed", info->index);
+            ERROR("calc diffid for layer %zu failed", runner->index);
             ret = -1;
             goto out;
         }
@@ -1231,8 +1298,8 @@ out:
         }
     }
     DAEMON_CLEAR_ERRMSG();
-    desc->pulling_number--;
-    set_cached_layers_info(info->blob_digest, diffid, ret, info->file);
+    info->desc->pulling_number--;
+    set_cached_layers_info(info->blob_digest, diffid, ret, runner != NULL ? runner->file : info->file);
     notify_cached_descs(info->blob_digest);
     // notify to continue pull
     if (pthread_cond_broadcast(&g_shared->cond)) {
@@ -1242,60 +1309,52 @@ out:
 
     free(diffid);
     diffid = NULL;
-
-    return NULL;
 }
 
 static int add_fetch_task(thread_fetch_info *info)
 {
     int ret = 0;
-    int cond_ret = 0;
-    pthread_t tid = 0;
-    bool cached_layers_added = true;
     cached_layer *cache = NULL;
-    struct timespec ts = { 0 };
+    pull_descriptor *desc = info->desc;
 
     mutex_lock(&g_shared->mutex);
     cache = get_cached_layer(info->blob_digest);
-    if (cache == NULL) {
-        // If there are too many download threads, wait until anyone completed.
-        while (info->desc->pulling_number >= MAX_CONCURRENT_DOWNLOAD_NUM) {
-            ts.tv_sec = time(NULL) + DEFAULT_WAIT_TIMEOUT; // avoid wait forever
-            cond_ret = pthread_cond_timedwait(&g_shared->cond, &g_shared->mutex, &ts);
-            if (cond_ret != 0 && cond_ret != ETIMEDOUT) {
-                ERROR("condition wait failed, ret %d", cond_ret);
-                ret = -1;
-                goto out;
-            }
-        }
-        // retry get cached layer after some time of unlock
-        cache = get_cached_layer(info->blob_digest);
-    }
 
     ret = add_cached_layer(info->blob_digest, info->file, info);
     if (ret != 0) {
-        ERROR("add fetch info failed, ret %d", cond_ret);
-        ret = -1;
-        goto out;
+        ERROR("add fetch info failed, ret %d", ret);
+        mutex_unlock(&g_shared->mutex);
+        return -1;
     }
-    cached_layers_added = true;
 
-    if (cache == NULL) {
-        ret = pthread_create(&tid, NULL, fetch_layer_in_thread, info);
-        if (ret != 0) {
-            ERROR("failed to start thread fetch layer %zu", info->index);
-            goto out;
-        }
-        info->desc->pulling_number++;
+    // Only the first puller of the blob downloads it, others wait for
+    // the cached layer to be completed.
+    if (cache != NULL) {
+        mutex_unlock(&g_shared->mutex);
+        return 0;
     }
+    desc->pulling_number++;
+    mutex_unlock(&g_shared->mutex);
 
-out:
-    if (ret != 0 && cached_layers_added) {
-        del_cached_layer(info->blob_digest, info->file);
+    // submit without g_shared->mutex, the scheduler has a lock of its own
+    ret = download_scheduler_submit(desc->host, desc->layers[info->index].size, fetch_layer_task, info);
+    if (ret == 0) {
+        return 0;
+    }
+    ERROR("failed to submit task to fetch layer %zu", info->index);
+
+    // other pulls may have joined the cached layer meanwhile, fail them as the download failed
+    mutex_lock(&g_shared->mutex);
+    desc->pulling_number--;
+    set_cached_layers_info(info->blob_digest, NULL, -1, info->file);
+    notify_cached_descs(info->blob_digest);
+    del_cached_layer(info->blob_digest, info->file);
+    if (pthread_cond_broadcast(&g_shared->cond)) {
+        ERROR("Failed to broadcast");
     }
     mutex_unlock(&g_shared->mutex);
 
-    return ret;
+    return -1;
 }
 
 static void free_thread_fetch_info(thread_fetch_info *info)
@@ -1309,6 +1368,8 @@ static void free_thread_fetch_info(thread_fetch_info *info)
     info->file = NULL;
     free(info->diffid);
     info->diffid = NULL;
+    free(info->staged_diff);
+    info->staged_diff = NULL;
     return;
 }
 
@@ -1403,6 +1464,166 @@ static bool wait_fetch_complete(thread_fetch_info *info)
     return true;
 }
 
+static bool wait_stage_complete(thread_fetch_info *info)
+{
+    return !info->desc->cancel && info->stage == LAYER_STAGE_RUNNING;
+}
+
+// unpack downloaded layer into a staging dir, so only moving it into place is serialized by register thread
+static void stage_layer(thread_fetch_info *info)
+{
+    pull_descriptor *desc = info->desc;
+    char *staged_diff = NULL;
+
+    staged_diff = storage_layer_stage_diff(info->file);
+    if (staged_diff == NULL) {
+        // driver may not support staging, errors of unpacking are logged by storage
+        DEBUG("Layer %zu of image %s is not staged, unpack it when registering", info->index, desc->image_name);
+    }
+
+    mutex_lock(&desc->mutex);
+    info->staged_diff = staged_diff;
+    info->stage = LAYER_STAGE_DONE;
+    if (pthread_cond_broadcast(&desc->cond)) {
+        ERROR("Failed to broadcast");
+    }
+    mutex_unlock(&desc->mutex);
+}
+
+// stage layers in the order their downloads complete, until stagers are stopped or pull is cancelled
+static void *stage_layers_in_thread(void *arg)
+{
+    thread_fetch_info *infos = (thread_fetch_info *)arg;
+    pull_descriptor *desc = infos[0].desc;
+    thread_fetch_info *info = NULL;
+    int cond_ret = 0;
+    struct timespec ts = { 0 };
+
+    prctl(PR_SET_NAME, "stage_layer");
+
+    mutex_lock(&desc->mutex);
+    for (;;) {
+        while (!desc->cancel && desc->staging && desc->stage_queue_head == desc->stage_queue_len) {
+            ts.tv_sec = time(NULL) + DEFAULT_WAIT_TIMEOUT; // avoid wait forever
+            cond_ret = pthread_cond_timedwait(&desc->cond, &desc->mutex, &ts);
+            if (cond_ret != 0 && cond_ret != ETIMEDOUT) {
+                // layers left are unpacked when registering
+                ERROR("condition wait for layers to stage failed, ret %d", cond_ret);
+                goto out;
+            }
+        }
+        if (desc->cancel || !desc->staging) {
+            break;
+        }
+
+        info = &infos[desc->stage_queue[desc->stage_queue_head++]];
+        // taken by register thread already
+        if (info->stage != LAYER_STAGE_NONE) {
+            continue;
+        }
+        info->stage = LAYER_STAGE_RUNNING;
+        mutex_unlock(&desc->mutex);
+
+        stage_layer(info);
+
+        mutex_lock(&desc->mutex);
+    }
+
+out:
+    mutex_unlock(&desc->mutex);
+    return NULL;
+}
+
+// stop stagers and wait for them to exit
+static void stop_stage_layers(pull_descriptor *desc, pthread_t *tids, size_t workers)
+{
+    size_t i = 0;
+
+    mutex_lock(&desc->mutex);
+    desc->staging = false;
+    if (pthread_cond_broadcast(&desc->cond)) {
+        ERROR("Failed to broadcast");
+    }
+    mutex_unlock(&desc->mutex);
+
+    for (i = 0; i < workers; i++) {
+        if (pthread_join(tids[i], NULL) != 0) {
+            ERROR("Failed to join thread to stage layers of image %s", desc->image_name);
+        }
+    }
+}
+
+// start stagers, return the number of them started
+static size_t start_stage_layers(thread_fetch_info *infos, pthread_t *tids)
+{
+    pull_descriptor *desc = infos[0].desc;
+    cached_layer *cache = NULL;
+    size_t count = 0;
+    size_t workers = 0;
+    size_t i = 0;
+
+    for (i = 0; i < desc->layers_len; i++) {
+        if (infos[i].use) {
+            count++;
+        }
+    }
+
+    // nothing to do in parallel with registering
+    if (count < 2) {
+        return 0;
+    }
+
+    desc->stage_queue = util_smart_calloc_s(sizeof(size_t), desc->layers_len);
+    if (desc->stage_queue == NULL) {
+        ERROR("Out of memory");
+        return 0;
+    }
+
+    // queue layers downloaded already, the others are queued by fetch tasks once downloaded
+    mutex_lock(&g_shared->mutex);
+    mutex_lock(&desc->mutex);
+    desc->staging = true;
+    for (i = 0; i < desc->layers_len; i++) {
+        if (!infos[i].use || !infos[i].notified) {
+            continue;
+        }
+        cache = (cached_layer *)map_search(g_shared->cached_layers, infos[i].blob_digest);
+        if (cache != NULL && cache->complete && cache->result == 0) {
+            queue_stage_layer(&infos[i]);
+        }
+    }
+    mutex_unlock(&desc->mutex);
+    mutex_unlock(&g_shared->mutex);
+
+    for (workers = 0; workers < count && workers < STAGE_LAYER_WORKERS; workers++) {
+        if (pthread_create(&tids[workers], NULL, stage_layers_in_thread, infos) != 0) {
+            WARN("Failed to start thread to stage layers of image %s", desc->image_name);
+            break;
+        }
+    }
+
+    if (workers == 0) {
+        stop_stage_layers(desc, tids, 0);
+    }
+
+    return workers;
+}
+
+static void finish_stage_layers(thread_fetch_info *infos, pthread_t *tids, size_t workers)
+{
+    pull_descriptor *desc = infos[0].desc;
+    size_t i = 0;
+
+    stop_stage_layers(desc, tids, workers);
+
+    // staged diffs are moved into layers created, remove the left
+    for (i = 0; i < desc->layers_len; i++) {
+        storage_layer_remove_staged_diff(infos[i].staged_diff);
+        free(infos[i].staged_diff);
+        infos[i].staged_diff = NULL;
+    }
+}
+
 static void *register_layers_in_thread(void *arg)
 {
     thread_fetch_info *infos = (thread_fetch_info *)arg;
@@ -1411,6 +1632,8 @@ static void *register_layers_in_thread(void *arg)
     int cond_ret = 0;
     size_t i = 0;
     struct timespec ts = { 0 };
+    pthread_t stage_tids[STAGE_LAYER_WORKERS] = { 0 };
+    size_t stagers = 0;
 
     ret = pthread_detach(pthread_self());
     if (ret != 0) {
@@ -1420,9 +1643,11 @@ static void *register_layers_in_thread(void *arg)
 
     prctl(PR_SET_NAME, "register_layer");
 
+    stagers = start_stage_layers(infos, stage_tids);
+
     for (i = 0; i < desc->layers_len; i++) {
         mutex_lock(&desc->mutex);
-        while (wait_fetch_complete(&infos[i])) {
+        while (wait_fetch_complete(&infos[i]) || wait_stage_complete(&infos[i])) {
             ts.tv_sec = time(NULL) + DEFAULT_WAIT_TIMEOUT; // avoid wait forever
             cond_ret = pthread_cond_timedwait(&desc->cond, &desc->mutex, &ts);
             if (cond_ret != 0 && cond_ret != ETIMEDOUT) {
@@ -1435,6 +1660,10 @@ static void *register_layers_in_thread(void *arg)
                 continue;
             }
         }
+        // not picked by stagers yet, unpack it when registering rather than waiting for them
+        if (infos[i].stage == LAYER_STAGE_NONE) {
+            infos[i].stage = LAYER_STAGE_DONE;
+        }
         mutex_unlock(&desc->mutex);
 
         if (desc->cancel) {
@@ -1449,7 +1678,7 @@ static void *register_layers_in_thread(void *arg)
         }
 
         // register layer
-        ret = register_layer(desc, i);
+        ret = register_layer(desc, i, infos[i].staged_diff);
         if (ret != 0) {
             ERROR("register layers for image %s failed", desc->image_name);
             isulad_try_set_error_message("register layers failed");
@@ -1466,6 +1695,14 @@ out:
         }
     }
     DAEMON_CLEAR_ERRMSG();
+    mutex_unlock(&g_shared->mutex);
+
+    // infos are freed once register layers completed, stagers must exit before it
+    if (stagers > 0) {
+        finish_stage_layers(infos, stage_tids, stagers);
+    }
+
+    mutex_lock(&g_shared->mutex);
     desc->register_layers_complete = true;
     if (pthread_cond_broadcast(&g_shared->cond)) {
         ERROR("Failed to broadcast");
@@ -1853,6 +2090,7 @@ static int prepare_pull_desc(pull_descriptor *desc, registry_pull_options *optio
     char blobpath[PATH_MAX] = { 0 };
     char scope[PATH_MAX] = { 0 };
     char *image_tmp_path = NULL;
+    char *partial_blobpath = NULL;
     struct oci_image_module_data *oci_image_data = NULL;
 
     if (desc == NULL || options == NULL) {
@@ -1914,6 +2152,14 @@ static int prepare_pull_desc(pull_descriptor *desc, registry_pull_options *optio
         goto out;
     }
 
+    // Downloads can still be done without resume support, so failure is not fatal
+    partial_blobpath = util_path_join(image_tmp_path, REGISTRY_PARTIAL_BLOB_DIR);
+    if (partial_blobpath != NULL && util_mkdir_p(partial_blobpath, TEMP_DIRECTORY_MODE) != 0) {
+        WARN("Failed to create directory %s, downloads will not be resumed", partial_blobpath);
+        free(partial_blobpath);
+        partial_blobpath = NULL;
+    }
+
     sret = snprintf(scope, sizeof(scope), "repository:%s:pull", desc->name);
     if (sret < 0 || (size_t)sret >= sizeof(scope)) {
         ERROR("Failed to sprintf scope");
@@ -1946,6 +2192,8 @@ static int prepare_pull_desc(pull_descriptor *desc, registry_pull_options *optio
     desc->dest_image_name = util_strdup_s(options->dest_image_name);
     desc->scope = util_strdup_s(scope);
     desc->blobpath = util_strdup_s(blobpath);
+    desc->partial_blobpath = partial_blobpath;
+    partial_blobpath = NULL;
     desc->use_decrypted_key = oci_image_data->use_decrypted_key;
     desc->skip_tls_verify = options->skip_tls_verify;
     desc->insecure_registry = options->insecure_registry;
@@ -1967,6 +2215,7 @@ static int prepare_pull_desc(pull_descriptor *desc, registry_pull_options *optio
 
 out:
     free(image_tmp_path);
+    free(partial_blobpath);
     return ret;
 }
 
@@ -2013,6 +2262,18 @@ static void try_rollback_layers(pull_descriptor *desc)
     }
 }
 
+static void log_download_stats(void)
+{
+    download_scheduler_stats stats = { 0 };
+    char *throughput = NULL;
+
+    download_scheduler_get_stats(&stats);
+    throughput = util_human_size(stats.throughput);
+    INFO("Layer downloads: %zu queued, %zu running, %lu completed, throughput %s/s", stats.queued, stats.running,
+         (unsigned long)stats.completed, throughput != NULL ? throughput : "unknown");
+    free(throughput);
+}
+
 int registry_pull(registry_pull_options *options)
 {
     int ret = 0;
@@ -2057,6 +2318,7 @@ int registry_pull(registry_pull_options *options)
     }
 
     INFO("Pull images %s success", options->image_name);
+    log_download_stats();
 
 out:
     if (desc->layer_of_hold_refs != NULL && storage_dec_hold_refs(desc->layer_of_hold_refs) != 0) {
@@ -2141,6 +2403,13 @@ int registry_init(char *auths_dir, char *certs_dir)
         goto out;
     }
 
+    ret = download_scheduler_init(conf_get_max_concurrent_downloads(),
+                                  conf_get_max_concurrent_downloads_per_registry());
+    if (ret != 0) {
+        ERROR("Failed to init layer download scheduler");
+        goto out;
+    }
+
 out:
 
     if (ret != 0) {
@@ -23,6 +23,9 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "registry_type.h"
 #include "isula_libutils/log.h"
@@ -35,6 +38,7 @@
 #include "isula_libutils/registry_manifest_list.h"
 #include "auths.h"
 #include "err_msg.h"
+#include "partial_blob.h"
 #include "sha256.h"
 #include "utils_array.h"
 #include "utils_file.h"
@@ -46,6 +50,7 @@
 // retry 5 times
 #define RETRY_TIMES 5
 #define BODY_DELIMITER "\r\n\r\n"
+#define BLOB_READ_BUF_SIZE (32 * 1024)
 
 static void set_body_null_if_exist(char *message)
 {
@@ -409,7 +414,7 @@ out:
 }
 
 static int registry_request(pull_descriptor *desc, char *path, char **custom_headers, char *file, char **output_buffer,
-                            resp_data_type type, CURLcode *errcode)
+                            resp_data_type type, CURLcode *errcode, write_hook_func hook, void *hook_data)
 {
     int ret = 0;
     int sret = 0;
@@ -457,7 +462,7 @@ static int registry_request(pull_descriptor *desc, char *path, char **custom_hea
         }
         DEBUG("resp=%s", *output_buffer);
     } else {
-        ret = http_request_file(desc, url, (const char **)headers, file, type, errcode);
+        ret = http_request_file(desc, url, (const char **)headers, file, type, errcode, hook, hook_data);
         if (ret != 0) {
             ERROR("http request file failed, url: %s", url);
             goto out;
@@ -679,7 +684,7 @@ static int fetch_manifest_list(pull_descriptor *desc, char *file, char **content
 
     while (retry_times > 0) {
         retry_times--;
-        ret = registry_request(desc, path, custom_headers, file, NULL, HEAD_BODY, &errcode);
+        ret = registry_request(desc, path, custom_headers, file, NULL, HEAD_BODY, &errcode, NULL, NULL);
         if (ret != 0) {
             if (retry_times > 0 && !desc->cancel) {
                 continue;
@@ -730,7 +735,121 @@ static void try_log_resp_body(char *path, char *file)
     return;
 }
 
-static int fetch_data(pull_descriptor *desc, char *path, char *file, char *content_type, char *digest)
+// digests calculated while the blob is being downloaded, so the downloaded
+// file needs not to be read back from disk to verify it.
+typedef struct {
+    sha256_stream *digest;
+    // digest of the uncompressed data, only calculated if required
+    sha256_stream *diff_id;
+} blob_stream;
+
+static int blob_stream_write_hook(void *p, const void *data, size_t len)
+{
+    blob_stream *stream = (blob_stream *)p;
+
+    // failure of digest stream is not fatal, digest will be calculated
+    // from the downloaded file instead in that case.
+    if (stream->digest != NULL) {
+        (void)sha256_stream_update(stream->digest, data, len);
+    }
+    if (stream->diff_id != NULL) {
+        (void)sha256_stream_update(stream->diff_id, data, len);
+    }
+
+    return 0;
+}
+
+static void blob_stream_release(blob_stream *stream)
+{
+    sha256_stream_free(stream->digest);
+    stream->digest = NULL;
+    sha256_stream_free(stream->diff_id);
+    stream->diff_id = NULL;
+}
+
+static void blob_stream_reset(blob_stream *stream, bool calc_diff_id)
+{
+    blob_stream_release(stream);
+    stream->digest = sha256_stream_new(false);
+    if (calc_diff_id) {
+        stream->diff_id = sha256_stream_new(true);
+    }
+}
+
+// Feed data downloaded by a former pull to the digests, so the download
+// can continue from the end of file without reading it back afterwards.
+static int blob_stream_load_file(blob_stream *stream, const char *file)
+{
+    int ret = 0;
+    int fd = -1;
+    ssize_t size = 0;
+    char buf[BLOB_READ_BUF_SIZE];
+
+    fd = util_open(file, O_RDONLY, 0);
+    if (fd < 0) {
+        ERROR("Failed to open %s: %s", file, strerror(errno));
+        return -1;
+    }
+
+    for (;;) {
+        size = util_read_nointr(fd, buf, sizeof(buf));
+        if (size <= 0) {
+            break;
+        }
+        (void)blob_stream_write_hook(stream, buf, (size_t)size);
+    }
+    if (size < 0) {
+        ERROR("Failed to read %s: %s", file, strerror(errno));
+        ret = -1;
+    }
+
+    close(fd);
+    return ret;
+}
+
+// Get the digest calculated while downloading. Return NULL if it does not cover
+// the whole file, for example some data failed to be flushed before resume.
+static char *blob_stream_digest(sha256_stream *stream, const char *file)
+{
+    int64_t fsize = 0;
+
+    if (stream == NULL) {
+        return NULL;
+    }
+
+    fsize = util_file_size(file);
+    if (fsize < 0 || (uint64_t)fsize != sha256_stream_size(stream)) {
+        return NULL;
+    }
+
+    return sha256_stream_full_digest(stream);
+}
+
+static bool blob_stream_valid_digest(blob_stream *stream, const char *file, const char *digest)
+{
+    char *stream_digest = NULL;
+    bool valid = false;
+
+    stream_digest = blob_stream_digest(stream->digest, file);
+    if (stream_digest == NULL) {
+        DEBUG("digest of %s not calculated while downloading, calculate it from file", file);
+        return sha256_valid_digest_file(file, digest);
+    }
+
+    valid = (strcmp(stream_digest, digest) == 0);
+    if (!valid) {
+        ERROR("file %s digest %s not match %s", file, stream_digest, digest);
+    }
+    free(stream_digest);
+
+    return valid;
+}
+
+// diff_id can be NULL, if set, digest of uncompressed data is returned if it's
+// calculated while downloading, caller need to calculate it from file if not.
+// If resume is true, file already has part of the data and only the rest is requested.
+static int fetch_data(pull_descriptor *desc, char *path, char *file, char *content_type, char *digest,
+                      char **diff_id, bool resume)
 {
     int ret = 0;
     int sret = 0;
@@ -739,7 +858,9 @@ static int fetch_data(pull_descriptor *desc, char *path, char *file, char *conte
     int retry_times = RETRY_TIMES;
     resp_data_type type = BODY_ONLY;
     bool forbid_resume = false;
+    bool verify = false;
     CURLcode errcode = CURLE_OK;
+    blob_stream stream = { 0 };
 
     // digest can be NULL
     if (desc == NULL || path == NULL || file == NULL || content_type == NULL) {
@@ -747,6 +868,9 @@ static int fetch_data(pull_descriptor *desc, char *path, char *file, char *conte
         return -1;
     }
 
+    // If content is signatured, digest is for payload but not fetched data
+    verify = (strcmp(content_type, DOCKER_MANIFEST_SCHEMA1_PRETTYJWS) && digest != NULL);
+
     sret = snprintf(accept, MAX_ACCEPT_LEN, "Accept: %s", content_type);
     if (sret < 0 || (size_t)sret >= MAX_ACCEPT_LEN) {
         ERROR("Failed to sprintf accept media type %s", content_type);
@@ -760,9 +884,27 @@ static int fetch_data(pull_descriptor *desc, char *path, char *file, char *conte
         goto out;
     }
 
+    if (resume) {
+        type = RESUME_BODY;
+        if (verify) {
+            blob_stream_reset(&stream, diff_id != NULL);
+            if (blob_stream_load_file(&stream, file) != 0) {
+                WARN("Failed to digest partial data in %s, download from the beginning", file);
+                type = BODY_ONLY;
+            }
+        }
+    }
+
     while (retry_times > 0) {
         retry_times--;
-        ret = registry_request(desc, path, custom_headers, file, NULL, type, &errcode);
+        // file is truncated if not resume, digest it from the beginning.
+        // Resumed data is appended to the stream, its size is checked
+        // against file size before the digest is used.
+        if (verify && type == BODY_ONLY) {
+            blob_stream_reset(&stream, diff_id != NULL);
+        }
+        ret = registry_request(desc, path, custom_headers, file, NULL, type, &errcode,
+                               verify ? blob_stream_write_hook : NULL, &stream);
         if (ret != 0) {
             if (errcode == CURLE_RANGE_ERROR) {
                 forbid_resume = true;
@@ -780,25 +922,30 @@ static int fetch_data(pull_descriptor *desc, char *path, char *file, char *conte
             goto out;
         }
 
-        // If content is signatured, digest is for payload but not fetched data
-        if (strcmp(content_type, DOCKER_MANIFEST_SCHEMA1_PRETTYJWS) && digest != NULL) {
-            if (!sha256_valid_digest_file(file, digest)) {
+        if (verify) {
+            if (!blob_stream_valid_digest(&stream, file, digest)) {
                 type = BODY_ONLY;
                 if (retry_times > 0 && !desc->cancel) {
                     continue;
                 }
                 ret = -1;
                 try_log_resp_body(path, file);
+                // invalid data must not be kept to resume from
+                (void)util_path_remove(file);
                 ERROR("data from %s does not have digest %s", path, digest);
                 isulad_try_set_error_message("Invalid data fetched for %s, this mainly caused by server error", path);
                 desc->cancel = true;
                 goto out;
             }
+            if (diff_id != NULL) {
+                *diff_id = blob_stream_digest(stream.diff_id, file);
+            }
         }
         break;
     }
 
 out:
+    blob_stream_release(&stream);
     util_free_array(custom_headers);
     custom_headers = NULL;
 
@@ -1019,7 +1166,7 @@ static int fetch_manifest_data(pull_descriptor *desc, char *file, char **content
             goto out;
         }
 
-        ret = fetch_data(desc, path, file, *content_type, *digest);
+        ret = fetch_data(desc, path, file, *content_type, *digest, NULL, false);
         if (ret != 0) {
             ERROR("registry: Get %s failed", path);
             goto out;
@@ -1100,7 +1247,7 @@ int fetch_config(pull_descriptor *desc)
         goto out;
     }
 
-    ret = fetch_data(desc, path, file, desc->config.media_type, desc->config.digest);
+    ret = fetch_data(desc, path, file, desc->config.media_type, desc->config.digest, NULL, false);
     if (ret != 0) {
         ERROR("registry: Get %s failed", path);
         goto out;
@@ -1113,12 +1260,14 @@ out:
     return ret;
 }
 
-int fetch_layer(pull_descriptor *desc, size_t index)
+int fetch_layer(pull_descriptor *desc, size_t index, char **diff_id)
 {
     int ret = 0;
     int sret = 0;
     char file[PATH_MAX] = { 0 };
     char path[PATH_MAX] = { 0 };
+    char *partial = NULL;
+    bool resume = false;
     layer_blob *layer = NULL;
 
     if (desc == NULL) {
@@ -1145,13 +1294,17 @@ int fetch_layer(pull_descriptor *desc, size_t index)
         goto out;
     }
 
-    ret = fetch_data(desc, path, file, layer->media_type, layer->digest);
+    partial = partial_blob_path(desc->partial_blobpath, layer->digest);
+    resume = partial_blob_restore(partial, file, layer->size);
+    ret = fetch_data(desc, path, file, layer->media_type, layer->digest, diff_id, resume);
     if (ret != 0) {
         ERROR("registry: Get %s failed", path);
+        partial_blob_save(desc->partial_blobpath, file, partial);
         goto out;
     }
 
 out:
+    free(partial);
 
     return ret;
 }
@@ -1211,7 +1364,7 @@ int login_to_registry(pull_descriptor *desc)
         goto out;
     }
 
-    ret = registry_request(desc, path, NULL, NULL, &resp_buffer, HEAD_BODY, &errcode);
+    ret = registry_request(desc, path, NULL, NULL, &resp_buffer, HEAD_BODY, &errcode, NULL, NULL);
     if (ret != 0) {
         ERROR("registry: Get %s failed, resp: %s", path, resp_buffer);
         isulad_try_set_error_message("login to registry for %s failed", desc->host);
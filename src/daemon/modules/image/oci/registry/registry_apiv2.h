@@ -27,7 +27,9 @@ int fetch_manifest(pull_descriptor *desc);
 
 int fetch_config(pull_descriptor *desc);
 
-int fetch_layer(pull_descriptor *desc, size_t index);
+// diff_id can be NULL, if set, digest of uncompressed layer is returned if it can be
+// calculated while downloading, otherwise *diff_id is left NULL.
+int fetch_layer(pull_descriptor *desc, size_t index, char **diff_id);
 
 int login_to_registry(pull_descriptor *desc);
 
@@ -99,6 +99,8 @@ void free_pull_desc(pull_descriptor *desc)
 
     free(desc->blobpath);
     desc->blobpath = NULL;
+    free(desc->partial_blobpath);
+    desc->partial_blobpath = NULL;
     free(desc->protocol);
     desc->protocol = NULL;
     desc->skip_tls_verify = false;
@@ -141,6 +143,11 @@ void free_pull_desc(pull_descriptor *desc)
     free(desc->layer_of_hold_refs);
     desc->layer_of_hold_refs = NULL;
 
+    free(desc->stage_queue);
+    desc->stage_queue = NULL;
+    desc->stage_queue_head = 0;
+    desc->stage_queue_len = 0;
+
     if (desc->cond_inited) {
         pthread_cond_destroy(&desc->cond);
     }
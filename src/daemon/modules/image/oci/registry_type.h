@@ -101,6 +101,8 @@ typedef struct {
     char *errmsg;
 
     char *blobpath;
+    // partial blobs of failed downloads, shared by pulls to resume downloading
+    char *partial_blobpath;
     char *protocol;
     bool skip_tls_verify;
     bool insecure_registry;
@@ -129,6 +131,12 @@ typedef struct {
     bool mutex_inited;
     pthread_cond_t cond;
     bool cond_inited;
+    // indexes of downloaded layers queued for stagers in the order downloads complete, protected by mutex
+    size_t *stage_queue;
+    size_t stage_queue_head;
+    size_t stage_queue_len;
+    // stagers are running, layers are queued only while it is set
+    bool staging;
 #ifdef ENABLE_IMAGE_SEARCH
     //used to search image
     char *search_name;
@@ -49,6 +49,7 @@
 #include "image_type.h"
 #include "linked_list.h"
 #include "utils_verify.h"
+#include "util_atomic.h"
 #ifdef ENABLE_REMOTE_LAYER_STORE
 #include "ro_symlink_maintain.h"
 #endif
@@ -62,12 +63,35 @@
 #define MAX_IMAGE_NAME_LENGTH 72
 #define DIGEST_PREFIX "@sha256:"
 #define MAX_IMAGE_DIGEST_LENGTH 64
+// max number of cached image info
+#define IMAGE_INFO_CACHE_SIZE 64
 
 typedef struct digest_image {
     struct linked_list images_list;
     size_t images_list_len;
 } digest_image_t;
 
+// Read-only view of an image, shared by snapshots until the image is changed.
+typedef struct image_view {
+    uint64_t refcnt;
+    char *id;
+    // NULL if failed to pack summary of the image
+    imagetool_image_summary *summary;
+} image_view_t;
+
+// Immutable indexes of all images. Writers publish a new snapshot once the
+// store is changed, read-only operations work on a reference of the published
+// snapshot without holding the store lock, so they never block writers.
+typedef struct image_store_snapshot {
+    uint64_t refcnt;
+    image_view_t **views;
+    size_t views_len;
+    // id/name/digest -> image_view_t
+    map_t *byid;
+    map_t *byname;
+    map_t *bydigest;
+} image_store_snapshot_t;
+
 typedef struct image_store {
     pthread_rwlock_t rwlock;
     char *dir;
@@ -77,6 +101,21 @@ typedef struct image_store {
     map_t *byname;
     map_t *bydigest;
 
+    // ids of images changed since the snapshot was published, protected by rwlock
+    map_t *changed_ids;
+    pthread_mutex_t snapshot_mutex;
+    bool snapshot_mutex_inited;
+    image_store_snapshot_t *snapshot;
+
+    // id -> node of info_lru whose elem is image_info_ref, the least recently used
+    // info is at the head of info_lru, protected by info_cache_mutex
+    pthread_mutex_t info_cache_mutex;
+    bool info_cache_mutex_inited;
+    map_t *info_cache;
+    struct linked_list info_lru;
+    uint64_t info_cache_hits;
+    uint64_t info_cache_misses;
+
     bool loaded;
 } image_store_t;
 
@@ -84,6 +123,12 @@ enum lock_type { SHARED = 0, EXCLUSIVE };
 
 image_store_t *g_image_store = NULL;
 
+static void publish_image_store_snapshot(void);
+static void drop_image_store_snapshot(void);
+static image_store_snapshot_t *get_image_store_snapshot(void);
+static image_view_t *snapshot_lookup(const image_store_snapshot_t *snapshot, const char *id);
+static void invalidate_image_info(const char *id);
+
 static inline bool image_store_lock(enum lock_type type)
 {
     int nret = 0;
@@ -105,12 +150,63 @@ static inline void image_store_unlock()
 {
     int nret = 0;
 
+    // changed_ids is only updated by writers, so it is empty for readers
+    if (map_size(g_image_store->changed_ids) != 0) {
+        publish_image_store_snapshot();
+    }
+
     nret = pthread_rwlock_unlock(&g_image_store->rwlock);
     if (nret != 0) {
         FATAL("Unlock memory store failed: %s", strerror(nret));
     }
 }
 
+// called with exclusive lock held, the snapshot is republished when the lock is released
+static void mark_image_changed(const char *id)
+{
+    bool changed = true;
+
+    if (!map_replace(g_image_store->changed_ids, (void *)id, (void *)&changed)) {
+        // view of the image must not be reused, readers rebuild the snapshot instead
+        ERROR("Failed to mark image %s changed", id);
+        drop_image_store_snapshot();
+    }
+    // tags, repo digests and load time of the info are derived from the image record
+    invalidate_image_info(id);
+}
+
+static void image_view_ref_dec(image_view_t *view)
+{
+    if (view == NULL || !atomic_int_dec_test(&view->refcnt)) {
+        return;
+    }
+
+    free(view->id);
+    free_imagetool_image_summary(view->summary);
+    free(view);
+}
+
+static void free_image_store_snapshot(image_store_snapshot_t *snapshot)
+{
+    size_t i;
+
+    map_free(snapshot->byid);
+    map_free(snapshot->byname);
+    map_free(snapshot->bydigest);
+    for (i = 0; i < snapshot->views_len; i++) {
+        image_view_ref_dec(snapshot->views[i]);
+    }
+    free(snapshot->views);
+    free(snapshot);
+}
+
+static void snapshot_ref_dec(image_store_snapshot_t *snapshot)
+{
+    if (snapshot != NULL && atomic_int_dec_test(&snapshot->refcnt)) {
+        free_image_store_snapshot(snapshot);
+    }
+}
+
 static void free_image_store(image_store_t *store)
 {
     struct linked_list *item = NULL;
@@ -132,6 +228,21 @@ static void free_image_store(image_store_t *store)
     (void)map_free(store->bydigest);
     store->bydigest = NULL;
 
+    (void)map_free(store->changed_ids);
+    store->changed_ids = NULL;
+
+    snapshot_ref_dec(store->snapshot);
+    store->snapshot = NULL;
+    if (store->snapshot_mutex_inited) {
+        (void)pthread_mutex_destroy(&store->snapshot_mutex);
+    }
+
+    (void)map_free(store->info_cache);
+    store->info_cache = NULL;
+    if (store->info_cache_mutex_inited) {
+        (void)pthread_mutex_destroy(&store->info_cache_mutex);
+    }
+
     linked_list_for_each_safe(item, &(store->images_list), next) {
         linked_list_del(item);
         image_ref_dec((image_t *)item->elem);
@@ -156,6 +267,18 @@ static void image_store_field_kvfree(void *key, void *value)
     free(key);
 }
 
+static void image_info_cache_kvfree(void *key, void *value)
+{
+    struct linked_list *node = (struct linked_list *)value;
+
+    free(key);
+    if (node != NULL) {
+        linked_list_del(node);
+        image_store_put_image_ref((image_info_ref *)node->elem);
+        free(node);
+    }
+}
+
 static void image_store_digest_field_kvfree(void *key, void *value)
 {
     digest_image_t *val = (digest_image_t *)value;
@@ -233,6 +356,8 @@ static int remove_name(image_t *img, const char *name)
         return 0;
     }
 
+    mark_image_changed(img->simage->id);
+
     for (i = 0; i < img->simage->names_len; i++) {
         if (strcmp(img->simage->names[i], name) == 0) {
             count++;
@@ -402,14 +527,15 @@ out:
     return im;
 }
 
-static image_t *get_image_for_store_by_prefix(const char *id)
+// search value of the only key in byid with prefix id, works for snapshot too
+static void *search_by_id_prefix(const map_t *byid, const char *id)
 {
     bool ret = true;
-    image_t *value = NULL;
+    void *value = NULL;
     map_itor *itor = NULL;
     const char *key = NULL;
 
-    itor = map_itor_new(g_image_store->byid);
+    itor = map_itor_new(byid);
     if (itor == NULL) {
         ERROR("Failed to get byid's iterator from image store");
         return NULL;
@@ -442,18 +568,29 @@ out:
     return value;
 }
 
+// split digest for image name with digest, return NULL if name has no valid digest
+static const char *digest_of_name(const char *name)
+{
+    const char *digest = NULL;
+
+    digest = strrchr(name, '@');
+    if (digest == NULL || util_reg_match(__DIGESTPattern, digest)) {
+        return NULL;
+    }
+
+    return digest + 1;
+}
+
 // by_digest returns the image which matches the specified name.
 static image_t *by_digest(const char *name)
 {
     digest_image_t *digest_filter_images = NULL;
-    char *digest = NULL;
-    
-    // split digest for image name with digest
-    digest = strrchr(name, '@');
-    if (digest == NULL || util_reg_match(__DIGESTPattern, digest)) {
+    const char *digest = NULL;
+
+    digest = digest_of_name(name);
+    if (digest == NULL) {
         return NULL;
     }
-    digest++;
     digest_filter_images = (digest_image_t *)map_search(g_image_store->bydigest, (void *)digest);
     if (digest_filter_images == NULL) {
         return NULL;
@@ -482,7 +619,7 @@ static image_t *lookup(const char *id)
         goto found;
     }
 
-    value = get_image_for_store_by_prefix(id);
+    value = search_by_id_prefix(g_image_store->byid, id);
     if (value != NULL) {
         goto found;
     }
@@ -620,6 +757,7 @@ static int remove_image_from_memory(const char *id)
         g_image_store->images_list_len--;
         break;
     }
+    mark_image_changed(id);
 
 out:
     free(digest);
@@ -800,6 +938,7 @@ static int image_store_append_image(const char *id, const char *searchable_diges
         }
     }
 
+    mark_image_changed(id);
     return 0;
 
 err_out:
@@ -920,7 +1059,8 @@ out:
 char *image_store_lookup(const char *id)
 {
     char *image_id = NULL;
-    image_t *img = NULL;
+    image_store_snapshot_t *snapshot = NULL;
+    image_view_t *view = NULL;
 
     if (id == NULL) {
         ERROR("Invalid input parameter, id is NULL");
@@ -932,22 +1072,22 @@ char *image_store_lookup(const char *id)
         return NULL;
     }
 
-    if (!image_store_lock(SHARED)) {
-        ERROR("Failed to lock image store with shared lock, not allowed to get image id assignments");
+    snapshot = get_image_store_snapshot();
+    if (snapshot == NULL) {
+        ERROR("Failed to get image store snapshot, not allowed to get image id assignments");
         return NULL;
     }
 
-    img = lookup(id);
-    if (img == NULL) {
+    view = snapshot_lookup(snapshot, id);
+    if (view == NULL) {
         ERROR("Image not known");
         goto out;
     }
 
-    image_id = util_strdup_s(img->simage->id);
+    image_id = util_strdup_s(view->id);
 
 out:
-    image_ref_dec(img);
-    image_store_unlock();
+    snapshot_ref_dec(snapshot);
     return image_id;
 }
 
@@ -1227,6 +1367,7 @@ int image_store_set_big_data(const char *id, const char *key, const char *data)
         goto out;
     }
 
+    mark_image_changed(image_id);
     if (update_image_with_big_data(img, key, data, &save) != 0) {
         ERROR("Failed to update image big data");
         ret = -1;
@@ -1354,6 +1495,7 @@ int image_store_add_name(const char *id, const char *name)
         }
     }
 
+    mark_image_changed(img->simage->id);
     util_free_array_by_len(img->simage->names, img->simage->names_len);
     img->simage->names = unique_names;
     img->simage->names_len = unique_names_len;
@@ -1439,6 +1581,7 @@ int image_store_set_names(const char *id, const char **names, size_t names_len)
         }
     }
 
+    mark_image_changed(img->simage->id);
     util_free_array_by_len(img->simage->names, img->simage->names_len);
     img->simage->names = unique_names;
     img->simage->names_len = unique_names_len;
@@ -1534,6 +1677,7 @@ int image_store_set_metadata(const char *id, const char *metadata)
         goto out;
     }
 
+    mark_image_changed(img->simage->id);
     free(img->simage->metadata);
     img->simage->metadata = util_strdup_s(metadata);
     if (save_image(img->simage) != 0) {
@@ -1582,6 +1726,7 @@ int image_store_set_load_time(const char *id, const types_timestamp_t *time)
         goto out;
     }
 
+    mark_image_changed(img->simage->id);
     free(img->simage->loaded);
     img->simage->loaded = util_strdup_s(timebuffer);
     if (save_image(img->simage) != 0) {
@@ -1598,7 +1743,7 @@ out:
 bool image_store_exists(const char *id)
 {
     bool ret = true;
-    image_t *img = NULL;
+    image_store_snapshot_t *snapshot = NULL;
 
     if (id == NULL) {
         ERROR("Invalid paratemer, id is NULL");
@@ -1610,21 +1755,18 @@ bool image_store_exists(const char *id)
         return false;
     }
 
-    if (!image_store_lock(SHARED)) {
-        ERROR("Failed to lock image store with shared lock, not allowed to get image exist info");
+    snapshot = get_image_store_snapshot();
+    if (snapshot == NULL) {
+        ERROR("Failed to get image store snapshot, not allowed to get image exist info");
         return false;
     }
 
-    img = lookup(id);
-    if (img == NULL) {
+    if (snapshot_lookup(snapshot, id) == NULL) {
         ERROR("Image %s not known", id);
         ret = false;
-        goto out;
     }
 
-out:
-    image_ref_dec(img);
-    image_store_unlock();
+    snapshot_ref_dec(snapshot);
     return ret;
 }
 
@@ -1982,6 +2124,7 @@ int image_store_set_image_size(const char *id, uint64_t size)
         goto out;
     }
 
+    mark_image_changed(img->simage->id);
     img->simage->size = size;
     if (save_image(img->simage) != 0) {
         ERROR("Failed to save image");
@@ -2597,6 +2740,302 @@ out:
     return info;
 }
 
+static image_view_t *new_image_view(image_t *img)
+{
+    image_view_t *view = NULL;
+
+    view = util_common_calloc_s(sizeof(image_view_t));
+    if (view == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    atomic_int_set(&view->refcnt, 1);
+    view->id = util_strdup_s(img->simage->id);
+    view->summary = get_image_summary(img);
+    if (view->summary == NULL) {
+        ERROR("Failed to get summary info of image: %s", img->simage->id);
+    }
+
+    return view;
+}
+
+static int snapshot_add_view(image_store_snapshot_t *snapshot, const image_store_snapshot_t *old, image_t *img)
+{
+    image_view_t *view = NULL;
+
+    if (old != NULL && map_search(g_image_store->changed_ids, (void *)img->simage->id) == NULL) {
+        view = map_search(old->byid, (void *)img->simage->id);
+    }
+    // retry to pack summary which failed last time
+    if (view != NULL && view->summary != NULL) {
+        atomic_int_inc(&view->refcnt);
+    } else {
+        view = new_image_view(img);
+        if (view == NULL) {
+            return -1;
+        }
+    }
+    snapshot->views[snapshot->views_len++] = view;
+
+    if (!map_insert(snapshot->byid, (void *)view->id, (void *)view)) {
+        ERROR("Failed to insert image %s to snapshot", view->id);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int snapshot_index_names(image_store_snapshot_t *snapshot)
+{
+    int ret = 0;
+    map_itor *itor = NULL;
+    image_t *img = NULL;
+    image_view_t *view = NULL;
+
+    itor = map_itor_new(g_image_store->byname);
+    if (itor == NULL) {
+        ERROR("Failed to get byname's iterator from image store");
+        return -1;
+    }
+
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        img = map_itor_value(itor);
+        view = map_search(snapshot->byid, (void *)img->simage->id);
+        if (view != NULL && !map_insert(snapshot->byname, map_itor_key(itor), (void *)view)) {
+            ERROR("Failed to insert image name to snapshot");
+            ret = -1;
+            break;
+        }
+    }
+
+    map_itor_free(itor);
+    return ret;
+}
+
+static int snapshot_index_digests(image_store_snapshot_t *snapshot)
+{
+    int ret = 0;
+    map_itor *itor = NULL;
+    digest_image_t *digest_images = NULL;
+    image_t *img = NULL;
+    image_view_t *view = NULL;
+
+    itor = map_itor_new(g_image_store->bydigest);
+    if (itor == NULL) {
+        ERROR("Failed to get bydigest's iterator from image store");
+        return -1;
+    }
+
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        digest_images = map_itor_value(itor);
+        // currently, a digest corresponds to an image, same as by_digest
+        img = linked_list_first_elem(&(digest_images->images_list));
+        if (img == NULL) {
+            continue;
+        }
+        view = map_search(snapshot->byid, (void *)img->simage->id);
+        if (view != NULL && !map_insert(snapshot->bydigest, map_itor_key(itor), (void *)view)) {
+            ERROR("Failed to insert image digest to snapshot");
+            ret = -1;
+            break;
+        }
+    }
+
+    map_itor_free(itor);
+    return ret;
+}
+
+// build snapshot of the store, views of images not changed are reused from old,
+// called with store lock held
+static image_store_snapshot_t *build_image_store_snapshot(const image_store_snapshot_t *old)
+{
+    image_store_snapshot_t *snapshot = NULL;
+    struct linked_list *item = NULL;
+    struct linked_list *next = NULL;
+
+    snapshot = util_common_calloc_s(sizeof(image_store_snapshot_t));
+    if (snapshot == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    atomic_int_set(&snapshot->refcnt, 1);
+
+    snapshot->byid = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, image_store_field_kvfree);
+    snapshot->byname = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, image_store_field_kvfree);
+    snapshot->bydigest = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, image_store_field_kvfree);
+    if (snapshot->byid == NULL || snapshot->byname == NULL || snapshot->bydigest == NULL) {
+        ERROR("Out of memory");
+        goto err_out;
+    }
+
+    if (g_image_store->images_list_len != 0) {
+        snapshot->views = util_smart_calloc_s(sizeof(image_view_t *), g_image_store->images_list_len);
+        if (snapshot->views == NULL) {
+            ERROR("Out of memory");
+            goto err_out;
+        }
+    }
+
+    linked_list_for_each_safe(item, &(g_image_store->images_list), next) {
+        if (snapshot_add_view(snapshot, old, (image_t *)item->elem) != 0) {
+            goto err_out;
+        }
+    }
+
+    if (snapshot_index_names(snapshot) != 0 || snapshot_index_digests(snapshot) != 0) {
+        goto err_out;
+    }
+
+    return snapshot;
+
+err_out:
+    free_image_store_snapshot(snapshot);
+    return NULL;
+}
+
+static void replace_image_store_snapshot(image_store_snapshot_t *snapshot)
+{
+    image_store_snapshot_t *old = NULL;
+
+    (void)pthread_mutex_lock(&g_image_store->snapshot_mutex);
+    old = g_image_store->snapshot;
+    g_image_store->snapshot = snapshot;
+    (void)pthread_mutex_unlock(&g_image_store->snapshot_mutex);
+
+    snapshot_ref_dec(old);
+}
+
+// called with exclusive lock held, after the store is changed
+static void publish_image_store_snapshot(void)
+{
+    image_store_snapshot_t *snapshot = NULL;
+
+    // only writers replace the snapshot, so it is safe to read it without snapshot mutex
+    snapshot = build_image_store_snapshot(g_image_store->snapshot);
+    if (snapshot == NULL) {
+        WARN("Failed to build image store snapshot, it will be rebuilt by readers");
+    }
+    map_clear(g_image_store->changed_ids);
+    replace_image_store_snapshot(snapshot);
+}
+
+static void drop_image_store_snapshot(void)
+{
+    map_clear(g_image_store->changed_ids);
+    replace_image_store_snapshot(NULL);
+}
+
+// Get a reference of the published snapshot, caller should call snapshot_ref_dec
+// after use. Build one if it was not published because of failure.
+static image_store_snapshot_t *get_image_store_snapshot(void)
+{
+    image_store_snapshot_t *snapshot = NULL;
+
+    (void)pthread_mutex_lock(&g_image_store->snapshot_mutex);
+    snapshot = g_image_store->snapshot;
+    if (snapshot != NULL) {
+        atomic_int_inc(&snapshot->refcnt);
+    }
+    (void)pthread_mutex_unlock(&g_image_store->snapshot_mutex);
+
+    if (snapshot != NULL) {
+        return snapshot;
+    }
+
+    if (!image_store_lock(SHARED)) {
+        ERROR("Failed to lock image store with shared lock, not allowed to build image store snapshot");
+        return NULL;
+    }
+
+    snapshot = build_image_store_snapshot(NULL);
+    if (snapshot != NULL) {
+        (void)pthread_mutex_lock(&g_image_store->snapshot_mutex);
+        // writers are blocked by shared lock, but other readers may have published one
+        if (g_image_store->snapshot == NULL) {
+            atomic_int_inc(&snapshot->refcnt);
+            g_image_store->snapshot = snapshot;
+        }
+        (void)pthread_mutex_unlock(&g_image_store->snapshot_mutex);
+    }
+
+    image_store_unlock();
+    return snapshot;
+}
+
+// same as lookup, but search in snapshot
+static image_view_t *snapshot_lookup(const image_store_snapshot_t *snapshot, const char *id)
+{
+    image_view_t *view = NULL;
+    const char *digest = NULL;
+
+    view = map_search(snapshot->byid, (void *)id);
+    if (view != NULL) {
+        return view;
+    }
+
+    view = map_search(snapshot->byname, (void *)id);
+    if (view != NULL) {
+        return view;
+    }
+
+    view = search_by_id_prefix(snapshot->byid, id);
+    if (view != NULL) {
+        return view;
+    }
+
+    digest = digest_of_name(id);
+    if (digest != NULL) {
+        return map_search(snapshot->bydigest, (void *)digest);
+    }
+
+    return NULL;
+}
+
+static imagetool_image_summary *dup_image_summary(const imagetool_image_summary *src)
+{
+    imagetool_image_summary *dst = NULL;
+
+    dst = util_common_calloc_s(sizeof(imagetool_image_summary));
+    if (dst == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    dst->id = util_strdup_s(src->id);
+    dst->repo_tags = util_str_array_dup((const char **)src->repo_tags, src->repo_tags_len);
+    dst->repo_tags_len = dst->repo_tags != NULL ? src->repo_tags_len : 0;
+    dst->repo_digests = util_str_array_dup((const char **)src->repo_digests, src->repo_digests_len);
+    dst->repo_digests_len = dst->repo_digests != NULL ? src->repo_digests_len : 0;
+    dst->size = src->size;
+    dst->username = util_strdup_s(src->username);
+    dst->created = util_strdup_s(src->created);
+    dst->loaded = util_strdup_s(src->loaded);
+    dst->top_layer = util_strdup_s(src->top_layer);
+
+    if (src->uid != NULL) {
+        dst->uid = util_common_calloc_s(sizeof(imagetool_image_summary_uid));
+        if (dst->uid == NULL) {
+            ERROR("Out of memory");
+            goto err_out;
+        }
+        dst->uid->value = src->uid->value;
+    }
+
+    if (src->labels != NULL) {
+        dst->labels = util_common_calloc_s(sizeof(json_map_string_string));
+        if (dst->labels == NULL || dup_json_map_string_string(src->labels, dst->labels) != 0) {
+            ERROR("Failed to dup image labels");
+            goto err_out;
+        }
+    }
+
+    return dst;
+
+err_out:
+    free_imagetool_image_summary(dst);
+    return NULL;
+}
+
 imagetool_image *image_store_get_image(const char *id)
 {
     image_t *img = NULL;
@@ -2635,21 +3074,77 @@ unlock:
     return imginfo;
 }
 
-imagetool_image_summary *image_store_get_image_summary(const char *id)
+void image_store_put_image_ref(image_info_ref *ref)
 {
-    image_t *img = NULL;
-    imagetool_image_summary *img_summary = NULL;
+    if (ref == NULL || !atomic_int_dec_test(&ref->refcnt)) {
+        return;
+    }
 
-    if (id == NULL) {
-        ERROR("Invalid paratemer, id is NULL");
-        return NULL;
+    free_imagetool_image(ref->info);
+    free(ref);
+}
+
+static void invalidate_image_info(const char *id)
+{
+    (void)pthread_mutex_lock(&g_image_store->info_cache_mutex);
+    if (map_search(g_image_store->info_cache, (void *)id) != NULL) {
+        (void)map_remove(g_image_store->info_cache, (void *)id);
     }
+    (void)pthread_mutex_unlock(&g_image_store->info_cache_mutex);
+}
 
-    if (g_image_store == NULL) {
-        ERROR("Image store is not ready");
+// called with info cache mutex held
+static image_info_ref *info_cache_get(const char *id)
+{
+    struct linked_list *node = NULL;
+    image_info_ref *ref = NULL;
+
+    node = map_search(g_image_store->info_cache, (void *)id);
+    if (node == NULL) {
         return NULL;
     }
 
+    linked_list_del(node);
+    linked_list_add_tail(&g_image_store->info_lru, node);
+    ref = (image_info_ref *)node->elem;
+    atomic_int_inc(&ref->refcnt);
+    return ref;
+}
+
+// called with info cache mutex held, the cache holds a reference of ref
+static void info_cache_add(const char *id, image_info_ref *ref)
+{
+    struct linked_list *node = NULL;
+    struct linked_list *oldest = NULL;
+
+    node = util_common_calloc_s(sizeof(struct linked_list));
+    if (node == NULL) {
+        ERROR("Out of memory");
+        return;
+    }
+
+    linked_list_add_elem(node, ref);
+    linked_list_add_tail(&g_image_store->info_lru, node);
+    atomic_int_inc(&ref->refcnt);
+    if (!map_insert(g_image_store->info_cache, (void *)id, node)) {
+        ERROR("Failed to cache info of image %s", id);
+        image_info_cache_kvfree(NULL, node);
+        return;
+    }
+
+    while (map_size(g_image_store->info_cache) > IMAGE_INFO_CACHE_SIZE) {
+        oldest = linked_list_first_node(&g_image_store->info_lru);
+        (void)map_remove(g_image_store->info_cache, (void *)((image_info_ref *)oldest->elem)->info->id);
+    }
+}
+
+// build the info with shared lock held, so it can not be invalidated before it is cached
+static image_info_ref *new_image_info_ref(const char *id)
+{
+    image_t *img = NULL;
+    image_info_ref *ref = NULL;
+    image_info_ref *cached = NULL;
+
     if (!image_store_lock(SHARED)) {
         ERROR("Failed to lock image store with shared lock, not allowed to get the known image");
         return NULL;
@@ -2661,23 +3156,141 @@ imagetool_image_summary *image_store_get_image_summary(const char *id)
         goto unlock;
     }
 
-    img_summary = get_image_summary(img);
-    if (img_summary == NULL) {
-        ERROR("Failed to get summary of image %s", img->simage->id);
+    ref = util_common_calloc_s(sizeof(image_info_ref));
+    if (ref == NULL) {
+        ERROR("Out of memory");
+        goto unlock;
+    }
+    ref->refcnt = 1;
+    ref->info = get_image_info(img);
+    if (ref->info == NULL) {
+        ERROR("Failed to get detail info of image: %s", img->simage->id);
+        free(ref);
+        ref = NULL;
         goto unlock;
     }
 
+    (void)pthread_mutex_lock(&g_image_store->info_cache_mutex);
+    // other readers may have cached one
+    cached = info_cache_get(img->simage->id);
+    if (cached == NULL) {
+        info_cache_add(img->simage->id, ref);
+    }
+    (void)pthread_mutex_unlock(&g_image_store->info_cache_mutex);
+
+    if (cached != NULL) {
+        image_store_put_image_ref(ref);
+        ref = cached;
+    }
+
 unlock:
     image_store_unlock();
     image_ref_dec(img);
+    return ref;
+}
+
+image_info_ref *image_store_get_image_ref(const char *id)
+{
+    image_store_snapshot_t *snapshot = NULL;
+    image_view_t *view = NULL;
+    image_info_ref *ref = NULL;
+
+    if (id == NULL) {
+        ERROR("Invalid parameter, id is NULL");
+        return NULL;
+    }
+
+    if (g_image_store == NULL) {
+        ERROR("Image store is not ready");
+        return NULL;
+    }
+
+    snapshot = get_image_store_snapshot();
+    if (snapshot == NULL) {
+        ERROR("Failed to get image store snapshot");
+        return NULL;
+    }
+
+    view = snapshot_lookup(snapshot, id);
+    if (view == NULL) {
+        WARN("Image not known");
+        goto out;
+    }
+
+    (void)pthread_mutex_lock(&g_image_store->info_cache_mutex);
+    ref = info_cache_get(view->id);
+    if (ref != NULL) {
+        g_image_store->info_cache_hits++;
+    } else {
+        g_image_store->info_cache_misses++;
+    }
+    (void)pthread_mutex_unlock(&g_image_store->info_cache_mutex);
+
+    if (ref == NULL) {
+        // the image may be deleted after the snapshot was taken, lookup it again
+        ref = new_image_info_ref(view->id);
+    }
+
+out:
+    snapshot_ref_dec(snapshot);
+    return ref;
+}
+
+void image_store_get_image_cache_stats(uint64_t *hits, uint64_t *misses)
+{
+    if (hits == NULL || misses == NULL || g_image_store == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_image_store->info_cache_mutex);
+    *hits = g_image_store->info_cache_hits;
+    *misses = g_image_store->info_cache_misses;
+    (void)pthread_mutex_unlock(&g_image_store->info_cache_mutex);
+}
+
+imagetool_image_summary *image_store_get_image_summary(const char *id)
+{
+    image_store_snapshot_t *snapshot = NULL;
+    image_view_t *view = NULL;
+    imagetool_image_summary *img_summary = NULL;
+
+    if (id == NULL) {
+        ERROR("Invalid paratemer, id is NULL");
+        return NULL;
+    }
+
+    if (g_image_store == NULL) {
+        ERROR("Image store is not ready");
+        return NULL;
+    }
+
+    snapshot = get_image_store_snapshot();
+    if (snapshot == NULL) {
+        ERROR("Failed to get image store snapshot, not allowed to get the known image");
+        return NULL;
+    }
+
+    view = snapshot_lookup(snapshot, id);
+    if (view == NULL) {
+        WARN("Image not known");
+        goto out;
+    }
+
+    if (view->summary == NULL || (img_summary = dup_image_summary(view->summary)) == NULL) {
+        ERROR("Failed to get summary of image %s", view->id);
+        goto out;
+    }
+
+out:
+    snapshot_ref_dec(snapshot);
     return img_summary;
 }
 
 int image_store_get_all_images(imagetool_images_list *images_list)
 {
     int ret = 0;
-    struct linked_list *item = NULL;
-    struct linked_list *next = NULL;
+    size_t i;
+    image_store_snapshot_t *snapshot = NULL;
 
     if (images_list == NULL) {
         ERROR("Invalid input paratemer, memory should be allocated first");
@@ -2689,36 +3302,38 @@ int image_store_get_all_images(imagetool_images_list *images_list)
         return -1;
     }
 
-    if (!image_store_lock(EXCLUSIVE)) {
-        ERROR("Failed to lock image store with exclusive lock, not allowed to get all the known images");
+    snapshot = get_image_store_snapshot();
+    if (snapshot == NULL) {
+        ERROR("Failed to get image store snapshot, not allowed to get all the known images");
         return -1;
     }
 
-    if (g_image_store->images_list_len == 0) {
-        goto unlock;
+    if (snapshot->views_len == 0) {
+        goto out;
     }
 
-    images_list->images = util_smart_calloc_s(g_image_store->images_list_len, sizeof(imagetool_image *));
+    images_list->images = util_smart_calloc_s(snapshot->views_len, sizeof(imagetool_image_summary *));
     if (images_list->images == NULL) {
         ERROR("Out of memory");
         ret = -1;
-        goto unlock;
+        goto out;
     }
 
-    linked_list_for_each_safe(item, &(g_image_store->images_list), next) {
+    for (i = 0; i < snapshot->views_len; i++) {
         imagetool_image_summary *imginfo = NULL;
-        image_t *img = (image_t *)item->elem;
-        imginfo = get_image_summary(img);
+        image_view_t *view = snapshot->views[i];
+        if (view->summary != NULL) {
+            imginfo = dup_image_summary(view->summary);
+        }
         if (imginfo == NULL) {
-            ERROR("Failed to get summary info of image: %s", img->simage->id);
+            ERROR("Failed to get summary info of image: %s", view->id);
             continue;
         }
         images_list->images[images_list->images_len++] = imginfo;
-        imginfo = NULL;
     }
 
-unlock:
-    image_store_unlock();
+out:
+    snapshot_ref_dec(snapshot);
     return ret;
 }
 
@@ -2906,17 +3521,11 @@ out:
     return ret;
 }
 
-static int do_append_image(storage_image *im)
+// append img into store, img is freed by g_image_store even if failed
+static int do_append_loaded_image(image_t *img)
 {
-    image_t *img = NULL;
     struct linked_list *item = NULL;
 
-    img = new_image(im, g_image_store->dir);
-    if (img == NULL) {
-        ERROR("Out of memory");
-        return -1;
-    }
-
     item = util_smart_calloc_s(sizeof(struct linked_list), 1);
     if (item == NULL) {
         ERROR("Out of memory");
@@ -2937,6 +3546,19 @@ static int do_append_image(storage_image *im)
     return 0;
 }
 
+static int do_append_image(storage_image *im)
+{
+    image_t *img = NULL;
+
+    img = new_image(im, g_image_store->dir);
+    if (img == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    return do_append_loaded_image(img);
+}
+
 static void strip_host_prefix(char **name)
 {
     char *new_image_name = NULL;
@@ -3500,59 +4122,172 @@ out:
     return ret;
 }
 
-static int get_images_from_json()
+// max threads to parse image json files at startup
+#define LOAD_IMAGE_WORKERS 8
+
+typedef enum {
+    IMAGE_DIR_SKIP = 0,
+    IMAGE_DIR_V1,
+    IMAGE_DIR_LOADED,
+} image_dir_state;
+
+struct image_dir_load_result {
+    image_dir_state state;
+    image_t *img;
+};
+
+struct image_dirs_load_context {
+    char **names;
+    struct image_dir_load_result *results;
+};
+
+static image_t *load_image_from_directory(const char *image_dir)
 {
-    int ret = 0;
     int nret;
-    char **image_dirs = NULL;
-    size_t image_dirs_num = 0;
-    size_t i;
-    char *id_patten = "^[a-f0-9]{64}$";
     char image_path[PATH_MAX] = { 0x00 };
+    storage_image *im = NULL;
+    image_t *img = NULL;
+    parser_error err = NULL;
 
-    ret = util_list_all_subdir(g_image_store->dir, &image_dirs);
-    if (ret != 0) {
-        ERROR("Failed to get images directory");
+    nret = snprintf(image_path, sizeof(image_path), "%s/%s", image_dir, IMAGE_JSON);
+    if (nret < 0 || (size_t)nret >= sizeof(image_path)) {
+        ERROR("Failed to get image path");
+        return NULL;
+    }
+
+    im = storage_image_parse_file(image_path, NULL, &err);
+    if (im == NULL) {
+        ERROR("Failed to parse images path: %s", err);
         goto out;
     }
-    image_dirs_num = util_array_len((const char **)image_dirs);
 
-    for (i = 0; i < image_dirs_num; i++) {
-        bool valid_v1_image = false;
+    img = new_image(im, g_image_store->dir);
+    if (img == NULL) {
+        ERROR("Out of memory");
+        goto out;
+    }
+    im = NULL;
 
-        if (util_reg_match(id_patten, image_dirs[i]) != 0) {
-            DEBUG("Image's json is placed inside image's data directory, so skip any other file or directory: %s",
-                  image_dirs[i]);
-            continue;
-        }
+out:
+    free_storage_image(im);
+    free(err);
+    return img;
+}
+
+// parse the json files of image dir, it runs in parallel and only reads files
+static void load_image_dir_json(size_t idx, void *context)
+{
+    int nret;
+    struct image_dirs_load_context *ctx = (struct image_dirs_load_context *)context;
+    const char *name = ctx->names[idx];
+    struct image_dir_load_result *result = &ctx->results[idx];
+    char *id_patten = "^[a-f0-9]{64}$";
+    char image_path[PATH_MAX] = { 0x00 };
+    bool valid_v1_image = false;
+
+    result->state = IMAGE_DIR_SKIP;
+
+    if (util_reg_match(id_patten, name) != 0) {
+        DEBUG("Image's json is placed inside image's data directory, so skip any other file or directory: %s", name);
+        return;
+    }
+
+    DEBUG("Restore the images:%s", name);
+    nret = snprintf(image_path, sizeof(image_path), "%s/%s", g_image_store->dir, name);
+    if (nret < 0 || (size_t)nret >= sizeof(image_path)) {
+        ERROR("Failed to get image path");
+        return;
+    }
+
+    if (image_store_validate_manifest_schema_version_1(image_path, &valid_v1_image) != 0) {
+        ERROR("Failed to validate manifest schema version 1 format");
+        return;
+    }
+
+    if (valid_v1_image) {
+        result->state = IMAGE_DIR_V1;
+        return;
+    }
+
+    result->img = load_image_from_directory(image_path);
+    if (result->img == NULL) {
+        ERROR("Found image path but load json failed: %s", name);
+        return;
+    }
+    result->state = IMAGE_DIR_LOADED;
+}
+
+static void load_image_dir(const char *name, struct image_dir_load_result *result)
+{
+    int nret;
+    char image_path[PATH_MAX] = { 0x00 };
 
-        DEBUG("Restore the images:%s", image_dirs[i]);
-        nret = snprintf(image_path, sizeof(image_path), "%s/%s", g_image_store->dir, image_dirs[i]);
+    if (result->state == IMAGE_DIR_V1) {
+        nret = snprintf(image_path, sizeof(image_path), "%s/%s", g_image_store->dir, name);
         if (nret < 0 || (size_t)nret >= sizeof(image_path)) {
             ERROR("Failed to get image path");
-            continue;
+            return;
         }
-
-        if (image_store_validate_manifest_schema_version_1(image_path, &valid_v1_image) != 0) {
-            ERROR("Failed to validate manifest schema version 1 format");
-            continue;
+        if (convert_to_v2_image_and_load(image_path) != 0) {
+            ERROR("Failed to convert image to v2 format image and load to store");
         }
+        return;
+    }
 
-        if (!valid_v1_image) {
-            if (append_image_by_directory(image_path) != 0) {
-                ERROR("Found image path but load json failed: %s", image_dirs[i]);
-                continue;
-            }
-        } else {
-            if (convert_to_v2_image_and_load(image_path) != 0) {
-                ERROR("Failed to convert image to v2 format image and load to store");
-                continue;
-            }
-        }
+    if (result->state != IMAGE_DIR_LOADED) {
+        return;
+    }
+
+    if (strip_default_hostname(result->img->simage) != 0) {
+        ERROR("Failed to strip default hostname of image: %s", name);
+        free_image_t(result->img);
+        result->img = NULL;
+        return;
+    }
+
+    if (do_append_loaded_image(result->img) != 0) {
+        ERROR("Found image path but load json failed: %s", name);
+    }
+    result->img = NULL;
+}
+
+/*
+ * Image json files are parsed by several threads, then appended into image store in order of dirs,
+ * so conflict names are resolved as before.
+ */
+static int get_images_from_json()
+{
+    int ret = 0;
+    size_t image_dirs_num = 0;
+    size_t i;
+    struct image_dirs_load_context ctx = { 0 };
+
+    ret = util_list_all_subdir(g_image_store->dir, &ctx.names);
+    if (ret != 0) {
+        ERROR("Failed to get images directory");
+        goto out;
+    }
+    image_dirs_num = util_array_len((const char **)ctx.names);
+    if (image_dirs_num == 0) {
+        goto out;
+    }
+
+    ctx.results = util_smart_calloc_s(sizeof(struct image_dir_load_result), image_dirs_num);
+    if (ctx.results == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto out;
+    }
+
+    util_parallel_for(image_dirs_num, LOAD_IMAGE_WORKERS, load_image_dir_json, &ctx);
+
+    for (i = 0; i < image_dirs_num; i++) {
+        load_image_dir(ctx.names[i], &ctx.results[i]);
     }
 
 out:
-    util_free_array(image_dirs);
+    free(ctx.results);
+    util_free_array(ctx.names);
     return ret;
 }
 
@@ -3663,12 +4398,44 @@ int image_store_init(struct storage_module_init_options *opts)
         goto out;
     }
 
+    g_image_store->changed_ids = map_new(MAP_STR_BOOL, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (g_image_store->changed_ids == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto out;
+    }
+
+    ret = pthread_mutex_init(&g_image_store->snapshot_mutex, NULL);
+    if (ret != 0) {
+        ERROR("Failed to init image store snapshot mutex");
+        ret = -1;
+        goto out;
+    }
+    g_image_store->snapshot_mutex_inited = true;
+
+    g_image_store->info_cache = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, image_info_cache_kvfree);
+    if (g_image_store->info_cache == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto out;
+    }
+    linked_list_init(&g_image_store->info_lru);
+
+    ret = pthread_mutex_init(&g_image_store->info_cache_mutex, NULL);
+    if (ret != 0) {
+        ERROR("Failed to init image store info cache mutex");
+        ret = -1;
+        goto out;
+    }
+    g_image_store->info_cache_mutex_inited = true;
+
     ret = image_store_load();
     if (ret != 0) {
         ERROR("Failed to load image store");
         ret = -1;
         goto out;
     }
+    publish_image_store_snapshot();
 
 #ifdef ENABLE_REMOTE_LAYER_STORE
     ret = remote_image_init(g_image_store->dir);
@@ -73,6 +73,15 @@ bool image_store_exists(const char *id);
 // Retrieve information about an image given an ID or name.
 imagetool_image *image_store_get_image(const char *id);
 
+// Retrieve shared information about an image given an ID or name. The info is cached until
+// the image is changed or deleted, release it with image_store_put_image_ref after use.
+image_info_ref *image_store_get_image_ref(const char *id);
+
+void image_store_put_image_ref(image_info_ref *ref);
+
+// Get hit and miss counters of the image info cache
+void image_store_get_image_cache_stats(uint64_t *hits, uint64_t *misses);
+
 // Retrieves a (potentially large) piece of data associated with this ID, if it has previously been set.
 char *image_store_big_data(const char *id, const char *key);
 
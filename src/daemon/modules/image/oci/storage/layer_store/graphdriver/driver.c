@@ -47,6 +47,8 @@ static const struct graphdriver_ops g_overlay2_ops = {
     .umount_layer = overlay2_umount_layer,
     .exists = overlay2_layer_exists,
     .apply_diff = overlay2_apply_diff,
+    .stage_diff = overlay2_stage_diff,
+    .apply_staged_diff = overlay2_apply_staged_diff,
     .get_layer_metadata = overlay2_get_layer_metadata,
     .get_driver_status = overlay2_get_driver_status,
     .clean_up = overlay2_clean_up,
@@ -339,6 +341,75 @@ int graphdriver_apply_diff(const char *id, const struct io_read_wrapper *content
     return ret;
 }
 
+bool graphdriver_support_stage_diff(void)
+{
+    if (g_graphdriver == NULL) {
+        ERROR("Driver not inited yet");
+        return false;
+    }
+
+    return g_graphdriver->ops->stage_diff != NULL && g_graphdriver->ops->apply_staged_diff != NULL;
+}
+
+int graphdriver_stage_diff(const char *staged_dir, const struct io_read_wrapper *content)
+{
+    int ret = 0;
+
+    if (g_graphdriver == NULL) {
+        ERROR("Driver not inited yet");
+        return -1;
+    }
+
+    if (staged_dir == NULL || content == NULL) {
+        ERROR("Invalid input arguments for driver stage diff");
+        return -1;
+    }
+
+    if (!graphdriver_support_stage_diff()) {
+        DEBUG("Driver %s do not support staging diff", g_graphdriver->name);
+        return -1;
+    }
+
+    if (!driver_rd_lock()) {
+        return -1;
+    }
+
+    ret = g_graphdriver->ops->stage_diff(staged_dir, g_graphdriver, content);
+
+    driver_unlock();
+
+    return ret;
+}
+
+int graphdriver_apply_staged_diff(const char *id, const char *staged_dir)
+{
+    int ret = 0;
+
+    if (g_graphdriver == NULL) {
+        ERROR("Driver not inited yet");
+        return -1;
+    }
+
+    if (id == NULL || staged_dir == NULL) {
+        ERROR("Invalid input arguments for driver apply staged diff");
+        return -1;
+    }
+
+    if (g_graphdriver->ops->apply_staged_diff == NULL) {
+        return -1;
+    }
+
+    if (!driver_rd_lock()) {
+        return -1;
+    }
+
+    ret = g_graphdriver->ops->apply_staged_diff(id, g_graphdriver, staged_dir);
+
+    driver_unlock();
+
+    return ret;
+}
+
 container_inspect_graph_driver *graphdriver_get_metadata(const char *id)
 {
     int ret = -1;
@@ -70,6 +70,11 @@ struct graphdriver_ops {
 
     int (*apply_diff)(const char *id, const struct graphdriver *driver, const struct io_read_wrapper *content);
 
+    // optional, unpack content into staged_dir without any layer created, to apply it by apply_staged_diff later
+    int (*stage_diff)(const char *staged_dir, const struct graphdriver *driver, const struct io_read_wrapper *content);
+
+    int (*apply_staged_diff)(const char *id, const struct graphdriver *driver, const char *staged_dir);
+
     int (*get_layer_metadata)(const char *id, const struct graphdriver *driver, json_map_string_string *map_info);
 
     int (*get_driver_status)(const struct graphdriver *driver, struct graphdriver_status *status);
@@ -121,6 +126,12 @@ bool graphdriver_layer_exists(const char *id);
 
 int graphdriver_apply_diff(const char *id, const struct io_read_wrapper *content);
 
+bool graphdriver_support_stage_diff(void);
+
+int graphdriver_stage_diff(const char *staged_dir, const struct io_read_wrapper *content);
+
+int graphdriver_apply_staged_diff(const char *id, const char *staged_dir);
+
 struct graphdriver_status *graphdriver_get_status(void);
 
 void free_graphdriver_status(struct graphdriver_status *status);
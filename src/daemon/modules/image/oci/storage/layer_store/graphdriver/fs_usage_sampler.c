@@ -0,0 +1,232 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide cached directory usage sampler functions
+ ******************************************************************************/
+#define _GNU_SOURCE /* See feature_test_macros(7) */
+#include "fs_usage_sampler.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/prctl.h>
+#include <isula_libutils/log.h>
+
+#include "utils.h"
+#include "utils_file.h"
+#include "utils_timestamp.h"
+#include "map.h"
+#include "linked_list.h"
+
+typedef struct {
+    int64_t bytes;
+    int64_t inodes;
+    // time of the last sample
+    int64_t sampled_at;
+    // waiting for the sampler thread
+    bool queued;
+} fs_usage;
+
+static pthread_mutex_t g_sampler_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_sampler_cond = PTHREAD_COND_INITIALIZER;
+// dir -> fs_usage, protected by g_sampler_mutex
+static map_t *g_usages = NULL;
+// dirs waiting to be sampled again, protected by g_sampler_mutex
+static struct linked_list g_sample_queue;
+
+static void *sampler_routine(void *arg)
+{
+    struct linked_list *node = NULL;
+    char *dir = NULL;
+    fs_usage *usage = NULL;
+    int64_t bytes = 0;
+    int64_t inodes = 0;
+
+    if (pthread_detach(pthread_self()) != 0) {
+        ERROR("Set thread detach fail");
+    }
+
+    prctl(PR_SET_NAME, "fs_usage");
+
+    for (;;) {
+        (void)pthread_mutex_lock(&g_sampler_mutex);
+        while (linked_list_empty(&g_sample_queue)) {
+            (void)pthread_cond_wait(&g_sampler_cond, &g_sampler_mutex);
+        }
+        node = linked_list_first_node(&g_sample_queue);
+        linked_list_del(node);
+        (void)pthread_mutex_unlock(&g_sampler_mutex);
+
+        dir = (char *)node->elem;
+        free(node);
+
+        bytes = 0;
+        inodes = 0;
+        util_calculate_dir_size(dir, 0, &bytes, &inodes);
+
+        (void)pthread_mutex_lock(&g_sampler_mutex);
+        // dir may be forgot while sampling
+        usage = map_search(g_usages, (void *)dir);
+        if (usage != NULL) {
+            usage->bytes = bytes;
+            usage->inodes = inodes;
+            usage->sampled_at = util_get_now_time_nanos();
+            usage->queued = false;
+        }
+        (void)pthread_mutex_unlock(&g_sampler_mutex);
+
+        free(dir);
+    }
+
+    return NULL;
+}
+
+// called with g_sampler_mutex held
+static int sampler_init(void)
+{
+    pthread_t tid = 0;
+
+    if (g_usages != NULL) {
+        return 0;
+    }
+
+    g_usages = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (g_usages == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    linked_list_init(&g_sample_queue);
+
+    // the thread never exits, so g_usages is never freed
+    if (pthread_create(&tid, NULL, sampler_routine, NULL) != 0) {
+        ERROR("Failed to start fs usage sampler");
+        map_free(g_usages);
+        g_usages = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+// called with g_sampler_mutex held
+static void queue_sample(const char *dir, fs_usage *usage)
+{
+    struct linked_list *node = NULL;
+    char *dup_dir = NULL;
+
+    node = util_common_calloc_s(sizeof(struct linked_list));
+    dup_dir = util_strdup_s(dir);
+    if (node == NULL || dup_dir == NULL) {
+        ERROR("Out of memory");
+        free(node);
+        free(dup_dir);
+        return;
+    }
+
+    linked_list_add_elem(node, dup_dir);
+    linked_list_add_tail(&g_sample_queue, node);
+    usage->queued = true;
+    (void)pthread_cond_signal(&g_sampler_cond);
+}
+
+// called with g_sampler_mutex held
+static void save_usage(const char *dir, int64_t bytes, int64_t inodes, int64_t sampled_at)
+{
+    fs_usage *usage = NULL;
+
+    usage = map_search(g_usages, (void *)dir);
+    if (usage != NULL) {
+        // sampled by others at the same time
+        if (usage->sampled_at < sampled_at) {
+            usage->bytes = bytes;
+            usage->inodes = inodes;
+            usage->sampled_at = sampled_at;
+        }
+        return;
+    }
+
+    usage = util_common_calloc_s(sizeof(fs_usage));
+    if (usage == NULL) {
+        ERROR("Out of memory");
+        return;
+    }
+    usage->bytes = bytes;
+    usage->inodes = inodes;
+    usage->sampled_at = sampled_at;
+
+    if (!map_insert(g_usages, (void *)dir, usage)) {
+        ERROR("Failed to save fs usage of %s", dir);
+        free(usage);
+    }
+}
+
+int fs_usage_sampler_get(const char *dir, int64_t *bytes, int64_t *inodes)
+{
+    fs_usage *usage = NULL;
+    int64_t now = 0;
+    bool cached = false;
+
+    if (dir == NULL || bytes == NULL || inodes == NULL) {
+        ERROR("Invalid input arguments");
+        return -1;
+    }
+
+    now = util_get_now_time_nanos();
+
+    (void)pthread_mutex_lock(&g_sampler_mutex);
+    if (sampler_init() != 0) {
+        (void)pthread_mutex_unlock(&g_sampler_mutex);
+        return -1;
+    }
+
+    usage = map_search(g_usages, (void *)dir);
+    if (usage != NULL) {
+        *bytes = usage->bytes;
+        *inodes = usage->inodes;
+        cached = true;
+        if (!usage->queued && now - usage->sampled_at >= FS_USAGE_SAMPLE_INTERVAL_SECOND * Time_Second) {
+            queue_sample(dir, usage);
+        }
+    }
+    (void)pthread_mutex_unlock(&g_sampler_mutex);
+
+    if (cached) {
+        return 0;
+    }
+
+    // nothing to return yet, sample it directly
+    *bytes = 0;
+    *inodes = 0;
+    util_calculate_dir_size(dir, 0, bytes, inodes);
+
+    // do not keep result of a dir removed while sampling
+    if (util_dir_exists(dir)) {
+        (void)pthread_mutex_lock(&g_sampler_mutex);
+        save_usage(dir, *bytes, *inodes, now);
+        (void)pthread_mutex_unlock(&g_sampler_mutex);
+    }
+
+    return 0;
+}
+
+void fs_usage_sampler_forget(const char *dir)
+{
+    if (dir == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_sampler_mutex);
+    if (g_usages != NULL && map_search(g_usages, (void *)dir) != NULL) {
+        (void)map_remove(g_usages, (void *)dir);
+    }
+    (void)pthread_mutex_unlock(&g_sampler_mutex);
+}
@@ -0,0 +1,41 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide cached directory usage sampler definition
+ ******************************************************************************/
+#ifndef DAEMON_MODULES_IMAGE_OCI_STORAGE_LAYER_STORE_GRAPHDRIVER_FS_USAGE_SAMPLER_H
+#define DAEMON_MODULES_IMAGE_OCI_STORAGE_LAYER_STORE_GRAPHDRIVER_FS_USAGE_SAMPLER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// min interval between two samples of the same directory
+#define FS_USAGE_SAMPLE_INTERVAL_SECOND 30
+
+/*
+ * Get the space and inodes used by dir. The first call walks dir directly, later
+ * calls return the cached result, and results older than the sample interval are
+ * refreshed by a background thread which walks one directory at a time.
+ */
+int fs_usage_sampler_get(const char *dir, int64_t *bytes, int64_t *inodes);
+
+// drop the cached result of dir, called when dir is removed
+void fs_usage_sampler_forget(const char *dir);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_MODULES_IMAGE_OCI_STORAGE_LAYER_STORE_GRAPHDRIVER_FS_USAGE_SAMPLER_H
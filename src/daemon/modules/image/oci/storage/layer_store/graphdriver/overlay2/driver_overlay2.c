@@ -35,6 +35,7 @@
 #include "util_archive.h"
 #include "project_quota.h"
 #include "driver.h"
+#include "fs_usage_sampler.h"
 #include "driver_overlay2_types.h"
 #include "image_api.h"
 #include "utils_array.h"
@@ -1160,6 +1161,19 @@ out:
     return lower;
 }
 
+static void forget_layer_usage(const char *layer_dir)
+{
+    char *layer_diff = NULL;
+
+    layer_diff = util_path_join(layer_dir, OVERLAY_LAYER_DIFF);
+    if (layer_diff == NULL) {
+        ERROR("Failed to join layer diff dir:%s", layer_dir);
+        return;
+    }
+    fs_usage_sampler_forget(layer_diff);
+    free(layer_diff);
+}
+
 int overlay2_rm_layer(const char *id, const struct graphdriver *driver)
 {
     int ret = 0;
@@ -1238,6 +1252,8 @@ int overlay2_rm_layer(const char *id, const struct graphdriver *driver)
     }
 #endif
 
+    forget_layer_usage(layer_dir);
+
 out:
     free(layer_dir);
     free(link_id);
@@ -1895,18 +1911,49 @@ out:
     return exists;
 }
 
-int overlay2_apply_diff(const char *id, const struct graphdriver *driver, const struct io_read_wrapper *content)
+static int unpack_layer_diff(const char *layer_diff, const struct io_read_wrapper *content)
 {
     int ret = 0;
 #ifdef ENABLE_USERNS_REMAP
     unsigned int size = 0;
     char *userns_remap = conf_get_isulad_userns_remap();
 #endif
-    char *layer_dir = NULL;
-    char *layer_diff = NULL;
     struct archive_options options = { 0 };
     char *err = NULL;
 
+    options.whiteout_format = OVERLAY_WHITEOUT_FORMATE;
+
+#ifdef ENABLE_USERNS_REMAP
+    if (userns_remap != NULL) {
+        if (util_parse_user_remap(userns_remap, &options.uid, &options.gid, &size)) {
+            ERROR("Failed to split string '%s'.", userns_remap);
+            ret = -1;
+            goto out;
+        }
+    }
+#endif
+
+    ret = archive_unpack(content, layer_diff, &options, &err);
+    if (ret != 0) {
+        ERROR("Failed to unpack to %s: %s", layer_diff, err);
+        ret = -1;
+        goto out;
+    }
+
+out:
+    free(err);
+#ifdef ENABLE_USERNS_REMAP
+    free(userns_remap);
+#endif
+    return ret;
+}
+
+int overlay2_apply_diff(const char *id, const struct graphdriver *driver, const struct io_read_wrapper *content)
+{
+    int ret = 0;
+    char *layer_dir = NULL;
+    char *layer_diff = NULL;
+
     if (id == NULL || driver == NULL || content == NULL) {
         ERROR("invalid argument");
         ret = -1;
@@ -1927,32 +1974,81 @@ int overlay2_apply_diff(const char *id, const struct graphdriver *driver, const
         goto out;
     }
 
-    options.whiteout_format = OVERLAY_WHITEOUT_FORMATE;
+    ret = unpack_layer_diff(layer_diff, content);
 
-#ifdef ENABLE_USERNS_REMAP
-    if (userns_remap != NULL) {
-        if (util_parse_user_remap(userns_remap, &options.uid, &options.gid, &size)) {
-            ERROR("Failed to split string '%s'.", userns_remap);
-            ret = -1;
-            goto out;
-        }
+out:
+    free(layer_dir);
+    free(layer_diff);
+    return ret;
+}
+
+int overlay2_stage_diff(const char *staged_dir, const struct graphdriver *driver,
+                        const struct io_read_wrapper *content)
+{
+    int ret = 0;
+    char *staged_diff = NULL;
+
+    if (staged_dir == NULL || driver == NULL || content == NULL) {
+        ERROR("invalid argument");
+        return -1;
     }
-#endif
 
-    ret = archive_unpack(content, layer_diff, &options, &err);
-    if (ret != 0) {
-        ERROR("Failed to unpack to %s: %s", layer_diff, err);
+    if (mk_diff_directory(staged_dir) != 0) {
+        ERROR("Failed to create staged diff directory in %s", staged_dir);
+        return -1;
+    }
+
+    staged_diff = util_path_join(staged_dir, OVERLAY_LAYER_DIFF);
+    if (staged_diff == NULL) {
+        ERROR("Failed to join staged diff dir:%s", staged_dir);
+        return -1;
+    }
+
+    ret = unpack_layer_diff(staged_diff, content);
+
+    free(staged_diff);
+    return ret;
+}
+
+int overlay2_apply_staged_diff(const char *id, const struct graphdriver *driver, const char *staged_dir)
+{
+    int ret = 0;
+    char *layer_dir = NULL;
+    char *layer_diff = NULL;
+    char *staged_diff = NULL;
+
+    if (id == NULL || driver == NULL || staged_dir == NULL) {
+        ERROR("invalid argument");
+        return -1;
+    }
+
+    layer_dir = util_path_join(driver->home, id);
+    if (layer_dir == NULL) {
+        ERROR("Failed to join layer dir:%s", id);
+        ret = -1;
+        goto out;
+    }
+
+    layer_diff = util_path_join(layer_dir, OVERLAY_LAYER_DIFF);
+    staged_diff = util_path_join(staged_dir, OVERLAY_LAYER_DIFF);
+    if (layer_diff == NULL || staged_diff == NULL) {
+        ERROR("Failed to join diff dir of layer %s and %s", id, staged_dir);
+        ret = -1;
+        goto out;
+    }
+
+    // diff dir of the new layer is still empty, so replace it with the staged one.
+    // rename fails with EXDEV if staged_dir is on another filesystem, callers apply the diff again then
+    if (rename(staged_diff, layer_diff) != 0) {
+        WARN("Failed to move staged diff %s to %s: %s", staged_diff, layer_diff, strerror(errno));
         ret = -1;
         goto out;
     }
 
 out:
-    free(err);
     free(layer_dir);
     free(layer_diff);
-#ifdef ENABLE_USERNS_REMAP
-    free(userns_remap);
-#endif
+    free(staged_diff);
     return ret;
 }
 
@@ -2222,7 +2318,28 @@ out:
     return ret;
 }
 
-static int do_cal_layer_fs_info(const char *layer_diff, imagetool_fs_info *fs_info)
+// walking the diff directory costs seconds for layers with many files, so
+// read the usage from project quota if possible, or use the cached sample
+static void get_layer_usage(const char *layer_dir, const char *layer_diff, const struct graphdriver *driver,
+                            int64_t *total_size, int64_t *total_inodes)
+{
+    uint64_t bytes = 0;
+    uint64_t inodes = 0;
+
+    if (driver->support_quota && driver->quota_ctrl->get_usage(layer_dir, driver->quota_ctrl, &bytes, &inodes) == 0) {
+        *total_size = (int64_t)bytes;
+        *total_inodes = (int64_t)inodes;
+        return;
+    }
+
+    if (fs_usage_sampler_get(layer_diff, total_size, total_inodes) != 0) {
+        WARN("Failed to get sampled usage of %s, calculate it directly", layer_diff);
+        util_calculate_dir_size(layer_diff, 0, total_size, total_inodes);
+    }
+}
+
+static int do_cal_layer_fs_info(const char *layer_dir, const char *layer_diff, const struct graphdriver *driver,
+                                imagetool_fs_info *fs_info)
 {
     int ret = 0;
     imagetool_fs_info_image_filesystems_element *fs_usage_tmp = NULL;
@@ -2246,7 +2363,7 @@ static int do_cal_layer_fs_info(const char *layer_diff, imagetool_fs_info *fs_in
     }
     fs_usage_tmp->fs_id->mountpoint = util_strdup_s(layer_diff);
 
-    util_calculate_dir_size(layer_diff, 0, &total_size, &total_inodes);
+    get_layer_usage(layer_dir, layer_diff, driver, &total_size, &total_inodes);
 
     fs_usage_tmp->inodes_used = util_common_calloc_s(sizeof(imagetool_fs_info_image_filesystems_inodes_used));
     if (fs_usage_tmp->inodes_used == NULL) {
@@ -2308,7 +2425,7 @@ int overlay2_get_layer_fs_info(const char *id, const struct graphdriver *driver,
         goto out;
     }
 
-    if (do_cal_layer_fs_info(layer_diff, fs_info) != 0) {
+    if (do_cal_layer_fs_info(layer_dir, layer_diff, driver, fs_info) != 0) {
         ERROR("Failed to cal layer diff :%s fs info", layer_diff);
         ret = -1;
         goto out;
@@ -54,6 +54,11 @@ bool overlay2_layer_exists(const char *id, const struct graphdriver *driver);
 
 int overlay2_apply_diff(const char *id, const struct graphdriver *driver, const struct io_read_wrapper *content);
 
+int overlay2_stage_diff(const char *staged_dir, const struct graphdriver *driver,
+                        const struct io_read_wrapper *content);
+
+int overlay2_apply_staged_diff(const char *id, const struct graphdriver *driver, const char *staged_dir);
+
 int overlay2_get_layer_metadata(const char *id, const struct graphdriver *driver, json_map_string_string *map_info);
 
 int overlay2_get_driver_status(const struct graphdriver *driver, struct graphdriver_status *status);
@@ -251,6 +251,69 @@ out:
     return ret;
 }
 
+static int get_own_project_id(const char *target, const struct pquota_control *ctrl, uint32_t *project_id)
+{
+    if (target == NULL || ctrl == NULL) {
+        return -1;
+    }
+
+    if (get_project_quota_id(target, project_id) != 0) {
+        ERROR("Failed to get %s project id", target);
+        return -1;
+    }
+
+    // project id inherited from the home directory is shared by all layers without quota
+    if (*project_id < ctrl->min_project_id) {
+        DEBUG("Directory %s has no project id of its own", target);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int ext4_get_usage(const char *target, struct pquota_control *ctrl, uint64_t *bytes, uint64_t *inodes)
+{
+    int ret = 0;
+    uint32_t project_id = 0;
+    struct dqblk d = { 0 };
+
+    if (get_own_project_id(target, ctrl, &project_id) != 0) {
+        return -1;
+    }
+
+    ret = quotactl(QCMD(Q_GETQUOTA, FS_PROJ_QUOTA), ctrl->backing_fs_device, project_id, (caddr_t)&d);
+    if (ret != 0) {
+        SYSERROR("Failed to get quota usage for projid %u on %s", project_id, ctrl->backing_fs_device);
+        return ret;
+    }
+
+    *bytes = d.dqb_curspace;
+    *inodes = d.dqb_curinodes;
+    return 0;
+}
+
+static int xfs_get_usage(const char *target, struct pquota_control *ctrl, uint64_t *bytes, uint64_t *inodes)
+{
+    int ret = 0;
+    uint32_t project_id = 0;
+    fs_disk_quota_t d = { 0 };
+
+    if (get_own_project_id(target, ctrl, &project_id) != 0) {
+        return -1;
+    }
+
+    ret = quotactl(QCMD(Q_XGETQUOTA, FS_PROJ_QUOTA), ctrl->backing_fs_device, project_id, (caddr_t)&d);
+    if (ret != 0) {
+        SYSERROR("Failed to get quota usage for projid %u on %s", project_id, ctrl->backing_fs_device);
+        return ret;
+    }
+
+    // d_bcount is in 512 bytes basic blocks
+    *bytes = d.d_bcount * 512;
+    *inodes = d.d_icount;
+    return 0;
+}
+
 static void get_next_project_id(const char *dirpath, struct pquota_control *ctrl)
 {
     int nret = 0;
@@ -390,6 +453,7 @@ struct pquota_control *project_quota_control_init(const char *home_dir, const ch
         goto err_out;
     }
     min_project_id++;
+    ctrl->min_project_id = min_project_id;
     ctrl->next_project_id = min_project_id;
     get_next_project_id(home_dir, ctrl);
 
@@ -408,8 +472,10 @@ struct pquota_control *project_quota_control_init(const char *home_dir, const ch
 
     if (strcmp(ctrl->backing_fs_type, "extfs") == 0) {
         ctrl->set_quota = ext4_set_quota;
+        ctrl->get_usage = ext4_get_usage;
     } else {
         ctrl->set_quota = xfs_set_quota;
+        ctrl->get_usage = xfs_get_usage;
     }
 
     return ctrl;
@@ -77,9 +77,13 @@ struct pquota_control {
     char *backing_fs_type;
     char *backing_fs_device;
     uint32_t next_project_id;
+    // project ids less than it are not allocated by us, and may be shared by directories
+    uint32_t min_project_id;
     pthread_rwlock_t rwlock;
     // ops
     int (*set_quota)(const char *target, struct pquota_control *ctrl, uint64_t size);
+    // get space and inodes used by the project of target, fail if target has no project of its own
+    int (*get_usage)(const char *target, struct pquota_control *ctrl, uint64_t *bytes, uint64_t *inodes);
 };
 
 struct pquota_control *project_quota_control_init(const char *home_dir, const char *fs);
@@ -52,6 +52,12 @@
 
 #define PAYLOAD_CRC_LEN 12
 
+// diffs of layers are unpacked in subdirs of it before the layers are created
+#define LAYER_STAGING_DIR "staging"
+#define STAGED_TAR_SPLIT "tar-split"
+#define STAGED_TAR_SPLIT_GZ "tar-split.gz"
+#define STAGED_DIFF_SIZE "diff-size"
+
 typedef struct __layer_store_metadata_t {
     pthread_rwlock_t rwlock;
     map_t *by_id;
@@ -800,27 +806,18 @@ out:
     return ret;
 }
 
-static int make_tar_split_file(const char *lid, const struct io_read_wrapper *diff, int64_t *size)
+static int write_tar_split_file(const char *save_fname, const char *save_fname_gz, const struct io_read_wrapper *diff,
+                                int64_t *size)
 {
     int *pfd = (int *)diff->context;
-    char *save_fname = NULL;
-    char *save_fname_gz = NULL;
     int ret = -1;
     int tfd = -1;
 
-    save_fname = tar_split_tmp_path(lid);
-    if (save_fname == NULL) {
-        return -1;
-    }
-    save_fname_gz = tar_split_path(lid);
-    if (save_fname_gz == NULL) {
-        goto out;
-    }
     // step 1: read header;
     tfd = util_open(save_fname, O_WRONLY | O_CREAT, SECURE_CONFIG_FILE_MODE);
     if (tfd == -1) {
         SYSERROR("touch file failed");
-        goto out;
+        return -1;
     }
     close(tfd);
     tfd = -1;
@@ -829,12 +826,12 @@ static int make_tar_split_file(const char *lid, const struct io_read_wrapper *di
     // step 3: write into tar split;
     ret = archive_copy_oci_tar_split_and_ret_size(*pfd, save_fname, size);
     if (ret != 0) {
-        goto out;
+        return ret;
     }
 
     // not exist entry for layer, just return 0
     if (!util_file_exists(save_fname)) {
-        goto out;
+        return ret;
     }
 
     // step 4: gzip tar split, and save file.
@@ -846,13 +843,269 @@ static int make_tar_split_file(const char *lid, const struct io_read_wrapper *di
         WARN("remove tmp tar split failed");
     }
 
+    return ret;
+}
+
+static int make_tar_split_file(const char *lid, const struct io_read_wrapper *diff, int64_t *size)
+{
+    char *save_fname = NULL;
+    char *save_fname_gz = NULL;
+    int ret = -1;
+
+    save_fname = tar_split_tmp_path(lid);
+    if (save_fname == NULL) {
+        return -1;
+    }
+    save_fname_gz = tar_split_path(lid);
+    if (save_fname_gz == NULL) {
+        goto out;
+    }
+
+    ret = write_tar_split_file(save_fname, save_fname_gz, diff, size);
+
 out:
     free(save_fname_gz);
     free(save_fname);
     return ret;
 }
 
-static int apply_diff(layer_t *l, const struct io_read_wrapper *diff)
+static char *staging_dir_path(void)
+{
+    char *result = NULL;
+    int nret = 0;
+
+    nret = asprintf(&result, "%s/%s", g_root_dir, LAYER_STAGING_DIR);
+    if (nret < 0 || nret > PATH_MAX) {
+        SYSERROR("Create layer staging path failed");
+        return NULL;
+    }
+
+    return result;
+}
+
+static char *staged_diff_path(const char *stage, const char *name)
+{
+    char *result = NULL;
+    int nret = 0;
+
+    // stage is returned by layer_store_stage_diff, which is a plain name
+    if (stage == NULL || strchr(stage, '/') != NULL || strcmp(stage, ".") == 0 || strcmp(stage, "..") == 0) {
+        ERROR("Invalid staged diff %s", stage != NULL ? stage : "");
+        return NULL;
+    }
+
+    if (name == NULL) {
+        nret = asprintf(&result, "%s/%s/%s", g_root_dir, LAYER_STAGING_DIR, stage);
+    } else {
+        nret = asprintf(&result, "%s/%s/%s/%s", g_root_dir, LAYER_STAGING_DIR, stage, name);
+    }
+    if (nret < 0 || nret > PATH_MAX) {
+        SYSERROR("Create staged diff path failed");
+        free(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+static int save_staged_diff_size(const char *staged_dir, int64_t size)
+{
+    char *fname = NULL;
+    char buf[ISULAD_NUMSTRLEN64] = { 0 };
+    int nret = 0;
+    int ret = 0;
+
+    fname = util_path_join(staged_dir, STAGED_DIFF_SIZE);
+    if (fname == NULL) {
+        ERROR("Failed to join staged diff size path of %s", staged_dir);
+        return -1;
+    }
+
+    nret = snprintf(buf, sizeof(buf), "%lld", (long long)size);
+    if (nret < 0 || (size_t)nret >= sizeof(buf)) {
+        ERROR("Failed to print staged diff size");
+        ret = -1;
+        goto out;
+    }
+
+    ret = util_write_file(fname, buf, strlen(buf), SECURE_CONFIG_FILE_MODE);
+    if (ret != 0) {
+        ERROR("Failed to save staged diff size to %s", fname);
+    }
+
+out:
+    free(fname);
+    return ret;
+}
+
+// diffs staged by unfinished pulls of last run are useless
+static void remove_staging_dir(void)
+{
+    char *staging_dir = staging_dir_path();
+
+    if (staging_dir != NULL && util_dir_exists(staging_dir) && util_recursive_rmdir(staging_dir, 0) != 0) {
+        WARN("Failed to remove layer staging dir %s", staging_dir);
+    }
+    free(staging_dir);
+}
+
+bool layer_store_support_stage_diff(void)
+{
+    return graphdriver_support_stage_diff();
+}
+
+char *layer_store_stage_diff(const struct io_read_wrapper *diff)
+{
+    char *staging_dir = NULL;
+    char *staged_dir = NULL;
+    char *tar_split = NULL;
+    char *tar_split_gz = NULL;
+    char *stage = NULL;
+    int64_t size = 0;
+    int nret = 0;
+
+    if (diff == NULL || diff->context == NULL) {
+        ERROR("Invalid argument");
+        return NULL;
+    }
+
+    if (!layer_store_support_stage_diff()) {
+        DEBUG("Staging diff is not supported by the driver");
+        return NULL;
+    }
+
+    // layer store lock is not taken, as nothing of the store is touched until the layer is created
+    staging_dir = staging_dir_path();
+    if (staging_dir == NULL) {
+        return NULL;
+    }
+    if (util_mkdir_p(staging_dir, IMAGE_STORE_PATH_MODE) != 0) {
+        ERROR("Failed to create layer staging dir %s", staging_dir);
+        goto out;
+    }
+
+    nret = asprintf(&staged_dir, "%s/XXXXXX", staging_dir);
+    if (nret < 0 || nret > PATH_MAX) {
+        SYSERROR("Create staged diff path failed");
+        goto out;
+    }
+    if (mkdtemp(staged_dir) == NULL) {
+        SYSERROR("Failed to create staged diff dir %s", staged_dir);
+        free(staged_dir);
+        staged_dir = NULL;
+        goto out;
+    }
+
+    if (graphdriver_stage_diff(staged_dir, diff) != 0) {
+        DEBUG("Failed to stage diff in %s", staged_dir);
+        goto err_out;
+    }
+
+    tar_split = util_path_join(staged_dir, STAGED_TAR_SPLIT);
+    tar_split_gz = util_path_join(staged_dir, STAGED_TAR_SPLIT_GZ);
+    if (tar_split == NULL || tar_split_gz == NULL) {
+        ERROR("Failed to join tar split path of %s", staged_dir);
+        goto err_out;
+    }
+
+    if (write_tar_split_file(tar_split, tar_split_gz, diff, &size) != 0) {
+        ERROR("Failed to make tar split of staged diff %s", staged_dir);
+        goto err_out;
+    }
+
+    if (save_staged_diff_size(staged_dir, size) != 0) {
+        goto err_out;
+    }
+
+    stage = util_strdup_s(strrchr(staged_dir, '/') + 1);
+    goto out;
+
+err_out:
+    if (util_recursive_rmdir(staged_dir, 0) != 0) {
+        WARN("Failed to remove staged diff dir %s", staged_dir);
+    }
+out:
+    free(staging_dir);
+    free(staged_dir);
+    free(tar_split);
+    free(tar_split_gz);
+    return stage;
+}
+
+void layer_store_remove_staged_diff(const char *stage)
+{
+    char *staged_dir = NULL;
+
+    staged_dir = staged_diff_path(stage, NULL);
+    if (staged_dir == NULL) {
+        return;
+    }
+
+    // staged diff is moved away if layer is created with it
+    if (util_dir_exists(staged_dir) && util_recursive_rmdir(staged_dir, 0) != 0) {
+        WARN("Failed to remove staged diff dir %s", staged_dir);
+    }
+
+    free(staged_dir);
+}
+
+// return 1 if the staged diff can not be moved to layer, then diff should be applied from data
+static int apply_staged_diff(layer_t *l, const char *stage)
+{
+    char *staged_dir = NULL;
+    char *staged_tar_split = NULL;
+    char *size_file = NULL;
+    char *size_str = NULL;
+    char *save_fname_gz = NULL;
+    long long size = 0;
+    int ret = -1;
+
+    staged_dir = staged_diff_path(stage, NULL);
+    staged_tar_split = staged_diff_path(stage, STAGED_TAR_SPLIT_GZ);
+    size_file = staged_diff_path(stage, STAGED_DIFF_SIZE);
+    if (staged_dir == NULL || staged_tar_split == NULL || size_file == NULL) {
+        ret = 1;
+        goto out;
+    }
+
+    size_str = util_read_text_file(size_file);
+    if (size_str == NULL || util_safe_llong(size_str, &size) != 0) {
+        WARN("Invalid size of staged diff %s", staged_dir);
+        ret = 1;
+        goto out;
+    }
+
+    if (graphdriver_apply_staged_diff(l->slayer->id, staged_dir) != 0) {
+        ret = 1;
+        goto out;
+    }
+
+    // layer data is in place, failures from here can not be fallen back
+    if (util_file_exists(staged_tar_split)) {
+        save_fname_gz = tar_split_path(l->slayer->id);
+        if (save_fname_gz == NULL) {
+            goto out;
+        }
+        if (rename(staged_tar_split, save_fname_gz) != 0) {
+            SYSERROR("Failed to move staged tar split %s to %s", staged_tar_split, save_fname_gz);
+            goto out;
+        }
+    }
+
+    INFO("Apply staged layer get size: %lld", size);
+    l->slayer->diff_size = (int64_t)size;
+    ret = 0;
+
+out:
+    free(staged_dir);
+    free(staged_tar_split);
+    free(size_file);
+    free(size_str);
+    free(save_fname_gz);
+    return ret;
+}
+
+static int apply_diff(layer_t *l, const struct io_read_wrapper *diff, const char *staged_diff)
 {
     int64_t size = 0;
     int ret = 0;
@@ -861,6 +1114,14 @@ static int apply_diff(layer_t *l, const struct io_read_wrapper *diff)
         return 0;
     }
 
+    if (staged_diff != NULL) {
+        ret = apply_staged_diff(l, staged_diff);
+        if (ret <= 0) {
+            return ret;
+        }
+        WARN("Staged diff %s of layer %s is not used, apply diff again", staged_diff, l->slayer->id);
+    }
+
     ret = graphdriver_apply_diff(l->slayer->id, diff);
     if (ret != 0) {
         goto out;
@@ -1079,7 +1340,7 @@ int layer_store_create(const char *id, const struct layer_opts *opts, const stru
         goto clear_memory;
     }
 
-    ret = apply_diff(l, diff);
+    ret = apply_diff(l, diff, opts->staged_diff);
     if (ret != 0) {
         goto clear_memory;
     }
@@ -1515,6 +1776,8 @@ void free_layer_opts(struct layer_opts *ptr)
     ptr->uncompressed_digest = NULL;
     free(ptr->compressed_digest);
     ptr->compressed_digest = NULL;
+    free(ptr->staged_diff);
+    ptr->staged_diff = NULL;
 
     free_layer_store_mount_opts(ptr->opts);
     ptr->opts = NULL;
@@ -1570,66 +1833,107 @@ out:
     return ret;
 }
 
-static bool load_layer_json_cb(const char *path_name, const struct dirent *sub_dir, void *context)
-{
 #define LAYER_NAME_LEN 64
-    bool flag = false;
-    char tmpdir[PATH_MAX] = { 0 };
-    int nret = 0;
+// max threads to parse layer json files at startup
+#define LOAD_LAYER_WORKERS 8
+
+typedef enum {
+    LAYER_DIR_SKIP = 0,
+    LAYER_DIR_INVALID,
+    LAYER_DIR_LOADED,
+} layer_dir_state;
+
+struct layer_dir_load_result {
+    layer_dir_state state;
+    layer_t *layer;
+};
+
+struct layer_dirs_load_context {
+    char **names;
+    struct layer_dir_load_result *results;
+};
+
+// parse the json files of layer dir, it runs in parallel and only reads files
+static void load_layer_dir_json(size_t idx, void *context)
+{
+    struct layer_dirs_load_context *ctx = (struct layer_dirs_load_context *)context;
+    const char *name = ctx->names[idx];
+    struct layer_dir_load_result *result = &ctx->results[idx];
     char *rpath = NULL;
     char *mount_point_path = NULL;
-    layer_t *l = NULL;
 
-    nret = snprintf(tmpdir, PATH_MAX, "%s/%s", path_name, sub_dir->d_name);
-    if (nret < 0 || nret >= PATH_MAX) {
-        ERROR("Sprintf: %s failed", sub_dir->d_name);
-        goto free_out;
-    }
+    result->state = LAYER_DIR_SKIP;
 
 #ifdef ENABLE_REMOTE_LAYER_STORE
     // skip RO dir
     // otherwise, RO dir will be treat as invalid layer dir
-    if (strcmp(sub_dir->d_name, REMOTE_RO_LAYER_DIR) == 0) {
-        goto free_out;
+    if (strcmp(name, REMOTE_RO_LAYER_DIR) == 0) {
+        return;
     }
 #endif
 
-    if (!util_dir_exists(tmpdir)) {
-        // ignore non-dir
-        DEBUG("%s is not directory", sub_dir->d_name);
-        goto free_out;
+    if (strcmp(name, LAYER_STAGING_DIR) == 0) {
+        return;
     }
 
-    mount_point_path = mountpoint_json_path(sub_dir->d_name);
+    mount_point_path = mountpoint_json_path(name);
     if (mount_point_path == NULL) {
         ERROR("Out of Memory");
-        goto free_out;
+        return;
     }
 
-    if (strlen(sub_dir->d_name) != LAYER_NAME_LEN) {
-        ERROR("%s is invalid subdir name", sub_dir->d_name);
-        goto remove_invalid_dir;
+    result->state = LAYER_DIR_INVALID;
+    if (strlen(name) != LAYER_NAME_LEN) {
+        ERROR("%s is invalid subdir name", name);
+        goto out;
     }
 
-    rpath = layer_json_path(sub_dir->d_name);
+    rpath = layer_json_path(name);
     if (rpath == NULL) {
-        ERROR("%s is invalid layer", sub_dir->d_name);
-        goto remove_invalid_dir;
+        ERROR("%s is invalid layer", name);
+        goto out;
     }
 
-    l = load_layer(rpath, mount_point_path);
-    if (l == NULL) {
-        ERROR("load layer: %s failed, remove it", sub_dir->d_name);
+    result->layer = load_layer(rpath, mount_point_path);
+    if (result->layer == NULL) {
+        ERROR("load layer: %s failed, remove it", name);
+        goto out;
+    }
+    result->state = LAYER_DIR_LOADED;
+
+out:
+    free(rpath);
+    free(mount_point_path);
+}
+
+static void load_layer_dir(const char *name, struct layer_dir_load_result *result)
+{
+    char tmpdir[PATH_MAX] = { 0 };
+    int nret = 0;
+    layer_t *l = result->layer;
+
+    result->layer = NULL;
+    if (result->state == LAYER_DIR_SKIP) {
+        return;
+    }
+
+    nret = snprintf(tmpdir, PATH_MAX, "%s/%s", g_root_dir, name);
+    if (nret < 0 || nret >= PATH_MAX) {
+        ERROR("Sprintf: %s failed", name);
+        goto free_out;
+    }
+
+    if (result->state == LAYER_DIR_INVALID) {
         goto remove_invalid_dir;
     }
 
     if (do_validate_image_layer(tmpdir, l) != 0) {
-        ERROR("%s is invalid image layer", sub_dir->d_name);
+        ERROR("%s is invalid image layer", name);
         goto remove_invalid_dir;
     }
 
     if (do_validate_rootfs_layer(l) != 0) {
-        ERROR("%s is invalid rootfs layer", sub_dir->d_name);
+        ERROR("%s is invalid rootfs layer", name);
         goto remove_invalid_dir;
     }
 
@@ -1638,14 +1942,13 @@ static bool load_layer_json_cb(const char *path_name, const struct dirent *sub_d
         goto remove_invalid_dir;
     }
 
-    flag = true;
-    goto free_out;
+    return;
 
 remove_invalid_dir:
-    (void)graphdriver_umount_layer(sub_dir->d_name);
+    (void)graphdriver_umount_layer(name);
     // layer not removed successfully, we can't remove layer.json
-    if (graphdriver_rm_layer(sub_dir->d_name) != 0) {
-        ERROR("failed to rm layer: %s when handing invalid rootfs", sub_dir->d_name);
+    if (graphdriver_rm_layer(name) != 0) {
+        ERROR("failed to rm layer: %s when handing invalid rootfs", name);
         goto free_out;
     }
     ERROR("tmpdir is %s", tmpdir);
@@ -1654,14 +1957,48 @@ remove_invalid_dir:
     }
 
 free_out:
-    free(rpath);
-    free(mount_point_path);
-    if (!flag) {
-        free_layer_t(l);
+    free_layer_t(l);
+}
+
+/*
+ * Layer json files are parsed by several threads, then validated and appended into layer list in
+ * order of dirs. If load layer failed, just remove it.
+ */
+static int load_layer_dirs(void)
+{
+    int ret = 0;
+    size_t i;
+    size_t len = 0;
+    struct layer_dirs_load_context ctx = { 0 };
+
+    ret = util_list_all_subdir(g_root_dir, &ctx.names);
+    if (ret != 0) {
+        ERROR("Failed to list layer dirs in %s", g_root_dir);
+        return -1;
     }
-    // always return true;
-    // if load layer failed, just remove it
-    return true;
+
+    len = util_array_len((const char **)ctx.names);
+    if (len == 0) {
+        goto out;
+    }
+
+    ctx.results = util_smart_calloc_s(sizeof(struct layer_dir_load_result), len);
+    if (ctx.results == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto out;
+    }
+
+    util_parallel_for(len, LOAD_LAYER_WORKERS, load_layer_dir_json, &ctx);
+
+    for (i = 0; i < len; i++) {
+        load_layer_dir(ctx.names[i], &ctx.results[i]);
+    }
+
+out:
+    free(ctx.results);
+    util_free_array(ctx.names);
+    return ret;
 }
 
 static int load_layers_from_json_files()
@@ -1675,7 +2012,7 @@ static int load_layers_from_json_files()
         return -1;
     }
 
-    ret = util_scan_subdirs(g_root_dir, load_layer_json_cb, NULL);
+    ret = load_layer_dirs();
     if (ret != 0) {
         goto unlock_out;
     }
@@ -1787,6 +2124,7 @@ int layer_store_init(const struct storage_module_init_options *conf)
         ERROR("build run dir of layer store failed");
         goto free_out;
     }
+    remove_staging_dir();
 
 #ifdef ENABLE_REMOTE_LAYER_STORE
     if (g_enable_remote_layer && remote_layer_init(g_root_dir) != 0) {
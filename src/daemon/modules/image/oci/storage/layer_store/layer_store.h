@@ -46,6 +46,9 @@ struct layer_opts {
     char *uncompressed_digest;
     char *compressed_digest;
 
+    // diff staged by layer_store_stage_diff, diff content is applied if it can not be used
+    char *staged_diff;
+
     // mount options
     struct layer_store_mount_opts *opts;
 };
@@ -57,6 +60,9 @@ void layer_store_cleanup();
 void remove_layer_list_tail();
 int layer_store_create(const char *id, const struct layer_opts *opts, const struct io_read_wrapper *content,
                        char **new_id);
+bool layer_store_support_stage_diff(void);
+char *layer_store_stage_diff(const struct io_read_wrapper *diff);
+void layer_store_remove_staged_diff(const char *stage);
 int layer_inc_hold_refs(const char *layer_id);
 int layer_dec_hold_refs(const char *layer_id);
 int layer_get_hold_refs(const char *layer_id, int *ref_num);
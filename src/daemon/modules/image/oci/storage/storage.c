@@ -154,6 +154,7 @@ static struct layer_opts *fill_create_layer_opts(storage_layer_create_opts_t *co
     opts->parent = util_strdup_s(copts->parent);
     opts->uncompressed_digest = util_strdup_s(copts->uncompress_digest);
     opts->compressed_digest = util_strdup_s(copts->compressed_digest);
+    opts->staged_diff = util_strdup_s(copts->staged_diff);
     opts->writable = copts->writable;
 
     opts->opts = util_common_calloc_s(sizeof(struct layer_store_mount_opts));
@@ -277,6 +278,44 @@ out:
     return ret;
 }
 
+char *storage_layer_stage_diff(const char *layer_data_path)
+{
+    char *staged_diff = NULL;
+    struct io_read_wrapper *reader = NULL;
+
+    if (layer_data_path == NULL) {
+        ERROR("Invalid arguments for stage layer diff");
+        return NULL;
+    }
+
+    // checked before the layer data is opened, diff is applied from it when the layer is created then
+    if (!layer_store_support_stage_diff()) {
+        return NULL;
+    }
+
+    if (fill_read_wrapper(layer_data_path, &reader) != 0) {
+        ERROR("Failed to fill layer read wrapper");
+        return NULL;
+    }
+
+    staged_diff = layer_store_stage_diff(reader);
+
+    if (reader->close != NULL) {
+        reader->close(reader->context, NULL);
+    }
+    free(reader);
+    return staged_diff;
+}
+
+void storage_layer_remove_staged_diff(const char *staged_diff)
+{
+    if (staged_diff == NULL) {
+        return;
+    }
+
+    layer_store_remove_staged_diff(staged_diff);
+}
+
 struct layer_list *storage_layers_get_by_compress_digest(const char *digest)
 {
     int ret = 0;
@@ -417,6 +456,32 @@ imagetool_image *storage_img_get(const char *img_id)
     return image_info;
 }
 
+image_info_ref *storage_img_get_ref(const char *img_id)
+{
+    char *normalized_name = NULL;
+    image_info_ref *ref = NULL;
+
+    if (img_id == NULL) {
+        ERROR("Invalid arguments for image get");
+        return NULL;
+    }
+
+    if (util_valid_short_sha256_id(img_id) && image_store_exists(img_id)) {
+        ref = image_store_get_image_ref(img_id);
+    } else {
+        normalized_name = oci_normalize_image_name(img_id);
+        ref = image_store_get_image_ref(normalized_name);
+    }
+
+    free(normalized_name);
+    return ref;
+}
+
+void storage_img_put_ref(image_info_ref *ref)
+{
+    image_store_put_image_ref(ref);
+}
+
 imagetool_image_summary *storage_img_get_summary(const char *img_id)
 {
     char *normalized_name = NULL;
@@ -959,6 +1024,11 @@ bool storage_image_exist(const char *image_or_id)
     return image_store_exists(image_or_id);
 }
 
+void storage_get_img_cache_stats(uint64_t *hits, uint64_t *misses)
+{
+    image_store_get_image_cache_stats(hits, misses);
+}
+
 size_t storage_get_img_count()
 {
     return image_store_get_images_number();
@@ -1508,7 +1578,7 @@ out:
 static int do_storage_check_image(const char *path, const char *id, map_t *checked_layers)
 {
     int ret = -1;
-    imagetool_image *img = NULL;
+    image_info_ref *img = NULL;
     struct linked_list *layer_ids = NULL;
 
     if (id == NULL) {
@@ -1516,11 +1586,11 @@ static int do_storage_check_image(const char *path, const char *id, map_t *check
         return -1;
     }
 
-    img = image_store_get_image(id);
+    img = image_store_get_image_ref(id);
     if (img == NULL) {
         goto out;
     }
-    layer_ids = get_image_layers(img->top_layer);
+    layer_ids = get_image_layers(img->info->top_layer);
     if (layer_ids == NULL) {
         goto out;
     }
@@ -1529,7 +1599,7 @@ static int do_storage_check_image(const char *path, const char *id, map_t *check
     ret = do_check_layers_list(path, layer_ids, checked_layers);
 
 out:
-    free_imagetool_image(img);
+    image_store_put_image_ref(img);
     free_layers_linked_list(layer_ids);
     return ret;
 }
@@ -113,10 +113,18 @@ typedef struct storage_layer_create_opts {
     const char *uncompress_digest;
     const char *compressed_digest;
     const char *layer_data_path;
+    // returned by storage_layer_stage_diff for layer_data_path, optional
+    const char *staged_diff;
     bool writable;
     json_map_string_string *storage_opts;
 } storage_layer_create_opts_t;
 
+// Detail info of an image shared by readers, it must not be modified
+typedef struct image_info_ref {
+    uint64_t refcnt;
+    imagetool_image *info;
+} image_info_ref;
+
 int storage_module_init(struct storage_module_init_options *opts);
 
 void storage_module_exit();
@@ -129,6 +137,11 @@ int storage_img_create(const char *id, const char *parent_id, const char *metada
 
 imagetool_image *storage_img_get(const char *img_id);
 
+// same as storage_img_get, but the info is shared and should be released by storage_img_put_ref
+image_info_ref *storage_img_get_ref(const char *img_id);
+
+void storage_img_put_ref(image_info_ref *ref);
+
 imagetool_image_summary *storage_img_get_summary(const char *img_id);
 
 int storage_img_set_big_data(const char *img_id, const char *key, const char *val);
@@ -155,11 +168,18 @@ char *storage_get_img_top_layer(const char *id);
 
 size_t storage_get_img_count();
 
+void storage_get_img_cache_stats(uint64_t *hits, uint64_t *misses);
+
 char *storage_img_get_image_id(const char *img_name);
 
 /* layer operations */
 int storage_layer_create(const char *layer_id, storage_layer_create_opts_t *opts);
 
+/* unpack layer data before the layer is created, storage is not locked so layers can be staged concurrently */
+char *storage_layer_stage_diff(const char *layer_data_path);
+
+void storage_layer_remove_staged_diff(const char *staged_diff);
+
 /* delete the layer and the parent layer if not used recursively */
 int storage_layer_chain_delete(const char *layer_id);
 
@@ -15,6 +15,7 @@
 #include "cni_operate.h"
 
 #include <pthread.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 
 #include "isula_libutils/log.h"
@@ -23,6 +24,7 @@
 #include "isula_libutils/cni_anno_port_mappings.h"
 #include "utils.h"
 #include "utils_network.h"
+#include "util_atomic.h"
 
 #define LO_IFNAME "lo"
 
@@ -283,6 +285,29 @@ out:
     return n_list;
 }
 
+static struct cni_network_list_conf *load_valid_cni_config_file_list(const char *fname)
+{
+    struct cni_network_list_conf *n_list = NULL;
+
+    n_list = load_cni_config_file_list(fname);
+    if (n_list == NULL) {
+        WARN("Load cni network conflist from file:%s failed", fname);
+        return NULL;
+    }
+
+    if (n_list->list == NULL || n_list->list->plugins_len == 0) {
+        WARN("CNI config list %s has no networks, skipping", fname);
+        free_cni_network_list_conf(n_list);
+        return NULL;
+    }
+
+    // TODO: check plugins of config
+
+    DEBUG("parse cni network: %s", n_list->list->name);
+
+    return n_list;
+}
+
 // Try my best to load file, when error occured, just skip and continue
 static int update_conflist_from_files(struct cni_network_list_conf **conflists, const char **files, size_t files_num,
                                       size_t *nets_num, cni_conf_filter_t filter_ops)
@@ -318,22 +343,11 @@ static int update_conflist_from_files(struct cni_network_list_conf **conflists,
             continue;
         }
 
-        n_list = load_cni_config_file_list(files[i]);
+        n_list = load_valid_cni_config_file_list(files[i]);
         if (n_list == NULL) {
-            WARN("Load cni network conflist from file:%s failed", files[i]);
             continue;
         }
 
-        if (n_list->list == NULL || n_list->list->plugins_len == 0) {
-            WARN("CNI config list %s has no networks, skipping", files[i]);
-            free_cni_network_list_conf(n_list);
-            continue;
-        }
-
-        // TODO: check plugins of config
-
-        DEBUG("parse cni network: %s", n_list->list->name);
-
         conflists[*nets_num] = n_list;
         (*nets_num)++;
     }
@@ -444,6 +458,158 @@ out:
     return ret;
 }
 
+void cni_conf_file_ref_dec(struct cni_conf_file *file)
+{
+    if (file == NULL || !atomic_int_dec_test(&file->refcnt)) {
+        return;
+    }
+
+    free(file->path);
+    free_cni_network_list_conf(file->conf);
+    free(file);
+}
+
+static bool conf_file_unchanged(const struct cni_conf_file *file, const char *path, const struct stat *st)
+{
+    return strcmp(file->path, path) == 0 && file->dev == st->st_dev && file->ino == st->st_ino &&
+           file->size == st->st_size && file->mtime.tv_sec == st->st_mtim.tv_sec &&
+           file->mtime.tv_nsec == st->st_mtim.tv_nsec && file->ctime.tv_sec == st->st_ctim.tv_sec &&
+           file->ctime.tv_nsec == st->st_ctim.tv_nsec;
+}
+
+// old is sorted by path as the result of get_conf_files, so search from the last matched position
+static struct cni_conf_file *find_unchanged_conf_file(struct cni_conf_file **old, size_t old_len, size_t *pos,
+                                                      const char *path, const struct stat *st)
+{
+    size_t i;
+
+    for (i = *pos; i < old_len; i++) {
+        if (strcmp(old[i]->path, path) > 0) {
+            break;
+        }
+        if (conf_file_unchanged(old[i], path, st)) {
+            *pos = i + 1;
+            atomic_int_inc(&old[i]->refcnt);
+            return old[i];
+        }
+    }
+
+    return NULL;
+}
+
+static struct cni_conf_file *load_cni_conf_file(const char *path, const struct stat *st)
+{
+    struct cni_conf_file *file = NULL;
+
+    file = util_common_calloc_s(sizeof(struct cni_conf_file));
+    if (file == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    file->conf = load_valid_cni_config_file_list(path);
+    if (file->conf == NULL) {
+        free(file);
+        return NULL;
+    }
+    file->path = util_strdup_s(path);
+    file->dev = st->st_dev;
+    file->ino = st->st_ino;
+    file->size = st->st_size;
+    file->mtime = st->st_mtim;
+    file->ctime = st->st_ctim;
+    atomic_int_set(&file->refcnt, 1);
+
+    return file;
+}
+
+int get_net_conf_files_from_dir(struct cni_conf_file **old, size_t old_len, cni_conf_filter_t filter_ops,
+                                struct cni_conf_file ***store, size_t *res_len, bool *changed)
+{
+    int ret = 0;
+    size_t i;
+    size_t pos = 0;
+    size_t files_num = 0;
+    size_t nets_num = 0;
+    size_t reused = 0;
+    char **files = NULL;
+    char *fname = NULL;
+    struct cni_conf_file **tmp_files = NULL;
+
+    if (store == NULL || res_len == NULL || changed == NULL) {
+        ERROR("Invalid input params");
+        return -1;
+    }
+
+    if (get_conf_files(&files, &files_num) != 0) {
+        ERROR("Get cni conf files in ascending order failed");
+        return -1;
+    }
+
+    if (files_num > 0) {
+        tmp_files = (struct cni_conf_file **)util_smart_calloc_s(sizeof(struct cni_conf_file *), files_num);
+        if (tmp_files == NULL) {
+            ERROR("Out of memory, cannot allocate mem to store conf files");
+            ret = -1;
+            goto out;
+        }
+    }
+
+    // Try my best to load file, when error occured, just skip and continue
+    for (i = 0; i < files_num; i++) {
+        struct stat st = { 0 };
+        struct cni_conf_file *file = NULL;
+
+        UTIL_FREE_AND_SET_NULL(fname);
+        fname = util_path_base(files[i]);
+        if (fname == NULL) {
+            ERROR("Get file name from full path:%s failed", files[i]);
+            ret = -1;
+            goto out;
+        }
+
+        if (filter_ops != NULL && !filter_ops(fname)) {
+            DEBUG("Net config file:%s donot match, skip", fname);
+            continue;
+        }
+
+        if (stat(files[i], &st) != 0) {
+            SYSWARN("Failed to stat cni conf file %s", files[i]);
+            continue;
+        }
+
+        file = find_unchanged_conf_file(old, old_len, &pos, files[i], &st);
+        if (file != NULL) {
+            reused++;
+        } else {
+            file = load_cni_conf_file(files[i], &st);
+        }
+        if (file == NULL) {
+            continue;
+        }
+
+        tmp_files[nets_num] = file;
+        nets_num++;
+    }
+
+    // files of old are reused in order, so nothing changed if all of them are reused
+    *changed = (reused != old_len || nets_num != old_len);
+    *store = tmp_files;
+    tmp_files = NULL;
+    *res_len = nets_num;
+
+out:
+    if (tmp_files != NULL) {
+        for (i = 0; i < nets_num; i++) {
+            cni_conf_file_ref_dec(tmp_files[i]);
+        }
+        free(tmp_files);
+    }
+    free(fname);
+    util_free_array_by_len(files, files_num);
+    return ret;
+}
+
 static struct runtime_conf *build_loopback_runtime_conf(const char *cid, const char *netns_path)
 {
     struct runtime_conf *rt = NULL;
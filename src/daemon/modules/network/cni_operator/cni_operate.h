@@ -15,6 +15,10 @@
 #ifndef NET_MANAGER_API_H
 #define NET_MANAGER_API_H
 
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+
 #include "map.h"
 #include "libcni_api.h"
 
@@ -45,6 +49,31 @@ int cni_manager_store_init(const char *cache_dir, const char *conf_path, const c
 
 int get_net_conflist_from_dir(struct cni_network_list_conf ***store, size_t *res_len, cni_conf_filter_t filter_ops);
 
+// conflist loaded from a conf file, shared by the loaded results until the file changes
+struct cni_conf_file {
+    char *path;
+    // identity of the file when it was loaded
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    // mtime can be set back by writers, but ctime can not
+    struct timespec ctime;
+
+    struct cni_network_list_conf *conf;
+    uint64_t refcnt;
+};
+
+void cni_conf_file_ref_dec(struct cni_conf_file *file);
+
+/*
+ * Load conf files in conf dir in ascending order, like get_net_conflist_from_dir. Files not changed
+ * since they were loaded in old are shared with old instead of being parsed again, and changed
+ * reports whether the result differs from old. Caller should drop the result by cni_conf_file_ref_dec.
+ */
+int get_net_conf_files_from_dir(struct cni_conf_file **old, size_t old_len, cni_conf_filter_t filter_ops,
+                                struct cni_conf_file ***store, size_t *res_len, bool *changed);
+
 int attach_loopback(const char *id, const char *netns);
 
 int detach_loopback(const char *id, const char *netns);
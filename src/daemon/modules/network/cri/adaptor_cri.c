@@ -14,6 +14,7 @@
  *********************************************************************************/
 #include "network_api.h"
 
+#include <pthread.h>
 #include <isula_libutils/log.h>
 #include "cni_operate.h"
 #include "utils.h"
@@ -21,22 +22,68 @@
 #include "utils_network.h"
 #include "err_msg.h"
 #include "network_tools.h"
+#include "util_atomic.h"
 
-// do not need lock;
-// because cri can make sure do not concurrent to call these apis
+// immutable snapshot of cni network configs, replaced as a whole when configs changed,
+// so attaching networks never waits for reloading
 typedef struct network_store_t {
-    struct cni_network_list_conf **conflist;
+    struct cni_conf_file **conflist;
     size_t conflist_len;
     map_t *g_net_index_map;
+    uint64_t refcnt;
 } network_store;
 
 #define DEFAULT_NETWORK_INTERFACE "eth0"
 
-static network_store g_net_store = { 0 };
+static pthread_mutex_t g_net_store_mutex = PTHREAD_MUTEX_INITIALIZER;
+// protected by g_net_store_mutex
+static network_store *g_net_store = NULL;
+// serialize updaters, so a store is never replaced by one built from an older store
+static pthread_mutex_t g_net_store_update_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void free_network_store(network_store *store)
+{
+    size_t i;
+
+    map_free(store->g_net_index_map);
+    for (i = 0; i < store->conflist_len; i++) {
+        cni_conf_file_ref_dec(store->conflist[i]);
+    }
+    free(store->conflist);
+    free(store);
+}
+
+static void network_store_ref_dec(network_store *store)
+{
+    if (store != NULL && atomic_int_dec_test(&store->refcnt)) {
+        free_network_store(store);
+    }
+}
+
+// Get a reference of current networks, caller should call network_store_ref_dec after use
+static network_store *get_network_store(void)
+{
+    network_store *store = NULL;
+
+    (void)pthread_mutex_lock(&g_net_store_mutex);
+    store = g_net_store;
+    if (store != NULL) {
+        atomic_int_inc(&store->refcnt);
+    }
+    (void)pthread_mutex_unlock(&g_net_store_mutex);
+
+    return store;
+}
 
 bool adaptor_cni_check_inited()
 {
-    return g_net_store.conflist_len > 0;
+    bool inited = false;
+
+    (void)pthread_mutex_lock(&g_net_store_mutex);
+    inited = g_net_store != NULL && g_net_store->conflist_len > 0;
+    (void)pthread_mutex_unlock(&g_net_store_mutex);
+
+    return inited;
 }
 
 static bool is_cri_config_file(const char *filename)
@@ -48,62 +95,41 @@ static bool is_cri_config_file(const char *filename)
     return strncmp(ISULAD_CNI_NETWORK_CONF_FILE_PRE, filename, strlen(ISULAD_CNI_NETWORK_CONF_FILE_PRE)) != 0;
 }
 
-static void do_update_cni_stores(map_t *work, struct cni_network_list_conf **new_list, size_t new_list_len)
+static void do_update_cni_stores(network_store *store)
 {
-    size_t i;
+    network_store *old = NULL;
 
-    map_free(g_net_store.g_net_index_map);
-    g_net_store.g_net_index_map = work;
+    atomic_int_set(&store->refcnt, 1);
+    (void)pthread_mutex_lock(&g_net_store_mutex);
+    old = g_net_store;
+    g_net_store = store;
+    (void)pthread_mutex_unlock(&g_net_store_mutex);
 
-    for (i = 0; i < g_net_store.conflist_len; i++) {
-        free_cni_network_list_conf(g_net_store.conflist[i]);
-    }
-    free(g_net_store.conflist);
-    g_net_store.conflist = new_list;
-    g_net_store.conflist_len = new_list_len;
+    network_store_ref_dec(old);
 }
 
-int adaptor_cni_update_confs()
+static int build_net_index_map(network_store *store)
 {
-    int ret = 0;
-    map_t *work = NULL;
-    struct cni_network_list_conf **tmp_net_list = NULL;
-    size_t tmp_net_list_len = 0;
     size_t i;
     char message[MAX_BUFFER_SIZE] = { 0 };
     int pos = 0;
 
-    work = map_new(MAP_STR_INT, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
-    if (work == NULL) {
+    store->g_net_index_map = map_new(MAP_STR_INT, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (store->g_net_index_map == NULL) {
         ERROR("Out of memory");
         return -1;
     }
 
-    // get new conflist data
-    ret = get_net_conflist_from_dir(&tmp_net_list, &tmp_net_list_len, is_cri_config_file);
-    if (ret != 0) {
-        ERROR("Update new config list failed");
-        goto out;
-    }
-    if (tmp_net_list_len == 0) {
-        WARN("No cni config list found");
-        goto out;
-    }
-
-    for (i = 0; i < tmp_net_list_len; i++) {
-        struct cni_network_list_conf *iter = tmp_net_list[i];
-        if (iter == NULL) {
-            continue;
-        }
-        if (map_search(work, (void *)iter->list->name) != NULL) {
+    for (i = 0; i < store->conflist_len; i++) {
+        struct cni_network_list_conf *iter = store->conflist[i]->conf;
+        if (map_search(store->g_net_index_map, (void *)iter->list->name) != NULL) {
             INFO("Ignore CNI network: %s, because already exist", iter->list->name);
             continue;
         }
 
-        if (!map_replace(work, (void *)iter->list->name, (void *)&i)) {
+        if (!map_replace(store->g_net_index_map, (void *)iter->list->name, (void *)&i)) {
             ERROR("add net failed: %s", iter->list->name);
-            ret = -1;
-            goto out;
+            return -1;
         }
         if (strlen(iter->list->name) + 1 < MAX_BUFFER_SIZE - pos) {
             sprintf(message + pos, "%s,", iter->list->name);
@@ -111,22 +137,66 @@ int adaptor_cni_update_confs()
         }
     }
 
-    // update current conflist data
-    do_update_cni_stores(work, tmp_net_list, tmp_net_list_len);
-    work = NULL;
-    tmp_net_list_len = 0;
-    tmp_net_list = NULL;
-
     if (pos > 0) {
         message[pos - 1] = '\0';
     }
     INFO("Loaded cni plugins successfully, [ %s ]", message);
+    return 0;
+}
+
+int adaptor_cni_update_confs()
+{
+    int ret = 0;
+    network_store *store = NULL;
+    network_store *current = NULL;
+    struct cni_conf_file **old = NULL;
+    size_t old_len = 0;
+    bool changed = false;
+
+    store = util_common_calloc_s(sizeof(network_store));
+    if (store == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    (void)pthread_mutex_lock(&g_net_store_update_mutex);
+
+    current = get_network_store();
+    if (current != NULL) {
+        old = current->conflist;
+        old_len = current->conflist_len;
+    }
+
+    // get new conflist data, only changed files are parsed again
+    ret = get_net_conf_files_from_dir(old, old_len, is_cri_config_file, &store->conflist, &store->conflist_len,
+                                      &changed);
+    if (ret != 0) {
+        ERROR("Update new config list failed");
+        goto out;
+    }
+    if (store->conflist_len == 0) {
+        WARN("No cni config list found");
+        goto out;
+    }
+    if (!changed) {
+        goto out;
+    }
+
+    ret = build_net_index_map(store);
+    if (ret != 0) {
+        goto out;
+    }
+
+    // update current conflist data
+    do_update_cni_stores(store);
+    store = NULL;
+
 out:
-    for (i = 0; i < tmp_net_list_len; i++) {
-        free_cni_network_list_conf(tmp_net_list[i]);
+    network_store_ref_dec(current);
+    (void)pthread_mutex_unlock(&g_net_store_update_mutex);
+    if (store != NULL) {
+        free_network_store(store);
     }
-    free(tmp_net_list);
-    map_free(work);
     return ret;
 }
 
@@ -169,8 +239,8 @@ static int do_cri_append_cni_result(const char *name, const char *interface, con
     return -1;
 }
 
-static int do_foreach_network_op(const network_api_conf *conf, bool ignore_nofound, cni_op_t op,
-                                 network_api_result_list *list)
+static int do_foreach_network_op(const network_store *store, const network_api_conf *conf, bool ignore_nofound,
+                                 cni_op_t op, network_api_result_list *list)
 {
     int ret = 0;
     size_t i;
@@ -194,7 +264,7 @@ static int do_foreach_network_op(const network_api_conf *conf, bool ignore_nofou
             WARN("ignore net idx: %zu", i);
             continue;
         }
-        tmp_idx = map_search(g_net_store.g_net_index_map, (void *)conf->extral_nets[i]->name);
+        tmp_idx = map_search(store->g_net_index_map, (void *)conf->extral_nets[i]->name);
         // if user defined network is default network, return error
         if (tmp_idx == NULL || *tmp_idx == 0) {
             ERROR("User defined network is in conflict with default network: %s", conf->extral_nets[i]->name);
@@ -217,7 +287,7 @@ static int do_foreach_network_op(const network_api_conf *conf, bool ignore_nofou
         free_cni_opt_result(cni_result);
         cni_result = NULL;
 
-        if (op(&manager, g_net_store.conflist[*tmp_idx], &cni_result) != 0) {
+        if (op(&manager, store->conflist[*tmp_idx]->conf, &cni_result) != 0) {
             ERROR("Do op on net: %s failed", conf->extral_nets[i]->name);
             ret = -1;
             goto out;
@@ -230,18 +300,20 @@ static int do_foreach_network_op(const network_api_conf *conf, bool ignore_nofou
         }
     }
 
-    if (g_net_store.conflist_len > 0 && default_idx < g_net_store.conflist_len) {
+    if (store->conflist_len > 0 && default_idx < store->conflist_len) {
+        const struct cni_network_list_conf *default_net = store->conflist[default_idx]->conf;
+
         free_cni_opt_result(cni_result);
         cni_result = NULL;
 
         manager.ifname = (char *)default_interface;
-        ret = op(&manager, g_net_store.conflist[default_idx], &cni_result);
+        ret = op(&manager, default_net, &cni_result);
         if (ret != 0) {
-            ERROR("Do op on default net: %s failed", g_net_store.conflist[default_idx]->list->name);
+            ERROR("Do op on default net: %s failed", default_net->list->name);
             goto out;
         }
 
-        if (do_cri_append_cni_result(g_net_store.conflist[default_idx]->list->name, manager.ifname, cni_result, list) != 0) {
+        if (do_cri_append_cni_result(default_net->list->name, manager.ifname, cni_result, list) != 0) {
             ERROR("parse cni result failed");
             ret = -1;
             goto out;
@@ -256,57 +328,71 @@ out:
 int adaptor_cni_setup(const network_api_conf *conf, network_api_result_list *result)
 {
     int ret = 0;
+    network_store *store = NULL;
 
     if (conf == NULL) {
         ERROR("Invalid argument");
         return -1;
     }
-    if (g_net_store.conflist_len == 0) {
+    store = get_network_store();
+    if (store == NULL || store->conflist_len == 0) {
         ERROR("Not found cni networks");
-        return -1;
+        ret = -1;
+        goto out;
     }
 
     // first, attach to loopback network
     ret = attach_loopback(conf->pod_id, conf->netns_path);
     if (ret != 0) {
         ERROR("Attach to loop net failed");
-        return -1;
+        ret = -1;
+        goto out;
     }
 
-    ret = do_foreach_network_op(conf, false, attach_network_plane, result);
+    ret = do_foreach_network_op(store, conf, false, attach_network_plane, result);
     if (ret != 0) {
-        return -1;
+        ret = -1;
+        goto out;
     }
 
-    return 0;
+out:
+    network_store_ref_dec(store);
+    return ret;
 }
 
 int adaptor_cni_teardown(const network_api_conf *conf, network_api_result_list *result)
 {
     int ret = 0;
+    network_store *store = NULL;
 
     if (conf == NULL) {
         ERROR("Invalid argument");
         return -1;
     }
-    if (g_net_store.conflist_len == 0) {
+    store = get_network_store();
+    if (store == NULL || store->conflist_len == 0) {
         ERROR("Not found cni networks");
-        return -1;
+        ret = -1;
+        goto out;
     }
 
     // first, detach to loopback network
     ret = detach_loopback(conf->pod_id, conf->netns_path);
     if (ret != 0) {
         ERROR("Deatch to loop net failed");
-        return -1;
+        ret = -1;
+        goto out;
     }
 
-    ret = do_foreach_network_op(conf, true, detach_network_plane, result);
+    ret = do_foreach_network_op(store, conf, true, detach_network_plane, result);
     if (ret != 0) {
-        return -1;
+        ret = -1;
+        goto out;
     }
 
-    return 0;
+out:
+    network_store_ref_dec(store);
+    return ret;
 }
 
 int adaptor_cni_check(const network_api_conf *conf, network_api_result_list *result)
@@ -317,22 +403,26 @@ int adaptor_cni_check(const network_api_conf *conf, network_api_result_list *res
     struct cni_opt_result *cni_result = NULL;
     int default_idx = 0;
     int *tmp_idx = &default_idx;
+    network_store *store = NULL;
+    const struct cni_network_list_conf *net = NULL;
 
     if (conf == NULL) {
         ERROR("Invalid argument");
         return -1;
     }
 
-    if (g_net_store.conflist_len == 0) {
+    store = get_network_store();
+    if (store == NULL || store->conflist_len == 0) {
         ERROR("Not found cni networks");
-        return -1;
+        ret = -1;
+        goto out;
     }
 
     if (conf->default_interface != NULL) {
         use_interface = conf->default_interface;
     }
     if (conf->name != NULL) {
-        tmp_idx = map_search(g_net_store.g_net_index_map, (void *)conf->name);
+        tmp_idx = map_search(store->g_net_index_map, (void *)conf->name);
     }
 
     if (tmp_idx == NULL) {
@@ -340,23 +430,25 @@ int adaptor_cni_check(const network_api_conf *conf, network_api_result_list *res
         ret = -1;
         goto out;
     }
+    net = store->conflist[*tmp_idx]->conf;
 
     // Step1, build cni manager config
     prepare_cni_manager(conf, &manager);
     manager.ifname = (char *)use_interface;
 
-    ret = check_network_plane(&manager, g_net_store.conflist[*tmp_idx], &cni_result);
+    ret = check_network_plane(&manager, net, &cni_result);
     if (ret != 0) {
         goto out;
     }
-    if (do_cri_append_cni_result(g_net_store.conflist[*tmp_idx]->list->name, use_interface, cni_result, result) != 0) {
-        isulad_set_error_message("parse cni result for net: '%s' failed", g_net_store.conflist[*tmp_idx]->list->name);
-        ERROR("parse cni result for net: '%s' failed", g_net_store.conflist[*tmp_idx]->list->name);
+    if (do_cri_append_cni_result(net->list->name, use_interface, cni_result, result) != 0) {
+        isulad_set_error_message("parse cni result for net: '%s' failed", net->list->name);
+        ERROR("parse cni result for net: '%s' failed", net->list->name);
         ret = -1;
         goto out;
     }
 
 out:
     free_cni_opt_result(cni_result);
+    network_store_ref_dec(store);
     return ret;
 }
@@ -0,0 +1,305 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: client of exec agent in isulad-shim
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "isula_rt_exec_agent.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <isula_libutils/auto_cleanup.h>
+
+#include "isula_libutils/log.h"
+#include "constants.h"
+#include "err_msg.h"
+#include "utils.h"
+#include "utils_file.h"
+
+// must be the same as exec_agent.h of isulad-shim
+#define EXEC_AGENT_MARKER "exec-agent"
+#define EXEC_AGENT_SOCK "exec-agent.sock"
+#define EXEC_AGENT_MAGIC 0x45584147
+#define EXEC_AGENT_MSG_LEN 256
+
+// the agent kills the process on timeout, give it some time to reply before giving up
+#define EXEC_AGENT_REPLY_MARGIN 10
+
+struct exec_agent_request {
+    uint32_t magic;
+    uint32_t timeout;
+    uint32_t len;
+};
+
+enum {
+    EXEC_AGENT_OK = 0,
+    EXEC_AGENT_ERROR,
+    EXEC_AGENT_UNSUPPORTED,
+    EXEC_AGENT_TIMEOUT,
+};
+
+struct exec_agent_response {
+    uint32_t magic;
+    int32_t status;
+    int32_t pid;
+    int32_t exit_code;
+    char message[EXEC_AGENT_MSG_LEN];
+};
+
+int isula_exec_agent_prepare(const char *workdir, const json_map_string_string *annotations)
+{
+    char fname[PATH_MAX] = { 0 };
+    size_t i;
+    int nret;
+
+    if (workdir == NULL || annotations == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < annotations->len; i++) {
+        if (strcmp(annotations->keys[i], ANNOTATION_EXEC_AGENT_KEY) == 0) {
+            break;
+        }
+    }
+    if (i == annotations->len || strcmp(annotations->values[i], "true") != 0) {
+        return 0;
+    }
+
+    nret = snprintf(fname, sizeof(fname), "%s/%s", workdir, EXEC_AGENT_MARKER);
+    if (nret < 0 || (size_t)nret >= sizeof(fname)) {
+        ERROR("Failed make exec agent marker full path");
+        return -1;
+    }
+
+    if (util_write_file(fname, "", 0, DEFAULT_SECURE_FILE_MODE) != 0) {
+        ERROR("Failed write exec agent marker %s", fname);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int open_exec_stdio(const char *fifo, int flags)
+{
+    int fd = -1;
+
+    if (fifo == NULL) {
+        return util_open("/dev/null", (flags == O_RDONLY ? O_RDONLY : O_WRONLY) | O_CLOEXEC, 0);
+    }
+
+    // open nonblock as the other side may not be opened yet, the agent clears it for the process
+    fd = util_open(fifo, flags | O_NONBLOCK | O_CLOEXEC, 0);
+    if (fd < 0) {
+        SYSERROR("Failed to open exec fifo %s", fifo);
+    }
+
+    return fd;
+}
+
+static int connect_exec_agent(const char *workdir)
+{
+    struct sockaddr_un addr;
+    int nret = 0;
+    int fd = -1;
+
+    (void)memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    nret = snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/%s", workdir, EXEC_AGENT_SOCK);
+    if (nret < 0 || (size_t)nret >= sizeof(addr.sun_path)) {
+        DEBUG("Exec agent socket path of %s is too long", workdir);
+        return -1;
+    }
+
+    if (!util_file_exists(addr.sun_path)) {
+        return -1;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        SYSERROR("Failed to create exec agent socket");
+        return -1;
+    }
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        // the shim may have exited, or the container started before the agent was enabled
+        DEBUG("Failed to connect exec agent %s: %s", addr.sun_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static int send_exec_request(int fd, const char *data, int64_t timeout, const char **console_fifos)
+{
+    struct exec_agent_request req = { 0 };
+    char control[CMSG_SPACE(sizeof(int) * 3)] = { 0 };
+    struct iovec iov = { &req, sizeof(req) };
+    struct msghdr msg;
+    struct cmsghdr *cmsg = NULL;
+    int stdio[3] = { -1, -1, -1 };
+    ssize_t nret = 0;
+    int ret = -1;
+    int i;
+
+    stdio[0] = open_exec_stdio(console_fifos != NULL ? console_fifos[0] : NULL, O_RDONLY);
+    // write side is opened read-write, which never blocks nor fails without a reader
+    stdio[1] = open_exec_stdio(console_fifos != NULL ? console_fifos[1] : NULL, O_RDWR);
+    stdio[2] = open_exec_stdio(console_fifos != NULL ? console_fifos[2] : NULL, O_RDWR);
+    if (stdio[0] < 0 || stdio[1] < 0 || stdio[2] < 0) {
+        goto out;
+    }
+
+    req.magic = EXEC_AGENT_MAGIC;
+    req.timeout = timeout > 0 ? (uint32_t)timeout : 0;
+    req.len = (uint32_t)strlen(data);
+
+    (void)memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(stdio));
+    (void)memcpy(CMSG_DATA(cmsg), stdio, sizeof(stdio));
+
+    do {
+        nret = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    } while (nret < 0 && errno == EINTR);
+    if (nret != (ssize_t)sizeof(req)) {
+        SYSERROR("Failed to send exec request to agent");
+        goto out;
+    }
+
+    if (util_write_nointr_in_total(fd, data, req.len) != (ssize_t)req.len) {
+        SYSERROR("Failed to send exec process to agent");
+        goto out;
+    }
+
+    ret = 0;
+
+out:
+    for (i = 0; i < 3; i++) {
+        if (stdio[i] >= 0) {
+            close(stdio[i]);
+        }
+    }
+    return ret;
+}
+
+static int recv_exec_response(int fd, int64_t timeout, struct exec_agent_response *resp)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    int wait_ms = timeout > 0 ? (int)((timeout + EXEC_AGENT_REPLY_MARGIN) * 1000) : -1;
+    size_t total = 0;
+    ssize_t nread = 0;
+    int nret = 0;
+
+    while (total < sizeof(*resp)) {
+        nret = poll(&pfd, 1, wait_ms);
+        if (nret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nret <= 0) {
+            ERROR("Wait exec agent response failed or timed out");
+            return -1;
+        }
+
+        nread = util_read_nointr(fd, (char *)resp + total, sizeof(*resp) - total);
+        if (nread <= 0) {
+            ERROR("Exec agent closed connection before response");
+            return -1;
+        }
+        total += (size_t)nread;
+    }
+
+    if (resp->magic != EXEC_AGENT_MAGIC) {
+        ERROR("Invalid exec agent response");
+        return -1;
+    }
+    resp->message[sizeof(resp->message) - 1] = '\0';
+
+    return 0;
+}
+
+int isula_exec_agent_exec(const char *workdir, const shim_client_process_state *p, const char **console_fifos,
+                          int64_t timeout, int *exit_code)
+{
+    struct parser_context ctx = { OPT_GEN_SIMPLIFY, 0 };
+    __isula_auto_free parser_error perr = NULL;
+    __isula_auto_free char *data = NULL;
+    struct exec_agent_response resp = { 0 };
+    int fd = -1;
+    int ret = 1;
+
+    if (workdir == NULL || p == NULL || exit_code == NULL || p->terminal) {
+        return 1;
+    }
+
+    fd = connect_exec_agent(workdir);
+    if (fd < 0) {
+        return 1;
+    }
+
+    data = shim_client_process_state_generate_json(p, &ctx, &perr);
+    if (data == NULL) {
+        ERROR("Failed generate json for exec process error=%s", perr);
+        goto out;
+    }
+
+    // nothing is run if the request is not sent, the shim can be tried then
+    if (send_exec_request(fd, data, timeout, console_fifos) != 0) {
+        goto out;
+    }
+
+    if (recv_exec_response(fd, timeout, &resp) != 0) {
+        isulad_set_error_message("Exec container error;exec agent failed");
+        ret = -1;
+        goto out;
+    }
+
+    switch (resp.status) {
+        case EXEC_AGENT_OK:
+            DEBUG("Exec agent ran process %d, exit code %d", resp.pid, resp.exit_code);
+            *exit_code = resp.exit_code;
+            ret = 0;
+            break;
+        case EXEC_AGENT_UNSUPPORTED:
+            DEBUG("Exec agent of %s can not run the process: %s", workdir, resp.message);
+            ret = 1;
+            break;
+        case EXEC_AGENT_TIMEOUT:
+            ERROR("Exec agent killed process %d for execing timeout", resp.pid);
+            isulad_set_error_message("Exec container error;exec timeout");
+            ret = -1;
+            break;
+        default:
+            ERROR("Exec agent failed to run process: %s", resp.message);
+            isulad_set_error_message("Exec container error;%s", resp.message);
+            ret = -1;
+            break;
+    }
+
+out:
+    close(fd);
+    return ret;
+}
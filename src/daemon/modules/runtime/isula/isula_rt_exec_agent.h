@@ -0,0 +1,42 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: client of exec agent in isulad-shim definition
+ ******************************************************************************/
+
+#ifndef DAEMON_MODULES_RUNTIME_ISULA_ISULA_RT_EXEC_AGENT_H
+#define DAEMON_MODULES_RUNTIME_ISULA_ISULA_RT_EXEC_AGENT_H
+
+#include <stdint.h>
+#include <isula_libutils/json_common.h>
+#include <isula_libutils/shim_client_process_state.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// enable the exec agent of container shim in workdir, if annotations ask for it
+int isula_exec_agent_prepare(const char *workdir, const json_map_string_string *annotations);
+
+/*
+ * Exec process p by the exec agent of container shim in workdir.
+ * Return 0 if the process ran, -1 on failure, and 1 if the agent is not available
+ * or can not run the process, which should be execed with a new shim then.
+ */
+int isula_exec_agent_exec(const char *workdir, const shim_client_process_state *p, const char **console_fifos,
+                          int64_t timeout, int *exit_code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_MODULES_RUNTIME_ISULA_ISULA_RT_EXEC_AGENT_H
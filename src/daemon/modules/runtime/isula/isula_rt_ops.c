@@ -49,6 +49,8 @@
 #include "utils_convert.h"
 #include "utils_file.h"
 #include "console.h"
+#include "isula_rt_stats.h"
+#include "isula_rt_exec_agent.h"
 
 #define SHIM_BINARY "isulad-shim"
 #define RESIZE_FIFO_NAME "resize_fifo"
@@ -59,6 +61,8 @@
 
 // file name formats of cgroup resources json
 #define RESOURCE_FNAME_FORMATS "%s/resources.json"
+// start time of the container process, saved once the container is started
+#define START_TIME_FNAME "start-time"
 
 // handle string from stderr output.
 typedef int(*handle_output_callback_t)(const char *output);
@@ -147,6 +151,63 @@ static void file_read_int(const char *fname, int *val)
     free(sint);
 }
 
+static int save_process_start_time(const char *workdir, unsigned long long start_time)
+{
+    char fname[PATH_MAX] = { 0 };
+    char stime[ISULAD_NUMSTRLEN64] = { 0 };
+    int nret = 0;
+
+    nret = snprintf(fname, sizeof(fname), "%s/%s", workdir, START_TIME_FNAME);
+    if (nret < 0 || (size_t)nret >= sizeof(fname)) {
+        ERROR("failed make start time full path");
+        return -1;
+    }
+
+    nret = snprintf(stime, sizeof(stime), "%llu", start_time);
+    if (nret < 0 || (size_t)nret >= sizeof(stime)) {
+        return -1;
+    }
+
+    if (util_write_file(fname, stime, strlen(stime), DEFAULT_SECURE_FILE_MODE) < 0) {
+        ERROR("failed write start time file %s", fname);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int read_process_start_time(const char *workdir, unsigned long long *start_time)
+{
+    char fname[PATH_MAX] = { 0 };
+    char *stime = NULL;
+    uint64_t val = 0;
+    int nret = 0;
+
+    nret = snprintf(fname, sizeof(fname), "%s/%s", workdir, START_TIME_FNAME);
+    if (nret < 0 || (size_t)nret >= sizeof(fname)) {
+        ERROR("failed make start time full path");
+        return -1;
+    }
+
+    if (!util_file_exists(fname)) {
+        return -1;
+    }
+
+    stime = util_read_text_file(fname);
+    if (stime == NULL) {
+        return -1;
+    }
+
+    nret = util_safe_uint64(stime, &val);
+    free(stime);
+    if (nret != 0) {
+        return -1;
+    }
+
+    *start_time = (unsigned long long)val;
+    return 0;
+}
+
 static void get_err_message(char *buf, int buf_size, const char *workdir, const char *file)
 {
     int nret;
@@ -959,6 +1020,10 @@ int rt_isula_create(const char *id, const char *runtime, const rt_create_params_
         goto out;
     }
 
+    if (isula_exec_agent_prepare(workdir, config->annotations) != 0) {
+        WARN("%s: failed to enable exec agent, exec with new shim", id);
+    }
+
     get_runtime_cmd(runtime, &cmd);
     ret = shim_create(false, id, workdir, params->bundle, cmd, NULL, NULL, &shim_exit_code);
     if (ret != 0) {
@@ -1031,6 +1096,9 @@ int rt_isula_start(const char *id, const char *runtime, const rt_start_params_t
         goto out;
     }
 
+    // only used to get status quickly, the runtime is asked if it is missing
+    (void)save_process_start_time(workdir, proc->start_time);
+
     ret = 0;
 out:
     if (ret != 0) {
@@ -1066,6 +1134,9 @@ int rt_isula_clean_resource(const char *id, const char *runtime, const rt_clean_
         return -1;
     }
 
+    // cgroup of the container will be removed
+    isula_rt_forget_cgroup_stats(id);
+
     if (shim_alive(workdir)) {
         shim_kill_force(workdir);
     }
@@ -1108,6 +1179,8 @@ int rt_isula_rm(const char *id, const char *runtime, const rt_rm_params_t *param
         return -1;
     }
 
+    isula_rt_forget_cgroup_stats(id);
+
     if (util_recursive_rmdir(libdir, 0) != 0) {
         ERROR("failed rmdir -r shim workdir");
         return -1;
@@ -1125,6 +1198,29 @@ static bool fg_exec(const rt_exec_params_t *params)
     return false;
 }
 
+// run the process by exec agent of container shim, return 1 if it should be execed with a new shim
+static int exec_by_agent(const char *id, const rt_exec_params_t *params, int *exit_code)
+{
+    char workdir[PATH_MAX] = { 0 };
+    shim_client_process_state p = { 0 };
+    int nret = 0;
+
+    // the agent replies after the process exits, detached execs and ttys are left to new shims
+    if (!fg_exec(params) || params->spec->terminal) {
+        return 1;
+    }
+
+    nret = snprintf(workdir, sizeof(workdir), "%s/%s", params->state, id);
+    if (nret < 0 || (size_t)nret >= sizeof(workdir)) {
+        return 1;
+    }
+
+    p.exec = true;
+    copy_process(&p, params->spec);
+
+    return isula_exec_agent_exec(workdir, &p, params->console_fifos, params->timeout, exit_code);
+}
+
 static char *try_generate_exec_id()
 {
     char *id = NULL;
@@ -1176,6 +1272,11 @@ int rt_isula_exec(const char *id, const char *runtime, const rt_exec_params_t *p
         return -1;
     }
 
+    ret = exec_by_agent(id, params, exit_code);
+    if (ret <= 0) {
+        return ret;
+    }
+
     if (params->suffix != NULL) {
         exec_id = util_strdup_s(params->suffix);
     } else {
@@ -1275,6 +1376,61 @@ out:
     return ret;
 }
 
+/*
+ * Get status of a started container without calling the runtime: the init process in
+ * pid file is the one we started, and the freezer tells whether it is paused.
+ * Return -1 if the status can not be decided, the runtime should be asked then.
+ */
+static int native_get_status(const char *workdir, const char *id, struct runtime_container_status_info *status)
+{
+    char fname[PATH_MAX] = { 0 };
+    int pid = 0;
+    unsigned long long start_time = 0;
+    proc_t *proc = NULL;
+    bool frozen = false;
+    int ret = -1;
+
+    if (snprintf(fname, sizeof(fname), "%s/pid", workdir) < 0) {
+        ERROR("failed make pid full path");
+        return -1;
+    }
+
+    file_read_int(fname, &pid);
+    if (pid <= 0) {
+        return -1;
+    }
+
+    // not started yet, or started before start time was saved
+    if (read_process_start_time(workdir, &start_time) != 0) {
+        return -1;
+    }
+
+    proc = util_get_process_proc_info(pid);
+    if (proc == NULL) {
+        DEBUG("container %s process %d not found", id, pid);
+        goto out;
+    }
+
+    // exited but not reaped by shim yet, or pid reused
+    if (proc->state == 'Z' || proc->start_time != start_time) {
+        DEBUG("container %s process %d is exiting", id, pid);
+        goto out;
+    }
+
+    if (isula_rt_read_freezer_state(pid, &frozen) != 0) {
+        goto out;
+    }
+
+    status->status = frozen ? RUNTIME_CONTAINER_STATUS_PAUSED : RUNTIME_CONTAINER_STATUS_RUNNING;
+    status->pid = pid;
+    status->has_pid = true;
+    ret = 0;
+
+out:
+    free(proc);
+    return ret;
+}
+
 int rt_isula_status(const char *id, const char *runtime, const rt_status_params_t *params,
                     struct runtime_container_status_info *status)
 {
@@ -1298,6 +1454,11 @@ int rt_isula_status(const char *id, const char *runtime, const rt_status_params_
         goto out;
     }
 
+    if (native_get_status(workdir, id, status) == 0) {
+        ret = 0;
+        goto out;
+    }
+
     ret = runtime_call_status(workdir, runtime, id, status);
 
 out:
@@ -1530,6 +1691,8 @@ int rt_isula_resources_stats(const char *id, const char *runtime, const rt_stats
                              struct runtime_container_resources_stats_info *rs_stats)
 {
     char workdir[PATH_MAX] = { 0 };
+    char fpid[PATH_MAX] = { 0 };
+    int pid = 0;
     int ret = 0;
 
     if (id == NULL || runtime == NULL || params == NULL || rs_stats == NULL) {
@@ -1549,6 +1712,18 @@ int rt_isula_resources_stats(const char *id, const char *runtime, const rt_stats
         goto out;
     }
 
+    // read stats from cgroup files directly, rather than fork the runtime for each container
+    ret = snprintf(fpid, sizeof(fpid), "%s/pid", workdir);
+    if (ret >= 0 && (size_t)ret < sizeof(fpid)) {
+        file_read_int(fpid, &pid);
+    }
+    if (pid > 0 && isula_rt_read_cgroup_stats(id, pid, rs_stats) == 0) {
+        ret = 0;
+        goto out;
+    }
+
+    WARN("Failed to read cgroup stats of container %s, call runtime instead", id);
+    (void)memset(rs_stats, 0, sizeof(struct runtime_container_resources_stats_info));
     ret = runtime_call_stats(workdir, runtime, id, rs_stats);
 
 out:
@@ -0,0 +1,686 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: read container stats from cgroup files
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "isula_rt_stats.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "isula_libutils/log.h"
+#include "cgroup.h"
+#include "map.h"
+#include "utils.h"
+#include "utils_array.h"
+#include "utils_file.h"
+#include "utils_string.h"
+
+// big enough for memory.stat and io.stat of a container
+#define STATS_FILE_BUF_SIZE (16 * 1024)
+
+typedef enum {
+    STATS_CPU_USAGE,
+    STATS_CPU_STAT,
+    STATS_MEM_USAGE,
+    STATS_MEM_LIMIT,
+    STATS_MEM_STAT,
+    STATS_PIDS_CURRENT,
+    STATS_IO,
+    STATS_FILES_MAX
+} stats_file_index;
+
+struct stats_file {
+    // subsystem of cgroup v1
+    const char *subsystem;
+    const char *v1_file;
+    // NULL if the stat is in other file of cgroup v2
+    const char *v2_file;
+};
+
+static const struct stats_file g_stats_files[STATS_FILES_MAX] = {
+    [STATS_CPU_USAGE]       = { "cpuacct", "cpuacct.usage",                     NULL },
+    [STATS_CPU_STAT]        = { "cpuacct", "cpuacct.stat",                      "cpu.stat" },
+    [STATS_MEM_USAGE]       = { "memory",  "memory.usage_in_bytes",             "memory.current" },
+    [STATS_MEM_LIMIT]       = { "memory",  "memory.limit_in_bytes",             "memory.max" },
+    [STATS_MEM_STAT]        = { "memory",  "memory.stat",                       "memory.stat" },
+    [STATS_PIDS_CURRENT]    = { "pids",    "pids.current",                      "pids.current" },
+    [STATS_IO]              = { "blkio",   "blkio.throttle.io_service_bytes",   "io.stat" },
+};
+
+typedef struct {
+    pid_t pid;
+    int version;
+    // -1 if the file does not exist
+    int fds[STATS_FILES_MAX];
+} container_stats_files;
+
+static pthread_mutex_t g_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+// container id -> container_stats_files, protected by g_stats_mutex
+static map_t *g_stats_files_map = NULL;
+
+static void free_container_stats_files(container_stats_files *files)
+{
+    size_t i;
+
+    if (files == NULL) {
+        return;
+    }
+
+    for (i = 0; i < STATS_FILES_MAX; i++) {
+        if (files->fds[i] >= 0) {
+            close(files->fds[i]);
+        }
+    }
+    free(files);
+}
+
+static void stats_files_kvfree(void *key, void *value)
+{
+    free(key);
+    free_container_stats_files((container_stats_files *)value);
+}
+
+static bool controllers_contain(const char *controllers, size_t len, const char *subsystem)
+{
+    size_t sub_len = strlen(subsystem);
+    const char *end = controllers + len;
+    const char *next = NULL;
+
+    while (controllers < end) {
+        next = memchr(controllers, ',', (size_t)(end - controllers));
+        if (next == NULL) {
+            next = end;
+        }
+        if ((size_t)(next - controllers) == sub_len && strncmp(controllers, subsystem, sub_len) == 0) {
+            return true;
+        }
+        controllers = next + 1;
+    }
+
+    return false;
+}
+
+// find cgroup path of subsystem from lines of /proc/<pid>/cgroup, subsystem is NULL for cgroup v2
+static const char *find_cgroup_path(char **lines, const char *subsystem)
+{
+    char **line = NULL;
+    char *controllers = NULL;
+    char *path = NULL;
+
+    for (line = lines; line != NULL && *line != NULL; line++) {
+        // hierarchy-ID:controller-list:cgroup-path
+        controllers = strchr(*line, ':');
+        if (controllers == NULL) {
+            continue;
+        }
+        controllers++;
+        path = strchr(controllers, ':');
+        if (path == NULL) {
+            continue;
+        }
+
+        if (subsystem == NULL) {
+            if (path == controllers) {
+                return path + 1;
+            }
+            continue;
+        }
+        if (controllers_contain(controllers, (size_t)(path - controllers), subsystem)) {
+            return path + 1;
+        }
+    }
+
+    return NULL;
+}
+
+static int open_stats_file(const char *dir, const char *file)
+{
+    int nret = 0;
+    char path[PATH_MAX] = { 0 };
+    int fd = -1;
+
+    nret = snprintf(path, sizeof(path), "%s/%s", dir, file);
+    if (nret < 0 || (size_t)nret >= sizeof(path)) {
+        ERROR("Failed to make path of cgroup file %s", file);
+        return -1;
+    }
+
+    fd = util_open(path, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        DEBUG("Failed to open cgroup file %s: %s", path, strerror(errno));
+    }
+    return fd;
+}
+
+static int open_v2_stats_files(char **lines, container_stats_files *files)
+{
+    const char *path = NULL;
+    char dir[PATH_MAX] = { 0 };
+    int nret = 0;
+    size_t i;
+
+    path = find_cgroup_path(lines, NULL);
+    if (path == NULL) {
+        ERROR("Failed to find cgroup v2 path");
+        return -1;
+    }
+
+    nret = snprintf(dir, sizeof(dir), "%s%s", CGROUP_MOUNTPOINT, path);
+    if (nret < 0 || (size_t)nret >= sizeof(dir)) {
+        ERROR("Failed to make cgroup dir of %s", path);
+        return -1;
+    }
+
+    for (i = 0; i < STATS_FILES_MAX; i++) {
+        if (g_stats_files[i].v2_file != NULL) {
+            files->fds[i] = open_stats_file(dir, g_stats_files[i].v2_file);
+        }
+    }
+
+    return 0;
+}
+
+static int open_v1_stats_files(char **lines, container_stats_files *files)
+{
+    cgroup_layer_t *layers = NULL;
+    const char *mountpoint = NULL;
+    const char *path = NULL;
+    char dir[PATH_MAX] = { 0 };
+    int nret = 0;
+    size_t i;
+
+    layers = common_cgroup_layers_find();
+    if (layers == NULL) {
+        ERROR("Failed to parse cgroup information");
+        return -1;
+    }
+
+    for (i = 0; i < STATS_FILES_MAX; i++) {
+        mountpoint = common_find_cgroup_subsystem_mountpoint(layers, g_stats_files[i].subsystem);
+        path = find_cgroup_path(lines, g_stats_files[i].subsystem);
+        if (mountpoint == NULL || path == NULL) {
+            DEBUG("Cgroup subsystem %s is not available", g_stats_files[i].subsystem);
+            continue;
+        }
+
+        nret = snprintf(dir, sizeof(dir), "%s%s", mountpoint, path);
+        if (nret < 0 || (size_t)nret >= sizeof(dir)) {
+            ERROR("Failed to make cgroup dir of %s", path);
+            continue;
+        }
+        files->fds[i] = open_stats_file(dir, g_stats_files[i].v1_file);
+    }
+
+    common_free_cgroup_layer(layers);
+    return 0;
+}
+
+// read lines of /proc/<pid>/cgroup
+static char **read_proc_cgroup(pid_t pid)
+{
+    char proc_path[PATH_MAX] = { 0 };
+    char *content = NULL;
+    char **lines = NULL;
+    int nret = 0;
+
+    nret = snprintf(proc_path, sizeof(proc_path), "/proc/%d/cgroup", pid);
+    if (nret < 0 || (size_t)nret >= sizeof(proc_path)) {
+        ERROR("Failed to make cgroup path of process %d", pid);
+        return NULL;
+    }
+
+    content = util_read_content_from_file(proc_path);
+    if (content == NULL) {
+        ERROR("Failed to read %s", proc_path);
+        return NULL;
+    }
+
+    lines = util_string_split(content, '\n');
+    if (lines == NULL) {
+        ERROR("Failed to split %s", proc_path);
+    }
+
+    free(content);
+    return lines;
+}
+
+static container_stats_files *open_container_stats_files(pid_t pid)
+{
+    container_stats_files *files = NULL;
+    char **lines = NULL;
+    int nret = 0;
+    size_t i;
+
+    files = util_common_calloc_s(sizeof(container_stats_files));
+    if (files == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    for (i = 0; i < STATS_FILES_MAX; i++) {
+        files->fds[i] = -1;
+    }
+    files->pid = pid;
+
+    files->version = common_get_cgroup_version();
+    if (files->version < 0) {
+        goto err_out;
+    }
+
+    lines = read_proc_cgroup(pid);
+    if (lines == NULL) {
+        goto err_out;
+    }
+
+    if (files->version == CGROUP_VERSION_2) {
+        nret = open_v2_stats_files(lines, files);
+    } else {
+        nret = open_v1_stats_files(lines, files);
+    }
+    if (nret != 0) {
+        goto err_out;
+    }
+
+    util_free_array(lines);
+    return files;
+
+err_out:
+    util_free_array(lines);
+    free_container_stats_files(files);
+    return NULL;
+}
+
+// read the whole file from the beginning, so the stats are up to date
+static int read_stats_file(int fd, char *buf, size_t len)
+{
+    size_t total = 0;
+    ssize_t nret = 0;
+
+    while (total < len - 1) {
+        nret = pread(fd, buf + total, len - 1 - total, (off_t)total);
+        if (nret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nret < 0) {
+            SYSERROR("Failed to read cgroup file");
+            return -1;
+        }
+        if (nret == 0) {
+            break;
+        }
+        total += (size_t)nret;
+    }
+    buf[total] = '\0';
+
+    return 0;
+}
+
+// read file of index, return 1 if the file does not exist
+static int read_stats(const container_stats_files *files, stats_file_index index, char *buf, size_t len)
+{
+    if (files->fds[index] < 0) {
+        return 1;
+    }
+
+    return read_stats_file(files->fds[index], buf, len);
+}
+
+static int read_stats_value(const container_stats_files *files, stats_file_index index, char *buf, size_t len,
+                            uint64_t *value)
+{
+    int nret = read_stats(files, index, buf, len);
+
+    if (nret != 0) {
+        return nret;
+    }
+
+    util_trim_newline(buf);
+    // unlimited memory.max of cgroup v2
+    if (strcmp(buf, "max") == 0) {
+        *value = UINT64_MAX;
+        return 0;
+    }
+
+    return util_safe_uint64(buf, value) == 0 ? 0 : -1;
+}
+
+static int read_cpu_stats(const container_stats_files *files, char *buf, size_t len,
+                          struct runtime_container_resources_stats_info *info)
+{
+    uint64_t value = 0;
+    long ticks = 0;
+
+    if (files->version == CGROUP_VERSION_2) {
+        if (read_stats(files, STATS_CPU_STAT, buf, len) < 0) {
+            return -1;
+        }
+        if (common_cgroup_get_key_value(buf, "usage_usec", &value) == 0) {
+            info->cpu_use_nanos = value * 1000;
+        }
+        if (common_cgroup_get_key_value(buf, "system_usec", &value) == 0) {
+            info->cpu_system_use = value * 1000;
+        }
+        return 0;
+    }
+
+    if (read_stats_value(files, STATS_CPU_USAGE, buf, len, &info->cpu_use_nanos) < 0) {
+        return -1;
+    }
+    if (read_stats(files, STATS_CPU_STAT, buf, len) < 0) {
+        return -1;
+    }
+    // cpuacct.stat is in USER_HZ
+    ticks = sysconf(_SC_CLK_TCK);
+    if (ticks > 0 && common_cgroup_get_key_value(buf, "system", &value) == 0) {
+        info->cpu_system_use = value * (1000000000ULL / (uint64_t)ticks);
+    }
+
+    return 0;
+}
+
+static int read_memory_stats(const container_stats_files *files, char *buf, size_t len,
+                             struct runtime_container_resources_stats_info *info)
+{
+    bool v2 = (files->version == CGROUP_VERSION_2);
+
+    if (read_stats_value(files, STATS_MEM_USAGE, buf, len, &info->mem_used) < 0) {
+        return -1;
+    }
+    if (read_stats_value(files, STATS_MEM_LIMIT, buf, len, &info->mem_limit) < 0) {
+        return -1;
+    }
+    if (read_stats(files, STATS_MEM_STAT, buf, len) < 0) {
+        return -1;
+    }
+
+    // keys missing in memory.stat are left as zero
+    (void)common_cgroup_get_key_value(buf, v2 ? "anon" : "rss", &info->rss_bytes);
+    (void)common_cgroup_get_key_value(buf, "pgfault", &info->page_faults);
+    (void)common_cgroup_get_key_value(buf, "pgmajfault", &info->major_page_faults);
+    (void)common_cgroup_get_key_value(buf, v2 ? "inactive_file" : "total_inactive_file",
+                                      &info->inactive_file_total);
+
+    return 0;
+}
+
+static void sum_io_line(const char *line, bool v2, struct runtime_container_resources_stats_info *info)
+{
+    char op[16] = { 0 };
+    unsigned long long value = 0;
+    const char *field = NULL;
+
+    if (v2) {
+        // MAJ:MIN rbytes=N wbytes=N rios=N wios=N ...
+        field = strstr(line, " rbytes=");
+        if (field != NULL && sscanf(field, " rbytes=%llu", &value) == 1) {
+            info->blkio_read += value;
+        }
+        field = strstr(line, " wbytes=");
+        if (field != NULL && sscanf(field, " wbytes=%llu", &value) == 1) {
+            info->blkio_write += value;
+        }
+        return;
+    }
+
+    // MAJ:MIN Read N
+    if (sscanf(line, "%*u:%*u %15s %llu", op, &value) != 2) {
+        return;
+    }
+    if (strcmp(op, "Read") == 0) {
+        info->blkio_read += value;
+    } else if (strcmp(op, "Write") == 0) {
+        info->blkio_write += value;
+    }
+}
+
+static int read_io_stats(const container_stats_files *files, char *buf, size_t len,
+                         struct runtime_container_resources_stats_info *info)
+{
+    char *line = NULL;
+    char *saveptr = NULL;
+
+    if (read_stats(files, STATS_IO, buf, len) != 0) {
+        // io controller may be not enabled
+        return 0;
+    }
+
+    for (line = strtok_r(buf, "\n", &saveptr); line != NULL; line = strtok_r(NULL, "\n", &saveptr)) {
+        sum_io_line(line, files->version == CGROUP_VERSION_2, info);
+    }
+
+    return 0;
+}
+
+static int read_container_stats(const container_stats_files *files,
+                                 struct runtime_container_resources_stats_info *info)
+{
+    char *buf = NULL;
+    int ret = 0;
+
+    buf = util_common_calloc_s(STATS_FILE_BUF_SIZE);
+    if (buf == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    if (read_cpu_stats(files, buf, STATS_FILE_BUF_SIZE, info) != 0 ||
+        read_memory_stats(files, buf, STATS_FILE_BUF_SIZE, info) != 0 ||
+        read_stats_value(files, STATS_PIDS_CURRENT, buf, STATS_FILE_BUF_SIZE, &info->pids_current) < 0 ||
+        read_io_stats(files, buf, STATS_FILE_BUF_SIZE, info) != 0) {
+        ret = -1;
+    }
+
+    free(buf);
+    return ret;
+}
+
+// called with g_stats_mutex held
+static container_stats_files *get_container_stats_files(const char *id, pid_t pid)
+{
+    container_stats_files *files = NULL;
+
+    if (g_stats_files_map == NULL) {
+        g_stats_files_map = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, stats_files_kvfree);
+        if (g_stats_files_map == NULL) {
+            ERROR("Out of memory");
+            return NULL;
+        }
+    }
+
+    files = map_search(g_stats_files_map, (void *)id);
+    if (files != NULL && files->pid == pid) {
+        return files;
+    }
+
+    // container restarted, the files of old process are closed by map_replace
+    files = open_container_stats_files(pid);
+    if (files == NULL) {
+        return NULL;
+    }
+
+    if (!map_replace(g_stats_files_map, (void *)id, files)) {
+        ERROR("Failed to save cgroup files of container %s", id);
+        free_container_stats_files(files);
+        return NULL;
+    }
+
+    return files;
+}
+
+int isula_rt_read_cgroup_stats(const char *id, pid_t pid, struct runtime_container_resources_stats_info *info)
+{
+    container_stats_files *files = NULL;
+    int ret = 0;
+
+    if (id == NULL || pid <= 0 || info == NULL) {
+        ERROR("Invalid input arguments");
+        return -1;
+    }
+
+    (void)pthread_mutex_lock(&g_stats_mutex);
+    files = get_container_stats_files(id, pid);
+    if (files == NULL) {
+        ret = -1;
+        goto unlock;
+    }
+
+    ret = read_container_stats(files, info);
+    if (ret != 0) {
+        // cgroup may be removed, reopen files next time
+        ERROR("Failed to read cgroup stats of container %s", id);
+        (void)map_remove(g_stats_files_map, (void *)id);
+    }
+
+unlock:
+    (void)pthread_mutex_unlock(&g_stats_mutex);
+    return ret;
+}
+
+void isula_rt_forget_cgroup_stats(const char *id)
+{
+    if (id == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_stats_mutex);
+    if (g_stats_files_map != NULL && map_search(g_stats_files_map, (void *)id) != NULL) {
+        (void)map_remove(g_stats_files_map, (void *)id);
+    }
+    (void)pthread_mutex_unlock(&g_stats_mutex);
+}
+
+static int read_v2_freezer_state(char **lines, bool *frozen)
+{
+    const char *path = NULL;
+    char fname[PATH_MAX] = { 0 };
+    char *content = NULL;
+    uint64_t value = 0;
+    int nret = 0;
+
+    path = find_cgroup_path(lines, NULL);
+    if (path == NULL) {
+        ERROR("Failed to find cgroup v2 path");
+        return -1;
+    }
+
+    nret = snprintf(fname, sizeof(fname), "%s%s/cgroup.events", CGROUP_MOUNTPOINT, path);
+    if (nret < 0 || (size_t)nret >= sizeof(fname)) {
+        ERROR("Failed to make cgroup events path of %s", path);
+        return -1;
+    }
+
+    content = util_read_content_from_file(fname);
+    if (content == NULL) {
+        DEBUG("Failed to read %s", fname);
+        return -1;
+    }
+
+    nret = common_cgroup_get_key_value(content, "frozen", &value);
+    free(content);
+    if (nret != 0) {
+        DEBUG("Failed to get frozen state from %s", fname);
+        return -1;
+    }
+
+    *frozen = (value == 1);
+    return 0;
+}
+
+static int read_v1_freezer_state(char **lines, bool *frozen)
+{
+    cgroup_layer_t *layers = NULL;
+    const char *mountpoint = NULL;
+    const char *path = NULL;
+    char fname[PATH_MAX] = { 0 };
+    char *content = NULL;
+    int nret = 0;
+    int ret = -1;
+
+    layers = common_cgroup_layers_find();
+    if (layers == NULL) {
+        ERROR("Failed to parse cgroup information");
+        return -1;
+    }
+
+    mountpoint = common_find_cgroup_subsystem_mountpoint(layers, "freezer");
+    path = find_cgroup_path(lines, "freezer");
+    if (mountpoint == NULL || path == NULL) {
+        DEBUG("Cgroup subsystem freezer is not available");
+        goto out;
+    }
+
+    nret = snprintf(fname, sizeof(fname), "%s%s/freezer.state", mountpoint, path);
+    if (nret < 0 || (size_t)nret >= sizeof(fname)) {
+        ERROR("Failed to make freezer state path of %s", path);
+        goto out;
+    }
+
+    content = util_read_content_from_file(fname);
+    if (content == NULL) {
+        DEBUG("Failed to read %s", fname);
+        goto out;
+    }
+    util_trim_newline(content);
+
+    // FREEZING is a transient state, let the caller ask the runtime
+    if (strcmp(content, "FROZEN") == 0) {
+        *frozen = true;
+        ret = 0;
+    } else if (strcmp(content, "THAWED") == 0) {
+        *frozen = false;
+        ret = 0;
+    }
+
+out:
+    free(content);
+    common_free_cgroup_layer(layers);
+    return ret;
+}
+
+int isula_rt_read_freezer_state(pid_t pid, bool *frozen)
+{
+    char **lines = NULL;
+    int version = 0;
+    int ret = 0;
+
+    if (pid <= 0 || frozen == NULL) {
+        ERROR("Invalid input arguments");
+        return -1;
+    }
+
+    version = common_get_cgroup_version();
+    if (version < 0) {
+        return -1;
+    }
+
+    lines = read_proc_cgroup(pid);
+    if (lines == NULL) {
+        return -1;
+    }
+
+    if (version == CGROUP_VERSION_2) {
+        ret = read_v2_freezer_state(lines, frozen);
+    } else {
+        ret = read_v1_freezer_state(lines, frozen);
+    }
+
+    util_free_array(lines);
+    return ret;
+}
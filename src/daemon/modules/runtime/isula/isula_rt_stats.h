@@ -0,0 +1,42 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: read container stats from cgroup files
+ ******************************************************************************/
+
+#ifndef DAEMON_MODULES_RUNTIME_ISULA_ISULA_RT_STATS_H
+#define DAEMON_MODULES_RUNTIME_ISULA_ISULA_RT_STATS_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "runtime_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Read stats of container whose init process is pid from its cgroup files directly.
+// The files are kept open, and reopened only if the init process changed.
+int isula_rt_read_cgroup_stats(const char *id, pid_t pid, struct runtime_container_resources_stats_info *info);
+
+// close the cgroup files of container
+void isula_rt_forget_cgroup_stats(const char *id);
+
+// Read whether the cgroup of process pid is frozen, return -1 if unknown or still freezing.
+int isula_rt_read_freezer_state(pid_t pid, bool *frozen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_MODULES_RUNTIME_ISULA_ISULA_RT_STATS_H
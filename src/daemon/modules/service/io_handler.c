@@ -21,10 +21,13 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <limits.h>
-#include <semaphore.h>
+#include <inttypes.h>
+#include <poll.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/prctl.h>
 #include <time.h>
 
@@ -35,6 +38,7 @@
 #include "utils.h"
 #include "utils_file.h"
 #include "err_msg.h"
+#include "linked_list.h"
 
 static char *create_single_fifo(const char *statepath, const char *subpath, const char *stdflag)
 {
@@ -186,308 +190,1205 @@ struct io_copy_arg {
     transfer_channel_type channel;
 };
 
-struct io_copy_thread_arg {
-    struct io_copy_arg *copy_arg;
-    bool detach;
+// threads shared by io copy sessions of all containers
+#define IO_COPY_WORKERS 4
+// a closing session finishes after its fds are idle for this time, to copy data left in other channels
+#define IO_COPY_DRAIN_MS 100
+#define IO_COPY_MAX_PIPES 6
+#define IO_COPY_SPLICE_LEN (64 * 1024)
+#define IO_COPY_MAX_EVENTS 64
+// reading for a function writer stops when this many bytes are queued, until half of them are written
+#define IO_COPY_QUEUE_MAX (1024 * 1024)
+// threads shared by sessions to call function writers, they are started on demand and never exit
+#define IO_COPY_WRITERS_MAX 16
+// max sleep of a worker after epoll_wait failed repeatedly
+#define IO_COPY_ERROR_BACKOFF_MAX_MS 1000
+
+typedef enum { IO_COPY_CONTINUE = 0, IO_COPY_CLOSE } io_copy_result;
+
+struct io_copy_pipe;
+
+// registration of a fd in epoll of worker
+struct io_copy_watch {
+    struct io_copy_pipe *pipe;
+    int fd;
+    bool registered;
+};
+
+// data queued for the function writer of a pipe, fields except started are protected by mutex of session writes
+struct io_copy_queue {
+    bool started;
+    // written by the writer thread once a throttled queue is half drained
+    int wake_fd;
+    size_t queued;
+    bool throttled;
+    bool failed;
+};
+
+// data read by the worker for function writers of a session. Writers may block on a slow client,
+// so they are called by a thread of the writer pool instead of the worker, one thread for a session
+// at a time in the order data is read, as the writers of stdout and stderr may be the same.
+struct io_copy_writes {
+    bool started;
+    // node in run queue of the writer pool
+    struct linked_list node;
+
+    // protect fields below and queues of pipes
+    pthread_mutex_t mutex;
+    struct linked_list chunks;
+    // in run queue of the writer pool or being written by a thread of it
+    bool scheduled;
+    // no more data is queued, writers are closed after the queued data is written
+    bool closed;
+};
+
+struct io_copy_chunk {
+    struct io_copy_pipe *pipe;
+    size_t len;
+    char data[MAX_BUFFER_SIZE];
+};
+
+// copy data from srcfd to dstfd or writer
+struct io_copy_pipe {
+    io_copy_session *session;
+    transfer_channel_type channel;
+    // fds are owned by session
+    int srcfd;
+    int dstfd;
+    // data is spliced from srcfd to dstfd without copying to userspace
+    bool use_splice;
+    // data read from srcfd but not written to the non-blocking dstfd yet
+    char *pending;
+    size_t pending_off;
+    size_t pending_len;
+    struct io_write_wrapper writer;
+    struct io_copy_queue queue;
+    struct io_copy_watch src_watch;
+    // registered when dstfd is full or the queue is throttled, src_watch is unregistered at the same time
+    struct io_copy_watch dst_watch;
+};
+
+struct io_copy_worker;
+
+struct io_copy_session {
+    struct io_copy_worker *worker;
+    struct io_copy_pipe pipes[IO_COPY_MAX_PIPES];
     size_t len;
-    int sync_fd;
-    sem_t wait_sem;
+    // dup of sync fd, closing is requested if it is written
+    struct io_copy_pipe sync;
+    struct io_copy_writes writes;
+
+    // fields below are only accessed by the worker thread
+    size_t watching;
+    bool closing;
+    bool finish;
+    struct timespec drain_deadline;
+
+    // protect fields below
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint64_t copied[MAX_CHANNEL];
+    // the worker and the writes which have not done with the session
+    size_t running;
+    bool finished;
+    bool detached;
+};
+
+struct io_copy_worker {
+    int epfd;
+    // wake up worker to register pending sessions
+    int wake_fd;
+    pthread_t tid;
+    // sessions served by worker, only accessed by worker thread
+    struct linked_list sessions;
+
+    // protect fields below
+    pthread_mutex_t mutex;
+    struct linked_list pending;
+    size_t sessions_len;
 };
 
-static void io_copy_thread_cleanup(struct io_write_wrapper *writers, struct io_copy_thread_arg *thread_arg, int *infds,
-                                   int *outfds, int *srcfds, transfer_channel_type *channels, size_t len)
+struct io_copy_writer_pool {
+    // protect fields below
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    // writes of sessions waiting for a thread
+    struct linked_list queue;
+    size_t queued;
+    size_t threads;
+    size_t idle;
+};
+
+static struct io_copy_worker g_io_copy_workers[IO_COPY_WORKERS];
+static struct io_copy_writer_pool g_io_copy_writers = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+static pthread_once_t g_io_copy_workers_once = PTHREAD_ONCE_INIT;
+static bool g_io_copy_workers_ready = false;
+
+static int64_t timespec_diff_ms(const struct timespec *end, const struct timespec *start)
 {
-    size_t i = 0;
-    for (i = 0; i < len; i++) {
-        if (writers != NULL && writers[i].close_func != NULL) {
-            (void)writers[i].close_func(writers[i].context, NULL);
+    return (int64_t)(end->tv_sec - start->tv_sec) * 1000 + (end->tv_nsec - start->tv_nsec) / 1000000;
+}
+
+static void io_copy_watch_add(struct io_copy_session *session, struct io_copy_watch *watch, uint32_t events)
+{
+    struct epoll_event ev = { 0 };
+
+    if (watch->fd < 0 || watch->registered) {
+        return;
+    }
+
+    ev.events = events;
+    ev.data.ptr = watch;
+    if (epoll_ctl(session->worker->epfd, EPOLL_CTL_ADD, watch->fd, &ev) != 0) {
+        SYSERROR("Failed to watch fd %d", watch->fd);
+        session->finish = true;
+        return;
+    }
+    watch->registered = true;
+}
+
+static void io_copy_watch_del(struct io_copy_session *session, struct io_copy_watch *watch)
+{
+    if (!watch->registered) {
+        return;
+    }
+
+    if (epoll_ctl(session->worker->epfd, EPOLL_CTL_DEL, watch->fd, NULL) != 0) {
+        SYSERROR("Failed to unwatch fd %d", watch->fd);
+    }
+    watch->registered = false;
+}
+
+static void io_copy_pipe_stop(struct io_copy_pipe *pipe)
+{
+    if (pipe->src_watch.registered || pipe->dst_watch.registered) {
+        pipe->session->watching--;
+    }
+    io_copy_watch_del(pipe->session, &pipe->src_watch);
+    io_copy_watch_del(pipe->session, &pipe->dst_watch);
+}
+
+static void io_copy_add_copied(struct io_copy_session *session, transfer_channel_type channel, size_t len)
+{
+    if (channel >= MAX_CHANNEL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&session->mutex);
+    session->copied[channel] += len;
+    (void)pthread_mutex_unlock(&session->mutex);
+}
+
+// stop reading srcfd until the destination can take more data
+static void io_copy_wait_dst(struct io_copy_pipe *pipe, uint32_t events)
+{
+    io_copy_watch_del(pipe->session, &pipe->src_watch);
+    io_copy_watch_add(pipe->session, &pipe->dst_watch, events);
+}
+
+static void *io_copy_writer_main(void *arg);
+
+// called with mutex of writes held, let a thread of the pool write the session
+static void io_copy_writes_schedule(struct io_copy_session *session)
+{
+    struct io_copy_writer_pool *pool = &g_io_copy_writers;
+    pthread_t tid;
+
+    if (session->writes.scheduled) {
+        return;
+    }
+    session->writes.scheduled = true;
+
+    (void)pthread_mutex_lock(&pool->mutex);
+    linked_list_add_tail(&pool->queue, &session->writes.node);
+    pool->queued++;
+    // at least one thread is started with the workers, sessions wait for it if no more can be started
+    if (pool->queued > pool->idle && pool->threads < IO_COPY_WRITERS_MAX) {
+        if (pthread_create(&tid, NULL, io_copy_writer_main, NULL) == 0) {
+            (void)pthread_detach(tid);
+            pool->threads++;
+        } else {
+            WARN("Failed to start io copy writer thread");
         }
     }
-    free(srcfds);
-    for (i = 0; i < len; i++) {
-        if ((infds != NULL) && (infds[i] >= 0)) {
-            console_fifo_close(infds[i]);
+    (void)pthread_cond_signal(&pool->cond);
+    (void)pthread_mutex_unlock(&pool->mutex);
+}
+
+static io_copy_result io_copy_enqueue(struct io_copy_pipe *pipe, struct io_copy_chunk *chunk)
+{
+    struct io_copy_writes *writes = &pipe->session->writes;
+    struct io_copy_queue *queue = &pipe->queue;
+    struct linked_list *node = NULL;
+    bool throttle = false;
+
+    node = util_common_calloc_s(sizeof(struct linked_list));
+    if (node == NULL) {
+        ERROR("Out of memory");
+        free(chunk);
+        return IO_COPY_CLOSE;
+    }
+
+    chunk->pipe = pipe;
+    (void)pthread_mutex_lock(&writes->mutex);
+    if (queue->failed) {
+        (void)pthread_mutex_unlock(&writes->mutex);
+        ERROR("Failed to write, channel: %d", pipe->channel);
+        free(node);
+        free(chunk);
+        return IO_COPY_CLOSE;
+    }
+    linked_list_add_elem(node, chunk);
+    linked_list_add_tail(&writes->chunks, node);
+    queue->queued += chunk->len;
+    if (queue->queued >= IO_COPY_QUEUE_MAX) {
+        queue->throttled = true;
+        throttle = true;
+    }
+    io_copy_writes_schedule(pipe->session);
+    (void)pthread_mutex_unlock(&writes->mutex);
+
+    if (throttle) {
+        io_copy_wait_dst(pipe, EPOLLIN);
+    }
+
+    return IO_COPY_CONTINUE;
+}
+
+// write pending data to the non-blocking dstfd, wait for it to be writable if it is full
+static io_copy_result io_copy_flush_pending(struct io_copy_pipe *pipe)
+{
+    ssize_t ret = 0;
+
+    while (pipe->pending_len > 0) {
+        ret = write(pipe->dstfd, pipe->pending + pipe->pending_off, pipe->pending_len);
+        if (ret < 0 && errno == EINTR) {
+            continue;
         }
-        if ((outfds != NULL) && (outfds[i] >= 0)) {
-            console_fifo_close(outfds[i]);
+        if (ret < 0 && errno == EAGAIN) {
+            io_copy_wait_dst(pipe, EPOLLOUT);
+            return IO_COPY_CONTINUE;
         }
+        if (ret <= 0) {
+            ERROR("Failed to write %d: %s", pipe->dstfd, strerror(errno));
+            return IO_COPY_CLOSE;
+        }
+        io_copy_add_copied(pipe->session, pipe->channel, (size_t)ret);
+        pipe->pending_off += (size_t)ret;
+        pipe->pending_len -= (size_t)ret;
     }
-    free(infds);
-    free(outfds);
-    free(writers);
-    free(channels);
+    pipe->pending_off = 0;
+
+    return IO_COPY_CONTINUE;
 }
 
-static int io_copy_init_fds(size_t len, int **infds, int **outfds, int **srcfds, struct io_write_wrapper **writers,
-                            transfer_channel_type **channels)
+static io_copy_result io_copy_buffered(struct io_copy_pipe *pipe)
 {
-    size_t i;
+    char buf[MAX_BUFFER_SIZE] = { 0 };
+    struct io_copy_chunk *chunk = NULL;
+    char *dst = buf;
+    ssize_t r_ret = 0;
+
+    if (pipe->queue.started) {
+        chunk = util_common_calloc_s(sizeof(struct io_copy_chunk));
+        if (chunk == NULL) {
+            ERROR("Out of memory");
+            return IO_COPY_CLOSE;
+        }
+        dst = chunk->data;
+    } else if (pipe->pending != NULL) {
+        dst = pipe->pending;
+    }
 
-    *srcfds = util_smart_calloc_s(sizeof(int), len);
-    if (*srcfds == NULL) {
-        ERROR("Out of memory");
-        return -1;
+    r_ret = util_read_nointr(pipe->srcfd, dst, MAX_BUFFER_SIZE);
+    if (r_ret <= 0) {
+        free(chunk);
+        return (r_ret < 0 && errno == EAGAIN) ? IO_COPY_CONTINUE : IO_COPY_CLOSE;
     }
 
-    *infds = util_smart_calloc_s(sizeof(int), len);
-    if (*infds == NULL) {
-        ERROR("Out of memory");
-        return -1;
+    if (chunk != NULL) {
+        chunk->len = (size_t)r_ret;
+        return io_copy_enqueue(pipe, chunk);
     }
-    for (i = 0; i < len; i++) {
-        (*infds)[i] = -1;
+    if (pipe->pending != NULL) {
+        pipe->pending_len = (size_t)r_ret;
+        return io_copy_flush_pending(pipe);
     }
-    *outfds = util_smart_calloc_s(sizeof(int), len);
-    if (*outfds == NULL) {
-        ERROR("Out of memory");
-        return -1;
+
+    // no writer, data is dropped
+    return IO_COPY_CONTINUE;
+}
+
+// the destination can take more data, continue to read srcfd
+static io_copy_result io_copy_resume(struct io_copy_pipe *pipe)
+{
+    eventfd_t val = 0;
+    io_copy_result ret = IO_COPY_CONTINUE;
+
+    if (pipe->queue.started) {
+        (void)eventfd_read(pipe->queue.wake_fd, &val);
+    } else if (pipe->pending_len > 0) {
+        ret = io_copy_flush_pending(pipe);
+        if (ret != IO_COPY_CONTINUE || pipe->pending_len > 0) {
+            return ret;
+        }
     }
-    for (i = 0; i < len; i++) {
-        (*outfds)[i] = -1;
+
+    io_copy_watch_del(pipe->session, &pipe->dst_watch);
+    io_copy_watch_add(pipe->session, &pipe->src_watch, EPOLLIN);
+    return IO_COPY_CONTINUE;
+}
+
+static bool fd_writable(int fd)
+{
+    struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLOUT) != 0;
+}
+
+static io_copy_result io_copy_splice(struct io_copy_pipe *pipe)
+{
+    ssize_t ret = 0;
+
+    ret = splice(pipe->srcfd, NULL, pipe->dstfd, NULL, IO_COPY_SPLICE_LEN, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (ret > 0) {
+        io_copy_add_copied(pipe->session, pipe->channel, (size_t)ret);
+        return IO_COPY_CONTINUE;
+    }
+    if (ret == 0) {
+        return IO_COPY_CLOSE;
     }
 
-    *writers = util_smart_calloc_s(sizeof(struct io_write_wrapper), len);
-    if (*writers == NULL) {
-        ERROR("Out of memory");
-        return -1;
+    if (errno == EINTR) {
+        return IO_COPY_CONTINUE;
     }
 
-    *channels = util_smart_calloc_s(sizeof(transfer_channel_type), len);
-    if (*channels == NULL) {
-        ERROR("Out of memory");
-        return -1;
+    if (errno == EAGAIN) {
+        // srcfd is readable, so dstfd is full, wait for it without watching srcfd
+        if (!fd_writable(pipe->dstfd)) {
+            io_copy_wait_dst(pipe, EPOLLOUT);
+        }
+        return IO_COPY_CONTINUE;
     }
 
-    for (i = 0; i < len; i++) {
-        (*channels)[i] = MAX_CHANNEL;
+    if (errno == EINVAL) {
+        // fds can not be spliced, copy data by buffer
+        DEBUG("Splice is unsupported for channel %d, copy by buffer", pipe->channel);
+        pipe->pending = util_common_calloc_s(MAX_BUFFER_SIZE);
+        if (pipe->pending == NULL) {
+            ERROR("Out of memory");
+            return IO_COPY_CLOSE;
+        }
+        pipe->use_splice = false;
+        return io_copy_buffered(pipe);
     }
-    return 0;
+
+    ERROR("Failed to splice data of channel %d: %s", pipe->channel, strerror(errno));
+    return IO_COPY_CLOSE;
 }
-typedef int (*src_io_type_handle)(int index, struct io_copy_arg *copy_arg, int *infds, int *srcfds);
 
-struct src_io_copy_handler {
-    io_type type;
-    src_io_type_handle handle;
-};
+static io_copy_result io_copy_sync(struct io_copy_pipe *pipe)
+{
+    eventfd_t val = 0;
+
+    if (eventfd_read(pipe->srcfd, &val) < 0) {
+        if (errno == EAGAIN) {
+            return IO_COPY_CONTINUE;
+        }
+        // stop watching sync fd, continue to copy other fds
+        io_copy_pipe_stop(pipe);
+        return IO_COPY_CONTINUE;
+    }
+
+    return IO_COPY_CLOSE;
+}
+
+static void io_copy_session_activity(struct io_copy_session *session)
+{
+    if (!session->closing) {
+        return;
+    }
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &session->drain_deadline);
+    session->drain_deadline.tv_nsec += (long)IO_COPY_DRAIN_MS * 1000000;
+    if (session->drain_deadline.tv_nsec >= 1000000000) {
+        session->drain_deadline.tv_sec++;
+        session->drain_deadline.tv_nsec -= 1000000000;
+    }
+}
+
+static void io_copy_handle_event(struct io_copy_watch *watch)
+{
+    struct io_copy_pipe *pipe = watch->pipe;
+    struct io_copy_session *session = pipe->session;
+    io_copy_result ret = IO_COPY_CONTINUE;
+
+    // the session may be finished or the watch removed by previous events of the same batch
+    if (session->finish || !watch->registered) {
+        return;
+    }
+
+    if (watch == &pipe->dst_watch) {
+        ret = io_copy_resume(pipe);
+    } else if (pipe == &session->sync) {
+        ret = io_copy_sync(pipe);
+    } else if (pipe->use_splice) {
+        ret = io_copy_splice(pipe);
+    } else {
+        ret = io_copy_buffered(pipe);
+    }
+
+    if (ret == IO_COPY_CONTINUE) {
+        io_copy_session_activity(session);
+    } else {
+        // the first closed channel makes the session closing, the second one finishes it
+        io_copy_pipe_stop(pipe);
+        if (session->closing) {
+            session->finish = true;
+        } else {
+            session->closing = true;
+            io_copy_session_activity(session);
+        }
+    }
+
+    if (session->watching == 0) {
+        session->finish = true;
+    }
+}
+
+static void io_copy_pipe_close(struct io_copy_pipe *pipe)
+{
+    if (pipe->srcfd >= 0) {
+        close(pipe->srcfd);
+        pipe->srcfd = -1;
+    }
+    if (pipe->dstfd >= 0) {
+        console_fifo_close(pipe->dstfd);
+        pipe->dstfd = -1;
+    }
+}
+
+// drop data queued for pipe, or for all pipes if pipe is NULL
+static void io_copy_writes_drop(struct io_copy_writes *writes, const struct io_copy_pipe *pipe)
+{
+    struct linked_list *it = NULL;
+    struct linked_list *next = NULL;
+    struct io_copy_chunk *chunk = NULL;
+
+    linked_list_for_each_safe(it, &writes->chunks, next) {
+        chunk = (struct io_copy_chunk *)it->elem;
+        if (pipe != NULL && chunk->pipe != pipe) {
+            continue;
+        }
+        chunk->pipe->queue.queued -= chunk->len;
+        linked_list_del(it);
+        free(chunk);
+        free(it);
+    }
+}
+
+static void io_copy_writes_free(struct io_copy_session *session)
+{
+    size_t i = 0;
+
+    if (!session->writes.started) {
+        return;
+    }
+
+    io_copy_writes_drop(&session->writes, NULL);
+    pthread_mutex_destroy(&session->writes.mutex);
+    for (i = 0; i < session->len; i++) {
+        if (session->pipes[i].queue.started) {
+            close(session->pipes[i].queue.wake_fd);
+        }
+    }
+}
+
+// no more data is queued, writers are closed by the pool after the queued data is written
+static void io_copy_writes_close(struct io_copy_session *session)
+{
+    (void)pthread_mutex_lock(&session->writes.mutex);
+    session->writes.closed = true;
+    io_copy_writes_schedule(session);
+    (void)pthread_mutex_unlock(&session->writes.mutex);
+}
+
+// close writers of pipes without queue, those with queue are closed by the writer pool
+static void io_copy_close_unqueued_writers(struct io_copy_session *session)
+{
+    size_t i = 0;
+
+    for (i = 0; i < session->len; i++) {
+        if (!session->pipes[i].queue.started && session->pipes[i].writer.close_func != NULL) {
+            (void)session->pipes[i].writer.close_func(session->pipes[i].writer.context, NULL);
+        }
+    }
+}
+
+static void io_copy_session_free(struct io_copy_session *session)
+{
+    size_t i = 0;
+
+    for (i = 0; i < session->len; i++) {
+        io_copy_pipe_close(&session->pipes[i]);
+        free(session->pipes[i].pending);
+    }
+    io_copy_writes_free(session);
+    io_copy_pipe_close(&session->sync);
+    pthread_cond_destroy(&session->cond);
+    pthread_mutex_destroy(&session->mutex);
+    free(session);
+}
+
+// the worker or the writes have done with the session, the last one finishes it
+static void io_copy_session_put(struct io_copy_session *session)
+{
+    bool finished = false;
+    bool detached = false;
+
+    (void)pthread_mutex_lock(&session->mutex);
+    session->running--;
+    if (session->running == 0) {
+        DEBUG("IO copy session finished, stdin: %" PRIu64 ", stdout: %" PRIu64 ", stderr: %" PRIu64,
+              session->copied[STDIN_CHANNEL], session->copied[STDOUT_CHANNEL], session->copied[STDERR_CHANNEL]);
+        session->finished = true;
+        finished = true;
+        detached = session->detached;
+        (void)pthread_cond_broadcast(&session->cond);
+    }
+    (void)pthread_mutex_unlock(&session->mutex);
+
+    if (finished && detached) {
+        io_copy_session_free(session);
+    }
+}
+
+static void io_copy_session_finish(struct io_copy_session *session)
+{
+    size_t i = 0;
+
+    for (i = 0; i < session->len; i++) {
+        io_copy_pipe_stop(&session->pipes[i]);
+        io_copy_pipe_close(&session->pipes[i]);
+    }
+    io_copy_close_unqueued_writers(session);
+    if (session->writes.started) {
+        io_copy_writes_close(session);
+    }
+    io_copy_pipe_stop(&session->sync);
+    io_copy_pipe_close(&session->sync);
+
+    io_copy_session_put(session);
+}
+
+// write data queued for the session until the queue is empty, return true if the writes are done
+static bool io_copy_writes_run(struct io_copy_session *session)
+{
+    struct io_copy_writes *writes = &session->writes;
+    struct linked_list *node = NULL;
+    struct io_copy_chunk *chunk = NULL;
+    struct io_copy_pipe *pipe = NULL;
+    ssize_t w_ret = 0;
+    bool failed = false;
+    bool done = false;
+
+    (void)pthread_mutex_lock(&writes->mutex);
+    while (!linked_list_empty(&writes->chunks)) {
+        node = linked_list_first_node(&writes->chunks);
+        linked_list_del(node);
+        chunk = (struct io_copy_chunk *)node->elem;
+        free(node);
+        pipe = chunk->pipe;
+        (void)pthread_mutex_unlock(&writes->mutex);
+
+        w_ret = pipe->writer.write_func(pipe->writer.context, chunk->data, chunk->len);
+        failed = (w_ret != (ssize_t)chunk->len);
+        if (failed) {
+            ERROR("Failed to write, channel: %d, expect: %zu, wrote: %zd, error: %s!", pipe->channel, chunk->len,
+                  w_ret, strerror(errno));
+        } else {
+            io_copy_add_copied(session, pipe->channel, chunk->len);
+        }
+
+        (void)pthread_mutex_lock(&writes->mutex);
+        pipe->queue.queued -= chunk->len;
+        free(chunk);
+        if (failed) {
+            // the worker closes the channel when it reads more data, queued data is dropped
+            pipe->queue.failed = true;
+            io_copy_writes_drop(writes, pipe);
+        }
+        if (pipe->queue.throttled && (pipe->queue.failed || pipe->queue.queued <= IO_COPY_QUEUE_MAX / 2)) {
+            pipe->queue.throttled = false;
+            if (eventfd_write(pipe->queue.wake_fd, 1) < 0) {
+                SYSERROR("Failed to wake up io copy worker");
+            }
+        }
+    }
+    done = writes->closed;
+    if (!done) {
+        // scheduled again when more data is queued
+        writes->scheduled = false;
+    }
+    (void)pthread_mutex_unlock(&writes->mutex);
+
+    return done;
+}
+
+static void io_copy_writes_finish(struct io_copy_session *session)
+{
+    size_t i = 0;
+
+    for (i = 0; i < session->len; i++) {
+        if (session->pipes[i].queue.started && session->pipes[i].writer.close_func != NULL) {
+            (void)session->pipes[i].writer.close_func(session->pipes[i].writer.context, NULL);
+        }
+    }
+    io_copy_session_put(session);
+}
+
+static void *io_copy_writer_main(void *arg)
+{
+    struct io_copy_writer_pool *pool = &g_io_copy_writers;
+    struct linked_list *node = NULL;
+    struct io_copy_session *session = NULL;
+
+    (void)prctl(PR_SET_NAME, "IoWriter");
+
+    (void)pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (linked_list_empty(&pool->queue)) {
+            pool->idle++;
+            (void)pthread_cond_wait(&pool->cond, &pool->mutex);
+            pool->idle--;
+        }
+        node = linked_list_first_node(&pool->queue);
+        linked_list_del(node);
+        pool->queued--;
+        session = (struct io_copy_session *)node->elem;
+        (void)pthread_mutex_unlock(&pool->mutex);
+
+        if (io_copy_writes_run(session)) {
+            io_copy_writes_finish(session);
+        }
+        DAEMON_CLEAR_ERRMSG();
 
-static int handle_src_io_fd(int index, struct io_copy_arg *copy_arg, int *infds, int *srcfds)
+        (void)pthread_mutex_lock(&pool->mutex);
+    }
+    (void)pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+static int io_copy_writer_pool_init(void)
 {
-    srcfds[index] = *(int *)(copy_arg[index].src);
+    pthread_t tid;
+
+    linked_list_init(&g_io_copy_writers.queue);
+    if (pthread_create(&tid, NULL, io_copy_writer_main, NULL) != 0) {
+        CRIT("Thread creation failed");
+        return -1;
+    }
+    (void)pthread_detach(tid);
+    g_io_copy_writers.threads = 1;
 
     return 0;
 }
 
-static int handle_src_io_fifo(int index, struct io_copy_arg *copy_arg, int *infds, int *srcfds)
+static int io_copy_start_writer(struct io_copy_pipe *pipe)
 {
-    if (console_fifo_open((const char *)copy_arg[index].src, &(infds[index]), O_RDONLY | O_NONBLOCK)) {
-        ERROR("failed to open console fifo.");
+    struct io_copy_queue *queue = &pipe->queue;
+
+    queue->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (queue->wake_fd < 0) {
+        SYSERROR("Failed to create eventfd");
         return -1;
     }
-    srcfds[index] = infds[index];
+
+    queue->started = true;
+    pipe->dst_watch.fd = queue->wake_fd;
 
     return 0;
 }
 
-static int handle_src_io_fun(int index, struct io_copy_arg *copy_arg, int *infds, int *srcfds)
+static void io_copy_session_start(struct io_copy_session *session)
 {
-    ERROR("Got invalid src fd type");
-    return -1;
+    size_t i = 0;
+
+    for (i = 0; i < session->len; i++) {
+        io_copy_watch_add(session, &session->pipes[i].src_watch, EPOLLIN);
+        session->watching++;
+    }
+    if (session->sync.srcfd >= 0) {
+        io_copy_watch_add(session, &session->sync.src_watch, EPOLLIN);
+        session->watching++;
+    }
 }
 
-static int handle_src_io_max(int index, struct io_copy_arg *copy_arg, int *infds, int *srcfds)
+// take sessions added by other threads
+static void io_copy_worker_take_pending(struct io_copy_worker *worker)
 {
-    ERROR("Got invalid src fd type");
-    return -1;
+    eventfd_t val = 0;
+    struct linked_list *it = NULL;
+    struct linked_list *next = NULL;
+
+    (void)eventfd_read(worker->wake_fd, &val);
+
+    (void)pthread_mutex_lock(&worker->mutex);
+    linked_list_for_each_safe(it, &worker->pending, next) {
+        linked_list_del(it);
+        linked_list_add_tail(&worker->sessions, it);
+        io_copy_session_start((struct io_copy_session *)it->elem);
+    }
+    (void)pthread_mutex_unlock(&worker->mutex);
 }
 
-static int io_copy_make_srcfds(size_t len, struct io_copy_arg *copy_arg, int *infds, int *srcfds,
-                               transfer_channel_type *channels)
+// finish sessions closed or drained, return ms to wait for the next drain deadline
+static int io_copy_worker_reap(struct io_copy_worker *worker)
 {
-    size_t i;
+    struct linked_list *it = NULL;
+    struct linked_list *next = NULL;
+    struct io_copy_session *session = NULL;
+    struct timespec now = { 0 };
+    int64_t left = 0;
+    int timeout = -1;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    linked_list_for_each_safe(it, &worker->sessions, next) {
+        session = (struct io_copy_session *)it->elem;
+        if (!session->finish && session->closing) {
+            left = timespec_diff_ms(&session->drain_deadline, &now);
+            if (left <= 0) {
+                session->finish = true;
+            } else if (timeout < 0 || left < timeout) {
+                timeout = (int)left;
+            }
+        }
+        if (!session->finish) {
+            continue;
+        }
 
-    struct src_io_copy_handler src_handler_jump_table[] = {
-        { IO_FD, handle_src_io_fd },
-        { IO_FIFO, handle_src_io_fifo },
-        { IO_FUNC, handle_src_io_fun },
-        { IO_MAX, handle_src_io_max },
-    };
+        linked_list_del(it);
+        free(it);
+        (void)pthread_mutex_lock(&worker->mutex);
+        worker->sessions_len--;
+        (void)pthread_mutex_unlock(&worker->mutex);
+        io_copy_session_finish(session);
+    }
 
-    for (i = 0; i < len; i++) {
-        if (src_handler_jump_table[(int)(copy_arg[i].srctype)].handle(i, copy_arg, infds, srcfds) != 0) {
-            return -1;
+    return timeout;
+}
+
+static void *io_copy_worker_main(void *arg)
+{
+    struct io_copy_worker *worker = (struct io_copy_worker *)arg;
+    struct epoll_event evs[IO_COPY_MAX_EVENTS];
+    int timeout = -1;
+    int nfds = 0;
+    int i = 0;
+    int backoff_ms = 0;
+
+    (void)prctl(PR_SET_NAME, "IoCopy");
+
+    for (;;) {
+        nfds = epoll_wait(worker->epfd, evs, IO_COPY_MAX_EVENTS, timeout);
+        if (nfds < 0 && errno != EINTR) {
+            // sleep longer while the error persists instead of spinning on it
+            if (backoff_ms == 0) {
+                SYSERROR("Failed to wait io copy events");
+            }
+            backoff_ms = backoff_ms == 0 ? 1 : backoff_ms * 2;
+            if (backoff_ms > IO_COPY_ERROR_BACKOFF_MAX_MS) {
+                backoff_ms = IO_COPY_ERROR_BACKOFF_MAX_MS;
+            }
+            util_usleep_nointerupt((unsigned long)backoff_ms * 1000);
+        } else if (nfds >= 0) {
+            backoff_ms = 0;
+        }
+
+        for (i = 0; i < nfds; i++) {
+            if (evs[i].data.ptr == NULL) {
+                io_copy_worker_take_pending(worker);
+                continue;
+            }
+            io_copy_handle_event((struct io_copy_watch *)evs[i].data.ptr);
         }
-        channels[i] = copy_arg[i].channel;
+
+        timeout = io_copy_worker_reap(worker);
+        DAEMON_CLEAR_ERRMSG();
     }
 
-    return 0;
+    return NULL;
 }
 
-static ssize_t write_to_fifo(void *context, const void *data, size_t len)
+static int io_copy_worker_init(struct io_copy_worker *worker)
 {
-    ssize_t ret;
-    int fd;
+    struct epoll_event ev = { 0 };
+
+    linked_list_init(&worker->sessions);
+    linked_list_init(&worker->pending);
+    (void)pthread_mutex_init(&worker->mutex, NULL);
+
+    worker->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (worker->epfd < 0) {
+        SYSERROR("Failed to create epoll");
+        return -1;
+    }
+
+    worker->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (worker->wake_fd < 0) {
+        SYSERROR("Failed to create eventfd");
+        return -1;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(worker->epfd, EPOLL_CTL_ADD, worker->wake_fd, &ev) != 0) {
+        SYSERROR("Failed to watch eventfd");
+        return -1;
+    }
 
-    fd = *(int *)context;
-    ret = util_write_nointr_in_total(fd, data, len);
-    if ((ret <= 0) || (ret != (ssize_t)len)) {
-        ERROR("Failed to write %d: %s", fd, strerror(errno));
+    if (pthread_create(&worker->tid, NULL, io_copy_worker_main, worker) != 0) {
+        CRIT("Thread creation failed");
         return -1;
     }
+    (void)pthread_detach(worker->tid);
+
+    return 0;
+}
+
+static void io_copy_workers_init(void)
+{
+    size_t i = 0;
+
+    if (io_copy_writer_pool_init() != 0) {
+        return;
+    }
+
+    for (i = 0; i < IO_COPY_WORKERS; i++) {
+        if (io_copy_worker_init(&g_io_copy_workers[i]) != 0) {
+            // workers started already are never stopped, fds of the failed one are leaked on purpose
+            return;
+        }
+    }
+
+    g_io_copy_workers_ready = true;
+}
+
+// pick the worker serving fewest sessions
+static struct io_copy_worker *io_copy_pick_worker(void)
+{
+    size_t i = 0;
+    size_t min_len = 0;
+    struct io_copy_worker *picked = NULL;
+
+    for (i = 0; i < IO_COPY_WORKERS; i++) {
+        (void)pthread_mutex_lock(&g_io_copy_workers[i].mutex);
+        if (picked == NULL || g_io_copy_workers[i].sessions_len < min_len) {
+            picked = &g_io_copy_workers[i];
+            min_len = g_io_copy_workers[i].sessions_len;
+        }
+        (void)pthread_mutex_unlock(&g_io_copy_workers[i].mutex);
+    }
+
+    return picked;
+}
+
+static void io_copy_pipe_init(struct io_copy_session *session, struct io_copy_pipe *pipe)
+{
+    pipe->session = session;
+    pipe->channel = MAX_CHANNEL;
+    pipe->srcfd = -1;
+    pipe->dstfd = -1;
+    pipe->src_watch.pipe = pipe;
+    pipe->src_watch.fd = -1;
+    pipe->dst_watch.pipe = pipe;
+    pipe->dst_watch.fd = -1;
+    pipe->queue.wake_fd = -1;
+}
+
+// fds of caller are duplicated, so the caller can close them at any time
+static int dup_fd(int fd)
+{
+    int ret = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+
+    if (ret < 0) {
+        SYSERROR("Failed to dup fd %d", fd);
+    }
     return ret;
 }
 
-static ssize_t write_to_fd(void *context, const void *data, size_t len)
+typedef int (*src_io_type_handle)(const struct io_copy_arg *copy_arg, struct io_copy_pipe *pipe);
+
+struct src_io_copy_handler {
+    io_type type;
+    src_io_type_handle handle;
+};
+
+static int handle_src_io_fd(const struct io_copy_arg *copy_arg, struct io_copy_pipe *pipe)
+{
+    pipe->srcfd = dup_fd(*(int *)(copy_arg->src));
+
+    return pipe->srcfd < 0 ? -1 : 0;
+}
+
+static int handle_src_io_fifo(const struct io_copy_arg *copy_arg, struct io_copy_pipe *pipe)
 {
-    ssize_t ret;
-    ret = util_write_nointr(*(int *)context, data, len);
-    if (ret < 0 || (size_t)ret != len) {
-        ERROR("Failed to write: %s", strerror(errno));
+    if (console_fifo_open((const char *)copy_arg->src, &pipe->srcfd, O_RDONLY | O_NONBLOCK)) {
+        ERROR("failed to open console fifo.");
         return -1;
     }
-    return ret;
+
+    return 0;
+}
+
+static int handle_src_io_invalid(const struct io_copy_arg *copy_arg, struct io_copy_pipe *pipe)
+{
+    ERROR("Got invalid src fd type");
+    return -1;
 }
 
-typedef int (*dst_io_type_handle)(int index, struct io_copy_arg *copy_arg, int *outfds,
-                                  struct io_write_wrapper *writers);
+typedef int (*dst_io_type_handle)(const struct io_copy_arg *copy_arg, struct io_copy_pipe *pipe);
 
 struct dst_io_copy_handler {
     io_type type;
     dst_io_type_handle handle;
 };
 
-static int handle_dst_io_fd(int index, struct io_copy_arg *copy_arg, int *outfds, struct io_write_wrapper *writers)
+static int handle_dst_io_fd(const struct io_copy_arg *copy_arg, struct io_copy_pipe *pipe)
 {
-    writers[index].context = copy_arg[index].dst;
-    writers[index].write_func = write_to_fd;
+    pipe->dstfd = dup_fd(*(int *)(copy_arg->dst));
+    if (pipe->dstfd < 0) {
+        return -1;
+    }
+    pipe->use_splice = true;
 
     return 0;
 }
 
-static int handle_dst_io_fifo(int index, struct io_copy_arg *copy_arg, int *outfds, struct io_write_wrapper *writers)
+static int handle_dst_io_fifo(const struct io_copy_arg *copy_arg, struct io_copy_pipe *pipe)
 {
-    if (console_fifo_open_withlock((const char *)copy_arg[index].dst, &outfds[index],
-                                   copy_arg[index].dstfifoflag | O_NONBLOCK)) {
+    if (console_fifo_open_withlock((const char *)copy_arg->dst, &pipe->dstfd, copy_arg->dstfifoflag | O_NONBLOCK)) {
         ERROR("Failed to open console fifo.");
         return -1;
     }
-    writers[index].context = &outfds[index];
-    writers[index].write_func = write_to_fifo;
+    pipe->use_splice = true;
 
     return 0;
 }
 
-static int handle_dst_io_fun(int index, struct io_copy_arg *copy_arg, int *outfds, struct io_write_wrapper *writers)
+static int handle_dst_io_fun(const struct io_copy_arg *copy_arg, struct io_copy_pipe *pipe)
 {
-    struct io_write_wrapper *io_write = copy_arg[index].dst;
-    writers[index].context = io_write->context;
-    writers[index].write_func = io_write->write_func;
-    writers[index].close_func = io_write->close_func;
+    struct io_write_wrapper *io_write = copy_arg->dst;
+
+    pipe->writer.context = io_write->context;
+    pipe->writer.write_func = io_write->write_func;
+    pipe->writer.close_func = io_write->close_func;
 
     return 0;
 }
 
-static int handle_dst_io_max(int index, struct io_copy_arg *copy_arg, int *outfds, struct io_write_wrapper *writers)
+static int handle_dst_io_invalid(const struct io_copy_arg *copy_arg, struct io_copy_pipe *pipe)
 {
     ERROR("Got invalid dst fd type");
     return -1;
 }
 
-static int io_copy_make_dstfds(size_t len, struct io_copy_arg *copy_arg, int *outfds, struct io_write_wrapper *writers)
+static int io_copy_make_pipes(struct io_copy_session *session, const struct io_copy_arg *copy_arg, size_t len)
 {
     size_t i;
+    struct io_copy_pipe *pipe = NULL;
 
+    struct src_io_copy_handler src_handler_jump_table[] = {
+        { IO_FD, handle_src_io_fd },
+        { IO_FIFO, handle_src_io_fifo },
+        { IO_FUNC, handle_src_io_invalid },
+        { IO_MAX, handle_src_io_invalid },
+    };
     struct dst_io_copy_handler dst_handler_jump_table[] = {
         { IO_FD, handle_dst_io_fd },
         { IO_FIFO, handle_dst_io_fifo },
         { IO_FUNC, handle_dst_io_fun },
-        { IO_MAX, handle_dst_io_max },
+        { IO_MAX, handle_dst_io_invalid },
     };
 
     for (i = 0; i < len; i++) {
-        if (dst_handler_jump_table[(int)(copy_arg[i].dsttype)].handle(i, copy_arg, outfds, writers) != 0) {
+        pipe = &session->pipes[i];
+        session->len++;
+        pipe->channel = copy_arg[i].channel;
+        if (src_handler_jump_table[(int)(copy_arg[i].srctype)].handle(&copy_arg[i], pipe) != 0) {
             return -1;
         }
+        if (dst_handler_jump_table[(int)(copy_arg[i].dsttype)].handle(&copy_arg[i], pipe) != 0) {
+            return -1;
+        }
+        pipe->src_watch.fd = pipe->srcfd;
+        pipe->dst_watch.fd = pipe->dstfd;
     }
 
     return 0;
 }
 
-static void *io_copy_thread_main(void *arg)
+static int io_copy_start_writers(struct io_copy_session *session)
 {
-    int ret = -1;
-    struct io_copy_thread_arg *thread_arg = (struct io_copy_thread_arg *)arg;
-    struct io_copy_arg *copy_arg = thread_arg->copy_arg;
-    size_t len = 0;
-    int *infds = NULL;
-    int *outfds = NULL; // recored fds to close
-    int *srcfds = NULL;
-    struct io_write_wrapper *writers = NULL;
-    transfer_channel_type *channels = NULL;
-    int sync_fd = thread_arg->sync_fd;
-    bool posted = false;
+    size_t i = 0;
 
-    if (thread_arg->detach) {
-        ret = pthread_detach(pthread_self());
-        if (ret != 0) {
-            CRIT("Set thread detach fail");
-            goto err;
+    for (i = 0; i < session->len; i++) {
+        if (session->pipes[i].writer.write_func == NULL || session->pipes[i].writer.context == NULL) {
+            continue;
+        }
+        if (!session->writes.started) {
+            (void)pthread_mutex_init(&session->writes.mutex, NULL);
+            linked_list_init(&session->writes.chunks);
+            linked_list_add_elem(&session->writes.node, session);
+            session->writes.started = true;
+            // put by the writer pool after the writers are closed
+            session->running++;
+        }
+        if (io_copy_start_writer(&session->pipes[i]) != 0) {
+            return -1;
         }
     }
 
-    (void)prctl(PR_SET_NAME, "IoCopy");
+    return 0;
+}
+
+// the session is freed by the writer pool if writes are started
+static void io_copy_session_abort(struct io_copy_session *session)
+{
+    io_copy_close_unqueued_writers(session);
+    if (session->writes.started) {
+        io_copy_writes_close(session);
+    }
+    (void)pthread_mutex_lock(&session->mutex);
+    session->detached = true;
+    (void)pthread_mutex_unlock(&session->mutex);
+    io_copy_session_put(session);
+}
+
+static int start_io_copy_session(int sync_fd, bool detach, const struct io_copy_arg *copy_arg, size_t len,
+                                 io_copy_session **session_out)
+{
+    size_t i = 0;
+    struct io_copy_session *session = NULL;
+    struct io_copy_worker *worker = NULL;
+    struct linked_list *node = NULL;
+
+    if (copy_arg == NULL || len == 0) {
+        return 0;
+    }
+
+    (void)pthread_once(&g_io_copy_workers_once, io_copy_workers_init);
+    if (!g_io_copy_workers_ready) {
+        ERROR("IO copy workers are not ready");
+        return -1;
+    }
 
-    len = thread_arg->len;
-    if (io_copy_init_fds(len, &infds, &outfds, &srcfds, &writers, &channels) != 0) {
-        goto err;
+    session = util_common_calloc_s(sizeof(struct io_copy_session));
+    node = util_common_calloc_s(sizeof(struct linked_list));
+    if (session == NULL || node == NULL) {
+        ERROR("Out of memory");
+        free(session);
+        free(node);
+        return -1;
     }
+    (void)pthread_mutex_init(&session->mutex, NULL);
+    (void)pthread_cond_init(&session->cond, NULL);
+    // put by the worker when the session finishes
+    session->running = 1;
+    for (i = 0; i < IO_COPY_MAX_PIPES; i++) {
+        io_copy_pipe_init(session, &session->pipes[i]);
+    }
+    io_copy_pipe_init(session, &session->sync);
 
-    if (io_copy_make_srcfds(len, copy_arg, infds, srcfds, channels) != 0) {
-        goto err;
+    if (io_copy_make_pipes(session, copy_arg, len) != 0) {
+        goto err_out;
     }
 
-    if (io_copy_make_dstfds(len, copy_arg, outfds, writers) != 0) {
-        goto err;
+    if (sync_fd >= 0) {
+        session->sync.srcfd = dup_fd(sync_fd);
+        if (session->sync.srcfd < 0) {
+            goto err_out;
+        }
+        session->sync.src_watch.fd = session->sync.srcfd;
     }
 
-    sem_post(&thread_arg->wait_sem);
-    posted = true;
-    (void)console_loop_io_copy(sync_fd, srcfds, writers, channels, len);
-err:
-    if (!posted) {
-        sem_post(&thread_arg->wait_sem);
+    if (io_copy_start_writers(session) != 0) {
+        goto err_out;
     }
-    io_copy_thread_cleanup(writers, thread_arg, infds, outfds, srcfds, channels, len);
-    DAEMON_CLEAR_ERRMSG();
-    return NULL;
+
+    session->detached = detach;
+    worker = io_copy_pick_worker();
+    session->worker = worker;
+
+    (void)pthread_mutex_lock(&worker->mutex);
+    linked_list_add_elem(node, session);
+    linked_list_add_tail(&worker->pending, node);
+    worker->sessions_len++;
+    (void)pthread_mutex_unlock(&worker->mutex);
+
+    if (eventfd_write(worker->wake_fd, 1) < 0) {
+        SYSERROR("Failed to wake up io copy worker");
+    }
+
+    *session_out = detach ? NULL : session;
+    return 0;
+
+err_out:
+    free(node);
+    io_copy_session_abort(session);
+    return -1;
 }
 
-static int start_io_copy_thread(int sync_fd, bool detach, struct io_copy_arg *copy_arg, size_t len, pthread_t *tid)
+void io_copy_session_stats(io_copy_session *session, struct io_copy_stats *stats)
 {
-    int res = 0;
-    struct io_copy_thread_arg thread_arg;
+    if (session == NULL || stats == NULL) {
+        return;
+    }
 
-    if (copy_arg == NULL || len == 0) {
-        return 0;
+    (void)pthread_mutex_lock(&session->mutex);
+    stats->stdin_bytes = session->copied[STDIN_CHANNEL];
+    stats->stdout_bytes = session->copied[STDOUT_CHANNEL];
+    stats->stderr_bytes = session->copied[STDERR_CHANNEL];
+    (void)pthread_mutex_unlock(&session->mutex);
+}
+
+void io_copy_session_wait(io_copy_session *session, struct io_copy_stats *stats)
+{
+    if (session == NULL) {
+        return;
     }
 
-    thread_arg.detach = detach;
-    thread_arg.copy_arg = copy_arg;
-    thread_arg.len = len;
-    thread_arg.sync_fd = sync_fd;
-    if (sem_init(&thread_arg.wait_sem, 0, 0)) {
-        ERROR("Failed to init start semaphore");
-        return -1;
+    (void)pthread_mutex_lock(&session->mutex);
+    while (!session->finished) {
+        (void)pthread_cond_wait(&session->cond, &session->mutex);
     }
+    (void)pthread_mutex_unlock(&session->mutex);
 
-    res = pthread_create(tid, NULL, io_copy_thread_main, (void *)(&thread_arg));
-    if (res != 0) {
-        CRIT("Thread creation failed");
-        return -1;
+    io_copy_session_stats(session, stats);
+    io_copy_session_free(session);
+}
+
+void io_copy_session_detach(io_copy_session *session)
+{
+    bool finished = false;
+
+    if (session == NULL) {
+        return;
     }
 
-    sem_wait(&thread_arg.wait_sem);
-    sem_destroy(&thread_arg.wait_sem);
-    return 0;
+    (void)pthread_mutex_lock(&session->mutex);
+    session->detached = true;
+    finished = session->finished;
+    (void)pthread_mutex_unlock(&session->mutex);
+
+    if (finished) {
+        io_copy_session_free(session);
+    }
 }
 
 static void add_io_copy_element(struct io_copy_arg *element, io_type srctype, void *src, io_type dsttype, void *dst,
@@ -517,10 +1418,10 @@ static void add_io_copy_element(struct io_copy_arg *element, io_type srctype, vo
 */
 int ready_copy_io_data(int sync_fd, bool detach, const char *fifoin, const char *fifoout, const char *fifoerr,
                        int stdin_fd, struct io_write_wrapper *stdout_handler, struct io_write_wrapper *stderr_handler,
-                       const char *fifos[], pthread_t *tid)
+                       const char *fifos[], io_copy_session **session)
 {
     size_t len = 0;
-    struct io_copy_arg io_copy[6];
+    struct io_copy_arg io_copy[IO_COPY_MAX_PIPES];
 
     if (fifoin != NULL) {
         // fifoin   : iSula -> iSulad read
@@ -554,7 +1455,7 @@ int ready_copy_io_data(int sync_fd, bool detach, const char *fifoin, const char
                             STDERR_CHANNEL);
     }
 
-    if (start_io_copy_thread(sync_fd, detach, io_copy, len, tid) != 0) {
+    if (start_io_copy_session(sync_fd, detach, io_copy, len, session) != 0) {
         return -1;
     }
 
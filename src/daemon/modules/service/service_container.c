@@ -20,6 +20,7 @@
 #include <sys/epoll.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <isula_libutils/container_config.h>
 #include <isula_libutils/container_config_v2.h>
 #include <isula_libutils/container_exec_request.h>
@@ -49,10 +50,12 @@
 #include "verify.h"
 #include "plugin_api.h"
 #include "container_api.h"
+#include "container_journal.h"
 #include "namespace.h"
 #include "runtime_api.h"
 #include "error.h"
 #include "io_handler.h"
+#include "phase_trace.h"
 #include "mainloop.h"
 #include "constants.h"
 #include "event_type.h"
@@ -678,7 +681,8 @@ out:
     epoll_loop_close(&descr);
 }
 
-static int do_start_container(container_t *cont, const char *console_fifos[], bool reset_rm, pid_ppid_info_t *pid_info)
+static int do_start_container(container_t *cont, const char *console_fifos[], bool reset_rm, pid_ppid_info_t *pid_info,
+                              phase_trace_t *trace)
 {
     int ret = 0;
     int nret = 0;
@@ -732,6 +736,7 @@ static int do_start_container(container_t *cont, const char *console_fifos[], bo
         ret = -1;
         goto out;
     }
+    phase_trace_mark(trace, PHASE_START_PREPARE);
 
     oci_spec = load_oci_config(cont->root_path, id);
     if (oci_spec == NULL) {
@@ -744,6 +749,7 @@ static int do_start_container(container_t *cont, const char *console_fifos[], bo
         ret = -1;
         goto close_exit_fd;
     }
+    phase_trace_mark(trace, PHASE_START_LOAD_OCI_CONFIG);
 
     nret = im_mount_container_rootfs(cont->common_config->image_type, cont->common_config->image, id);
     if (nret != 0) {
@@ -751,6 +757,7 @@ static int do_start_container(container_t *cont, const char *console_fifos[], bo
         ret = -1;
         goto close_exit_fd;
     }
+    phase_trace_mark(trace, PHASE_START_MOUNT_ROOTFS);
 
     nret = setup_ipc_dirs(cont->hostconfig, cont->common_config);
     if (nret != 0) {
@@ -774,6 +781,7 @@ static int do_start_container(container_t *cont, const char *console_fifos[], bo
         ret = -1;
         goto close_exit_fd;
     }
+    phase_trace_mark(trace, PHASE_START_MOUNTS);
 
     if (renew_oci_config(cont, oci_spec) != 0) {
         ret = -1;
@@ -790,6 +798,7 @@ static int do_start_container(container_t *cont, const char *console_fifos[], bo
         ret = -1;
         goto close_exit_fd;
     }
+    phase_trace_mark(trace, PHASE_START_OCI_CONFIG);
 
     start_timeout = conf_get_start_timeout();
     if (cont->common_config->config != NULL) {
@@ -803,6 +812,7 @@ static int do_start_container(container_t *cont, const char *console_fifos[], bo
         ret = -1;
         goto close_exit_fd;
     }
+    phase_trace_mark(trace, PHASE_START_PLUGIN);
 
     create_params.bundle = bundle;
     create_params.state = cont->state_path;
@@ -819,6 +829,7 @@ static int do_start_container(container_t *cont, const char *console_fifos[], bo
         ret = -1;
         goto close_exit_fd;
     }
+    phase_trace_mark(trace, PHASE_START_RUNTIME_CREATE);
 
     start_params.rootpath = cont->root_path;
     start_params.state = cont->state_path;
@@ -837,6 +848,7 @@ static int do_start_container(container_t *cont, const char *console_fifos[], bo
 
     ret = runtime_start(id, runtime, &start_params, pid_info);
     if (ret == 0) {
+        phase_trace_mark(trace, PHASE_START_RUNTIME_START);
         if (do_post_start_on_success(id, runtime, pidfile, exit_fifo_fd, pid_info) != 0) {
             ERROR("Failed to do post start on runtime start success");
             ret = -1;
@@ -876,16 +888,21 @@ int start_container(container_t *cont, const char *console_fifos[], bool reset_r
     int ret = 0;
     pid_ppid_info_t pid_info = { 0 };
     int exit_code = 125;
+    // starting a running container is a no-op, its total is not recorded
+    bool noop = false;
+    phase_trace_t trace;
 
     if (cont == NULL || console_fifos == NULL) {
         ERROR("Invalid input arguments");
-        ret = -1;
-        goto out;
+        return -1;
     }
 
+    phase_trace_begin(&trace, PHASE_TRACE_START, cont->common_config->id);
     container_lock(cont);
+    phase_trace_mark(&trace, PHASE_START_LOCK);
 
     if (reset_rm && container_is_running(cont->state)) {
+        noop = true;
         ret = 0;
         goto out;
     }
@@ -926,10 +943,11 @@ int start_container(container_t *cont, const char *console_fifos[], bool reset_r
             ret = -1;
             goto out;
         }
+        phase_trace_mark(&trace, PHASE_START_NETWORK);
     }
 #endif
 
-    ret = do_start_container(cont, console_fifos, reset_rm, &pid_info);
+    ret = do_start_container(cont, console_fifos, reset_rm, &pid_info, &trace);
     if (ret != 0) {
         ERROR("Runtime start container failed");
         ret = -1;
@@ -986,8 +1004,10 @@ save_container:
         ret = -1;
         goto out;
     }
+    phase_trace_mark(&trace, PHASE_START_POST);
 out:
     container_unlock(cont);
+    phase_trace_end(&trace, ret == 0 && !noop);
     return ret;
 }
 
@@ -1252,6 +1272,9 @@ static int do_delete_container(container_t *cont)
     // clean residual mount points
     cleanup_mounts_by_id(id, rootpath);
 
+    // config files saved by journal are removed with root dir of container
+    container_journal_forget(rootpath, id);
+
     if (do_runtime_rm_helper(id, runtime, rootpath) != 0) {
         ret = -1;
         goto out;
@@ -1485,6 +1508,9 @@ int stop_container(container_t *cont, int timeout, bool force, bool restart)
     int ret = 0;
     char *id = NULL;
     int stop_signal = 0;
+    // stopping a stopped container is a no-op, its total is not recorded
+    bool noop = false;
+    phase_trace_t trace;
 
     if (cont == NULL) {
         ERROR("Invalid input arguments");
@@ -1493,15 +1519,19 @@ int stop_container(container_t *cont, int timeout, bool force, bool restart)
 
     id = cont->common_config->id;
 
+    phase_trace_begin(&trace, PHASE_TRACE_STOP, id);
     container_lock(cont);
+    phase_trace_mark(&trace, PHASE_STOP_LOCK);
 
     if (!container_is_running(cont->state)) {
         INFO("Container %s is already stopped", id);
+        noop = true;
         ret = 0;
         goto out;
     }
 
     container_stop_health_checks(cont);
+    phase_trace_mark(&trace, PHASE_STOP_HEALTH_CHECKS);
 
     // set AutoRemove flag to false before stop so the container won't be
     // removed during restart process
@@ -1516,10 +1546,13 @@ int stop_container(container_t *cont, int timeout, bool force, bool restart)
         if (ret) {
             ERROR("Failed to grace shutdown container %s", id);
         }
+        phase_trace_mark(&trace, PHASE_STOP_SIGNAL);
         ret = container_wait_stop(cont, timeout);
+        phase_trace_mark(&trace, PHASE_STOP_WAIT);
         if (ret != 0) {
             ERROR("Failed to wait Container(%s) 'STOPPED' for %d seconds, force killing", id, timeout);
             ret = force_kill(cont);
+            phase_trace_mark(&trace, PHASE_STOP_FORCE_KILL);
             if (ret != 0) {
                 ERROR("Failed to force kill container %s", id);
                 goto out;
@@ -1527,6 +1560,7 @@ int stop_container(container_t *cont, int timeout, bool force, bool restart)
         }
     } else {
         ret = force_kill(cont);
+        phase_trace_mark(&trace, PHASE_STOP_FORCE_KILL);
         if (ret != 0) {
             ERROR("Failed to force kill container %s", id);
             goto out;
@@ -1538,6 +1572,7 @@ out:
         cont->hostconfig->auto_remove = cont->hostconfig->auto_remove_bak;
     }
     container_unlock(cont);
+    phase_trace_end(&trace, ret == 0 && !noop);
     return ret;
 }
 
@@ -2021,7 +2056,7 @@ out:
 
 static int exec_prepare_console(const container_t *cont, const container_exec_request *request, int stdinfd,
                                 struct io_write_wrapper *stdout_handler, struct io_write_wrapper *stderr_handler,
-                                char **fifos, char **fifopath, int *sync_fd, pthread_t *thread_id)
+                                char **fifos, char **fifopath, int *sync_fd, io_copy_session **io_session)
 {
     int ret = 0;
     const char *id = cont->common_config->id;
@@ -2040,7 +2075,7 @@ static int exec_prepare_console(const container_t *cont, const container_exec_re
             goto out;
         }
         if (ready_copy_io_data(*sync_fd, false, request->stdin, request->stdout, request->stderr, stdinfd,
-                               stdout_handler, stderr_handler, (const char **)fifos, thread_id)) {
+                               stdout_handler, stderr_handler, (const char **)fifos, io_session)) {
             ret = -1;
             goto out;
         }
@@ -2050,7 +2085,7 @@ out:
 }
 
 static void exec_container_end(container_exec_response *response, uint32_t cc, int exit_code, int sync_fd,
-                               pthread_t thread_id)
+                               io_copy_session *io_session)
 {
     if (response != NULL) {
         response->cc = cc;
@@ -2065,10 +2100,12 @@ static void exec_container_end(container_exec_response *response, uint32_t cc, i
             ERROR("Failed to write eventfd: %s", strerror(errno));
         }
     }
-    if (thread_id > 0) {
-        if (pthread_join(thread_id, NULL) != 0) {
-            ERROR("Failed to join thread: 0x%lx", thread_id);
-        }
+    if (io_session != NULL) {
+        struct io_copy_stats stats = { 0 };
+
+        io_copy_session_wait(io_session, &stats);
+        DEBUG("Exec io copied, stdin: %" PRIu64 ", stdout: %" PRIu64 ", stderr: %" PRIu64, stats.stdin_bytes,
+              stats.stdout_bytes, stats.stderr_bytes);
     }
     if (sync_fd >= 0) {
         close(sync_fd);
@@ -2138,7 +2175,7 @@ int exec_container(const container_t *cont, const container_exec_request *reques
     char *id = NULL;
     char *fifos[3] = { NULL, NULL, NULL };
     char *fifopath = NULL;
-    pthread_t thread_id = 0;
+    io_copy_session *io_session = NULL;
     defs_process_user *puser = NULL;
     char exec_command[EVENT_ARGS_MAX] = { 0x00 };
 
@@ -2196,7 +2233,7 @@ int exec_container(const container_t *cont, const container_exec_request *reques
     }
 
     if (exec_prepare_console(cont, request, stdinfd, stdout_handler, stderr_handler, fifos, &fifopath, &sync_fd,
-                             &thread_id)) {
+                             &io_session)) {
         cc = ISULAD_ERR_EXEC;
         goto pack_response;
     }
@@ -2210,7 +2247,7 @@ int exec_container(const container_t *cont, const container_exec_request *reques
     (void)isulad_monitor_send_container_event(id, EXEC_DIE, -1, 0, NULL, NULL);
 
 pack_response:
-    exec_container_end(response, cc, exit_code, sync_fd, thread_id);
+    exec_container_end(response, cc, exit_code, sync_fd, io_session);
     delete_daemon_fifos(fifopath, (const char **)fifos);
     free(fifos[0]);
     free(fifos[1]);
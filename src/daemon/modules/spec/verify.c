@@ -45,6 +45,7 @@
 #include "utils.h"
 #include "utils_convert.h"
 #include "utils_file.h"
+#include "utils_fs.h"
 #include "utils_verify.h"
 #ifdef ENABLE_USERNS_REMAP
 #include "isulad_config.h"
@@ -1324,8 +1325,6 @@ out:
 /* get source mount */
 static int get_source_mount(const char *src, char **srcpath, char **optional)
 {
-    mountinfo_t **minfos = NULL;
-    mountinfo_t *info = NULL;
     int ret = 0;
     char real_path[PATH_MAX + 1] = { 0 };
     char *dirc = NULL;
@@ -1336,17 +1335,8 @@ static int get_source_mount(const char *src, char **srcpath, char **optional)
         return -1;
     }
 
-    minfos = getmountsinfo();
-    if (minfos == NULL) {
-        ERROR("Failed to get mounts info");
-        ret = -1;
-        goto out;
-    }
-
-    info = find_mount_info(minfos, real_path);
-    if (info != NULL) {
+    if (util_find_mount_optional(real_path, optional)) {
         *srcpath = util_strdup_s(real_path);
-        *optional = info->optional ? util_strdup_s(info->optional) : NULL;
         goto out;
     }
 
@@ -1354,10 +1344,8 @@ static int get_source_mount(const char *src, char **srcpath, char **optional)
     dname = dirc;
     while (strcmp(dirc, "/")) {
         dname = dirname(dname);
-        info = find_mount_info(minfos, dname);
-        if (info != NULL) {
+        if (util_find_mount_optional(dname, optional)) {
             *srcpath = util_strdup_s(dname);
-            *optional = info->optional ? util_strdup_s(info->optional) : NULL;
             goto out;
         }
     }
@@ -1365,7 +1353,6 @@ static int get_source_mount(const char *src, char **srcpath, char **optional)
     ret = -1;
 out:
     free(dirc);
-    free_mounts_info(minfos);
     return ret;
 }
 
@@ -18,12 +18,24 @@
 
 #include <unistd.h>
 #include <sys/mount.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 #include <sched.h>
 #include <pthread.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
 #include <isula_libutils/log.h>
 
 #include "utils.h"
 #include "utils_fs.h"
+#include "utils_file.h"
+#include "map.h"
+
+// big enough for a netlink dump message
+#define NETLINK_RECV_BUF_SIZE (32 * 1024)
+#define NETLINK_RECV_TIMEOUT_SEC 5
 
 struct mount_netns {
     int pid;
@@ -169,6 +181,8 @@ int remove_network_namespace(const char *netns_path)
         return -1;
     }
 
+    forget_network_namespace_link_stats(netns_path);
+
     if (!util_file_exists(netns_path)) {
         WARN("Namespace file does not exist");
         return 0;
@@ -237,3 +251,468 @@ int remove_network_namespace_file(const char *netns_path)
 
     return 0;
 }
+
+/* netlink socket created in a network namespace, the socket keeps working in it */
+struct netns_netlink_socket {
+    int fd;
+    dev_t dev;
+    ino_t ino;
+    // the path the namespace was last requested by, the entry is stale once it is gone or replaced
+    char *path;
+    // serializes dumps on the socket, so dumps of other namespaces do not wait for it
+    pthread_mutex_t lock;
+    uint32_t seq;
+    // a dump failed, a new socket is created next time
+    bool broken;
+    // the map and every running dump hold a reference, protected by g_netns_sockets_lock
+    size_t refcnt;
+};
+
+struct open_netlink_args {
+    int netns_fd;
+    int sock;
+};
+
+static pthread_mutex_t g_netns_sockets_lock = PTHREAD_MUTEX_INITIALIZER;
+// "<dev>:<ino>" of netns -> struct netns_netlink_socket, protected by g_netns_sockets_lock
+static map_t *g_netns_sockets = NULL;
+
+// called with g_netns_sockets_lock held
+static void put_netns_netlink_socket(struct netns_netlink_socket *ns_sock)
+{
+    if (ns_sock == NULL || --ns_sock->refcnt > 0) {
+        return;
+    }
+
+    if (ns_sock->fd >= 0) {
+        close(ns_sock->fd);
+    }
+    (void)pthread_mutex_destroy(&ns_sock->lock);
+    free(ns_sock->path);
+    free(ns_sock);
+}
+
+static void netns_sockets_kvfree(void *key, void *value)
+{
+    free(key);
+    put_netns_netlink_socket((struct netns_netlink_socket *)value);
+}
+
+// run in a thread of its own, so the namespace of other threads is not changed
+static void *open_netlink_in_netns(void *arg)
+{
+    struct open_netlink_args *args = (struct open_netlink_args *)arg;
+    struct timeval timeout = { .tv_sec = NETLINK_RECV_TIMEOUT_SEC, .tv_usec = 0 };
+
+    if (setns(args->netns_fd, CLONE_NEWNET) != 0) {
+        SYSERROR("Failed to enter network namespace");
+        return NULL;
+    }
+
+    args->sock = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (args->sock < 0) {
+        SYSERROR("Failed to create netlink socket");
+        return NULL;
+    }
+
+    // a dump must not block forever, the socket is recreated after a failed one
+    if (setsockopt(args->sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0) {
+        SYSERROR("Failed to set receive timeout of netlink socket");
+        close(args->sock);
+        args->sock = -1;
+    }
+
+    return NULL;
+}
+
+static struct netns_netlink_socket *open_netns_netlink_socket(const char *netns_path)
+{
+    struct open_netlink_args args = { .netns_fd = -1, .sock = -1 };
+    struct netns_netlink_socket *ns_sock = NULL;
+    struct stat st = { 0 };
+    pthread_t tid = 0;
+
+    args.netns_fd = util_open(netns_path, O_RDONLY | O_CLOEXEC, 0);
+    if (args.netns_fd < 0) {
+        SYSERROR("Failed to open network namespace %s", netns_path);
+        return NULL;
+    }
+
+    if (fstat(args.netns_fd, &st) != 0) {
+        SYSERROR("Failed to stat network namespace %s", netns_path);
+        goto out;
+    }
+
+    if (pthread_create(&tid, NULL, open_netlink_in_netns, &args) != 0) {
+        ERROR("Failed to create thread");
+        goto out;
+    }
+    if (pthread_join(tid, NULL) != 0) {
+        ERROR("Failed to join thread");
+        goto out;
+    }
+    if (args.sock < 0) {
+        goto out;
+    }
+
+    ns_sock = util_common_calloc_s(sizeof(struct netns_netlink_socket));
+    if (ns_sock == NULL) {
+        ERROR("Out of memory");
+        close(args.sock);
+        goto out;
+    }
+    if (pthread_mutex_init(&ns_sock->lock, NULL) != 0) {
+        ERROR("Failed to init netlink socket lock");
+        close(args.sock);
+        free(ns_sock);
+        ns_sock = NULL;
+        goto out;
+    }
+    ns_sock->fd = args.sock;
+    ns_sock->dev = st.st_dev;
+    ns_sock->ino = st.st_ino;
+    ns_sock->path = util_strdup_s(netns_path);
+    ns_sock->refcnt = 1;
+
+out:
+    close(args.netns_fd);
+    return ns_sock;
+}
+
+static char *netns_socket_key(dev_t dev, ino_t ino)
+{
+    char key[64] = { 0 };
+    int nret = 0;
+
+    nret = snprintf(key, sizeof(key), "%llu:%llu", (unsigned long long)dev, (unsigned long long)ino);
+    if (nret < 0 || (size_t)nret >= sizeof(key)) {
+        ERROR("Failed to sprintf netns socket key");
+        return NULL;
+    }
+
+    return util_strdup_s(key);
+}
+
+// the path of the entry is gone, mounted with another namespace, or equal to path if it is not NULL
+static bool netns_netlink_socket_stale(const struct netns_netlink_socket *ns_sock, const char *path)
+{
+    struct stat st = { 0 };
+
+    if (path != NULL) {
+        return strcmp(ns_sock->path, path) == 0;
+    }
+
+    return stat(ns_sock->path, &st) != 0 || ns_sock->dev != st.st_dev || ns_sock->ino != st.st_ino;
+}
+
+// remove stale entries, called with g_netns_sockets_lock held
+static void evict_netns_netlink_sockets(const char *path)
+{
+    map_itor *itor = NULL;
+    char **keys = NULL;
+    size_t i;
+
+    if (g_netns_sockets == NULL) {
+        return;
+    }
+
+    itor = map_itor_new(g_netns_sockets);
+    if (itor == NULL) {
+        ERROR("Out of memory");
+        return;
+    }
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        if (netns_netlink_socket_stale(map_itor_value(itor), path) &&
+            util_array_append(&keys, map_itor_key(itor)) != 0) {
+            ERROR("Out of memory");
+            break;
+        }
+    }
+    map_itor_free(itor);
+
+    for (i = 0; keys != NULL && keys[i] != NULL; i++) {
+        (void)map_remove(g_netns_sockets, keys[i]);
+    }
+    util_free_array(keys);
+}
+
+// return the socket of the namespace with a reference held, called with g_netns_sockets_lock held
+static struct netns_netlink_socket *get_netns_netlink_socket(const char *netns_path)
+{
+    struct netns_netlink_socket *ns_sock = NULL;
+    struct stat st = { 0 };
+    char *key = NULL;
+
+    if (g_netns_sockets == NULL) {
+        g_netns_sockets = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, netns_sockets_kvfree);
+        if (g_netns_sockets == NULL) {
+            ERROR("Out of memory");
+            return NULL;
+        }
+    }
+
+    if (stat(netns_path, &st) != 0) {
+        SYSERROR("Failed to stat network namespace %s", netns_path);
+        return NULL;
+    }
+
+    key = netns_socket_key(st.st_dev, st.st_ino);
+    if (key == NULL) {
+        return NULL;
+    }
+
+    ns_sock = map_search(g_netns_sockets, key);
+    if (ns_sock != NULL && !ns_sock->broken) {
+        if (strcmp(ns_sock->path, netns_path) != 0) {
+            free(ns_sock->path);
+            ns_sock->path = util_strdup_s(netns_path);
+        }
+        goto out;
+    }
+
+    // a new namespace, namespaces removed since the last one do not keep their sockets
+    evict_netns_netlink_sockets(NULL);
+
+    ns_sock = open_netns_netlink_socket(netns_path);
+    if (ns_sock == NULL) {
+        goto out;
+    }
+
+    if (!map_replace(g_netns_sockets, key, ns_sock)) {
+        ERROR("Failed to save netlink socket of %s", netns_path);
+        put_netns_netlink_socket(ns_sock);
+        ns_sock = NULL;
+        goto out;
+    }
+
+out:
+    if (ns_sock != NULL) {
+        ns_sock->refcnt++;
+    }
+    free(key);
+    return ns_sock;
+}
+
+static void parse_link_stats(struct nlmsghdr *nlh, struct netns_link_stats *stats)
+{
+    struct ifinfomsg *ifm = NLMSG_DATA(nlh);
+    struct rtattr *rta = IFLA_RTA(ifm);
+    int rta_len = (int)IFLA_PAYLOAD(nlh);
+    struct rtnl_link_stats64 stats64 = { 0 };
+    struct rtnl_link_stats stats32 = { 0 };
+    bool has_stats64 = false;
+    size_t name_len = 0;
+
+    for (; RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)) {
+        switch (rta->rta_type) {
+            case IFLA_IFNAME:
+                name_len = strnlen(RTA_DATA(rta), RTA_PAYLOAD(rta));
+                if (name_len >= sizeof(stats->name)) {
+                    name_len = sizeof(stats->name) - 1;
+                }
+                (void)memcpy(stats->name, RTA_DATA(rta), name_len);
+                stats->name[name_len] = '\0';
+                break;
+            case IFLA_STATS64:
+                if (RTA_PAYLOAD(rta) >= sizeof(stats64)) {
+                    (void)memcpy(&stats64, RTA_DATA(rta), sizeof(stats64));
+                    has_stats64 = true;
+                }
+                break;
+            case IFLA_STATS:
+                if (RTA_PAYLOAD(rta) >= sizeof(stats32)) {
+                    (void)memcpy(&stats32, RTA_DATA(rta), sizeof(stats32));
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (has_stats64) {
+        stats->rx_bytes = stats64.rx_bytes;
+        stats->rx_errors = stats64.rx_errors;
+        stats->tx_bytes = stats64.tx_bytes;
+        stats->tx_errors = stats64.tx_errors;
+    } else {
+        stats->rx_bytes = stats32.rx_bytes;
+        stats->rx_errors = stats32.rx_errors;
+        stats->tx_bytes = stats32.tx_bytes;
+        stats->tx_errors = stats32.tx_errors;
+    }
+}
+
+static int append_link_stats(struct nlmsghdr *nlh, struct netns_link_stats **stats, size_t *len)
+{
+    struct netns_link_stats *new_stats = NULL;
+
+    if (util_mem_realloc((void **)&new_stats, (*len + 1) * sizeof(struct netns_link_stats), (void *)*stats,
+                         *len * sizeof(struct netns_link_stats)) != 0) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    *stats = new_stats;
+
+    (void)memset(&(*stats)[*len], 0, sizeof(struct netns_link_stats));
+    parse_link_stats(nlh, &(*stats)[*len]);
+    (*len)++;
+
+    return 0;
+}
+
+static int send_getlink_request(int sock, uint32_t seq)
+{
+    struct {
+        struct nlmsghdr nlh;
+        struct ifinfomsg ifm;
+    } req;
+    struct sockaddr_nl kernel = { 0 };
+    ssize_t nret = 0;
+
+    (void)memset(&req, 0, sizeof(req));
+    req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    req.nlh.nlmsg_type = RTM_GETLINK;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.nlh.nlmsg_seq = seq;
+    req.ifm.ifi_family = AF_UNSPEC;
+    kernel.nl_family = AF_NETLINK;
+
+    do {
+        nret = sendto(sock, &req, req.nlh.nlmsg_len, 0, (struct sockaddr *)&kernel, sizeof(kernel));
+    } while (nret < 0 && errno == EINTR);
+    if (nret < 0) {
+        SYSERROR("Failed to send netlink request");
+        return -1;
+    }
+
+    return 0;
+}
+
+/* dump stats of all links in the namespace of sock */
+static int dump_link_stats(int sock, uint32_t seq, struct netns_link_stats **stats, size_t *len)
+{
+    char *buf = NULL;
+    struct nlmsghdr *nlh = NULL;
+    ssize_t nread = 0;
+    int msg_len = 0;
+    int ret = -1;
+
+    if (send_getlink_request(sock, seq) != 0) {
+        return -1;
+    }
+
+    buf = util_common_calloc_s(NETLINK_RECV_BUF_SIZE);
+    if (buf == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    for (;;) {
+        nread = recv(sock, buf, NETLINK_RECV_BUF_SIZE, 0);
+        if (nread < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nread <= 0) {
+            SYSERROR("Failed to receive netlink message");
+            goto out;
+        }
+
+        msg_len = (int)nread;
+        for (nlh = (struct nlmsghdr *)buf; NLMSG_OK(nlh, msg_len); nlh = NLMSG_NEXT(nlh, msg_len)) {
+            // left by an earlier dump
+            if (nlh->nlmsg_seq != seq) {
+                continue;
+            }
+            if (nlh->nlmsg_type == NLMSG_DONE) {
+                ret = 0;
+                goto out;
+            }
+            if (nlh->nlmsg_type == NLMSG_ERROR) {
+                ERROR("Netlink dump links failed");
+                goto out;
+            }
+            if (nlh->nlmsg_type == RTM_NEWLINK && append_link_stats(nlh, stats, len) != 0) {
+                goto out;
+            }
+        }
+    }
+
+out:
+    free(buf);
+    return ret;
+}
+
+int get_network_namespace_link_stats(const char *netns_path, struct netns_link_stats **stats, size_t *len)
+{
+    struct netns_netlink_socket *ns_sock = NULL;
+    int ret = -1;
+
+    if (netns_path == NULL || stats == NULL || len == NULL) {
+        ERROR("Invalid input arguments");
+        return -1;
+    }
+
+    *stats = NULL;
+    *len = 0;
+
+    if (pthread_mutex_lock(&g_netns_sockets_lock) != 0) {
+        ERROR("Failed to lock netns sockets");
+        return -1;
+    }
+    ns_sock = get_netns_netlink_socket(netns_path);
+    if (pthread_mutex_unlock(&g_netns_sockets_lock) != 0) {
+        ERROR("Failed to unlock netns sockets");
+    }
+    if (ns_sock == NULL) {
+        return -1;
+    }
+
+    // the dump may block until the receive timeout, do not hold the lock of all sockets for it
+    if (pthread_mutex_lock(&ns_sock->lock) != 0) {
+        ERROR("Failed to lock netlink socket of %s", netns_path);
+        goto put_out;
+    }
+    if (!ns_sock->broken) {
+        ns_sock->seq++;
+        ret = dump_link_stats(ns_sock->fd, ns_sock->seq, stats, len);
+        // replies of the failed dump may be left in the socket, create a new socket next time
+        ns_sock->broken = (ret != 0);
+    }
+    if (pthread_mutex_unlock(&ns_sock->lock) != 0) {
+        ERROR("Failed to unlock netlink socket of %s", netns_path);
+    }
+
+    if (ret != 0) {
+        free(*stats);
+        *stats = NULL;
+        *len = 0;
+    }
+
+put_out:
+    if (pthread_mutex_lock(&g_netns_sockets_lock) != 0) {
+        ERROR("Failed to lock netns sockets");
+        return ret;
+    }
+    put_netns_netlink_socket(ns_sock);
+    if (pthread_mutex_unlock(&g_netns_sockets_lock) != 0) {
+        ERROR("Failed to unlock netns sockets");
+    }
+    return ret;
+}
+
+void forget_network_namespace_link_stats(const char *netns_path)
+{
+    if (netns_path == NULL) {
+        return;
+    }
+
+    if (pthread_mutex_lock(&g_netns_sockets_lock) != 0) {
+        ERROR("Failed to lock netns sockets");
+        return;
+    }
+    // the path may be unmounted already, so entries are found by path rather than by inode
+    evict_netns_netlink_sockets(netns_path);
+    if (pthread_mutex_unlock(&g_netns_sockets_lock) != 0) {
+        ERROR("Failed to unlock netns sockets");
+    }
+}
@@ -17,6 +17,9 @@
 #define UTILS_CUTILS_NETWORK_NAMESPACE_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <net/if.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,6 +33,20 @@ int create_network_namespace_file(const char *netns_path);
 
 int remove_network_namespace_file(const char *netns_path);
 
+struct netns_link_stats {
+    char name[IFNAMSIZ];
+    uint64_t rx_bytes;
+    uint64_t rx_errors;
+    uint64_t tx_bytes;
+    uint64_t tx_errors;
+};
+
+// get stats of all links in the network namespace with a netlink dump, the netlink socket is cached
+int get_network_namespace_link_stats(const char *netns_path, struct netns_link_stats **stats, size_t *len);
+
+// close the cached netlink socket of the network namespace
+void forget_network_namespace_link_stats(const char *netns_path);
+
 #ifdef __cplusplus
 }
 #endif
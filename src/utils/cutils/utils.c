@@ -30,7 +30,9 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <pthread.h>
 #include <sys/prctl.h>
+#include <sys/sysinfo.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/utsname.h>
@@ -1603,3 +1605,83 @@ out:
 
     return dst;
 }
+
+struct parallel_context {
+    pthread_mutex_t mutex;
+    size_t next;
+    size_t count;
+    util_parallel_cb_t cb;
+    void *context;
+};
+
+static void *parallel_worker(void *arg)
+{
+    struct parallel_context *ctx = (struct parallel_context *)arg;
+    size_t idx = 0;
+
+    for (;;) {
+        (void)pthread_mutex_lock(&ctx->mutex);
+        idx = ctx->next;
+        if (idx < ctx->count) {
+            ctx->next++;
+        }
+        (void)pthread_mutex_unlock(&ctx->mutex);
+
+        if (idx >= ctx->count) {
+            break;
+        }
+        ctx->cb(idx, ctx->context);
+    }
+
+    return NULL;
+}
+
+void util_parallel_for(size_t count, size_t max_workers, util_parallel_cb_t cb, void *context)
+{
+    struct parallel_context ctx = { 0 };
+    pthread_t *tids = NULL;
+    size_t started = 0;
+    size_t workers = max_workers;
+    size_t i;
+    int nprocs = get_nprocs();
+
+    if (cb == NULL || count == 0) {
+        return;
+    }
+
+    if (nprocs > 0 && workers > (size_t)nprocs) {
+        workers = (size_t)nprocs;
+    }
+    if (workers > count) {
+        workers = count;
+    }
+
+    ctx.next = 0;
+    ctx.count = count;
+    ctx.cb = cb;
+    ctx.context = context;
+    (void)pthread_mutex_init(&ctx.mutex, NULL);
+
+    // the calling thread is one of the workers
+    if (workers > 1) {
+        tids = util_smart_calloc_s(sizeof(pthread_t), workers - 1);
+        if (tids == NULL) {
+            ERROR("Out of memory, run in current thread only");
+        }
+    }
+    for (i = 0; tids != NULL && i < workers - 1; i++) {
+        if (pthread_create(&tids[i], NULL, parallel_worker, &ctx) != 0) {
+            WARN("Failed to create parallel worker, run with %zu workers", started + 1);
+            break;
+        }
+        started++;
+    }
+
+    (void)parallel_worker(&ctx);
+
+    for (i = 0; i < started; i++) {
+        (void)pthread_join(tids[i], NULL);
+    }
+    free(tids);
+    (void)pthread_mutex_destroy(&ctx.mutex);
+}
@@ -132,6 +132,9 @@ int malloc_trim(size_t pad);
 #define UMASK_NORMAL "normal"
 #define UMASK_SECURE "secure"
 
+// exec processes of container by the agent in its shim, value "true" enables it
+#define ANNOTATION_EXEC_AGENT_KEY "native.exec_agent"
+
 // proxy value
 #define HTTP_PROXY "http_proxy"
 #define HTTPS_PROXY "https_proxy"
@@ -396,6 +399,14 @@ void util_parse_user_group(const char *username, char **user, char **group, char
 
 defs_map_string_object * dup_map_string_empty_object(defs_map_string_object *src);
 
+typedef void (*util_parallel_cb_t)(size_t idx, void *context);
+
+/*
+ * Call cb for each idx in [0, count) by at most max_workers threads, and no more threads than
+ * online cpus. The calling thread is one of the workers, and it returns after all calls finished.
+ */
+void util_parallel_for(size_t count, size_t max_workers, util_parallel_cb_t cb, void *context);
+
 /**
  * retry_cnt: max count of call cb;
  * interval_us: how many us to sleep, after call cb;
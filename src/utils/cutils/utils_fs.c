@@ -27,6 +27,9 @@
 #include <sys/statfs.h>
 #include <dirent.h>
 #include <stdint.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
 #include <sys/mount.h>
 
 #include "isula_libutils/log.h"
@@ -34,6 +37,7 @@
 #include "utils_array.h"
 #include "utils_file.h"
 #include "utils_string.h"
+#include "map.h"
 
 #ifndef JFS_SUPER_MAGIC
 #define JFS_SUPER_MAGIC 0x3153464a
@@ -354,13 +358,130 @@ err_out:
     return sret;
 }
 
-bool util_detect_mounted(const char *path)
+typedef struct {
+    // polled to detect changes of mount table, kernel reports POLLPRI after mount or umount
+    int fd;
+    // process which opened fd, a forked child should not use the table of parent
+    pid_t pid;
+    /*
+     * mountpoints of the table. Optional fields are not cached, because changes
+     * of mount propagation are not reported by POLLPRI.
+     */
+    map_t *mounts;
+} mount_table_t;
+
+static pthread_mutex_t g_mount_table_mutex = PTHREAD_MUTEX_INITIALIZER;
+// protected by g_mount_table_mutex
+static mount_table_t g_mount_table = { .fd = -1, .pid = 0, .mounts = NULL };
+
+// line format: id parent major:minor root mountpoint options [optional fields...] - fstype source super_options
+static bool parse_mountinfo_line(char *line, char **mountpoint, char **optional)
+{
+    char *fields[7] = { 0 };
+    char *saveptr = NULL;
+    char *token = NULL;
+    size_t i = 0;
+
+    for (token = strtok_r(line, " \n", &saveptr); token != NULL && i < 7; token = strtok_r(NULL, " \n", &saveptr)) {
+        fields[i++] = token;
+    }
+    if (i < 7) {
+        return false;
+    }
+
+    *mountpoint = fields[4];
+    *optional = strcmp(fields[6], "-") == 0 ? "" : fields[6];
+    return true;
+}
+
+static map_t *load_mount_table(void)
 {
     FILE *fp = NULL;
     char *line = NULL;
     char *mountpoint = NULL;
+    char *optional = NULL;
+    size_t length = 0;
+    bool exist = true;
+    map_t *mounts = NULL;
+
+    mounts = map_new(MAP_STR_BOOL, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (mounts == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    fp = util_fopen("/proc/self/mountinfo", "r");
+    if (fp == NULL) {
+        ERROR("Failed opening /proc/self/mountinfo");
+        map_free(mounts);
+        return NULL;
+    }
+
+    while (getline(&line, &length, fp) != -1) {
+        if (!parse_mountinfo_line(line, &mountpoint, &optional)) {
+            INFO("Error reading mountinfo: bad line '%s'", line);
+            continue;
+        }
+        if (!map_replace(mounts, (void *)mountpoint, (void *)&exist)) {
+            ERROR("Failed to index mountpoint %s", mountpoint);
+            map_free(mounts);
+            mounts = NULL;
+            break;
+        }
+    }
+
+    fclose(fp);
+    free(line);
+    return mounts;
+}
+
+// called with g_mount_table_mutex held, reload the table only if mount table changed since last load
+static int refresh_mount_table(void)
+{
+    struct pollfd pfd = { 0 };
+    bool stale = false;
+    pid_t pid = getpid();
+
+    if (g_mount_table.fd >= 0 && g_mount_table.pid != pid) {
+        close(g_mount_table.fd);
+        g_mount_table.fd = -1;
+    }
+
+    if (g_mount_table.fd < 0) {
+        // changes are reported since open, so open it before loading the table
+        g_mount_table.fd = util_open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC, 0);
+        if (g_mount_table.fd < 0) {
+            SYSERROR("Failed to open /proc/self/mountinfo");
+            return -1;
+        }
+        g_mount_table.pid = pid;
+        stale = true;
+    } else {
+        // poll consumes the change event, so it must be done before loading the table
+        pfd.fd = g_mount_table.fd;
+        pfd.events = POLLPRI;
+        // reload if failed to poll
+        stale = poll(&pfd, 1, 0) < 0 || (pfd.revents & (POLLPRI | POLLERR)) != 0;
+    }
+
+    if (!stale && g_mount_table.mounts != NULL) {
+        return 0;
+    }
+
+    map_free(g_mount_table.mounts);
+    g_mount_table.mounts = load_mount_table();
+    return g_mount_table.mounts != NULL ? 0 : -1;
+}
+
+// read the optional fields of the first mount on mountpoint from mountinfo
+static bool read_mount_optional(const char *mountpoint, char **optional)
+{
+    FILE *fp = NULL;
+    char *line = NULL;
+    char *mp = NULL;
+    char *value = NULL;
     size_t length = 0;
-    bool bret = false;
+    bool found = false;
 
     fp = util_fopen("/proc/self/mountinfo", "r");
     if (fp == NULL) {
@@ -369,22 +490,47 @@ bool util_detect_mounted(const char *path)
     }
 
     while (getline(&line, &length, fp) != -1) {
-        mountpoint = get_mtpoint(line);
-        if (mountpoint == NULL) {
+        if (!parse_mountinfo_line(line, &mp, &value)) {
             INFO("Error reading mountinfo: bad line '%s'", line);
             continue;
         }
-        if (strcmp(mountpoint, path) == 0) {
-            free(mountpoint);
-            bret = true;
-            goto out;
+        if (strcmp(mp, mountpoint) == 0) {
+            *optional = strcmp(value, "") != 0 ? util_strdup_s(value) : NULL;
+            found = true;
+            break;
         }
-        free(mountpoint);
     }
-out:
+
     fclose(fp);
     free(line);
-    return bret;
+    return found;
+}
+
+bool util_find_mount_optional(const char *mountpoint, char **optional)
+{
+    bool found = false;
+
+    if (mountpoint == NULL) {
+        return false;
+    }
+
+    (void)pthread_mutex_lock(&g_mount_table_mutex);
+    if (refresh_mount_table() == 0) {
+        found = map_search(g_mount_table.mounts, (void *)mountpoint) != NULL;
+    }
+    (void)pthread_mutex_unlock(&g_mount_table_mutex);
+
+    // the propagation may have changed without a change of the table, read it from mountinfo
+    if (found && optional != NULL) {
+        found = read_mount_optional(mountpoint, optional);
+    }
+
+    return found;
+}
+
+bool util_detect_mounted(const char *path)
+{
+    return util_find_mount_optional(path, NULL);
 }
 
 bool util_deal_with_mount_info(mount_info_call_back_t cb, const char *pattern)
@@ -31,6 +31,12 @@ bool util_support_d_type(const char *path);
 int util_mount(const char *src, const char *dst, const char *mtype, const char *mntopts);
 int util_force_mount(const char *src, const char *dst, const char *mtype, const char *mntopts);
 bool util_detect_mounted(const char *path);
+// Find mountpoint in the mount table of current process, return true if found, and
+// optional is set to the optional fields of mountinfo if not NULL, or NULL if no fields.
+// The mountpoints are indexed and reloaded only if the table changed, so it is cheap to call
+// frequently. The optional fields are always read from mountinfo, since changes of mount
+// propagation do not change the table.
+bool util_find_mount_optional(const char *mountpoint, char **optional);
 int util_ensure_mounted_as(const char *dst, const char *mntopts);
 int util_mount_from(const char *base, const char *src, const char *dst, const char *mtype, const char *mntopts);
 typedef int (*mount_info_call_back_t)(const char *, const char *);
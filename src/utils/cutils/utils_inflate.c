@@ -0,0 +1,148 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide streaming gzip inflate functions
+ ********************************************************************************/
+#include "utils_inflate.h"
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "isula_libutils/log.h"
+#include "utils.h"
+
+#define INFLATE_BLKSIZE 32768
+
+struct util_gzip_inflater {
+    z_stream zs;
+    util_inflate_cb cb;
+    void *context;
+    // a gzip member ended, data followed is a new member or trailing garbage
+    bool member_end;
+    bool trailing;
+    unsigned char *out_buf;
+};
+
+bool util_is_gzip_header(const unsigned char *data, size_t len)
+{
+    const unsigned char gzip_key[UTIL_GZIP_HEADER_LEN] = { 0x1F, 0x8B, 0x08 };
+
+    return data != NULL && len >= UTIL_GZIP_HEADER_LEN && memcmp(data, gzip_key, UTIL_GZIP_HEADER_LEN) == 0;
+}
+
+util_gzip_inflater *util_gzip_inflater_new(util_inflate_cb cb, void *context)
+{
+    util_gzip_inflater *inflater = NULL;
+
+    if (cb == NULL) {
+        ERROR("Invalid NULL param");
+        return NULL;
+    }
+
+    inflater = util_common_calloc_s(sizeof(util_gzip_inflater));
+    if (inflater == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    inflater->out_buf = util_common_calloc_s(INFLATE_BLKSIZE);
+    if (inflater->out_buf == NULL) {
+        ERROR("Out of memory");
+        free(inflater);
+        return NULL;
+    }
+
+    // 16 + MAX_WBITS means decode gzip format only
+    if (inflateInit2(&inflater->zs, 16 + MAX_WBITS) != Z_OK) {
+        ERROR("Failed to init inflate stream");
+        free(inflater->out_buf);
+        free(inflater);
+        return NULL;
+    }
+    inflater->cb = cb;
+    inflater->context = context;
+
+    return inflater;
+}
+
+int util_gzip_inflater_update(util_gzip_inflater *inflater, const void *data, size_t len)
+{
+    const unsigned char *pos = (const unsigned char *)data;
+    int zret = Z_OK;
+    size_t have = 0;
+
+    if (inflater == NULL || (data == NULL && len != 0)) {
+        ERROR("Invalid NULL param");
+        return -1;
+    }
+
+    while (len > 0 && !inflater->trailing) {
+        if (inflater->member_end) {
+            if (pos[0] != 0x1F) {
+                inflater->trailing = true;
+                break;
+            }
+            if (inflateReset(&inflater->zs) != Z_OK) {
+                ERROR("Failed to reset inflate stream");
+                return -1;
+            }
+            inflater->member_end = false;
+        }
+
+        inflater->zs.next_in = (Bytef *)pos;
+        inflater->zs.avail_in = (uInt)len;
+        do {
+            inflater->zs.next_out = inflater->out_buf;
+            inflater->zs.avail_out = INFLATE_BLKSIZE;
+            zret = inflate(&inflater->zs, Z_NO_FLUSH);
+            if (zret != Z_OK && zret != Z_STREAM_END && zret != Z_BUF_ERROR) {
+                ERROR("Failed to inflate data: %s", inflater->zs.msg != NULL ? inflater->zs.msg : "unknown error");
+                return -1;
+            }
+
+            have = INFLATE_BLKSIZE - inflater->zs.avail_out;
+            if (have > 0 && inflater->cb(inflater->out_buf, have, inflater->context) != 0) {
+                return -1;
+            }
+
+            // no progress is possible, wait for more input
+            if (zret == Z_BUF_ERROR && have == 0) {
+                break;
+            }
+        } while (zret != Z_STREAM_END && (inflater->zs.avail_in > 0 || inflater->zs.avail_out == 0));
+
+        pos = inflater->zs.next_in;
+        len = inflater->zs.avail_in;
+        if (zret != Z_STREAM_END) {
+            break;
+        }
+        inflater->member_end = true;
+    }
+
+    return 0;
+}
+
+bool util_gzip_inflater_ended(const util_gzip_inflater *inflater)
+{
+    return inflater != NULL && inflater->member_end;
+}
+
+void util_gzip_inflater_free(util_gzip_inflater *inflater)
+{
+    if (inflater == NULL) {
+        return;
+    }
+
+    (void)inflateEnd(&inflater->zs);
+    free(inflater->out_buf);
+    free(inflater);
+}
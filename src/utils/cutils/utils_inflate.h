@@ -0,0 +1,51 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide streaming gzip inflate functions
+ ********************************************************************************/
+
+#ifndef UTILS_CUTILS_UTILS_INFLATE_H
+#define UTILS_CUTILS_UTILS_INFLATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UTIL_GZIP_HEADER_LEN 3
+
+typedef struct util_gzip_inflater util_gzip_inflater;
+
+// receive inflated data, return 0 if success
+typedef int (*util_inflate_cb)(const void *data, size_t len, void *context);
+
+// check whether data starts with the gzip magic and deflate method
+bool util_is_gzip_header(const unsigned char *data, size_t len);
+
+util_gzip_inflater *util_gzip_inflater_new(util_inflate_cb cb, void *context);
+
+// inflate data and pass the result to cb. Concatenated gzip members are inflated,
+// anything else after the end of a member is ignored, just as gzread does.
+int util_gzip_inflater_update(util_gzip_inflater *inflater, const void *data, size_t len);
+
+// whether at least one complete gzip member is inflated and no member is left unfinished
+bool util_gzip_inflater_ended(const util_gzip_inflater *inflater);
+
+void util_gzip_inflater_free(util_gzip_inflater *inflater);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTILS_CUTILS_UTILS_INFLATE_H
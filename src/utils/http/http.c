@@ -14,6 +14,7 @@
  ******************************************************************************/
 #include "http.h"
 #include <curl/curl.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <string.h>
 #include <stdint.h>
@@ -45,6 +46,24 @@ size_t fwrite_file(const void *ptr, size_t size, size_t nmemb, void *stream)
     return written;
 }
 
+struct file_write_context {
+    FILE *pagefile;
+    const struct http_get_options *options;
+};
+
+static size_t fwrite_file_with_hook(const void *ptr, size_t size, size_t nmemb, void *context)
+{
+    struct file_write_context *ctx = (struct file_write_context *)context;
+    size_t written = fwrite(ptr, size, nmemb, ctx->pagefile);
+
+    if (written > 0 && ctx->options->write_hook_op(ctx->options->write_hook, ptr, written * size) != 0) {
+        ERROR("Write hook failed, abort transfer");
+        return 0;
+    }
+
+    return written;
+}
+
 size_t fwrite_null(char *ptr, size_t eltsize, size_t nmemb, void *strbuf)
 {
     return eltsize * nmemb;
@@ -84,13 +103,151 @@ void free_http_get_options(struct http_get_options *options)
     return;
 }
 
+// DNS cache and TLS sessions shared by all requests. Connection cache is not shared, as libcurl
+// does not support using it by concurrent threads, connections are reused by idle handles instead
+static CURLSH *g_curl_share = NULL;
+static pthread_mutex_t g_curl_share_locks[CURL_LOCK_DATA_LAST];
+
+// idle easy handles keep connections of the last host they requested, so requests to the same
+// registry reuse them instead of doing new TCP and TLS handshakes for each one
+#define HTTP_IDLE_HANDLES_MAX 8
+struct http_idle_handle {
+    char *host;
+    CURL *handle;
+};
+static struct http_idle_handle g_idle_handles[HTTP_IDLE_HANDLES_MAX];
+static size_t g_idle_handles_len = 0;
+static pthread_mutex_t g_idle_handles_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void http_share_lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+    (void)pthread_mutex_lock(&g_curl_share_locks[data]);
+}
+
+static void http_share_unlock(CURL *handle, curl_lock_data data, void *userptr)
+{
+    (void)pthread_mutex_unlock(&g_curl_share_locks[data]);
+}
+
+static void http_share_init(void)
+{
+    size_t i;
+
+    for (i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        (void)pthread_mutex_init(&g_curl_share_locks[i], NULL);
+    }
+
+    g_curl_share = curl_share_init();
+    if (g_curl_share == NULL) {
+        WARN("Failed to init curl share, connections will not be reused");
+        return;
+    }
+
+    curl_share_setopt(g_curl_share, CURLSHOPT_LOCKFUNC, http_share_lock);
+    curl_share_setopt(g_curl_share, CURLSHOPT_UNLOCKFUNC, http_share_unlock);
+    curl_share_setopt(g_curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(g_curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+// scheme and authority of url, connections of handles are reused by requests with the same one
+static char *http_url_host(const char *url)
+{
+    const char *start = NULL;
+    size_t len = 0;
+
+    start = strstr(url, "://");
+    start = (start == NULL) ? url : start + strlen("://");
+    len = (size_t)(start - url) + strcspn(start, "/?#");
+
+    return util_sub_string(url, 0, len);
+}
+
+static void http_idle_handle_remove(size_t index)
+{
+    free(g_idle_handles[index].host);
+    for (; index + 1 < g_idle_handles_len; index++) {
+        g_idle_handles[index] = g_idle_handles[index + 1];
+    }
+    g_idle_handles_len--;
+    g_idle_handles[g_idle_handles_len].host = NULL;
+    g_idle_handles[g_idle_handles_len].handle = NULL;
+}
+
+// take the idle handle used for host most recently, or create a new one
+static CURL *http_get_handle(const char *host)
+{
+    CURL *handle = NULL;
+    size_t i = 0;
+
+    (void)pthread_mutex_lock(&g_idle_handles_lock);
+    for (i = g_idle_handles_len; i > 0; i--) {
+        if (host != NULL && strcmp(g_idle_handles[i - 1].host, host) == 0) {
+            handle = g_idle_handles[i - 1].handle;
+            http_idle_handle_remove(i - 1);
+            break;
+        }
+    }
+    (void)pthread_mutex_unlock(&g_idle_handles_lock);
+
+    if (handle != NULL) {
+        return handle;
+    }
+
+    return curl_easy_init();
+}
+
+// keep the handle and its connections for next requests to host, the least recently used one
+// is cleaned up if too many are idle
+static void http_put_handle(const char *host, CURL *handle, bool reuse)
+{
+    CURL *evicted = NULL;
+
+    if (handle == NULL) {
+        return;
+    }
+
+    if (!reuse || host == NULL) {
+        curl_easy_cleanup(handle);
+        return;
+    }
+
+    // options are reset, connections, DNS cache and TLS sessions of the handle are kept
+    curl_easy_reset(handle);
+
+    (void)pthread_mutex_lock(&g_idle_handles_lock);
+    if (g_idle_handles_len == HTTP_IDLE_HANDLES_MAX) {
+        evicted = g_idle_handles[0].handle;
+        http_idle_handle_remove(0);
+    }
+    g_idle_handles[g_idle_handles_len].host = util_strdup_s(host);
+    g_idle_handles[g_idle_handles_len].handle = handle;
+    g_idle_handles_len++;
+    (void)pthread_mutex_unlock(&g_idle_handles_lock);
+
+    if (evicted != NULL) {
+        curl_easy_cleanup(evicted);
+    }
+}
+
 void http_global_init(void)
 {
     curl_global_init(CURL_GLOBAL_ALL);
+    http_share_init();
 }
 
 void http_global_cleanup(void)
 {
+    (void)pthread_mutex_lock(&g_idle_handles_lock);
+    while (g_idle_handles_len > 0) {
+        curl_easy_cleanup(g_idle_handles[0].handle);
+        http_idle_handle_remove(0);
+    }
+    (void)pthread_mutex_unlock(&g_idle_handles_lock);
+
+    if (g_curl_share != NULL) {
+        curl_share_cleanup(g_curl_share);
+        g_curl_share = NULL;
+    }
     curl_global_cleanup();
 }
 
@@ -423,6 +580,8 @@ int http_request(const char *url, struct http_get_options *options, long *respon
     char *tmp = NULL;
     size_t fsize = 0;
     char *replaced_url = 0;
+    char *host = NULL;
+    struct file_write_context write_ctx = { 0 };
 
     if (url == NULL || options == NULL) {
         ERROR("must set url and options to use http request");
@@ -434,9 +593,11 @@ int http_request(const char *url, struct http_get_options *options, long *respon
         return -1;
     }
 
-    /* init the curl session */
-    curl_handle = curl_easy_init();
+    /* init the curl session, or reuse an idle one requested the same host */
+    host = http_url_host(url);
+    curl_handle = http_get_handle(host);
     if (curl_handle == NULL) {
+        free(host);
         return -1;
     }
 
@@ -449,6 +610,9 @@ int http_request(const char *url, struct http_get_options *options, long *respon
     /* set URL to get here */
     curl_easy_setopt(curl_handle, CURLOPT_URL, replaced_url);
     curl_easy_setopt(curl_handle, CURLOPT_NOSIGNAL, 1L);
+    if (g_curl_share != NULL) {
+        curl_easy_setopt(curl_handle, CURLOPT_SHARE, g_curl_share);
+    }
 
     /* provide a buffer to store errors in */
     curl_easy_setopt(curl_handle, CURLOPT_ERRORBUFFER, errbuf);
@@ -495,8 +659,15 @@ int http_request(const char *url, struct http_get_options *options, long *respon
             curl_easy_setopt(curl_handle, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)fsize);
         }
         curl_easy_setopt(curl_handle, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, pagefile);
-        curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, fwrite_file);
+        if (options->write_hook_op != NULL) {
+            write_ctx.pagefile = pagefile;
+            write_ctx.options = options;
+            curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, &write_ctx);
+            curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, fwrite_file_with_hook);
+        } else {
+            curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, pagefile);
+            curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, fwrite_file);
+        }
     } else {
         /* do nothing */
     }
@@ -519,8 +690,9 @@ out:
     close_file(pagefile);
     free_rpath(rpath);
 
-    /* cleanup curl stuff */
-    curl_easy_cleanup(curl_handle);
+    /* keep curl handle for next requests if the request succeeded, connection may be broken otherwise */
+    http_put_handle(host, curl_handle, ret == 0 && curl_result == CURLE_OK);
+    free(host);
     curl_slist_free_all(chunk);
 
     if (redir_url) {
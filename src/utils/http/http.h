@@ -29,6 +29,7 @@ typedef int(*progress_info_func)(void *p,
 typedef int(*xferinfo_func)(void *p,
                             curl_off_t dltotal, curl_off_t dlnow,
                             curl_off_t ultotal, curl_off_t ulnow);
+typedef int(*write_hook_func)(void *p, const void *data, size_t len);
 
 struct http_get_options {
     unsigned with_head : 1, /* if set, means write output with response HEADER */
@@ -84,6 +85,10 @@ struct http_get_options {
 
     void *xferinfo;
     xferinfo_func xferinfo_op;
+
+    /* if set, data written to output file is passed to it too, return nonzero to abort */
+    void *write_hook;
+    write_hook_func write_hook_op;
 };
 
 #define HTTP_RES_OK                 0
@@ -80,6 +80,7 @@
 #define OCI_IMAGE_V1 "application/vnd.oci.image.config.v1+json"
 #define OCI_IMAGE_LAYER_TAR "application/vnd.oci.image.layer.v1.tar"
 #define OCI_IMAGE_LAYER_TAR_GZIP "application/vnd.oci.image.layer.v1.tar+gzip"
+#define OCI_IMAGE_LAYER_TAR_ZSTD "application/vnd.oci.image.layer.v1.tar+zstd"
 #define OCI_IMAGE_LAYER_ND_TAR "application/vnd.oci.image.layer.nondistributable.v1.tar"
 #define OCI_IMAGE_LAYER_ND_TAR_GZIP "application/vnd.oci.image.layer.nondistributable.v1.tar+gzip"
 
@@ -30,6 +30,7 @@
 #include "utils.h"
 #include "utils_file.h"
 #include "utils_string.h"
+#include "utils_inflate.h"
 
 #define BLKSIZE 32768
 
@@ -396,3 +397,223 @@ char *util_without_sha256_prefix(char *digest)
 
     return digest + strlen(SHA256_PREFIX);
 }
+
+struct sha256_stream {
+#if OPENSSL_VERSION_MAJOR >= 3
+    EVP_MD_CTX *ctx;
+    EVP_MD *sha256;
+#else
+    SHA256_CTX ctx;
+#endif
+    bool decompress;
+    // gzip header is checked only when the first UTIL_GZIP_HEADER_LEN bytes are received
+    unsigned char header[UTIL_GZIP_HEADER_LEN];
+    size_t header_len;
+    bool header_checked;
+    util_gzip_inflater *inflater;
+    uint64_t size;
+    bool finished;
+    bool failed;
+};
+
+static int stream_digest_update(sha256_stream *stream, const void *data, size_t len)
+{
+#if OPENSSL_VERSION_MAJOR >= 3
+    if (!EVP_DigestUpdate(stream->ctx, data, len)) {
+        ERROR("Failed to pass the message to be digested");
+        return -1;
+    }
+#else
+    SHA256_Update(&stream->ctx, data, len);
+#endif
+    return 0;
+}
+
+sha256_stream *sha256_stream_new(bool decompress)
+{
+    sha256_stream *stream = NULL;
+
+    stream = util_common_calloc_s(sizeof(sha256_stream));
+    if (stream == NULL) {
+        ERROR("out of memory");
+        return NULL;
+    }
+
+#if OPENSSL_VERSION_MAJOR >= 3
+    stream->ctx = EVP_MD_CTX_new();
+    if (stream->ctx == NULL) {
+        ERROR("Failed to create a context for the digest operation");
+        goto err_out;
+    }
+    stream->sha256 = EVP_MD_fetch(NULL, "SHA256", NULL);
+    if (stream->sha256 == NULL) {
+        ERROR("Failed to fetch the SHA256 algorithm implementation for doing the digest");
+        goto err_out;
+    }
+    if (!EVP_DigestInit_ex(stream->ctx, stream->sha256, NULL)) {
+        ERROR("Failed to initialise the digest operation");
+        goto err_out;
+    }
+#else
+    SHA256_Init(&stream->ctx);
+#endif
+    stream->decompress = decompress;
+
+    return stream;
+
+#if OPENSSL_VERSION_MAJOR >= 3
+err_out:
+    sha256_stream_free(stream);
+    return NULL;
+#endif
+}
+
+static int stream_inflate_cb(const void *data, size_t len, void *context)
+{
+    return stream_digest_update((sha256_stream *)context, data, len);
+}
+
+static int stream_data_update(sha256_stream *stream, const unsigned char *data, size_t len)
+{
+    if (stream->inflater != NULL) {
+        return util_gzip_inflater_update(stream->inflater, data, len);
+    }
+
+    return stream_digest_update(stream, data, len);
+}
+
+static int stream_check_header(sha256_stream *stream, const unsigned char **data, size_t *len)
+{
+    size_t copy_len = 0;
+
+    copy_len = UTIL_GZIP_HEADER_LEN - stream->header_len;
+    if (copy_len > *len) {
+        copy_len = *len;
+    }
+    (void)memcpy(stream->header + stream->header_len, *data, copy_len);
+    stream->header_len += copy_len;
+    *data += copy_len;
+    *len -= copy_len;
+
+    if (stream->header_len < UTIL_GZIP_HEADER_LEN) {
+        return 0;
+    }
+
+    stream->header_checked = true;
+    if (util_is_gzip_header(stream->header, stream->header_len)) {
+        stream->inflater = util_gzip_inflater_new(stream_inflate_cb, stream);
+        if (stream->inflater == NULL) {
+            return -1;
+        }
+    }
+
+    return stream_data_update(stream, stream->header, stream->header_len);
+}
+
+int sha256_stream_update(sha256_stream *stream, const void *data, size_t len)
+{
+    const unsigned char *pos = (const unsigned char *)data;
+    int ret = 0;
+
+    if (stream == NULL || (data == NULL && len != 0)) {
+        ERROR("Invalid NULL param");
+        return -1;
+    }
+
+    if (stream->failed || stream->finished) {
+        ERROR("Update a failed or finished sha256 stream");
+        return -1;
+    }
+
+    stream->size += len;
+
+    if (!stream->decompress) {
+        ret = stream_digest_update(stream, pos, len);
+        goto out;
+    }
+
+    if (!stream->header_checked) {
+        ret = stream_check_header(stream, &pos, &len);
+        if (ret != 0 || !stream->header_checked) {
+            goto out;
+        }
+    }
+
+    ret = stream_data_update(stream, pos, len);
+
+out:
+    if (ret != 0) {
+        stream->failed = true;
+    }
+    return ret;
+}
+
+uint64_t sha256_stream_size(const sha256_stream *stream)
+{
+    if (stream == NULL) {
+        return 0;
+    }
+
+    return stream->size;
+}
+
+char *sha256_stream_full_digest(sha256_stream *stream)
+{
+    unsigned char hash[SHA256_DIGEST_LENGTH] = { 0x00 };
+    char output_buffer[(SHA256_DIGEST_LENGTH * 2) + 1] = { 0x00 };
+#if OPENSSL_VERSION_MAJOR >= 3
+    unsigned int len = 0;
+#endif
+    int i = 0;
+
+    if (stream == NULL) {
+        ERROR("Invalid NULL param");
+        return NULL;
+    }
+
+    if (stream->failed || stream->finished) {
+        ERROR("Get digest from a failed or finished sha256 stream");
+        return NULL;
+    }
+    stream->finished = true;
+
+    // data shorter than gzip header can not be gzip data
+    if (stream->decompress && !stream->header_checked &&
+        stream_digest_update(stream, stream->header, stream->header_len) != 0) {
+        return NULL;
+    }
+
+#if OPENSSL_VERSION_MAJOR >= 3
+    if (!EVP_DigestFinal_ex(stream->ctx, hash, &len)) {
+        ERROR("Failed to calculate the digest itself");
+        return NULL;
+    }
+#else
+    SHA256_Final(hash, &stream->ctx);
+#endif
+
+    for (i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+        int sret = snprintf(output_buffer + (i * 2), 3, "%02x", (unsigned int)hash[i]);
+        if (sret >= 3 || sret < 0) {
+            ERROR("snprintf failed when calc sha256 from stream, result is %d", sret);
+            return NULL;
+        }
+    }
+    output_buffer[SHA256_DIGEST_LENGTH * 2] = '\0';
+
+    return util_full_digest(output_buffer);
+}
+
+void sha256_stream_free(sha256_stream *stream)
+{
+    if (stream == NULL) {
+        return;
+    }
+
+#if OPENSSL_VERSION_MAJOR >= 3
+    EVP_MD_free(stream->sha256);
+    EVP_MD_CTX_free(stream->ctx);
+#endif
+    util_gzip_inflater_free(stream->inflater);
+    free(stream);
+}
@@ -38,6 +38,25 @@ char *sha256_full_digest_str(char *str);
 
 char *util_without_sha256_prefix(char *digest);
 
+typedef struct sha256_stream sha256_stream;
+
+/*
+ * Incremental sha256 context used to digest data while it is being received,
+ * so the data needs not to be read back from disk to verify it. If decompress
+ * is true and the data is gzip compressed, the decompressed data is digested.
+ */
+sha256_stream *sha256_stream_new(bool decompress);
+
+int sha256_stream_update(sha256_stream *stream, const void *data, size_t len);
+
+// number of bytes passed to sha256_stream_update, before decompression
+uint64_t sha256_stream_size(const sha256_stream *stream);
+
+// return full digest like "sha256:xxx", stream can not be updated after that
+char *sha256_stream_full_digest(sha256_stream *stream);
+
+void sha256_stream_free(sha256_stream *stream);
+
 #ifdef __cplusplus
 }
 #endif
@@ -43,6 +43,7 @@
 #include "utils_file.h"
 #include "utils_string.h"
 #include "buffer.h"
+#include "util_decoder.h"
 
 struct archive;
 struct archive_entry;
@@ -584,6 +585,11 @@ out:
     return ret;
 }
 
+static ssize_t pipe_read(void *context, void *buf, size_t len)
+{
+    return util_read_nointr(*(int *)context, buf, len);
+}
+
 static void close_archive_pipes_fd(int *pipes, size_t pipe_size)
 {
     size_t i = 0;
@@ -600,9 +606,12 @@ int archive_unpack(const struct io_read_wrapper *content, const char *dstdir, co
                    char **errmsg)
 {
     int ret = 0;
+    int dret = 0;
     pid_t pid = -1;
     int keepfds[] = { -1, -1, -1 };
     int pipe_stderr[2] = { -1, -1 };
+    int pipe_content[2] = { -1, -1 };
+    struct io_read_wrapper pipe_context = { 0 };
     char errbuf[BUFSIZ + 1] = { 0 };
 
     if (pipe2(pipe_stderr, O_CLOEXEC) != 0) {
@@ -611,15 +620,22 @@ int archive_unpack(const struct io_read_wrapper *content, const char *dstdir, co
         goto cleanup;
     }
 
+    if (pipe2(pipe_content, O_CLOEXEC) != 0) {
+        ERROR("Failed to create pipe");
+        ret = -1;
+        goto cleanup;
+    }
+
     pid = fork();
     if (pid == (pid_t) -1) {
         ERROR("Failed to fork: %s", strerror(errno));
+        ret = -1;
         goto cleanup;
     }
 
     if (pid == (pid_t)0) {
         keepfds[0] = isula_libutils_get_log_fd();
-        keepfds[1] = *(int *)(content->context);
+        keepfds[1] = pipe_content[0];
         keepfds[2] = pipe_stderr[1];
         ret = util_check_inherited_exclude_fds(true, keepfds, 3);
         if (ret != 0) {
@@ -650,7 +666,9 @@ int archive_unpack(const struct io_read_wrapper *content, const char *dstdir, co
             goto child_out;
         }
 
-        ret = archive_unpack_handler(content, options);
+        pipe_context.context = (void *)&pipe_content[0];
+        pipe_context.read = pipe_read;
+        ret = archive_unpack_handler(&pipe_context, options);
 
 child_out:
         if (ret != 0) {
@@ -661,6 +679,14 @@ child_out:
     }
     close(pipe_stderr[1]);
     pipe_stderr[1] = -1;
+    close(pipe_content[0]);
+    pipe_content[0] = -1;
+
+    // decompress here while the child extracts the decoded data, so no thread
+    // is needed in the forked child
+    dret = archive_decode_to_fd(content, pipe_content[1]);
+    close(pipe_content[1]);
+    pipe_content[1] = -1;
 
     ret = util_wait_for_pid(pid);
     if (ret != 0) {
@@ -669,10 +695,15 @@ child_out:
         if (util_read_nointr(pipe_stderr[0], errbuf, BUFSIZ) < 0) {
             ERROR("read error message from child failed");
         }
+    } else if (dret != 0) {
+        ERROR("Failed to decode archive content");
+        (void)snprintf(errbuf, sizeof(errbuf), "Failed to decode archive content");
+        ret = -1;
     }
 
 cleanup:
     close_archive_pipes_fd(pipe_stderr, 2);
+    close_archive_pipes_fd(pipe_content, 2);
     if (errmsg != NULL && strlen(errbuf) != 0) {
         *errmsg = util_strdup_s(errbuf);
     }
@@ -1075,11 +1106,6 @@ cleanup:
     return ret;
 }
 
-static ssize_t pipe_read(void *context, void *buf, size_t len)
-{
-    return util_read_nointr(*(int *)context, buf, len);
-}
-
 static ssize_t archive_context_write(const void *context, const void *buf, size_t len)
 {
     struct archive_context *ctx = (struct archive_context *)context;
@@ -1428,8 +1454,10 @@ static void free_archive_read(struct archive *read_a)
 }
 
 #define READ_BLOCK_SIZE 10240
+// members are read in big blocks, as they are copied out of archive
+#define MEMBER_READ_BLOCK_SIZE (1024 * 1024)
 
-static struct archive *create_archive_read(int fd)
+static struct archive *create_archive_read(int fd, size_t block_size)
 {
     int nret = 0;
     struct archive *ret = NULL;
@@ -1449,7 +1477,7 @@ static struct archive *create_archive_read(int fd)
         ERROR("archive read support format all failed");
         goto err_out;
     }
-    nret = archive_read_open_fd(ret, fd, READ_BLOCK_SIZE);
+    nret = archive_read_open_fd(ret, fd, block_size);
     if (nret != 0) {
         ERROR("archive read open file failed: %s", archive_error_string(ret));
         goto err_out;
@@ -1602,7 +1630,7 @@ static int foreach_archive_entry(archive_entry_cb_t cb, int fd, const char *dist
         return -1;
     }
 
-    read_a = create_archive_read(fd);
+    read_a = create_archive_read(fd, READ_BLOCK_SIZE);
     if (read_a == NULL) {
         goto out;
     }
@@ -1645,4 +1673,78 @@ int archive_copy_oci_tar_split_and_ret_size(int src_fd, const char *dist_file, i
     }
 
     return foreach_archive_entry(archive_entry_parse, src_fd, dist_file, ret_size);
-}
\ No newline at end of file
+}
+
+static ssize_t archive_member_read(void *context, void *buf, size_t len)
+{
+    struct archive *read_a = (struct archive *)context;
+    la_ssize_t nret = 0;
+
+    nret = archive_read_data(read_a, buf, len);
+    if (nret < 0) {
+        ERROR("Failed to read archive member: %s", archive_error_string(read_a));
+        return -1;
+    }
+
+    return (ssize_t)nret;
+}
+
+int archive_foreach_member(int fd, archive_member_cb_t cb, void *context)
+{
+    int ret = -1;
+    int nret = 0;
+    struct archive *read_a = NULL;
+    struct archive_entry *entry = NULL;
+    struct archive_member member = { 0 };
+    struct io_read_wrapper data = { 0 };
+
+    if (fd < 0 || cb == NULL) {
+        ERROR("Invalid arguments");
+        return -1;
+    }
+
+    // archive may be walked more than once
+    if (lseek(fd, 0, SEEK_SET) == -1) {
+        SYSERROR("can not reposition of archive file");
+        return -1;
+    }
+
+    // members skipped are seeked over if the archive is not compressed
+    read_a = create_archive_read(fd, MEMBER_READ_BLOCK_SIZE);
+    if (read_a == NULL) {
+        return -1;
+    }
+
+    data.context = read_a;
+    data.read = archive_member_read;
+
+    for (;;) {
+        nret = archive_read_next_header(read_a, &entry);
+        if (nret == ARCHIVE_EOF) {
+            break;
+        }
+        if (nret != ARCHIVE_OK) {
+            ERROR("archive read header failed: %s", archive_error_string(read_a));
+            goto out;
+        }
+
+        member.name = archive_entry_pathname(entry);
+        if (member.name == NULL) {
+            continue;
+        }
+        member.hardlink = archive_entry_hardlink(entry) != NULL;
+        member.linkname = member.hardlink ? archive_entry_hardlink(entry) : archive_entry_symlink(entry);
+        member.regular = !member.hardlink && archive_entry_filetype(entry) == AE_IFREG;
+        member.size = archive_entry_size(entry);
+
+        if (cb(&member, &data, context) != 0) {
+            goto out;
+        }
+    }
+
+    ret = 0;
+
+out:
+    free_archive_read(read_a);
+    return ret;
+}
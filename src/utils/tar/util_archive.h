@@ -59,6 +59,22 @@ int archive_chroot_untar_stream(const struct io_read_wrapper *content, const cha
 
 int archive_copy_oci_tar_split_and_ret_size(int src_fd, const char *dist_file, int64_t *ret_size);
 
+struct archive_member {
+    const char *name;
+    // target of symbolic or hard link, NULL for other members
+    const char *linkname;
+    bool hardlink;
+    bool regular;
+    int64_t size;
+};
+
+// data reads the content of member, content not read is skipped after the callback returns
+typedef int (*archive_member_cb_t)(const struct archive_member *member, const struct io_read_wrapper *data,
+                                   void *context);
+
+// walk members of archive file fd without extracting it, a callback returns non zero to stop walking
+int archive_foreach_member(int fd, archive_member_cb_t cb, void *context);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,115 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide archive decoder functions
+ ********************************************************************************/
+#include "util_decoder.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "isula_libutils/log.h"
+#include "io_wrapper.h"
+#include "utils.h"
+#include "utils_file.h"
+#include "utils_inflate.h"
+
+#define DECODER_BLKSIZE (64 * 1024)
+
+static int write_decoded(const void *data, size_t len, void *context)
+{
+    int fd = *(int *)context;
+
+    if (util_write_nointr_in_total(fd, (const char *)data, len) != (ssize_t)len) {
+        SYSERROR("Failed to write decoded data");
+        return -1;
+    }
+
+    return 0;
+}
+
+// read until the gzip header can be checked or all content is read
+static ssize_t read_header(const struct io_read_wrapper *content, unsigned char *buf)
+{
+    size_t len = 0;
+    ssize_t n = 0;
+
+    while (len < UTIL_GZIP_HEADER_LEN) {
+        n = content->read(content->context, buf + len, DECODER_BLKSIZE - len);
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        len += (size_t)n;
+    }
+
+    return (ssize_t)len;
+}
+
+int archive_decode_to_fd(const struct io_read_wrapper *content, int fd)
+{
+    unsigned char *buf = NULL;
+    util_gzip_inflater *inflater = NULL;
+    ssize_t n = 0;
+    int ret = -1;
+
+    if (content == NULL || content->read == NULL || fd < 0) {
+        ERROR("Invalid arguments");
+        return -1;
+    }
+
+    buf = util_common_calloc_s(DECODER_BLKSIZE);
+    if (buf == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    n = read_header(content, buf);
+    // data not recognized is written as it is, and still decoded by libarchive
+    if (n > 0 && util_is_gzip_header(buf, (size_t)n)) {
+        inflater = util_gzip_inflater_new(write_decoded, &fd);
+        if (inflater == NULL) {
+            goto out;
+        }
+    }
+
+    while (n > 0) {
+        if (inflater != NULL) {
+            ret = util_gzip_inflater_update(inflater, buf, (size_t)n);
+        } else {
+            ret = write_decoded(buf, (size_t)n, &fd);
+        }
+        if (ret != 0) {
+            goto out;
+        }
+        n = content->read(content->context, buf, DECODER_BLKSIZE);
+    }
+    ret = -1;
+
+    if (n < 0) {
+        ERROR("Failed to read archive content");
+        goto out;
+    }
+
+    if (inflater != NULL && !util_gzip_inflater_ended(inflater)) {
+        ERROR("Unexpected end of gzip data");
+        goto out;
+    }
+
+    ret = 0;
+
+out:
+    util_gzip_inflater_free(inflater);
+    free(buf);
+    return ret;
+}
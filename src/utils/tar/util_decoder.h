@@ -0,0 +1,36 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide archive decoder definition
+ ********************************************************************************/
+#ifndef UTILS_TAR_UTIL_DECODER_H
+#define UTILS_TAR_UTIL_DECODER_H
+
+struct io_read_wrapper;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Read content and write the decoded data to fd. gzip data is inflated, other
+ * data is written as it is. The caller decodes while another process reads the
+ * decoded data from the other end of a pipe, so decoding and extracting run at
+ * the same time. Return 0 if all content is decoded and written to fd.
+ */
+int archive_decode_to_fd(const struct io_read_wrapper *content, int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -72,6 +72,23 @@ TEST(CgroupCpuUnitTest, test_common_find_cgroup_mnt_and_root)
     ASSERT_EQ(common_find_cgroup_mnt_and_root(nullptr, &mnt, &root), -1);
 }
 
+TEST(CgroupCpuUnitTest, test_common_cgroup_get_key_value)
+{
+    const char *content = "usage_usec 1200\nuser_usec 1000\nsystem_usec 200\nnr_periods 0";
+    uint64_t value = 0;
+
+    ASSERT_EQ(common_cgroup_get_key_value(content, "usage_usec", &value), 0);
+    ASSERT_EQ(value, 1200);
+    ASSERT_EQ(common_cgroup_get_key_value(content, "system_usec", &value), 0);
+    ASSERT_EQ(value, 200);
+    ASSERT_EQ(common_cgroup_get_key_value(content, "nr_periods", &value), 0);
+    ASSERT_EQ(value, 0);
+    // only full key matches
+    ASSERT_NE(common_cgroup_get_key_value(content, "usage", &value), 0);
+    ASSERT_NE(common_cgroup_get_key_value(content, "nr_throttled", &value), 0);
+    ASSERT_NE(common_cgroup_get_key_value(nullptr, "usage_usec", &value), 0);
+}
+
 TEST(CgroupCpuUnitTest, test_sysinfo_cgroup_controller_cpurt_mnt_path)
 {
     MOCK_SET(util_common_calloc_s, nullptr);
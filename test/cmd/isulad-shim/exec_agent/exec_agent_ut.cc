@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: exec agent unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "exec_agent.h"
+
+#define WORK_DIR "/tmp/exec_agent_ut"
+#define AGENT_SOCK WORK_DIR "/" EXEC_AGENT_SOCK
+
+namespace {
+int connect_agent()
+{
+    struct sockaddr_un addr = {};
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    (void)strcpy(addr.sun_path, AGENT_SOCK);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// send the request header with the stdio fds, stdout and stderr of the process are written to out
+int send_header(int fd, uint32_t magic, uint32_t timeout, size_t body_len, int out)
+{
+    struct exec_agent_request req = { magic, timeout, (uint32_t)body_len };
+    char control[CMSG_SPACE(sizeof(int) * 3)] = { 0 };
+    struct iovec iov = { &req, sizeof(req) };
+    struct msghdr msg = {};
+    struct cmsghdr *cmsg = nullptr;
+    int stdio[3] = { open("/dev/null", O_RDONLY | O_CLOEXEC), out, out };
+    ssize_t nret = 0;
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(stdio));
+    (void)memcpy(CMSG_DATA(cmsg), stdio, sizeof(stdio));
+
+    nret = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    close(stdio[0]);
+    return nret == (ssize_t)sizeof(req) ? 0 : -1;
+}
+
+int send_body(int fd, const std::string &body)
+{
+    return send(fd, body.data(), body.size(), MSG_NOSIGNAL) == (ssize_t)body.size() ? 0 : -1;
+}
+
+// send the request as isulad does
+int send_request(int fd, uint32_t magic, uint32_t timeout, const std::string &body, int out)
+{
+    if (send_header(fd, magic, timeout, body.size(), out) != 0) {
+        return -1;
+    }
+    return send_body(fd, body);
+}
+
+// read the response in 10 seconds, return the bytes read
+ssize_t recv_response(int fd, struct exec_agent_response *resp)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    size_t total = 0;
+    ssize_t nread = 0;
+
+    while (total < sizeof(*resp)) {
+        if (poll(&pfd, 1, 10 * 1000) <= 0) {
+            break;
+        }
+        nread = read(fd, (char *)resp + total, sizeof(*resp) - total);
+        if (nread <= 0) {
+            break;
+        }
+        total += (size_t)nread;
+    }
+    return (ssize_t)total;
+}
+
+std::string process_json(const std::string &cmd, const std::string &cwd = "/")
+{
+    return "{\"args\":[\"sh\",\"-c\",\"" + cmd + "\"],\"env\":[\"PATH=/usr/bin:/bin\"],\"cwd\":\"" + cwd + "\","
+           "\"user\":{\"uid\":0,\"gid\":0}}";
+}
+
+// run cmd with the agent, return false if no response is received
+bool exec_cmd(const std::string &cmd, uint32_t timeout, struct exec_agent_response *resp, std::string *output,
+              const std::string &cwd = "/")
+{
+    char buf[1024] = { 0 };
+    int pipefd[2] = { -1, -1 };
+    ssize_t nread = 0;
+    bool ok = false;
+    int fd = connect_agent();
+
+    if (fd < 0 || pipe2(pipefd, O_CLOEXEC) != 0) {
+        goto out;
+    }
+    if (send_request(fd, EXEC_AGENT_MAGIC, timeout, process_json(cmd, cwd), pipefd[1]) != 0) {
+        goto out;
+    }
+    close(pipefd[1]);
+    pipefd[1] = -1;
+
+    ok = recv_response(fd, resp) == (ssize_t)sizeof(*resp) && resp->magic == EXEC_AGENT_MAGIC;
+    // the process has exited, all writers of the pipe are closed
+    while (ok && output != nullptr && (nread = read(pipefd[0], buf, sizeof(buf))) > 0) {
+        output->append(buf, (size_t)nread);
+    }
+
+out:
+    if (fd >= 0) {
+        close(fd);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (pipefd[i] >= 0) {
+            close(pipefd[i]);
+        }
+    }
+    return ok;
+}
+
+bool has_seccomp()
+{
+    std::ifstream in("/proc/self/status");
+    std::string line;
+
+    while (std::getline(in, line)) {
+        if (line.compare(0, strlen("Seccomp:"), "Seccomp:") == 0) {
+            return line.find('0') == std::string::npos;
+        }
+    }
+    return false;
+}
+
+// the container process of the agent
+pid_t g_ctr_pid = -1;
+
+// the agent needs root to set the credentials of the process, and can not run with seccomp
+class ExecAgentUnitTest : public testing::Test {
+protected:
+    static void SetUpTestCase()
+    {
+        char cwd[PATH_MAX] = { 0 };
+
+        if (geteuid() != 0 || has_seccomp()) {
+            return;
+        }
+
+        g_ctr_pid = fork();
+        if (g_ctr_pid == 0) {
+            pause();
+            _exit(0);
+        }
+
+        ASSERT_EQ(system("rm -rf " WORK_DIR " && mkdir -p " WORK_DIR " && touch " WORK_DIR "/" EXEC_AGENT_MARKER),
+                  0);
+        ASSERT_NE(getcwd(cwd, sizeof(cwd)), nullptr);
+        // the agent listens in the current directory, as the shim runs in its workdir
+        ASSERT_EQ(chdir(WORK_DIR), 0);
+        ASSERT_EQ(exec_agent_start(g_ctr_pid), 0);
+        ASSERT_EQ(chdir(cwd), 0);
+    }
+
+    static void TearDownTestCase()
+    {
+        if (g_ctr_pid > 0) {
+            kill(g_ctr_pid, SIGKILL);
+            waitpid(g_ctr_pid, nullptr, 0);
+        }
+        (void)system("rm -rf " WORK_DIR);
+    }
+
+    void SetUp() override
+    {
+        if (g_ctr_pid <= 0) {
+            GTEST_SKIP() << "exec agent needs root without seccomp";
+        }
+    }
+};
+} // namespace
+
+TEST_F(ExecAgentUnitTest, test_exec_process)
+{
+    struct exec_agent_response resp = {};
+    std::string output;
+
+    ASSERT_TRUE(exec_cmd("echo hello; echo world >&2; exit 3", 0, &resp, &output));
+    EXPECT_EQ(resp.status, EXEC_AGENT_OK) << resp.message;
+    EXPECT_GT(resp.pid, 0);
+    EXPECT_EQ(resp.exit_code, 3);
+    EXPECT_EQ(output, "hello\nworld\n");
+
+    resp = {};
+    ASSERT_TRUE(exec_cmd("kill -9 $$", 0, &resp, nullptr));
+    EXPECT_EQ(resp.status, EXEC_AGENT_OK) << resp.message;
+    EXPECT_EQ(resp.exit_code, 128 + SIGKILL);
+
+    resp = {};
+    ASSERT_TRUE(exec_cmd("exec /not/exist", 0, &resp, nullptr));
+    EXPECT_EQ(resp.status, EXEC_AGENT_OK) << resp.message;
+    EXPECT_NE(resp.exit_code, 0);
+}
+
+TEST_F(ExecAgentUnitTest, test_inherited_fds_closed)
+{
+    struct exec_agent_response resp = {};
+    std::string output;
+    // not close-on-exec, it is inherited by the children of the agent
+    int fd = open("/dev/null", O_RDONLY);
+
+    ASSERT_GE(fd, 0);
+    // ls opens fd 3 to read the directory
+    ASSERT_TRUE(exec_cmd("ls /proc/self/fd", 0, &resp, &output));
+    close(fd);
+    EXPECT_EQ(resp.status, EXEC_AGENT_OK) << resp.message;
+    EXPECT_EQ(resp.exit_code, 0);
+    EXPECT_EQ(output, "0\n1\n2\n3\n");
+}
+
+TEST_F(ExecAgentUnitTest, test_parent_not_dumpable)
+{
+    struct exec_agent_response resp = {};
+    std::string output;
+
+    // processes of the container can not look into the parent of the process, which is a copy of the shim
+    ASSERT_TRUE(exec_cmd("readlink /proc/$PPID/exe || echo denied", 0, &resp, &output));
+    EXPECT_EQ(resp.status, EXEC_AGENT_OK) << resp.message;
+    EXPECT_EQ(output, "denied\n");
+}
+
+TEST_F(ExecAgentUnitTest, test_concurrent_execs)
+{
+    struct exec_agent_response long_resp = {};
+    struct exec_agent_response resp = {};
+    std::string body = process_json("echo done");
+    std::string output;
+    char buf[64] = { 0 };
+    int pipefd[2] = { -1, -1 };
+    ssize_t nread = 0;
+    bool long_ok = false;
+    time_t start = 0;
+    int fd = connect_agent();
+
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(pipe2(pipefd, O_CLOEXEC), 0);
+    // the agent holds the stdio of this exec while waiting for the body
+    ASSERT_EQ(send_header(fd, EXEC_AGENT_MAGIC, 0, body.size(), pipefd[1]), 0);
+    close(pipefd[1]);
+    usleep(100 * 1000);
+
+    std::thread long_exec([&]() {
+        long_ok = exec_cmd("sleep 30", 6, &long_resp, nullptr);
+    });
+    usleep(300 * 1000);
+
+    // the long running exec must not hold the stdio, the output ends once the process exits
+    start = time(nullptr);
+    ASSERT_EQ(send_body(fd, body), 0);
+    ASSERT_EQ(recv_response(fd, &resp), (ssize_t)sizeof(resp));
+    EXPECT_EQ(resp.status, EXEC_AGENT_OK) << resp.message;
+    while ((nread = read(pipefd[0], buf, sizeof(buf))) > 0) {
+        output.append(buf, (size_t)nread);
+    }
+    EXPECT_EQ(output, "done\n");
+    EXPECT_LT(time(nullptr) - start, 3);
+    close(pipefd[0]);
+    close(fd);
+
+    long_exec.join();
+    ASSERT_TRUE(long_ok);
+    EXPECT_EQ(long_resp.status, EXEC_AGENT_TIMEOUT) << long_resp.message;
+}
+
+TEST_F(ExecAgentUnitTest, test_exec_failed_message)
+{
+    struct exec_agent_response resp = {};
+
+    // the cloned children report the errno number, as they can not use strerror
+    ASSERT_TRUE(exec_cmd("true", 0, &resp, nullptr, "/not/exist"));
+    EXPECT_EQ(resp.status, EXEC_AGENT_ERROR);
+    EXPECT_EQ(std::string(resp.message), "chdir /not/exist: errno " + std::to_string(ENOENT));
+}
+
+TEST_F(ExecAgentUnitTest, test_exec_timeout)
+{
+    struct exec_agent_response resp = {};
+    time_t start = time(nullptr);
+
+    ASSERT_TRUE(exec_cmd("sleep 30", 1, &resp, nullptr));
+    EXPECT_EQ(resp.status, EXEC_AGENT_TIMEOUT) << resp.message;
+    EXPECT_LT(time(nullptr) - start, 10);
+}
+
+TEST_F(ExecAgentUnitTest, test_too_many_connections)
+{
+    std::vector<int> conns;
+    struct exec_agent_response resp = {};
+    bool ok = false;
+    int fd = -1;
+    int i;
+
+    // connections waiting for their requests hold the threads of the agent
+    for (i = 0; i < EXEC_AGENT_MAX_CONNS; i++) {
+        fd = connect_agent();
+        ASSERT_GE(fd, 0);
+        conns.push_back(fd);
+    }
+
+    // more connections are answered at once, isulad runs the process with a new shim
+    fd = connect_agent();
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(recv_response(fd, &resp), (ssize_t)sizeof(resp));
+    EXPECT_EQ(resp.magic, (uint32_t)EXEC_AGENT_MAGIC);
+    EXPECT_EQ(resp.status, EXEC_AGENT_UNSUPPORTED);
+    close(fd);
+
+    for (i = 0; i < EXEC_AGENT_MAX_CONNS; i++) {
+        close(conns[i]);
+    }
+
+    // threads are released when the connections are closed
+    for (i = 0; i < 500 && !ok; i++) {
+        resp = {};
+        ok = exec_cmd("true", 0, &resp, nullptr) && resp.status == EXEC_AGENT_OK;
+        if (!ok) {
+            usleep(10 * 1000);
+        }
+    }
+    EXPECT_TRUE(ok);
+}
+
+TEST_F(ExecAgentUnitTest, test_invalid_request)
+{
+    struct exec_agent_response resp = {};
+    int pipefd[2] = { -1, -1 };
+    int fd = connect_agent();
+
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(pipe2(pipefd, O_CLOEXEC), 0);
+    ASSERT_EQ(send_request(fd, 0, 0, process_json("true"), pipefd[1]), 0);
+    // the connection is closed without a response
+    EXPECT_EQ(recv_response(fd, &resp), 0);
+    close(fd);
+    close(pipefd[0]);
+    close(pipefd[1]);
+}
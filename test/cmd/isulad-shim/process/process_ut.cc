@@ -19,10 +19,14 @@
 #include <unistd.h>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <fstream>
+#include <regex>
+#include <isula_libutils/logger_json_file.h>
 
 #include "mainloop.h"
 #include "process.h"
 #include "common.h"
+#include "terminal.h"
 
 
 using ::testing::Args;
@@ -46,4 +50,100 @@ TEST(process, test_new_process)
 
     process_t *p = new_process((char*)id.c_str(), (char*)bundle.c_str(), (char*)runtime.c_str());
     ASSERT_TRUE(p == nullptr);
-}
\ No newline at end of file
+}
+static std::vector<std::string> read_log_lines(const std::string &path)
+{
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    std::string line;
+
+    while (std::getline(in, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+static std::string parse_log_line(const std::string &line, std::string &stream)
+{
+    std::string log;
+    parser_error err = nullptr;
+    struct parser_context ctx = { OPT_GEN_SIMPLIFY | OPT_GEN_NO_VALIDATE_UTF8, stderr };
+    logger_json_file *entry = logger_json_file_parse_data(line.c_str(), &ctx, &err);
+
+    free(err);
+    if (entry == nullptr) {
+        return "";
+    }
+    log = std::string((char *)entry->log, entry->log_len);
+    stream = entry->stream;
+    free_logger_json_file(entry);
+    return log;
+}
+
+TEST(process, test_shim_write_container_log_file)
+{
+    std::string dir = "/tmp/shim_log_ut";
+    std::string log_path = dir + "/console.log";
+    std::string stream;
+    log_terminal terminal = {};
+
+    ASSERT_EQ(system(("rm -rf " + dir + " && mkdir -p " + dir).c_str()), 0);
+    terminal.log_path = (char *)log_path.c_str();
+    terminal.log_maxfile = 2;
+    terminal.log_maxsize = 4096;
+    ASSERT_EQ(pthread_rwlock_init(&terminal.log_terminal_rwlock, nullptr), 0);
+    ASSERT_EQ(shim_create_container_log_file(&terminal), SHIM_OK);
+
+    std::string out = "hello \"world\" \\ /\x01\ttab\n";
+    shim_write_container_log_file(&terminal, STDID_OUT, (char *)out.c_str(), out.length());
+    std::string err = "error line\n";
+    shim_write_container_log_file(&terminal, STDID_ERR, (char *)err.c_str(), err.length());
+    // records are buffered until flushed
+    ASSERT_TRUE(read_log_lines(log_path).empty());
+    shim_flush_container_log_file(&terminal);
+
+    std::vector<std::string> lines = read_log_lines(log_path);
+    ASSERT_EQ(lines.size(), 2U);
+    // same bytes as the json generator of log records
+    std::string head = "{\"log\":\"hello \\\"world\\\" \\\\ /\\u0001\\ttab\\n\",\"stream\":\"stdout\",\"time\":\"";
+    ASSERT_EQ(lines[0].compare(0, head.length(), head), 0);
+    ASSERT_TRUE(std::regex_match(lines[0].substr(head.length()),
+                                 std::regex("[0-9]{4}-[0-9]{2}-[0-9]{2}T[0-9]{2}:[0-9]{2}:[0-9]{2}\\.[0-9]{9}Z\"\\}")));
+    head = "{\"log\":\"error line\\n\",\"stream\":\"stderr\",\"time\":\"";
+    ASSERT_EQ(lines[1].compare(0, head.length(), head), 0);
+    ASSERT_EQ(parse_log_line(lines[0], stream), out);
+    ASSERT_EQ(stream, "stdout");
+    ASSERT_EQ(parse_log_line(lines[1], stream), err);
+    ASSERT_EQ(stream, "stderr");
+
+    // rotate when the next record does not fit in log file
+    std::string line(100, 'a');
+    line += "\n";
+    for (int i = 0; i < 100; i++) {
+        shim_write_container_log_file(&terminal, STDID_OUT, (char *)line.c_str(), line.length());
+    }
+    shim_flush_container_log_file(&terminal);
+
+    struct stat st = { 0 };
+    ASSERT_EQ(stat((log_path + ".1").c_str(), &st), 0);
+    ASSERT_LE(st.st_size, 4096);
+    ASSERT_EQ(stat(log_path.c_str(), &st), 0);
+    ASSERT_LE(st.st_size, 4096);
+    ASSERT_EQ(st.st_size, terminal.log_size);
+    for (const auto &l : read_log_lines(log_path)) {
+        ASSERT_EQ(parse_log_line(l, stream), line);
+    }
+
+    // left records are written when the log file is closed
+    shim_write_container_log_file(&terminal, STDID_ERR, (char *)err.c_str(), err.length());
+    shim_close_container_log_file(&terminal);
+    ASSERT_EQ(terminal.batch, nullptr);
+    lines = read_log_lines(log_path);
+    ASSERT_FALSE(lines.empty());
+    ASSERT_EQ(parse_log_line(lines.back(), stream), err);
+    ASSERT_EQ(stream, "stderr");
+
+    close(terminal.fd);
+    pthread_rwlock_destroy(&terminal.log_terminal_rwlock);
+    ASSERT_EQ(system(("rm -rf " + dir).c_str()), 0);
+}
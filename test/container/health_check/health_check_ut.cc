@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: health check scheduler unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+#include <gtest/gtest.h>
+#include "health_check.h"
+#include "container_api.h"
+#include "container_state.h"
+#include "service_container_api.h"
+#include "utils.h"
+#include "utils_timestamp.h"
+
+#define MANY_CONTAINERS 32
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+// container id -> fake container
+static std::map<std::string, container_t *> g_containers;
+// container id -> probe count
+static std::map<std::string, int> g_probes;
+
+extern "C" {
+container_t *containers_store_get(const char *id_or_name)
+{
+    container_t *cont = nullptr;
+
+    pthread_mutex_lock(&g_lock);
+    auto it = g_containers.find(id_or_name);
+    if (it != g_containers.end()) {
+        cont = it->second;
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    return cont;
+}
+
+void container_unref(container_t *cont)
+{
+    (void)cont;
+}
+
+void container_state_lock(container_state_t *state)
+{
+    pthread_mutex_lock(&state->mutex);
+}
+
+void container_state_unlock(container_state_t *state)
+{
+    pthread_mutex_unlock(&state->mutex);
+}
+
+int container_state_to_disk(const container_t *cont)
+{
+    (void)cont;
+    return 0;
+}
+
+bool container_is_running(container_state_t *s)
+{
+    (void)s;
+    return true;
+}
+
+bool container_is_paused(container_state_t *s)
+{
+    (void)s;
+    return false;
+}
+
+bool container_is_restarting(container_state_t *s)
+{
+    (void)s;
+    return false;
+}
+
+int stop_container(container_t *cont, int timeout, bool force, bool restart)
+{
+    (void)cont;
+    (void)timeout;
+    (void)force;
+    (void)restart;
+    return 0;
+}
+
+int exec_container(const container_t *cont, const container_exec_request *request, container_exec_response *response,
+                   int stdinfd, struct io_write_wrapper *stdout_handler, struct io_write_wrapper *stderr_handler)
+{
+    (void)request;
+    (void)stdinfd;
+    (void)stdout_handler;
+    (void)stderr_handler;
+
+    pthread_mutex_lock(&g_lock);
+    g_probes[cont->common_config->id]++;
+    pthread_mutex_unlock(&g_lock);
+
+    response->exit_code = 0;
+    return 0;
+}
+}
+
+static container_t *new_container(const std::string &id, const char *probe, int64_t interval)
+{
+    container_t *cont = (container_t *)util_common_calloc_s(sizeof(container_t));
+    container_config *config = (container_config *)util_common_calloc_s(sizeof(container_config));
+    defs_health_check *healthcheck = (defs_health_check *)util_common_calloc_s(sizeof(defs_health_check));
+
+    healthcheck->test = (char **)util_common_calloc_s(2 * sizeof(char *));
+    healthcheck->test[0] = util_strdup_s(probe);
+    healthcheck->test[1] = util_strdup_s("true");
+    healthcheck->test_len = 2;
+    healthcheck->interval = interval;
+    config->healthcheck = healthcheck;
+
+    cont->common_config = (container_config_v2_common_config *)util_common_calloc_s(
+                              sizeof(container_config_v2_common_config));
+    cont->common_config->id = util_strdup_s(id.c_str());
+    cont->common_config->config = config;
+    cont->state = (container_state_t *)util_common_calloc_s(sizeof(container_state_t));
+    pthread_mutex_init(&cont->state->mutex, nullptr);
+    cont->state->state = (container_state *)util_common_calloc_s(sizeof(container_state));
+
+    pthread_mutex_lock(&g_lock);
+    g_containers[id] = cont;
+    g_probes[id] = 0;
+    pthread_mutex_unlock(&g_lock);
+
+    return cont;
+}
+
+static void free_container(container_t *cont)
+{
+    pthread_mutex_lock(&g_lock);
+    g_containers.erase(cont->common_config->id);
+    pthread_mutex_unlock(&g_lock);
+
+    health_check_manager_free(cont->health_check);
+    free_container_config_v2_common_config(cont->common_config);
+    free_container_state(cont->state->state);
+    pthread_mutex_destroy(&cont->state->mutex);
+    free(cont->state);
+    free(cont);
+}
+
+static int probes(const container_t *cont)
+{
+    int n = 0;
+
+    pthread_mutex_lock(&g_lock);
+    n = g_probes[cont->common_config->id];
+    pthread_mutex_unlock(&g_lock);
+
+    return n;
+}
+
+static bool wait_probes(const container_t *cont, int count, int timeout_seconds)
+{
+    int i;
+
+    for (i = 0; i < timeout_seconds * 100; i++) {
+        if (probes(cont) >= count) {
+            return true;
+        }
+        usleep(10 * 1000);
+    }
+
+    return false;
+}
+
+static std::string health_status(container_t *cont)
+{
+    std::string status;
+
+    container_state_lock(cont->state);
+    if (cont->state->state->health != nullptr && cont->state->state->health->status != nullptr) {
+        status = cont->state->state->health->status;
+    }
+    container_state_unlock(cont->state);
+
+    return status;
+}
+
+static int64_t now_millis()
+{
+    struct timespec ts = { 0 };
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+TEST(health_check_ut, test_probe_repeat_and_stop)
+{
+    container_t *cont = new_container("repeat", "CMD", 20 * Time_Milli);
+    int count = 0;
+
+    container_init_health_monitor("repeat");
+    ASSERT_NE(cont->health_check, nullptr);
+    ASSERT_TRUE(wait_probes(cont, 3, 5));
+    EXPECT_EQ(health_status(cont), HEALTHY);
+
+    container_stop_health_checks(cont);
+    // the monitor has exited when stop returns
+    count = probes(cont);
+    usleep(100 * 1000);
+    EXPECT_EQ(probes(cont), count);
+    EXPECT_EQ(health_status(cont), UNHEALTHY);
+
+    free_container(cont);
+}
+
+TEST(health_check_ut, test_stop_wakeup_waiting_monitor)
+{
+    container_t *cont = new_container("wakeup", "CMD", 3600 * Time_Second);
+    int64_t start = 0;
+
+    container_init_health_monitor("wakeup");
+    ASSERT_NE(cont->health_check, nullptr);
+
+    // the first probe is an hour later, stop must not wait for it
+    start = now_millis();
+    container_stop_health_checks(cont);
+    EXPECT_LT(now_millis() - start, 1000);
+    EXPECT_EQ(probes(cont), 0);
+    EXPECT_EQ(health_status(cont), UNHEALTHY);
+
+    // the monitor is restarted after stopped
+    cont->common_config->config->healthcheck->interval = 20 * Time_Milli;
+    container_init_health_monitor("wakeup");
+    ASSERT_TRUE(wait_probes(cont, 1, 5));
+    container_stop_health_checks(cont);
+
+    free_container(cont);
+}
+
+TEST(health_check_ut, test_many_containers)
+{
+    container_t *conts[MANY_CONTAINERS] = { 0 };
+    health_check_stats_t before = { 0 };
+    health_check_stats_t after = { 0 };
+    int i;
+
+    container_get_health_check_stats(&before);
+
+    for (i = 0; i < MANY_CONTAINERS; i++) {
+        std::string id = "many" + std::to_string(i);
+        conts[i] = new_container(id, "CMD-SHELL", 20 * Time_Milli);
+        container_init_health_monitor(id.c_str());
+    }
+
+    // a few probe workers serve all the containers
+    for (i = 0; i < MANY_CONTAINERS; i++) {
+        EXPECT_TRUE(wait_probes(conts[i], 2, 10));
+    }
+
+    for (i = 0; i < MANY_CONTAINERS; i++) {
+        container_stop_health_checks(conts[i]);
+    }
+
+    container_get_health_check_stats(&after);
+    EXPECT_GE(after.probes - before.probes, (uint64_t)(2 * MANY_CONTAINERS));
+
+    for (i = 0; i < MANY_CONTAINERS; i++) {
+        free_container(conts[i]);
+    }
+}
+
+TEST(health_check_ut, test_stop_without_monitor)
+{
+    container_t *cont = new_container("none", "NONE", 20 * Time_Milli);
+
+    container_init_health_monitor("none");
+    ASSERT_NE(cont->health_check, nullptr);
+
+    // no monitor is started for NONE probe, stop returns at once
+    container_stop_health_checks(cont);
+    usleep(100 * 1000);
+    EXPECT_EQ(probes(cont), 0);
+
+    container_stop_health_checks(nullptr);
+
+    free_container(cont);
+}
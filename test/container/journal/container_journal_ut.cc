@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: container journal unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <gtest/gtest.h>
+#include "container_journal.h"
+
+#define ROOT_DIR "/tmp/container_journal_ut"
+#define JOURNAL ROOT_DIR "/containers.journal"
+#define JOURNAL_OLD ROOT_DIR "/containers.journal.old"
+#define CONT_A ROOT_DIR "/a"
+#define CONT_B ROOT_DIR "/b"
+#define FILE_A CONT_A "/config.v2.json"
+#define FILE_B CONT_B "/config.v2.json"
+
+// the journal is initialized once in a process, so each case runs in a child process
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "check failed at line %d: %s\n", __LINE__, #cond); \
+            exit(1);                                                             \
+        }                                                                        \
+    } while (0)
+
+namespace {
+// same layout as the records written by container_journal.c
+struct record_header {
+    uint32_t magic;
+    uint32_t type;
+    uint32_t path_len;
+    uint32_t data_len;
+    uint32_t checksum;
+};
+
+const uint32_t RECORD_MAGIC = 0x6a726e6cU;
+const uint32_t RECORD_WRITE = 1;
+const uint32_t RECORD_FORGET = 2;
+
+std::string make_record(uint32_t type, const std::string &path, const std::string &data)
+{
+    struct record_header header = { RECORD_MAGIC, type, (uint32_t)path.size(), (uint32_t)data.size(), 2166136261U };
+    std::string payload = path + data;
+
+    for (size_t i = 0; i < payload.size(); i++) {
+        header.checksum = (header.checksum ^ (uint8_t)payload[i]) * 16777619U;
+    }
+    return std::string((const char *)&header, sizeof(header)) + payload;
+}
+
+void write_file(const std::string &path, const std::string &content)
+{
+    std::ofstream out(path, std::ios::trunc | std::ios::binary);
+
+    out << content;
+}
+
+std::string read_file(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+bool file_exists(const std::string &path)
+{
+    struct stat st;
+
+    return stat(path.c_str(), &st) == 0;
+}
+
+off_t file_size(const std::string &path)
+{
+    struct stat st;
+
+    return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+bool wait_content(const std::string &path, const std::string &content, int timeout_seconds)
+{
+    for (int i = 0; i < timeout_seconds * 100; i++) {
+        if (read_file(path) == content) {
+            return true;
+        }
+        usleep(10 * 1000);
+    }
+    return false;
+}
+
+void init_journal()
+{
+    CHECK(container_journal_init(ROOT_DIR) == 0);
+    CHECK(container_journal_enabled());
+}
+
+void check_replay()
+{
+    init_journal();
+    CHECK(read_file(FILE_A) == "a2");
+    CHECK(read_file(FILE_B) == "b1");
+    // replayed records are written to config files, a new empty journal is started
+    CHECK(file_size(JOURNAL) == 0);
+    CHECK(!file_exists(JOURNAL_OLD));
+    exit(0);
+}
+
+void check_torn_tail()
+{
+    init_journal();
+    CHECK(read_file(FILE_A) == "a1");
+    CHECK(read_file(FILE_B) == "origin");
+    exit(0);
+}
+
+void check_forget_replay()
+{
+    init_journal();
+    // records of a before the forget record are dropped, records after it are kept
+    CHECK(read_file(FILE_A) == "origin");
+    CHECK(read_file(FILE_B) == "b2");
+    exit(0);
+}
+
+void check_compaction()
+{
+    std::string big(5 * 1024 * 1024, 'x');
+
+    init_journal();
+    CHECK(container_journal_write(FILE_A, "a1", 2) == 0);
+    // config files are written by compaction, not by each write
+    CHECK(read_file(FILE_A) == "origin");
+
+    CHECK(container_journal_write(FILE_A, "a2", 2) == 0);
+    // the journal grows past the compaction size
+    CHECK(container_journal_write(FILE_B, big.c_str(), big.size()) == 0);
+    CHECK(wait_content(FILE_B, big, 10));
+    CHECK(read_file(FILE_A) == "a2");
+    CHECK(file_size(JOURNAL) < (off_t)big.size());
+    CHECK(!file_exists(JOURNAL_OLD));
+    exit(0);
+}
+
+void check_forget_runtime()
+{
+    std::string big(5 * 1024 * 1024, 'x');
+
+    init_journal();
+    CHECK(container_journal_write(FILE_A, "a1", 2) == 0);
+    container_journal_forget(ROOT_DIR, "a");
+    CHECK(system("rm -rf " CONT_A) == 0);
+
+    // compaction does not recreate files of the removed container
+    CHECK(container_journal_write(FILE_B, big.c_str(), big.size()) == 0);
+    CHECK(wait_content(FILE_B, big, 10));
+    CHECK(!file_exists(CONT_A));
+    exit(0);
+}
+
+// write a directly after the journal failed to append, then exit as if the daemon crashed
+void write_after_append_failed()
+{
+    struct rlimit limit = { 0 };
+    std::string padding(1000, 'p');
+    std::string content(300, 'n');
+
+    init_journal();
+    CHECK(container_journal_write(FILE_A, "a1", 2) == 0);
+    CHECK(container_journal_write(FILE_B, padding.c_str(), padding.size()) == 0);
+
+    // the write record of a does not fit in the journal, but the tombstone of it does
+    (void)signal(SIGXFSZ, SIG_IGN);
+    limit.rlim_cur = (rlim_t)file_size(JOURNAL) + sizeof(struct record_header) + strlen(FILE_A) + 8;
+    limit.rlim_max = RLIM_INFINITY;
+    CHECK(setrlimit(RLIMIT_FSIZE, &limit) == 0);
+    CHECK(container_journal_write(FILE_A, content.c_str(), content.size()) == 0);
+    CHECK(read_file(FILE_A) == content);
+    _exit(0);
+}
+
+void check_no_stale_replay()
+{
+    init_journal();
+    // the stale record of a is dropped by the tombstone appended after the direct write
+    CHECK(read_file(FILE_A) == std::string(300, 'n'));
+    CHECK(read_file(FILE_B) == std::string(1000, 'p'));
+    exit(0);
+}
+
+class ContainerJournalUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(system("rm -rf " ROOT_DIR " && mkdir -p " CONT_A " " CONT_B), 0);
+        write_file(FILE_A, "origin");
+        write_file(FILE_B, "origin");
+    }
+
+    void TearDown() override
+    {
+        ASSERT_EQ(system("rm -rf " ROOT_DIR), 0);
+    }
+};
+} // namespace
+
+TEST_F(ContainerJournalUnitTest, test_replay)
+{
+    // a crash during compaction leaves the old journal, it is replayed before the current one
+    write_file(JOURNAL_OLD, make_record(RECORD_WRITE, FILE_A, "a1") + make_record(RECORD_WRITE, FILE_B, "b1"));
+    write_file(JOURNAL, make_record(RECORD_WRITE, FILE_A, "a2"));
+
+    EXPECT_EXIT(check_replay(), testing::ExitedWithCode(0), "");
+}
+
+TEST_F(ContainerJournalUnitTest, test_torn_tail)
+{
+    std::string torn = make_record(RECORD_WRITE, FILE_B, "b1");
+    std::string bad = make_record(RECORD_WRITE, FILE_B, "b2");
+
+    // records after the torn or corrupted one are ignored
+    bad[bad.size() - 1] = 'x';
+    write_file(JOURNAL, make_record(RECORD_WRITE, FILE_A, "a1") + torn.substr(0, torn.size() - 1));
+    EXPECT_EXIT(check_torn_tail(), testing::ExitedWithCode(0), "");
+
+    write_file(FILE_A, "origin");
+    write_file(JOURNAL, make_record(RECORD_WRITE, FILE_A, "a1") + bad + make_record(RECORD_WRITE, FILE_B, "b3"));
+    EXPECT_EXIT(check_torn_tail(), testing::ExitedWithCode(0), "");
+}
+
+TEST_F(ContainerJournalUnitTest, test_forget_replay)
+{
+    write_file(JOURNAL, make_record(RECORD_WRITE, FILE_A, "a1") + make_record(RECORD_WRITE, FILE_B, "b1") +
+                            make_record(RECORD_FORGET, CONT_A "/", "") + make_record(RECORD_WRITE, FILE_B, "b2"));
+
+    EXPECT_EXIT(check_forget_replay(), testing::ExitedWithCode(0), "");
+}
+
+TEST_F(ContainerJournalUnitTest, test_compaction)
+{
+    EXPECT_EXIT(check_compaction(), testing::ExitedWithCode(0), "");
+}
+
+TEST_F(ContainerJournalUnitTest, test_forget_runtime)
+{
+    EXPECT_EXIT(check_forget_runtime(), testing::ExitedWithCode(0), "");
+}
+
+TEST_F(ContainerJournalUnitTest, test_append_failed)
+{
+    EXPECT_EXIT(write_after_append_failed(), testing::ExitedWithCode(0), "");
+    EXPECT_EXIT(check_no_stale_replay(), testing::ExitedWithCode(0), "");
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: supervisor unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <gtest/gtest.h>
+#include "supervisor.h"
+#include "container_api.h"
+#include "containers_gc.h"
+#include "events_sender_api.h"
+#include "service_container_api.h"
+
+#define CLEAN_JOBS 16
+#define CLEAN_DELAY_US (200 * 1000)
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static int g_running;
+static int g_max_running;
+static int g_cleaned;
+static int g_stopped_events;
+
+extern "C" {
+// cleaning resources mostly waits for the runtime processes, simulate it with a sleep
+int clean_container_resource(const char *id, const char *runtime, pid_t pid)
+{
+    (void)id;
+    (void)runtime;
+    (void)pid;
+
+    pthread_mutex_lock(&g_lock);
+    g_running++;
+    if (g_running > g_max_running) {
+        g_max_running = g_running;
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    usleep(CLEAN_DELAY_US);
+
+    pthread_mutex_lock(&g_lock);
+    g_running--;
+    g_cleaned++;
+    pthread_mutex_unlock(&g_lock);
+
+    return 0;
+}
+
+int gc_add_container(const char *id, const char *runtime, const pid_ppid_info_t *pid_info)
+{
+    (void)id;
+    (void)runtime;
+    (void)pid_info;
+    return 0;
+}
+
+int isulad_monitor_send_container_event(const char *name, runtime_state_t state, int pid, int exit_code,
+                                        const char *args, const char *extra_annations)
+{
+    (void)name;
+    (void)pid;
+    (void)exit_code;
+    (void)args;
+    (void)extra_annations;
+
+    pthread_mutex_lock(&g_lock);
+    if (state == STOPPED) {
+        g_stopped_events++;
+    }
+    pthread_cond_broadcast(&g_cond);
+    pthread_mutex_unlock(&g_lock);
+
+    return 0;
+}
+}
+
+// pid of a process which is already reaped
+static pid_t exited_pid()
+{
+    pid_t pid = fork();
+
+    if (pid == 0) {
+        _exit(0);
+    }
+    if (pid > 0) {
+        (void)waitpid(pid, nullptr, 0);
+    }
+
+    return pid;
+}
+
+static bool wait_stopped_events(int count, int timeout_seconds)
+{
+    struct timespec deadline = { 0 };
+    bool done = false;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_seconds;
+
+    pthread_mutex_lock(&g_lock);
+    while (g_stopped_events < count) {
+        if (pthread_cond_timedwait(&g_cond, &g_lock, &deadline) != 0) {
+            break;
+        }
+    }
+    done = (g_stopped_events >= count);
+    pthread_mutex_unlock(&g_lock);
+
+    return done;
+}
+
+TEST(supervisor_ut, test_clean_resources_workers_grow)
+{
+    pid_ppid_info_t pid_info = { 0 };
+    int exit_code = 0;
+    int i;
+
+    ASSERT_EQ(new_supervisor(), 0);
+
+    pid_info.pid = exited_pid();
+    ASSERT_GT(pid_info.pid, 0);
+
+    for (i = 0; i < CLEAN_JOBS; i++) {
+        int fds[2] = { -1, -1 };
+        std::string name = "container" + std::to_string(i);
+
+        ASSERT_EQ(pipe2(fds, O_CLOEXEC), 0);
+        ASSERT_EQ(container_supervisor_add_exit_monitor(fds[0], &pid_info, name.c_str(), "runc"), 0);
+        ASSERT_EQ(write(fds[1], &exit_code, sizeof(exit_code)), (ssize_t)sizeof(exit_code));
+        close(fds[1]);
+    }
+
+    // a fixed pool of a few workers would need CLEAN_JOBS / workers rounds of CLEAN_DELAY_US
+    ASSERT_TRUE(wait_stopped_events(CLEAN_JOBS, 10));
+
+    pthread_mutex_lock(&g_lock);
+    EXPECT_EQ(g_cleaned, CLEAN_JOBS);
+    EXPECT_GT(g_max_running, CLEAN_JOBS / 2);
+    pthread_mutex_unlock(&g_lock);
+}
+
+TEST(supervisor_ut, test_add_exit_monitor_invalid)
+{
+    pid_ppid_info_t pid_info = { 0 };
+    int fds[2] = { -1, -1 };
+
+    ASSERT_NE(container_supervisor_add_exit_monitor(-1, &pid_info, "name", "runc"), 0);
+
+    ASSERT_EQ(pipe2(fds, O_CLOEXEC), 0);
+    // fd is closed on failure
+    ASSERT_NE(container_supervisor_add_exit_monitor(fds[0], nullptr, "name", "runc"), 0);
+    ASSERT_EQ(fcntl(fds[0], F_GETFD), -1);
+    close(fds[1]);
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: archive decoder unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include "util_decoder.h"
+#include "io_wrapper.h"
+
+namespace {
+struct memory_reader {
+    std::string data;
+    size_t pos;
+    // max bytes returned by one read
+    size_t chunk;
+};
+
+ssize_t memory_read(void *context, void *buf, size_t len)
+{
+    struct memory_reader *reader = (struct memory_reader *)context;
+    size_t n = reader->data.size() - reader->pos;
+
+    if (n > len) {
+        n = len;
+    }
+    if (n > reader->chunk) {
+        n = reader->chunk;
+    }
+    (void)memcpy(buf, reader->data.data() + reader->pos, n);
+    reader->pos += n;
+
+    return (ssize_t)n;
+}
+
+ssize_t failed_read(void *context, void *buf, size_t len)
+{
+    (void)context;
+    (void)buf;
+    (void)len;
+    return -1;
+}
+
+std::string make_data(size_t len)
+{
+    std::string data;
+
+    for (size_t i = 0; i < len; i++) {
+        data.push_back((char)(i * 31 + i / 7));
+    }
+
+    return data;
+}
+
+std::string gzip_data(const std::string &data)
+{
+    z_stream zs = {};
+    std::string out;
+    char buf[4096];
+    int zret = Z_OK;
+
+    // 16 + MAX_WBITS means write gzip format
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return out;
+    }
+    zs.next_in = (Bytef *)data.data();
+    zs.avail_in = (uInt)data.size();
+    do {
+        zs.next_out = (Bytef *)buf;
+        zs.avail_out = sizeof(buf);
+        zret = deflate(&zs, Z_FINISH);
+        out.append(buf, sizeof(buf) - zs.avail_out);
+    } while (zret == Z_OK);
+    (void)deflateEnd(&zs);
+
+    return out;
+}
+
+// decode data read in chunks of chunk bytes, return the decoded data in out
+int decode(const std::string &data, size_t chunk, std::string &out)
+{
+    struct memory_reader reader = { data, 0, chunk };
+    struct io_read_wrapper content = { 0 };
+    char tmpl[] = "/tmp/utils_decoder_ut_XXXXXX";
+    char buf[4096];
+    ssize_t n = 0;
+    int fd = -1;
+    int ret = 0;
+
+    fd = mkstemp(tmpl);
+    if (fd < 0) {
+        return -2;
+    }
+    (void)unlink(tmpl);
+
+    content.context = &reader;
+    content.read = memory_read;
+    ret = archive_decode_to_fd(&content, fd);
+
+    out.clear();
+    (void)lseek(fd, 0, SEEK_SET);
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        out.append(buf, (size_t)n);
+    }
+    close(fd);
+
+    return ret;
+}
+} // namespace
+
+TEST(utils_decoder, test_decode_gzip)
+{
+    std::string data = make_data(1000000);
+    std::string out;
+
+    ASSERT_EQ(decode(gzip_data(data), 1 << 20, out), 0);
+    ASSERT_EQ(out, data);
+
+    // gzip header split across reads
+    ASSERT_EQ(decode(gzip_data(data), 1, out), 0);
+    ASSERT_EQ(out, data);
+}
+
+TEST(utils_decoder, test_decode_concatenated_members)
+{
+    std::string first = make_data(70000);
+    std::string second = make_data(123);
+
+    std::string out;
+    ASSERT_EQ(decode(gzip_data(first) + gzip_data(second), 4096, out), 0);
+    ASSERT_EQ(out, first + second);
+}
+
+TEST(utils_decoder, test_decode_trailing_garbage)
+{
+    std::string data = make_data(70000);
+    std::string out;
+
+    // anything after the last member is ignored, just as gzread does
+    ASSERT_EQ(decode(gzip_data(data) + std::string(1024, '\0'), 4096, out), 0);
+    ASSERT_EQ(out, data);
+    ASSERT_EQ(decode(gzip_data(data) + "garbage", 4096, out), 0);
+    ASSERT_EQ(out, data);
+}
+
+TEST(utils_decoder, test_decode_corrupt_gzip)
+{
+    std::string data = make_data(70000);
+    std::string gz = gzip_data(data);
+    std::string out;
+
+    // truncated stream
+    ASSERT_NE(decode(gz.substr(0, gz.size() - 10), 4096, out), 0);
+
+    // the crc32 in the trailer does not match
+    std::string bad_crc = gz;
+    bad_crc[bad_crc.size() - 8] = (char)(bad_crc[bad_crc.size() - 8] ^ 0xFF);
+    ASSERT_NE(decode(bad_crc, 4096, out), 0);
+
+    // truncated second member
+    std::string second = gzip_data(make_data(100));
+    ASSERT_NE(decode(gz + second.substr(0, second.size() / 2), 4096, out), 0);
+}
+
+TEST(utils_decoder, test_decode_passthrough)
+{
+    std::string data = make_data(100000);
+    std::string out;
+
+    // not gzip data, libarchive decodes it later
+    data[0] = 'x';
+    ASSERT_EQ(decode(data, 1000, out), 0);
+    ASSERT_EQ(out, data);
+
+    // shorter than gzip header
+    ASSERT_EQ(decode(std::string("\x1f\x8b", 2), 1, out), 0);
+    ASSERT_EQ(out, std::string("\x1f\x8b", 2));
+
+    ASSERT_EQ(decode(std::string(), 1, out), 0);
+    ASSERT_TRUE(out.empty());
+}
+
+TEST(utils_decoder, test_decode_invalid)
+{
+    struct io_read_wrapper content = { 0 };
+    int fds[2] = { -1, -1 };
+
+    ASSERT_NE(archive_decode_to_fd(nullptr, 1), 0);
+    ASSERT_NE(archive_decode_to_fd(&content, 1), 0);
+
+    content.read = failed_read;
+    ASSERT_NE(archive_decode_to_fd(&content, -1), 0);
+
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_NE(archive_decode_to_fd(&content, fds[1]), 0);
+    close(fds[0]);
+    close(fds[1]);
+}
@@ -13,6 +13,10 @@
  * Description: utils namespace unit test
  *******************************************************************************/
 
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mount.h>
 #include <gtest/gtest.h>
 #include "utils_fs.h"
 
@@ -40,3 +44,39 @@ TEST(utils_fs, test_util_deal_with_mount_info)
     ASSERT_EQ(util_deal_with_mount_info(good_check_cb, spattern.c_str()), true);
     ASSERT_EQ(util_deal_with_mount_info(good_check_cb, nullptr), false);
 }
+
+TEST(utils_fs, test_util_detect_mounted)
+{
+    char tmpdir[] = "/tmp/utils_fs_ut.XXXXXX";
+    char *optional = nullptr;
+
+    ASSERT_TRUE(util_detect_mounted("/proc"));
+    ASSERT_FALSE(util_detect_mounted("/proc/not-exist-mountpoint"));
+    ASSERT_FALSE(util_detect_mounted(nullptr));
+    ASSERT_TRUE(util_find_mount_optional("/", &optional));
+    free(optional);
+
+    ASSERT_NE(mkdtemp(tmpdir), nullptr);
+    ASSERT_FALSE(util_detect_mounted(tmpdir));
+    if (mount("tmpfs", tmpdir, "tmpfs", 0, nullptr) != 0) {
+        ASSERT_EQ(rmdir(tmpdir), 0);
+        GTEST_SKIP() << "mount is not permitted";
+    }
+    // changes of mount table are picked up by the cached table
+    ASSERT_TRUE(util_detect_mounted(tmpdir));
+
+    // changes of propagation are not reported, but optional fields are up to date
+    ASSERT_EQ(mount(nullptr, tmpdir, nullptr, MS_SHARED, nullptr), 0);
+    ASSERT_TRUE(util_find_mount_optional(tmpdir, &optional));
+    ASSERT_NE(optional, nullptr);
+    ASSERT_NE(strstr(optional, "shared:"), nullptr);
+    free(optional);
+    optional = nullptr;
+    ASSERT_EQ(mount(nullptr, tmpdir, nullptr, MS_PRIVATE, nullptr), 0);
+    ASSERT_TRUE(util_find_mount_optional(tmpdir, &optional));
+    ASSERT_EQ(optional, nullptr);
+
+    ASSERT_EQ(umount(tmpdir), 0);
+    ASSERT_FALSE(util_detect_mounted(tmpdir));
+    ASSERT_EQ(rmdir(tmpdir), 0);
+}
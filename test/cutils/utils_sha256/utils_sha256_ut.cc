@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: sha256 unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include "sha256.h"
+
+static std::string make_data(size_t len)
+{
+    std::string data;
+
+    for (size_t i = 0; i < len; i++) {
+        data.push_back((char)(i * 31 + i / 7));
+    }
+
+    return data;
+}
+
+static char *stream_digest(const std::string &data, bool decompress, size_t chunk)
+{
+    sha256_stream *stream = sha256_stream_new(decompress);
+    char *digest = nullptr;
+
+    if (stream == nullptr) {
+        return nullptr;
+    }
+    for (size_t pos = 0; pos < data.size(); pos += chunk) {
+        size_t len = data.size() - pos < chunk ? data.size() - pos : chunk;
+        if (sha256_stream_update(stream, data.data() + pos, len) != 0) {
+            sha256_stream_free(stream);
+            return nullptr;
+        }
+    }
+    EXPECT_EQ(sha256_stream_size(stream), data.size());
+    digest = sha256_stream_full_digest(stream);
+    sha256_stream_free(stream);
+
+    return digest;
+}
+
+TEST(utils_sha256, test_sha256_stream_plain)
+{
+    std::string data = make_data(100000);
+    std::string file = "/tmp/utils_sha256_ut_plain";
+    FILE *fp = fopen(file.c_str(), "w");
+    ASSERT_NE(fp, nullptr);
+    ASSERT_EQ(fwrite(data.data(), 1, data.size(), fp), data.size());
+    fclose(fp);
+
+    char *expect = sha256_full_file_digest(file.c_str());
+    ASSERT_NE(expect, nullptr);
+
+    const size_t chunks[] = { 1, 2, 4096, 100000 };
+    for (size_t chunk : chunks) {
+        char *digest = stream_digest(data, false, chunk);
+        ASSERT_STREQ(digest, expect);
+        free(digest);
+        // not gzip data, decompress is ignored
+        digest = stream_digest(data, true, chunk);
+        ASSERT_STREQ(digest, expect);
+        free(digest);
+    }
+
+    free(expect);
+    remove(file.c_str());
+}
+
+TEST(utils_sha256, test_sha256_stream_gzip)
+{
+    std::string data = make_data(100000);
+    std::string file = "/tmp/utils_sha256_ut_gzip";
+    std::string compressed;
+    char buf[4096];
+    size_t n = 0;
+
+    gzFile gz = gzopen(file.c_str(), "w");
+    ASSERT_NE(gz, nullptr);
+    ASSERT_EQ(gzwrite(gz, data.data(), data.size()), (int)data.size());
+    gzclose(gz);
+
+    FILE *fp = fopen(file.c_str(), "r");
+    ASSERT_NE(fp, nullptr);
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        compressed.append(buf, n);
+    }
+    fclose(fp);
+
+    char *expect_diff_id = sha256_full_gzip_digest(file.c_str());
+    ASSERT_NE(expect_diff_id, nullptr);
+    char *expect_digest = sha256_full_file_digest(file.c_str());
+    ASSERT_NE(expect_digest, nullptr);
+
+    const size_t chunks[] = { 1, 3, 4096, 1000000 };
+    for (size_t chunk : chunks) {
+        char *digest = stream_digest(compressed, true, chunk);
+        ASSERT_STREQ(digest, expect_diff_id);
+        free(digest);
+        digest = stream_digest(compressed, false, chunk);
+        ASSERT_STREQ(digest, expect_digest);
+        free(digest);
+    }
+
+    free(expect_diff_id);
+    free(expect_digest);
+    remove(file.c_str());
+}
+
+TEST(utils_sha256, test_sha256_stream_invalid)
+{
+    sha256_stream *stream = sha256_stream_new(false);
+    ASSERT_NE(stream, nullptr);
+
+    ASSERT_NE(sha256_stream_update(nullptr, "a", 1), 0);
+    ASSERT_EQ(sha256_stream_update(stream, "a", 1), 0);
+    char *digest = sha256_stream_full_digest(stream);
+    ASSERT_STREQ(digest, "sha256:ca978112ca1bbdcafac231b39a23dc4da786eff8147c4e72b9807785afee48bb");
+    free(digest);
+
+    // finished stream can not be used any more
+    ASSERT_NE(sha256_stream_update(stream, "a", 1), 0);
+    ASSERT_EQ(sha256_stream_full_digest(stream), nullptr);
+    sha256_stream_free(stream);
+}
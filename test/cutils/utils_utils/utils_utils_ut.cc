@@ -13,6 +13,12 @@
  * Description: utils unit test
  *******************************************************************************/
 
+#include <cerrno>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <pthread.h>
+#include <sys/sysinfo.h>
 #include <gtest/gtest.h>
 #include "utils.h"
 #include "mock.h"
@@ -22,6 +28,15 @@ static pid_t test_pid = -1;
 extern "C" {
     DECLARE_WRAPPER_V(waitpid, pid_t, (__pid_t pid, int *stat_loc, int options));
     DEFINE_WRAPPER_V(waitpid, pid_t, (__pid_t pid, int *stat_loc, int options), (pid, stat_loc, options));
+
+    DECLARE_WRAPPER_V(pthread_create, int, (pthread_t *thread, const pthread_attr_t *attr,
+                                            void *(*start_routine)(void *), void *arg));
+    DEFINE_WRAPPER_V(pthread_create, int, (pthread_t *thread, const pthread_attr_t *attr,
+                                           void *(*start_routine)(void *), void *arg),
+                     (thread, attr, start_routine, arg));
+
+    DECLARE_WRAPPER_V(get_nprocs, int, (void));
+    DEFINE_WRAPPER_V(get_nprocs, int, (void), ());
 }
 
 static pid_t waitpid_none_zero(__pid_t pid, int *stat_loc, int options)
@@ -36,6 +51,48 @@ static pid_t waitpid_zero(__pid_t pid, int *stat_loc, int options)
     return test_pid;
 }
 
+static int pthread_create_created = 0;
+static int pthread_create_success_limit = 0;
+
+// create threads until limit is reached, then fail as if resources are exhausted
+static int pthread_create_limited(pthread_t *thread, const pthread_attr_t *attr, void *(*start_routine)(void *),
+                                  void *arg)
+{
+    if (pthread_create_created >= pthread_create_success_limit) {
+        return EAGAIN;
+    }
+    pthread_create_created++;
+    return __real_pthread_create(thread, attr, start_routine, arg);
+}
+
+// workers are limited by count of processors, make it enough to create all of workers
+static int get_nprocs_many(void)
+{
+    return 64;
+}
+
+struct parallel_record {
+    std::mutex mutex;
+    std::vector<int> calls;
+    std::set<pthread_t> threads;
+};
+
+static void record_parallel_call(size_t idx, void *context)
+{
+    struct parallel_record *record = (struct parallel_record *)context;
+    std::lock_guard<std::mutex> lock(record->mutex);
+
+    record->calls[idx]++;
+    record->threads.insert(pthread_self());
+}
+
+static void check_parallel_calls(const struct parallel_record &record)
+{
+    for (size_t i = 0; i < record.calls.size(); i++) {
+        ASSERT_EQ(record.calls[i], 1) << "index " << i;
+    }
+}
+
 #define ExitSignalOffset 128
 static int status_to_exit_code(int status)
 {
@@ -345,4 +402,80 @@ TEST(utils_utils, test_util_waitpid_with_timeout)
 
     ASSERT_EQ(util_waitpid_with_timeout(pid, timeout, nullptr), -1);
 
-}
\ No newline at end of file
+}
+
+TEST(utils_utils, test_util_parallel_for_empty)
+{
+    struct parallel_record record;
+
+    util_parallel_for(0, 8, record_parallel_call, &record);
+    ASSERT_TRUE(record.threads.empty());
+
+    record.calls.resize(4, 0);
+    util_parallel_for(4, 8, nullptr, &record);
+    ASSERT_TRUE(record.threads.empty());
+}
+
+TEST(utils_utils, test_util_parallel_for_less_than_workers)
+{
+    struct parallel_record record;
+
+    // workers are not more than items, each item is handled once
+    record.calls.resize(3, 0);
+    pthread_create_created = 0;
+    pthread_create_success_limit = 1024;
+    MOCK_SET_V(get_nprocs, get_nprocs_many);
+    MOCK_SET_V(pthread_create, pthread_create_limited);
+    util_parallel_for(record.calls.size(), 16, record_parallel_call, &record);
+    MOCK_CLEAR(pthread_create);
+    MOCK_CLEAR(get_nprocs);
+    check_parallel_calls(record);
+    ASSERT_EQ(pthread_create_created, 2);
+    ASSERT_LE(record.threads.size(), 3);
+
+    // single worker runs in calling thread
+    record.calls.assign(5, 0);
+    record.threads.clear();
+    util_parallel_for(record.calls.size(), 1, record_parallel_call, &record);
+    check_parallel_calls(record);
+    ASSERT_EQ(record.threads.size(), 1);
+    ASSERT_EQ(*record.threads.begin(), pthread_self());
+}
+
+TEST(utils_utils, test_util_parallel_for_many_items)
+{
+    struct parallel_record record;
+
+    record.calls.resize(1000, 0);
+    util_parallel_for(record.calls.size(), 4, record_parallel_call, &record);
+    check_parallel_calls(record);
+    ASSERT_LE(record.threads.size(), 4);
+}
+
+TEST(utils_utils, test_util_parallel_for_create_failed)
+{
+    struct parallel_record record;
+
+    // no worker created, all items are handled by calling thread
+    record.calls.resize(100, 0);
+    pthread_create_created = 0;
+    pthread_create_success_limit = 0;
+    MOCK_SET_V(get_nprocs, get_nprocs_many);
+    MOCK_SET_V(pthread_create, pthread_create_limited);
+    util_parallel_for(record.calls.size(), 8, record_parallel_call, &record);
+    check_parallel_calls(record);
+    ASSERT_EQ(record.threads.size(), 1);
+    ASSERT_EQ(*record.threads.begin(), pthread_self());
+
+    // only part of workers created, items are shared by those running
+    record.calls.assign(100, 0);
+    record.threads.clear();
+    pthread_create_created = 0;
+    pthread_create_success_limit = 1;
+    util_parallel_for(record.calls.size(), 8, record_parallel_call, &record);
+    MOCK_CLEAR(pthread_create);
+    MOCK_CLEAR(get_nprocs);
+    check_parallel_calls(record);
+    ASSERT_EQ(pthread_create_created, 1);
+    ASSERT_LE(record.threads.size(), 2);
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: http request unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <string>
+#include <gtest/gtest.h>
+#include "buffer.h"
+#include "http.h"
+
+#define REQUEST_THREADS 4
+#define REQUESTS_PER_THREAD 10
+
+namespace {
+// HTTP/1.1 server on loopback answering every request on a kept-alive connection
+int g_listen_fd = -1;
+int g_port = 0;
+std::atomic<int> g_connections(0);
+std::atomic<int> g_requests(0);
+
+void *serve_connection(void *arg)
+{
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+    int fd = (int)(long)arg;
+    std::string data;
+    char buf[1024];
+    ssize_t nread = 0;
+    size_t pos = 0;
+
+    while ((nread = read(fd, buf, sizeof(buf))) > 0) {
+        data.append(buf, (size_t)nread);
+        // requests have no body
+        while ((pos = data.find("\r\n\r\n")) != std::string::npos) {
+            data.erase(0, pos + 4);
+            g_requests++;
+            if (write(fd, response.data(), response.size()) != (ssize_t)response.size()) {
+                break;
+            }
+        }
+    }
+    close(fd);
+
+    return nullptr;
+}
+
+void *serve(void *arg)
+{
+    pthread_t tid;
+    int fd = -1;
+
+    (void)arg;
+    while ((fd = accept(g_listen_fd, nullptr, nullptr)) >= 0) {
+        g_connections++;
+        if (pthread_create(&tid, nullptr, serve_connection, (void *)(long)fd) != 0) {
+            close(fd);
+            continue;
+        }
+        pthread_detach(tid);
+    }
+
+    return nullptr;
+}
+
+// return the body, or an empty string if the request failed
+std::string get(const std::string &host)
+{
+    struct http_get_options *options = (struct http_get_options *)calloc(1, sizeof(struct http_get_options));
+    Buffer *output = buffer_alloc(64);
+    std::string url = "http://" + host + ":" + std::to_string(g_port) + "/v2/";
+    std::string body;
+    long code = 0;
+
+    options->with_body = 1;
+    options->outputtype = HTTP_REQUEST_STRBUF;
+    options->output = output;
+    if (http_request(url.c_str(), options, &code, 0) == 0 && code == 200) {
+        body = std::string(output->contents, output->bytes_used);
+    }
+    buffer_free(output);
+    options->output = nullptr;
+    free_http_get_options(options);
+
+    return body;
+}
+
+void *get_in_thread(void *arg)
+{
+    std::atomic<int> *ok = (std::atomic<int> *)arg;
+
+    for (int i = 0; i < REQUESTS_PER_THREAD; i++) {
+        if (get("127.0.0.1") == "hello") {
+            (*ok)++;
+        }
+    }
+
+    return nullptr;
+}
+
+class HttpUnitTest : public testing::Test {
+protected:
+    static void SetUpTestCase()
+    {
+        struct sockaddr_in addr = {};
+        socklen_t len = sizeof(addr);
+        pthread_t tid;
+
+        signal(SIGPIPE, SIG_IGN);
+        http_global_init();
+
+        g_listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        ASSERT_GE(g_listen_fd, 0);
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(bind(g_listen_fd, (struct sockaddr *)&addr, sizeof(addr)), 0);
+        ASSERT_EQ(listen(g_listen_fd, 64), 0);
+        ASSERT_EQ(getsockname(g_listen_fd, (struct sockaddr *)&addr, &len), 0);
+        g_port = ntohs(addr.sin_port);
+        ASSERT_EQ(pthread_create(&tid, nullptr, serve, nullptr), 0);
+        pthread_detach(tid);
+    }
+
+    static void TearDownTestCase()
+    {
+        http_global_cleanup();
+    }
+
+    void SetUp() override
+    {
+        // connections of earlier tests are closed with the idle handles
+        http_global_cleanup();
+        http_global_init();
+        g_connections = 0;
+        g_requests = 0;
+    }
+};
+} // namespace
+
+TEST_F(HttpUnitTest, test_reuse_connection)
+{
+    for (int i = 0; i < 5; i++) {
+        ASSERT_EQ(get("127.0.0.1"), "hello");
+    }
+    ASSERT_EQ(g_requests, 5);
+    ASSERT_EQ(g_connections, 1);
+}
+
+TEST_F(HttpUnitTest, test_connections_per_host)
+{
+    // handles are kept for the host they requested, requests to other hosts do not take them
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(get("127.0.0.1"), "hello");
+        ASSERT_EQ(get("localhost"), "hello");
+    }
+    ASSERT_EQ(g_requests, 6);
+    ASSERT_EQ(g_connections, 2);
+}
+
+TEST_F(HttpUnitTest, test_concurrent_requests)
+{
+    pthread_t tids[REQUEST_THREADS];
+    std::atomic<int> ok(0);
+    int i;
+
+    // DNS cache and TLS sessions are shared by concurrent requests, a connection is used by one of them at a time
+    for (i = 0; i < REQUEST_THREADS; i++) {
+        ASSERT_EQ(pthread_create(&tids[i], nullptr, get_in_thread, &ok), 0);
+    }
+    for (i = 0; i < REQUEST_THREADS; i++) {
+        pthread_join(tids[i], nullptr);
+    }
+    ASSERT_EQ(ok, REQUEST_THREADS * REQUESTS_PER_THREAD);
+    ASSERT_EQ(g_requests, REQUEST_THREADS * REQUESTS_PER_THREAD);
+    ASSERT_LE(g_connections, REQUEST_THREADS);
+}
+
+TEST_F(HttpUnitTest, test_failed_request)
+{
+    std::string url = "http://127.0.0.1:" + std::to_string(g_port) + "/v2/";
+    struct http_get_options options = {};
+
+    ASSERT_NE(http_request(nullptr, &options, nullptr, 0), 0);
+    ASSERT_NE(http_request(url.c_str(), nullptr, nullptr, 0), 0);
+    ASSERT_EQ(get("127.0.0.1"), "hello");
+}
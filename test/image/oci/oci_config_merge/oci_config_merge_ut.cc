@@ -405,3 +405,71 @@ TEST(oci_config_merge_ut, test_oci_image_merge_config)
     free_container_config(custom_config);
     custom_config = nullptr;
 }
+
+static defs_map_string_object *make_exposed_ports(const char **ports, size_t len)
+{
+    defs_map_string_object *exposed = (defs_map_string_object *)util_common_calloc_s(sizeof(defs_map_string_object));
+
+    exposed->keys = (char **)util_smart_calloc_s(sizeof(char *), len);
+    exposed->values =
+        (defs_map_string_object_element **)util_smart_calloc_s(sizeof(defs_map_string_object_element *), len);
+    for (size_t i = 0; i < len; i++) {
+        exposed->keys[i] = util_strdup_s(ports[i]);
+    }
+    exposed->len = len;
+
+    return exposed;
+}
+
+TEST(oci_config_merge_ut, test_oci_image_merge_config_keep_image)
+{
+    char *imagetool_image_file = nullptr;
+    imagetool_image *tool_image = nullptr;
+    container_config *custom_config = nullptr;
+    char *err = nullptr;
+    const char *image_ports[] = { "80/tcp", "443/tcp" };
+    const char *custom_ports[] = { "80/tcp", "8080/tcp" };
+
+    imagetool_image_file = json_path(IMAGETOOL_IMAGE_FILE);
+    ASSERT_TRUE(imagetool_image_file != nullptr);
+    tool_image = imagetool_image_parse_file(imagetool_image_file, nullptr, &err);
+    ASSERT_TRUE(tool_image != nullptr);
+    ASSERT_TRUE(tool_image->spec != nullptr);
+    ASSERT_TRUE(tool_image->spec->config != nullptr);
+    free(err);
+    err = nullptr;
+    free(imagetool_image_file);
+    imagetool_image_file = nullptr;
+
+    free_defs_map_string_object(tool_image->spec->config->exposed_ports);
+    tool_image->spec->config->exposed_ports = make_exposed_ports(image_ports, 2);
+
+    // the image info may be shared by other readers, merging must not take anything from it
+    for (int i = 0; i < 2; i++) {
+        custom_config = (container_config *)util_common_calloc_s(sizeof(container_config));
+        ASSERT_TRUE(custom_config != nullptr);
+        ASSERT_EQ(oci_image_merge_config(tool_image, custom_config), 0);
+        ASSERT_TRUE(custom_config->exposed_ports != nullptr);
+        ASSERT_EQ(custom_config->exposed_ports->len, 2);
+        free_container_config(custom_config);
+        custom_config = nullptr;
+    }
+
+    custom_config = (container_config *)util_common_calloc_s(sizeof(container_config));
+    ASSERT_TRUE(custom_config != nullptr);
+    custom_config->exposed_ports = make_exposed_ports(custom_ports, 2);
+    ASSERT_EQ(oci_image_merge_config(tool_image, custom_config), 0);
+    ASSERT_EQ(custom_config->exposed_ports->len, 3);
+    ASSERT_STREQ(custom_config->exposed_ports->keys[0], "80/tcp");
+    ASSERT_STREQ(custom_config->exposed_ports->keys[1], "8080/tcp");
+    ASSERT_STREQ(custom_config->exposed_ports->keys[2], "443/tcp");
+    free_container_config(custom_config);
+    custom_config = nullptr;
+
+    ASSERT_EQ(tool_image->spec->config->exposed_ports->len, 2);
+    ASSERT_STREQ(tool_image->spec->config->exposed_ports->keys[0], "80/tcp");
+    ASSERT_STREQ(tool_image->spec->config->exposed_ports->keys[1], "443/tcp");
+
+    free_imagetool_image(tool_image);
+    tool_image = nullptr;
+}
@@ -0,0 +1,498 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: oci load unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "oci_load.h"
+#include "oci_image.h"
+#include "util_archive.h"
+#include "io_wrapper.h"
+#include "sha256.h"
+#include "storage_mock.h"
+
+#define WORK_DIR "/tmp/oci_load_ut"
+#define IMAGE_DIR WORK_DIR "/image"
+#define ARCHIVE WORK_DIR "/image.tar"
+#define ROOT_DIR WORK_DIR "/root"
+#define LOAD_TMP_DIR ROOT_DIR "/isulad_tmpdir"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+
+namespace {
+struct oci_image_module_data g_oci_image_data;
+}
+
+extern "C" {
+struct oci_image_module_data *get_oci_image_data(void)
+{
+    return &g_oci_image_data;
+}
+
+// count walks of archive
+int __real_archive_foreach_member(int fd, archive_member_cb_t cb, void *context);
+int g_archive_walks = 0;
+int __wrap_archive_foreach_member(int fd, archive_member_cb_t cb, void *context)
+{
+    g_archive_walks++;
+    return __real_archive_foreach_member(fd, cb, context);
+}
+}
+
+namespace {
+struct member_info {
+    std::string name;
+    std::string linkname;
+    bool hardlink;
+    bool regular;
+    int64_t size;
+    std::string data;
+};
+
+struct walk_info {
+    std::vector<member_info> members;
+    // data of the member is read, others are skipped
+    std::string read_member;
+    // walking is stopped by the member
+    std::string stop_member;
+};
+
+int record_member(const struct archive_member *member, const struct io_read_wrapper *data, void *context)
+{
+    walk_info *walk = (walk_info *)context;
+    member_info info = { member->name, member->linkname != nullptr ? member->linkname : "", member->hardlink,
+                         member->regular, member->size, "" };
+    char buf[4096] = { 0 };
+    ssize_t nread = 0;
+
+    if (info.name == walk->read_member) {
+        while ((nread = data->read(data->context, buf, sizeof(buf))) > 0) {
+            info.data.append(buf, (size_t)nread);
+        }
+        if (nread < 0) {
+            return -1;
+        }
+    }
+    walk->members.push_back(info);
+
+    return info.name == walk->stop_member ? -1 : 0;
+}
+
+void write_file(const std::string &path, const std::string &content)
+{
+    std::ofstream out(path, std::ios::trunc | std::ios::binary);
+
+    out << content;
+}
+
+std::string read_file(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+std::string file_digest(const std::string &path)
+{
+    char *digest = sha256_full_file_digest(path.c_str());
+    std::string ret = digest != nullptr ? digest : "";
+
+    free(digest);
+    return ret;
+}
+
+std::string chain_id(const std::string &parent, const std::string &diff_id)
+{
+    std::string prefix = "sha256:";
+    char *digest = nullptr;
+    std::string ret;
+
+    if (parent.empty()) {
+        return diff_id.substr(prefix.size());
+    }
+    digest = sha256_digest_str((parent + "+" + diff_id.substr(prefix.size())).c_str());
+    ret = digest != nullptr ? digest : "";
+    free(digest);
+    return ret;
+}
+
+// write layer member of the image with content, return the diff id of it
+std::string make_layer(const std::string &member, const std::string &content)
+{
+    std::string path = IMAGE_DIR "/" + member;
+
+    EXPECT_EQ(system(("mkdir -p $(dirname " + path + ")").c_str()), 0);
+    write_file(path, content);
+    return file_digest(path);
+}
+
+// write the config of image with layers of diff_ids, return the member name of it
+std::string make_config(const std::vector<std::string> &diff_ids)
+{
+    std::string config = "{\"architecture\":\"amd64\",\"os\":\"linux\",\"created\":\"2026-10-17T08:00:00.000000000Z\","
+                         "\"rootfs\":{\"type\":\"layers\",\"diff_ids\":[";
+    std::string path = IMAGE_DIR "/config.json";
+    std::string member;
+
+    for (size_t i = 0; i < diff_ids.size(); i++) {
+        config += (i == 0 ? "\"" : ",\"") + diff_ids[i] + "\"";
+    }
+    config += "]}}";
+    write_file(path, config);
+
+    // named by its digest as docker does
+    member = file_digest(path).substr(strlen("sha256:")) + ".json";
+    EXPECT_EQ(rename(path.c_str(), (IMAGE_DIR "/" + member).c_str()), 0);
+    return member;
+}
+
+void make_manifest(const std::string &config, const std::vector<std::string> &layers)
+{
+    std::string manifest = "[{\"Config\":\"" + config + "\",\"RepoTags\":[\"test:latest\"],\"Layers\":[";
+
+    for (size_t i = 0; i < layers.size(); i++) {
+        manifest += (i == 0 ? "\"" : ",\"") + layers[i] + "\"";
+    }
+    manifest += "]}]";
+    write_file(IMAGE_DIR "/manifest.json", manifest);
+}
+
+// archive members of the image in order
+void make_archive(const std::vector<std::string> &members, bool compressed = false)
+{
+    std::string cmd = std::string(compressed ? "tar -czf " : "tar -cf ") + ARCHIVE " -C " IMAGE_DIR;
+
+    for (const auto &member : members) {
+        cmd += " " + member;
+    }
+    ASSERT_EQ(system(cmd.c_str()), 0);
+}
+
+bool dir_empty(const std::string &path)
+{
+    return system(("test -z \"$(ls -A " + path + ")\"").c_str()) == 0;
+}
+
+struct created_layer {
+    std::string parent;
+    std::string diff_id;
+    std::string data;
+};
+
+// layers in storage, and the ones created by loading
+std::set<std::string> g_layers;
+std::map<std::string, created_layer> g_created;
+std::string g_image_top_layer;
+
+int invokeStorageLayerCreate(const char *layer_id, storage_layer_create_opts_t *opts)
+{
+    created_layer layer = { opts->parent != nullptr ? opts->parent : "", opts->uncompress_digest,
+                            read_file(opts->layer_data_path) };
+
+    g_created[layer_id] = layer;
+    g_layers.insert(layer_id);
+    return 0;
+}
+
+// storage_dec_hold_refs is mocked by StorageIncHoldRefs too, both succeed for layers in storage
+int invokeStorageIncHoldRefs(const char *layer_id)
+{
+    return g_layers.count(layer_id) > 0 ? 0 : -1;
+}
+
+struct layer *invokeStorageLayerGet(const char *layer_id)
+{
+    struct layer *l = nullptr;
+
+    if (g_layers.count(layer_id) == 0) {
+        return nullptr;
+    }
+    l = (struct layer *)calloc(1, sizeof(struct layer));
+    l->id = strdup(layer_id);
+    l->compress_size = 100;
+    return l;
+}
+
+void invokeFreeLayer(struct layer *l)
+{
+    if (l != nullptr) {
+        free(l->id);
+        free(l);
+    }
+}
+
+int invokeStorageImgCreate(const char *id, const char *parent_id, const char *metadata,
+                           struct storage_img_create_options *opts)
+{
+    (void)id;
+    (void)metadata;
+    (void)opts;
+    g_image_top_layer = parent_id;
+    return 0;
+}
+
+class OciLoadUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(system("rm -rf " WORK_DIR " && mkdir -p " IMAGE_DIR " " ROOT_DIR), 0);
+        g_oci_image_data.root_dir = (char *)ROOT_DIR;
+        g_layers.clear();
+        g_created.clear();
+        g_image_top_layer.clear();
+        g_archive_walks = 0;
+
+        MockStorage_SetMock(&m_storage_mock);
+        ON_CALL(m_storage_mock, StorageLayerCreate(_, _)).WillByDefault(Invoke(invokeStorageLayerCreate));
+        ON_CALL(m_storage_mock, StorageIncHoldRefs(_)).WillByDefault(Invoke(invokeStorageIncHoldRefs));
+        ON_CALL(m_storage_mock, StorageLayerGet(_)).WillByDefault(Invoke(invokeStorageLayerGet));
+        ON_CALL(m_storage_mock, FreeLayer(_)).WillByDefault(Invoke(invokeFreeLayer));
+        ON_CALL(m_storage_mock, StorageImgCreate(_, _, _, _)).WillByDefault(Invoke(invokeStorageImgCreate));
+        ON_CALL(m_storage_mock, StorageImgSetBigData(_, _, _)).WillByDefault(testing::Return(0));
+        ON_CALL(m_storage_mock, StorageImgAddName(_, _)).WillByDefault(testing::Return(0));
+        ON_CALL(m_storage_mock, StorageImgSetLoadedTime(_, _)).WillByDefault(testing::Return(0));
+        ON_CALL(m_storage_mock, StorageImgSetImageSize(_)).WillByDefault(testing::Return(0));
+    }
+
+    void TearDown() override
+    {
+        MockStorage_SetMock(nullptr);
+        g_oci_image_data.root_dir = nullptr;
+        ASSERT_EQ(system("rm -rf " WORK_DIR), 0);
+    }
+
+    int load()
+    {
+        im_load_request request = { (char *)ARCHIVE, nullptr, (char *)"oci" };
+
+        return oci_do_load(&request);
+    }
+
+    NiceMock<MockStorage> m_storage_mock;
+};
+} // namespace
+
+TEST_F(OciLoadUnitTest, test_archive_foreach_member)
+{
+    std::string big(3 * 1024 * 1024, 'x');
+    walk_info walk;
+    int fd = -1;
+
+    ASSERT_EQ(system("mkdir -p " IMAGE_DIR "/d"), 0);
+    write_file(IMAGE_DIR "/d/a", "hello");
+    write_file(IMAGE_DIR "/e", big);
+    ASSERT_EQ(system("ln " IMAGE_DIR "/d/a " IMAGE_DIR "/d/b && ln -s a " IMAGE_DIR "/d/c"), 0);
+    make_archive({ "e", "d/a", "d/b", "d/c" });
+
+    fd = open(ARCHIVE, O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(fd, 0);
+
+    // members not read are skipped
+    walk.read_member = "d/a";
+    ASSERT_EQ(archive_foreach_member(fd, record_member, &walk), 0);
+    ASSERT_EQ(walk.members.size(), 4U);
+    EXPECT_EQ(walk.members[0].name, "e");
+    EXPECT_TRUE(walk.members[0].regular);
+    EXPECT_EQ(walk.members[0].size, (int64_t)big.size());
+    EXPECT_EQ(walk.members[0].data, "");
+    EXPECT_EQ(walk.members[1].name, "d/a");
+    EXPECT_TRUE(walk.members[1].regular);
+    EXPECT_EQ(walk.members[1].data, "hello");
+    EXPECT_EQ(walk.members[2].name, "d/b");
+    EXPECT_TRUE(walk.members[2].hardlink);
+    EXPECT_FALSE(walk.members[2].regular);
+    EXPECT_EQ(walk.members[2].linkname, "d/a");
+    EXPECT_EQ(walk.members[3].name, "d/c");
+    EXPECT_FALSE(walk.members[3].hardlink);
+    EXPECT_FALSE(walk.members[3].regular);
+    EXPECT_EQ(walk.members[3].linkname, "a");
+
+    // archive is walked again from the start, until the callback fails
+    walk = walk_info();
+    walk.read_member = "e";
+    walk.stop_member = "d/a";
+    ASSERT_NE(archive_foreach_member(fd, record_member, &walk), 0);
+    ASSERT_EQ(walk.members.size(), 2U);
+    EXPECT_EQ(walk.members[0].data, big);
+
+    close(fd);
+    EXPECT_NE(archive_foreach_member(-1, record_member, &walk), 0);
+}
+
+TEST_F(OciLoadUnitTest, test_load_missing_layers)
+{
+    std::string diff1 = make_layer("l1/layer.tar", "layer1");
+    std::string diff2 = make_layer("l2/layer.tar", "layer2");
+    std::string config = make_config({ diff1, diff2 });
+    std::string chain1 = chain_id("", diff1);
+    std::string chain2 = chain_id(chain1, diff2);
+
+    make_manifest(config, { "l1/layer.tar", "l2/layer.tar" });
+    // members are found by name, manifest.json is not necessarily the first one
+    make_archive({ "l2/layer.tar", config, "l1/layer.tar", "manifest.json" });
+
+    ASSERT_EQ(load(), 0);
+    ASSERT_EQ(g_created.size(), 2U);
+    EXPECT_EQ(g_created[chain1].parent, "");
+    EXPECT_EQ(g_created[chain1].diff_id, diff1);
+    EXPECT_EQ(g_created[chain1].data, "layer1");
+    EXPECT_EQ(g_created[chain2].parent, chain1);
+    EXPECT_EQ(g_created[chain2].diff_id, diff2);
+    EXPECT_EQ(g_created[chain2].data, "layer2");
+    EXPECT_EQ(g_image_top_layer, chain2);
+    // files extracted are removed
+    EXPECT_TRUE(dir_empty(LOAD_TMP_DIR));
+}
+
+TEST_F(OciLoadUnitTest, test_load_linked_layers)
+{
+    std::string diff = make_layer("l1/layer.tar", "layer1");
+    std::string config = make_config({ diff, diff, diff });
+    std::string chain1 = chain_id("", diff);
+    std::string chain2 = chain_id(chain1, diff);
+    std::string chain3 = chain_id(chain2, diff);
+
+    make_manifest(config, { "l1/layer.tar", "l2/layer.tar", "l3/layer.tar" });
+    // same layers are saved as links to the first one, so is manifest.json linked here
+    ASSERT_EQ(system("mkdir -p " IMAGE_DIR "/l2 " IMAGE_DIR "/l3 " IMAGE_DIR "/meta && "
+                     "ln -s ../l1/layer.tar " IMAGE_DIR "/l2/layer.tar && "
+                     "ln " IMAGE_DIR "/l1/layer.tar " IMAGE_DIR "/l3/layer.tar && "
+                     "mv " IMAGE_DIR "/manifest.json " IMAGE_DIR "/meta/ && "
+                     "ln -s meta/manifest.json " IMAGE_DIR "/manifest.json"),
+              0);
+    make_archive({ "manifest.json", "l1/layer.tar", "l2/layer.tar", "l3/layer.tar", config, "meta/manifest.json" });
+
+    ASSERT_EQ(load(), 0);
+    ASSERT_EQ(g_created.size(), 3U);
+    EXPECT_EQ(g_created[chain1].data, "layer1");
+    EXPECT_EQ(g_created[chain2].parent, chain1);
+    EXPECT_EQ(g_created[chain2].data, "layer1");
+    EXPECT_EQ(g_created[chain3].parent, chain2);
+    EXPECT_EQ(g_created[chain3].data, "layer1");
+    EXPECT_EQ(g_image_top_layer, chain3);
+}
+
+TEST_F(OciLoadUnitTest, test_load_layers_in_storage)
+{
+    std::string diff1 = make_layer("l1/layer.tar", "layer1");
+    std::string diff2 = make_layer("l2/layer.tar", "layer2");
+    std::string config = make_config({ diff1, diff2 });
+    std::string chain1 = chain_id("", diff1);
+    std::string chain2 = chain_id(chain1, diff2);
+
+    make_manifest(config, { "l1/layer.tar", "l2/layer.tar" });
+    // layers in storage are not read from the archive
+    make_archive({ "manifest.json", config, "l2/layer.tar" });
+    g_layers.insert(chain1);
+
+    ASSERT_EQ(load(), 0);
+    ASSERT_EQ(g_created.size(), 1U);
+    EXPECT_EQ(g_created[chain2].parent, chain1);
+    EXPECT_EQ(g_created[chain2].diff_id, diff2);
+    EXPECT_EQ(g_created[chain2].data, "layer2");
+    EXPECT_EQ(g_image_top_layer, chain2);
+
+    // nothing to create if all layers are in storage
+    g_created.clear();
+    make_archive({ "manifest.json", config });
+    ASSERT_EQ(load(), 0);
+    EXPECT_EQ(g_created.size(), 0U);
+    EXPECT_EQ(g_image_top_layer, chain2);
+}
+
+TEST_F(OciLoadUnitTest, test_load_missing_layer_member)
+{
+    std::string diff1 = make_layer("l1/layer.tar", "layer1");
+    std::string diff2 = make_layer("l2/layer.tar", "layer2");
+    std::string config = make_config({ diff1, diff2 });
+
+    make_manifest(config, { "l1/layer.tar", "l2/layer.tar" });
+    make_archive({ "manifest.json", config, "l1/layer.tar" });
+
+    EXPECT_CALL(m_storage_mock, StorageImgCreate(_, _, _, _)).Times(0);
+    ASSERT_NE(load(), 0);
+    EXPECT_EQ(g_created.size(), 0U);
+
+    // so are missing config and manifest.json
+    make_archive({ "manifest.json", "l1/layer.tar", "l2/layer.tar" });
+    ASSERT_NE(load(), 0);
+    make_archive({ config, "l1/layer.tar", "l2/layer.tar" });
+    ASSERT_NE(load(), 0);
+    EXPECT_EQ(g_created.size(), 0U);
+    EXPECT_TRUE(dir_empty(LOAD_TMP_DIR));
+}
+
+TEST_F(OciLoadUnitTest, test_load_diff_id_mismatch)
+{
+    std::string diff1 = make_layer("l1/layer.tar", "layer1");
+    std::string diff2 = make_layer("l2/layer.tar", "layer2");
+    std::string config = make_config({ diff1, diff1 });
+
+    make_manifest(config, { "l1/layer.tar", "l2/layer.tar" });
+    make_archive({ "manifest.json", config, "l1/layer.tar", "l2/layer.tar" });
+
+    EXPECT_CALL(m_storage_mock, StorageImgCreate(_, _, _, _)).Times(0);
+    ASSERT_NE(load(), 0);
+    EXPECT_EQ(g_created.size(), 0U);
+    EXPECT_NE(diff1, diff2);
+}
+
+TEST_F(OciLoadUnitTest, test_load_walks_of_archive)
+{
+    std::string diff1 = make_layer("l1/layer.tar", "layer1");
+    std::string diff2 = make_layer("l2/layer.tar", "layer2");
+    std::string config = make_config({ diff1, diff2 });
+    std::string chain1 = chain_id("", diff1);
+    std::string chain2 = chain_id(chain1, diff2);
+
+    // image config is kept by the first walk with manifest.json, layers are extracted by the second one
+    make_manifest(config, { "l1/layer.tar", "l2/layer.tar" });
+    make_archive({ "l1/layer.tar", config, "l2/layer.tar", "manifest.json" }, true);
+    ASSERT_EQ(load(), 0);
+    EXPECT_EQ(g_archive_walks, 2);
+    ASSERT_EQ(g_created.size(), 2U);
+    EXPECT_EQ(g_created[chain2].data, "layer2");
+
+    // one walk only if all layers are in storage
+    g_created.clear();
+    g_archive_walks = 0;
+    ASSERT_EQ(load(), 0);
+    EXPECT_EQ(g_archive_walks, 1);
+    EXPECT_EQ(g_created.size(), 0U);
+
+    // image config not named as json is extracted by another walk
+    g_layers.clear();
+    g_archive_walks = 0;
+    ASSERT_EQ(rename((IMAGE_DIR "/" + config).c_str(), IMAGE_DIR "/config"), 0);
+    make_manifest("config", { "l1/layer.tar", "l2/layer.tar" });
+    make_archive({ "l1/layer.tar", "config", "l2/layer.tar", "manifest.json" }, true);
+    ASSERT_EQ(load(), 0);
+    EXPECT_EQ(g_archive_walks, 3);
+    ASSERT_EQ(g_created.size(), 2U);
+    EXPECT_TRUE(dir_empty(LOAD_TMP_DIR));
+}
@@ -0,0 +1,127 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide download scheduler unit test
+ ******************************************************************************/
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "download_scheduler.h"
+
+namespace {
+std::mutex g_mutex;
+std::condition_variable g_cond;
+bool g_released = false;
+std::vector<size_t> g_order;
+
+const size_t MB = 1024 * 1024;
+
+struct task_arg {
+    size_t id;
+    bool block;
+};
+
+void record_task(void *arg)
+{
+    struct task_arg *task = (struct task_arg *)arg;
+    std::unique_lock<std::mutex> lock(g_mutex);
+
+    if (task->block) {
+        g_cond.wait(lock, [] { return g_released; });
+    }
+    g_order.push_back(task->id);
+    g_cond.notify_all();
+}
+
+bool wait_tasks(size_t num)
+{
+    std::unique_lock<std::mutex> lock(g_mutex);
+
+    return g_cond.wait_for(lock, std::chrono::seconds(10), [num] { return g_order.size() >= num; });
+}
+
+void reset_tasks()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_released = false;
+    g_order.clear();
+}
+
+void release_tasks()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_released = true;
+    }
+    g_cond.notify_all();
+}
+}
+
+TEST(download_scheduler, test_smaller_blob_first)
+{
+    struct task_arg blocker = { 0, true };
+    struct task_arg big = { 3, false };
+    struct task_arg small = { 1, false };
+    struct task_arg middle = { 2, false };
+    download_scheduler_stats stats;
+
+    ASSERT_NE(download_scheduler_submit("docker.io", 1, record_task, &blocker), 0);
+
+    reset_tasks();
+    // only one worker, so the tasks below are queued while the blocker runs
+    ASSERT_EQ(download_scheduler_init(1, 1), 0);
+    ASSERT_EQ(download_scheduler_submit("docker.io", 1, record_task, &blocker), 0);
+    ASSERT_EQ(download_scheduler_submit("docker.io", 300 * MB, record_task, &big), 0);
+    ASSERT_EQ(download_scheduler_submit("quay.io", 100 * MB, record_task, &small), 0);
+    ASSERT_EQ(download_scheduler_submit("docker.io", 200 * MB, record_task, &middle), 0);
+
+    release_tasks();
+
+    ASSERT_TRUE(wait_tasks(4));
+    std::vector<size_t> expect = { 0, 1, 2, 3 };
+    ASSERT_EQ(g_order, expect);
+
+    download_scheduler_get_stats(&stats);
+    ASSERT_EQ(stats.queued, 0);
+    // a worker may still be between running the task and updating the counters
+    ASSERT_LE(stats.completed, 4);
+}
+
+TEST(download_scheduler, test_big_blob_not_starved)
+{
+    struct task_arg blocker = { 0, true };
+    struct task_arg big = { 1, false };
+    struct task_arg small = { 2, false };
+
+    reset_tasks();
+    ASSERT_EQ(download_scheduler_init(1, 1), 0);
+    ASSERT_EQ(download_scheduler_submit("docker.io", 1, record_task, &blocker), 0);
+    // a 10MB blob waits at most about one second for smaller blobs submitted later
+    ASSERT_EQ(download_scheduler_submit("docker.io", 10 * MB, record_task, &big), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    ASSERT_EQ(download_scheduler_submit("docker.io", 1, record_task, &small), 0);
+
+    release_tasks();
+
+    ASSERT_TRUE(wait_tasks(3));
+    std::vector<size_t> expect = { 0, 1, 2 };
+    ASSERT_EQ(g_order, expect);
+}
+
+TEST(download_scheduler, test_invalid_args)
+{
+    ASSERT_NE(download_scheduler_submit("docker.io", 1, nullptr, nullptr), 0);
+}
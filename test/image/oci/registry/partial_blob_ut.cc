@@ -0,0 +1,183 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: provide partial blob unit test
+ ******************************************************************************/
+#include <cstdlib>
+#include <string>
+#include <fstream>
+#include <ctime>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <gtest/gtest.h>
+
+#include "partial_blob.h"
+#include "utils_file.h"
+
+namespace {
+const char *ID = "91f30d776fb25ad7ab0b1c0c3d0ba1f5eb3ee0e8d4f31d5d50a8dfa8f0e3c30d";
+
+void write_file(const std::string &path, const std::string &data, time_t mtime = 0)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << data;
+    out.close();
+    if (mtime != 0) {
+        struct utimbuf times = { mtime, mtime };
+        ASSERT_EQ(utime(path.c_str(), &times), 0);
+    }
+}
+
+bool exist(const std::string &path)
+{
+    return access(path.c_str(), F_OK) == 0;
+}
+}
+
+class PartialBlobUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/partial_blob_ut_XXXXXX";
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        m_root = tmpl;
+        m_dir = m_root + "/registry-partial";
+        m_blobs = m_root + "/registry-blobs";
+        ASSERT_EQ(mkdir(m_dir.c_str(), 0700), 0);
+        ASSERT_EQ(mkdir(m_blobs.c_str(), 0700), 0);
+    }
+
+    void TearDown() override
+    {
+        (void)util_recursive_rmdir(m_root.c_str(), 0);
+    }
+
+    std::string m_root;
+    std::string m_dir;
+    std::string m_blobs;
+};
+
+TEST_F(PartialBlobUnitTest, test_partial_blob_path)
+{
+    char digest[] = "sha256:91f30d776fb25ad7ab0b1c0c3d0ba1f5eb3ee0e8d4f31d5d50a8dfa8f0e3c30d";
+    char invalid[] = "sha256:../../etc";
+    char *path = nullptr;
+
+    path = partial_blob_path(m_dir.c_str(), digest);
+    ASSERT_NE(path, nullptr);
+    ASSERT_EQ(std::string(path), m_dir + "/" + ID);
+    free(path);
+
+    ASSERT_EQ(partial_blob_path(m_dir.c_str(), invalid), nullptr);
+    ASSERT_EQ(partial_blob_path(nullptr, digest), nullptr);
+}
+
+TEST_F(PartialBlobUnitTest, test_save_and_restore)
+{
+    std::string file = m_blobs + "/0";
+    std::string partial = m_dir + "/" + ID;
+    std::string next_file = m_blobs + "/1";
+
+    write_file(file, "12345");
+    partial_blob_save(m_dir.c_str(), file.c_str(), partial.c_str());
+    ASSERT_FALSE(exist(file));
+    ASSERT_EQ(util_file_size(partial.c_str()), 5);
+
+    // download resumes from the end of data kept
+    ASSERT_TRUE(partial_blob_restore(partial.c_str(), next_file.c_str(), 10));
+    ASSERT_FALSE(exist(partial));
+    ASSERT_EQ(util_file_size(next_file.c_str()), 5);
+
+    // unknown blob size resumes too
+    partial_blob_save(m_dir.c_str(), next_file.c_str(), partial.c_str());
+    ASSERT_TRUE(partial_blob_restore(partial.c_str(), file.c_str(), 0));
+    ASSERT_EQ(util_file_size(file.c_str()), 5);
+}
+
+TEST_F(PartialBlobUnitTest, test_save_empty)
+{
+    std::string file = m_blobs + "/0";
+    std::string partial = m_dir + "/" + ID;
+
+    write_file(file, "");
+    partial_blob_save(m_dir.c_str(), file.c_str(), partial.c_str());
+    ASSERT_FALSE(exist(partial));
+
+    // nothing to keep if partial blobs are not kept
+    write_file(file, "12345");
+    partial_blob_save(m_dir.c_str(), file.c_str(), nullptr);
+    ASSERT_TRUE(exist(file));
+}
+
+TEST_F(PartialBlobUnitTest, test_restore_size_mismatch)
+{
+    std::string file = m_blobs + "/0";
+    std::string partial = m_dir + "/" + ID;
+
+    // no partial blob
+    ASSERT_FALSE(partial_blob_restore(partial.c_str(), file.c_str(), 10));
+    ASSERT_FALSE(partial_blob_restore(nullptr, file.c_str(), 10));
+
+    // as big as blob, nothing left to request
+    write_file(partial, "1234567890");
+    ASSERT_FALSE(partial_blob_restore(partial.c_str(), file.c_str(), 10));
+    ASSERT_FALSE(exist(partial));
+
+    // bigger than blob
+    write_file(partial, "1234567890");
+    ASSERT_FALSE(partial_blob_restore(partial.c_str(), file.c_str(), 5));
+
+    // empty
+    write_file(partial, "");
+    ASSERT_FALSE(partial_blob_restore(partial.c_str(), file.c_str(), 10));
+}
+
+TEST_F(PartialBlobUnitTest, test_gc_by_age)
+{
+    time_t now = time(nullptr);
+    std::string expired = m_dir + "/expired";
+    std::string fresh = m_dir + "/fresh";
+
+    write_file(expired, "1234", now - 200);
+    write_file(fresh, "1234", now - 10);
+
+    partial_blob_gc(m_dir.c_str(), 100, 1024);
+    ASSERT_FALSE(exist(expired));
+    ASSERT_TRUE(exist(fresh));
+}
+
+TEST_F(PartialBlobUnitTest, test_gc_by_total_size)
+{
+    time_t now = time(nullptr);
+    std::string oldest = m_dir + "/oldest";
+    std::string older = m_dir + "/older";
+    std::string newest = m_dir + "/newest";
+
+    write_file(newest, "1234", now - 10);
+    write_file(oldest, "1234", now - 30);
+    write_file(older, "1234", now - 20);
+
+    // the oldest ones are removed until the total size is not more than the limit
+    partial_blob_gc(m_dir.c_str(), 100, 8);
+    ASSERT_FALSE(exist(oldest));
+    ASSERT_TRUE(exist(older));
+    ASSERT_TRUE(exist(newest));
+
+    partial_blob_gc(m_dir.c_str(), 100, 3);
+    ASSERT_FALSE(exist(older));
+    ASSERT_FALSE(exist(newest));
+
+    // missing directory is ignored
+    partial_blob_gc((m_dir + "/none").c_str(), 100, 3);
+}
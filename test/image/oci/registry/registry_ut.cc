@@ -21,6 +21,9 @@
 #include <fstream>
 #include <streambuf>
 #include <climits>
+#include <map>
+#include <mutex>
+#include <set>
 #include <dirent.h>
 #include <unistd.h>
 #include <sys/stat.h>
@@ -466,6 +469,67 @@ int invokeStorageLayerCreate(const char *layer_id, storage_layer_create_opts_t *
     return 0;
 }
 
+char *invokeStorageLayerStageDiff(const char *layer_data_path)
+{
+    // layers are unpacked when created if not staged
+    return nullptr;
+}
+
+void invokeStorageLayerRemoveStagedDiff(const char *staged_diff)
+{
+    return;
+}
+
+// stages returned to the stagers of pulling, with the layer data they are staged from
+static std::mutex g_stage_mutex;
+static std::map<std::string, std::string> g_staged;
+static std::set<std::string> g_staged_created;
+static std::set<std::string> g_staged_removed;
+static bool g_stage_misused = false;
+
+char *invokeStorageLayerStageDiffRecorded(const char *layer_data_path)
+{
+    std::lock_guard<std::mutex> lock(g_stage_mutex);
+    std::string stage = "stage" + std::to_string(g_staged.size());
+
+    g_staged[stage] = layer_data_path;
+    return util_strdup_s(stage.c_str());
+}
+
+int invokeStorageLayerCreateRecorded(const char *layer_id, storage_layer_create_opts_t *opts)
+{
+    // keep registering the first layer, so stagers take the others in the meantime
+    if (opts->parent == nullptr) {
+        usleep(200 * 1000);
+    }
+    if (opts->staged_diff == nullptr) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(g_stage_mutex);
+    auto it = g_staged.find(opts->staged_diff);
+    // a layer is created with the diff staged from its own data, only once and before it is removed
+    if (it == g_staged.end() || it->second != opts->layer_data_path || g_staged_created.count(it->first) != 0 ||
+        g_staged_removed.count(it->first) != 0) {
+        g_stage_misused = true;
+    }
+    g_staged_created.insert(opts->staged_diff);
+    return 0;
+}
+
+void invokeStorageLayerRemoveStagedDiffRecorded(const char *staged_diff)
+{
+    if (staged_diff == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_stage_mutex);
+    if (g_staged.count(staged_diff) == 0 || g_staged_removed.count(staged_diff) != 0) {
+        g_stage_misused = true;
+    }
+    g_staged_removed.insert(staged_diff);
+}
+
 int invokeStorageIncHoldRefs(const char *layer_id)
 {
     return 0;
@@ -609,6 +673,9 @@ void mockCommonAll(MockStorage *mock, MockOciImage *oci_image_mock)
     EXPECT_CALL(*mock, StorageImgSetImageSize(::testing::_)).WillRepeatedly(Invoke(invokeStorageImgSetImageSize));
     EXPECT_CALL(*mock, StorageGetImgTopLayer(::testing::_)).WillRepeatedly(Invoke(invokeStorageGetImgTopLayer));
     EXPECT_CALL(*mock, StorageLayerCreate(::testing::_, ::testing::_)).WillRepeatedly(Invoke(invokeStorageLayerCreate));
+    EXPECT_CALL(*mock, StorageLayerStageDiff(::testing::_)).WillRepeatedly(Invoke(invokeStorageLayerStageDiff));
+    EXPECT_CALL(*mock, StorageLayerRemoveStagedDiff(::testing::_))
+    .WillRepeatedly(Invoke(invokeStorageLayerRemoveStagedDiff));
     EXPECT_CALL(*mock, StorageIncHoldRefs(::testing::_)).WillRepeatedly(Invoke(invokeStorageIncHoldRefs));
     EXPECT_CALL(*mock, StorageDecHoldRefs(::testing::_)).WillRepeatedly(Invoke(invokeStorageDecHoldRefs));
     EXPECT_CALL(*mock, StorageLayerGet(::testing::_)).WillRepeatedly(Invoke(invokeStorageLayerGet));
@@ -674,11 +741,25 @@ TEST_F(RegistryUnitTest, test_pull_v1_image)
     EXPECT_CALL(m_http_mock, HttpRequest(::testing::_, ::testing::_, ::testing::_, ::testing::_))
     .WillRepeatedly(Invoke(invokeHttpRequestV1));
     mockCommonAll(&m_storage_mock, &m_oci_image_mock);
+    EXPECT_CALL(m_storage_mock, StorageLayerCreate(::testing::_, ::testing::_))
+    .WillRepeatedly(Invoke(invokeStorageLayerCreateRecorded));
+    EXPECT_CALL(m_storage_mock, StorageLayerStageDiff(::testing::_))
+    .WillRepeatedly(Invoke(invokeStorageLayerStageDiffRecorded));
+    EXPECT_CALL(m_storage_mock, StorageLayerRemoveStagedDiff(::testing::_))
+    .WillRepeatedly(Invoke(invokeStorageLayerRemoveStagedDiffRecorded));
     ASSERT_EQ(registry_pull(&options), 0);
 
     ASSERT_EQ(registry_pull(&options), 0);
 
     ASSERT_EQ(registry_pull(&options), 0);
+
+    // layers are staged while the first one is registering, every staged diff is handed to the layer
+    // created from it, and removed once pulling is done
+    std::lock_guard<std::mutex> lock(g_stage_mutex);
+    ASSERT_FALSE(g_stage_misused);
+    ASSERT_FALSE(g_staged.empty());
+    ASSERT_EQ(g_staged_created.size(), g_staged.size());
+    ASSERT_EQ(g_staged_removed.size(), g_staged.size());
 }
 
 TEST_F(RegistryUnitTest, test_login)
@@ -650,6 +650,74 @@ TEST_F(StorageImagesUnitTest, test_image_store_remove_single_name)
     Restore();
 }
 
+TEST_F(StorageImagesUnitTest, test_image_store_read_after_change)
+{
+    std::string name = "imagehub.isulad.com/official/newname:latest";
+    imagetool_image_summary *summary = nullptr;
+    char *id = nullptr;
+
+    BackUp();
+
+    ASSERT_EQ(image_store_lookup(name.c_str()), nullptr);
+    ASSERT_EQ(image_store_add_name(ids.at(1).c_str(), name.c_str()), 0);
+
+    id = image_store_lookup(name.c_str());
+    ASSERT_STREQ(id, ids.at(1).c_str());
+    free(id);
+
+    summary = image_store_get_image_summary(name.c_str());
+    ASSERT_NE(summary, nullptr);
+    ASSERT_STREQ(summary->id, ids.at(1).c_str());
+    ASSERT_NE(find(summary->repo_tags, summary->repo_tags + summary->repo_tags_len, name),
+              summary->repo_tags + summary->repo_tags_len);
+    free_imagetool_image_summary(summary);
+
+    ASSERT_EQ(image_store_delete(ids.at(1).c_str()), 0);
+    ASSERT_FALSE(image_store_exists(name.c_str()));
+    ASSERT_EQ(image_store_get_image_summary(ids.at(1).c_str()), nullptr);
+
+    Restore();
+}
+
+TEST_F(StorageImagesUnitTest, test_image_store_image_info_cache)
+{
+    std::string name = "imagehub.isulad.com/official/newname:latest";
+    image_info_ref *first = nullptr;
+    image_info_ref *second = nullptr;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t old_hits = 0;
+
+    BackUp();
+
+    first = image_store_get_image_ref(ids.at(1).c_str());
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(first->info->spec, nullptr);
+    image_store_get_image_cache_stats(&old_hits, &misses);
+
+    second = image_store_get_image_ref(ids.at(1).c_str());
+    ASSERT_EQ(second, first);
+    image_store_get_image_cache_stats(&hits, &misses);
+    ASSERT_EQ(hits, old_hits + 1);
+    image_store_put_image_ref(second);
+
+    // changed image gets a new info, the old one is still valid for its holder
+    ASSERT_EQ(image_store_add_name(ids.at(1).c_str(), name.c_str()), 0);
+    second = image_store_get_image_ref(name.c_str());
+    ASSERT_NE(second, nullptr);
+    ASSERT_NE(second, first);
+    ASSERT_NE(find(second->info->repo_tags, second->info->repo_tags + second->info->repo_tags_len, name),
+              second->info->repo_tags + second->info->repo_tags_len);
+    ASSERT_STREQ(first->info->id, ids.at(1).c_str());
+    image_store_put_image_ref(second);
+    image_store_put_image_ref(first);
+
+    ASSERT_EQ(image_store_delete(ids.at(1).c_str()), 0);
+    ASSERT_EQ(image_store_get_image_ref(ids.at(1).c_str()), nullptr);
+
+    Restore();
+}
+
 TEST_F(StorageImagesUnitTest, test_image_store_remove_multi_name)
 {
     BackUp();
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <climits>
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <gtest/gtest.h>
@@ -26,6 +27,8 @@
 #include "utils.h"
 #include "utils_array.h"
 #include "driver_overlay2.h"
+#include "io_wrapper.h"
+#include "fs_usage_sampler.h"
 #include "driver_quota_mock.h"
 
 using ::testing::Args;
@@ -100,6 +103,11 @@ int invokeGetPageSize()
     return abs_mount.length() - 1;
 }
 
+ssize_t fdRead(void *context, void *buf, size_t buf_len)
+{
+    return read(*(int *)context, buf, buf_len);
+}
+
 int invokeIOCtl(int fd, int cmd)
 {
     return 0;
@@ -271,6 +279,45 @@ TEST_F(StorageDriverUnitTest, test_graphdriver_try_repair_lowers)
     ASSERT_EQ(graphdriver_try_repair_lowers(id.c_str(), nullptr), 0);
 }
 
+TEST_F(StorageDriverUnitTest, test_graphdriver_stage_diff)
+{
+    if (!support_overlay) {
+        return;
+    }
+
+    std::string id { "eb29745b8228e1e97c01b1d5c2554a319c00a94d8dd5746a3904222ad65a13f8" };
+    std::string staged_dir { "/tmp/isulad/staged" };
+    struct driver_create_opts create_opts = { 0 };
+    struct io_read_wrapper reader = { 0 };
+    int fd = -1;
+
+    ASSERT_EQ(system("mkdir -p /tmp/isulad/layer_data && echo hello > /tmp/isulad/layer_data/file && "
+                     "tar -cf /tmp/isulad/layer.tar -C /tmp/isulad/layer_data file"), 0);
+    fd = open("/tmp/isulad/layer.tar", O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    reader.context = &fd;
+    reader.read = fdRead;
+
+    ASSERT_TRUE(graphdriver_support_stage_diff());
+    ASSERT_EQ(mkdir(staged_dir.c_str(), 0700), 0);
+    FLAGS_gmock_catch_leaked_mocks = false; // the exit in the child without deleting the mock object
+    ASSERT_EQ(graphdriver_stage_diff(staged_dir.c_str(), &reader), 0);
+    FLAGS_gmock_catch_leaked_mocks = true;
+    close(fd);
+    ASSERT_TRUE(util_file_exists((staged_dir + "/diff/file").c_str()));
+
+    // the staged diff replaces the empty diff of the new layer
+    ASSERT_EQ(graphdriver_create_ro(id.c_str(), nullptr, &create_opts), 0);
+    ASSERT_EQ(graphdriver_apply_staged_diff(id.c_str(), staged_dir.c_str()), 0);
+    ASSERT_TRUE(util_file_exists(("/tmp/isulad/data/overlay/" + id + "/diff/file").c_str()));
+    ASSERT_FALSE(util_dir_exists((staged_dir + "/diff").c_str()));
+    // nothing is staged any more
+    ASSERT_NE(graphdriver_apply_staged_diff(id.c_str(), staged_dir.c_str()), 0);
+    ASSERT_TRUE(util_file_exists(("/tmp/isulad/data/overlay/" + id + "/diff/file").c_str()));
+
+    ASSERT_EQ(graphdriver_rm_layer(id.c_str()), 0);
+}
+
 TEST(StorageOverlay2QuotaOptionsTest, test_overlay2_is_quota_options)
 {
     std::vector<std::string> options { "overlay2.size", "overlay2.basesize" };
@@ -278,3 +325,32 @@ TEST(StorageOverlay2QuotaOptionsTest, test_overlay2_is_quota_options)
         ASSERT_TRUE(overlay2_is_quota_options(nullptr, option.c_str()));
     }
 }
+
+TEST(StorageFsUsageSamplerTest, test_fs_usage_sampler_get)
+{
+    char tmpl[] = "/tmp/fs_usage_sampler_XXXXXX";
+    char *dir = mkdtemp(tmpl);
+    int64_t bytes = 0;
+    int64_t inodes = 0;
+    int64_t cached_bytes = 0;
+    int64_t cached_inodes = 0;
+
+    ASSERT_NE(dir, nullptr);
+    ASSERT_EQ(util_write_file((std::string(dir) + "/first").c_str(), "data", 4, 0600), 0);
+
+    ASSERT_EQ(fs_usage_sampler_get(dir, &bytes, &inodes), 0);
+    ASSERT_GT(inodes, 0);
+
+    // result within the sample interval is served from cache
+    ASSERT_EQ(util_write_file((std::string(dir) + "/second").c_str(), "data", 4, 0600), 0);
+    ASSERT_EQ(fs_usage_sampler_get(dir, &cached_bytes, &cached_inodes), 0);
+    ASSERT_EQ(cached_bytes, bytes);
+    ASSERT_EQ(cached_inodes, inodes);
+
+    fs_usage_sampler_forget(dir);
+    ASSERT_EQ(fs_usage_sampler_get(dir, &bytes, &inodes), 0);
+    ASSERT_GT(inodes, cached_inodes);
+
+    fs_usage_sampler_forget(dir);
+    ASSERT_EQ(util_recursive_rmdir(dir, 0), 0);
+}
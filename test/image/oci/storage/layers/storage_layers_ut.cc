@@ -21,13 +21,16 @@
 #include <fstream>
 #include <climits>
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <sys/mount.h>
 #include <sys/stat.h>
 #include <gtest/gtest.h>
 #include "path.h"
 #include "utils.h"
 #include "storage.h"
 #include "layer.h"
+#include "io_wrapper.h"
 #include "driver_quota_mock.h"
 
 using ::testing::Args;
@@ -40,6 +43,7 @@ using ::testing::NotNull;
 using ::testing::AtLeast;
 using ::testing::Invoke;
 using ::testing::_;
+using ::testing::FLAGS_gmock_catch_leaked_mocks;
 
 std::string GetDirectory()
 {
@@ -126,6 +130,11 @@ void free_layer_list(struct layer_list *ptr)
     free(ptr);
 }
 
+ssize_t fdRead(void *context, void *buf, size_t buf_len)
+{
+    return read(*(int *)context, buf, buf_len);
+}
+
 int invokeIOCtl(int fd, int cmd)
 {
     return 0;
@@ -216,6 +225,8 @@ protected:
         if (support_overlay) {
             layer_store_exit();
             layer_store_cleanup();
+            // tmpfs mounted on the staging dir by the fallback test
+            (void)umount2((std::string(real_path) + "/overlay-layers/staging").c_str(), MNT_DETACH);
         }
 
         std::string rm_command = "rm -rf /tmp/isulad/";
@@ -318,6 +329,107 @@ TEST_F(StorageLayersUnitTest, test_layer_store_create)
     free_layer_opts(layer_opt);
 }
 
+TEST_F(StorageLayersUnitTest, test_layer_store_create_with_staged_diff)
+{
+    if (!support_overlay) {
+        return;
+    }
+
+    std::string id { "eb29745b8228e1e97c01b1d5c2554a319c00a94d8dd5746a3904222ad65a13f8" };
+    std::string staging_dir = std::string(real_path) + "/overlay-layers/staging";
+    std::string layer_file = std::string(real_path) + "/overlay/" + id + "/diff/file";
+    struct layer_opts opts = { 0 };
+    struct io_read_wrapper reader = { 0 };
+    char *stage = nullptr;
+    char *new_id = nullptr;
+    int fd = -1;
+
+    ASSERT_EQ(system("mkdir -p /tmp/isulad/layer_data && echo hello > /tmp/isulad/layer_data/file && "
+                     "tar -cf /tmp/isulad/layer.tar -C /tmp/isulad/layer_data file"), 0);
+    fd = open("/tmp/isulad/layer.tar", O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    reader.context = &fd;
+    reader.read = fdRead;
+
+    ASSERT_TRUE(layer_store_support_stage_diff());
+    FLAGS_gmock_catch_leaked_mocks = false; // the exit in the child without deleting the mock object
+    stage = layer_store_stage_diff(&reader);
+    FLAGS_gmock_catch_leaked_mocks = true;
+    close(fd);
+    ASSERT_NE(stage, nullptr);
+    ASSERT_TRUE(util_file_exists((staging_dir + "/" + stage + "/diff/file").c_str()));
+
+    // layer data is opened again to create the layer, as storage does
+    fd = open("/tmp/isulad/layer.tar", O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    opts.staged_diff = stage;
+    ASSERT_EQ(layer_store_create(id.c_str(), &opts, &reader, &new_id), 0);
+    close(fd);
+    ASSERT_STREQ(new_id, id.c_str());
+    ASSERT_TRUE(util_file_exists(layer_file.c_str()));
+    // staged diff is moved to the layer
+    ASSERT_FALSE(util_dir_exists((staging_dir + "/" + stage + "/diff").c_str()));
+
+    layer_store_remove_staged_diff(stage);
+    ASSERT_FALSE(util_dir_exists((staging_dir + "/" + stage).c_str()));
+    ASSERT_EQ(layer_store_delete(id.c_str()), 0);
+    free(new_id);
+    free(stage);
+}
+
+TEST_F(StorageLayersUnitTest, test_layer_store_create_staged_diff_fallback)
+{
+    if (!support_overlay) {
+        return;
+    }
+
+    std::string id { "eb29745b8228e1e97c01b1d5c2554a319c00a94d8dd5746a3904222ad65a13f8" };
+    std::string staging_dir = std::string(real_path) + "/overlay-layers/staging";
+    std::string layer_file = std::string(real_path) + "/overlay/" + id + "/diff/file";
+    struct layer_opts opts = { 0 };
+    struct io_read_wrapper reader = { 0 };
+    char *stage = nullptr;
+    char *new_id = nullptr;
+    int fd = -1;
+
+    // staged diff on another filesystem can not be renamed to the layer
+    ASSERT_EQ(util_mkdir_p(staging_dir.c_str(), 0700), 0);
+    if (mount("tmpfs", staging_dir.c_str(), "tmpfs", 0, nullptr) != 0) {
+        std::cout << "Cannot mount tmpfs, skip staged diff fallback test." << std::endl;
+        return;
+    }
+
+    ASSERT_EQ(system("mkdir -p /tmp/isulad/layer_data && echo hello > /tmp/isulad/layer_data/file && "
+                     "tar -cf /tmp/isulad/layer.tar -C /tmp/isulad/layer_data file"), 0);
+    fd = open("/tmp/isulad/layer.tar", O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    reader.context = &fd;
+    reader.read = fdRead;
+
+    FLAGS_gmock_catch_leaked_mocks = false; // the exit in the child without deleting the mock object
+    stage = layer_store_stage_diff(&reader);
+    FLAGS_gmock_catch_leaked_mocks = true;
+    close(fd);
+    ASSERT_NE(stage, nullptr);
+
+    // rename fails with EXDEV, the diff is applied from the layer data again
+    fd = open("/tmp/isulad/layer.tar", O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    opts.staged_diff = stage;
+    FLAGS_gmock_catch_leaked_mocks = false;
+    ASSERT_EQ(layer_store_create(id.c_str(), &opts, &reader, &new_id), 0);
+    FLAGS_gmock_catch_leaked_mocks = true;
+    close(fd);
+    ASSERT_TRUE(util_file_exists(layer_file.c_str()));
+    ASSERT_TRUE(util_dir_exists((staging_dir + "/" + stage + "/diff").c_str()));
+
+    layer_store_remove_staged_diff(stage);
+    ASSERT_FALSE(util_dir_exists((staging_dir + "/" + stage).c_str()));
+    ASSERT_EQ(layer_store_delete(id.c_str()), 0);
+    free(new_id);
+    free(stage);
+}
+
 TEST_F(StorageLayersUnitTest, test_layer_store_by_compress_digest)
 {
     if (!support_overlay) {
@@ -121,6 +121,21 @@ int storage_layer_create(const char *layer_id, storage_layer_create_opts_t *opts
     return -1;
 }
 
+char *storage_layer_stage_diff(const char *layer_data_path)
+{
+    if (g_storage_mock != nullptr) {
+        return g_storage_mock->StorageLayerStageDiff(layer_data_path);
+    }
+    return nullptr;
+}
+
+void storage_layer_remove_staged_diff(const char *staged_diff)
+{
+    if (g_storage_mock != nullptr) {
+        g_storage_mock->StorageLayerRemoveStagedDiff(staged_diff);
+    }
+}
+
 struct layer *storage_layer_get(const char *layer_id)
 {
     if (g_storage_mock != nullptr) {
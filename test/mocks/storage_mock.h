@@ -35,6 +35,8 @@ public:
     MOCK_METHOD1(StorageImgSetImageSize, int(const char *image_id));
     MOCK_METHOD1(StorageGetImgTopLayer, char *(const char *id));
     MOCK_METHOD2(StorageLayerCreate, int(const char *layer_id, storage_layer_create_opts_t *opts));
+    MOCK_METHOD1(StorageLayerStageDiff, char *(const char *layer_data_path));
+    MOCK_METHOD1(StorageLayerRemoveStagedDiff, void(const char *staged_diff));
     MOCK_METHOD1(StorageLayerGet, struct layer * (const char *layer_id));
     MOCK_METHOD2(StorageLayerTryRepairLowers, int(const char *layer_id, const char *last_layer_id));
     MOCK_METHOD1(FreeLayer, void(struct layer *l));
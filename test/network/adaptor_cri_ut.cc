@@ -0,0 +1,296 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: cri network adaptor unit test
+ ******************************************************************************/
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "adaptor_cri.h"
+#include "cni_operate.h"
+#include "network_tools.h"
+#include "util_atomic.h"
+
+namespace {
+std::mutex g_mutex;
+std::condition_variable g_cond;
+// conf files in conf dir, loaded by get_net_conf_files_from_dir
+std::vector<struct cni_conf_file *> g_dir_files;
+bool g_dir_changed = true;
+// old files given by the last update
+std::vector<struct cni_conf_file *> g_old_files;
+std::set<std::string> g_freed;
+// network checked, and whether check is blocked until released
+const struct cni_network_list_conf *g_checking = nullptr;
+bool g_block_check = false;
+
+struct cni_conf_file *new_conf_file(const char *name)
+{
+    struct cni_conf_file *file = (struct cni_conf_file *)calloc(1, sizeof(struct cni_conf_file));
+
+    file->path = strdup(name);
+    file->conf = (struct cni_network_list_conf *)calloc(1, sizeof(struct cni_network_list_conf));
+    file->conf->list = (cni_net_conf_list *)calloc(1, sizeof(cni_net_conf_list));
+    file->conf->list->name = strdup(name);
+    atomic_int_set(&file->refcnt, 1);
+    return file;
+}
+
+// conf dir holds a reference of its files
+void set_dir_files(const std::vector<std::string> &names, bool changed)
+{
+    std::vector<struct cni_conf_file *> old;
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        old.swap(g_dir_files);
+        for (const auto &name : names) {
+            g_dir_files.push_back(new_conf_file(name.c_str()));
+        }
+        g_dir_changed = changed;
+    }
+    for (auto file : old) {
+        cni_conf_file_ref_dec(file);
+    }
+}
+
+bool is_freed(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_freed.count(name) > 0;
+}
+
+void release_check()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_block_check = false;
+    g_cond.notify_all();
+}
+
+bool wait_checking()
+{
+    std::unique_lock<std::mutex> lock(g_mutex);
+    return g_cond.wait_for(lock, std::chrono::seconds(10), [] { return g_checking != nullptr; });
+}
+
+int check_network(const char *name)
+{
+    network_api_conf conf = {};
+    network_api_result_list result = {};
+
+    conf.name = (char *)name;
+    return adaptor_cni_check(&conf, &result);
+}
+}
+
+extern "C" {
+int get_net_conf_files_from_dir(struct cni_conf_file **old, size_t old_len, cni_conf_filter_t filter_ops,
+                                struct cni_conf_file ***store, size_t *res_len, bool *changed)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    size_t i;
+
+    (void)filter_ops;
+    g_old_files.assign(old, old + old_len);
+    *store = (struct cni_conf_file **)calloc(g_dir_files.size() + 1, sizeof(struct cni_conf_file *));
+    for (i = 0; i < g_dir_files.size(); i++) {
+        atomic_int_inc(&g_dir_files[i]->refcnt);
+        (*store)[i] = g_dir_files[i];
+    }
+    *res_len = g_dir_files.size();
+    *changed = g_dir_changed;
+    return 0;
+}
+
+void cni_conf_file_ref_dec(struct cni_conf_file *file)
+{
+    if (file == nullptr || !atomic_int_dec_test(&file->refcnt)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_freed.insert(file->path);
+    }
+    free(file->conf->list->name);
+    free(file->conf->list);
+    free(file->conf);
+    free(file->path);
+    free(file);
+}
+
+int check_network_plane(const struct cni_manager *manager, const struct cni_network_list_conf *list,
+                        struct cni_opt_result **result)
+{
+    std::unique_lock<std::mutex> lock(g_mutex);
+
+    (void)manager;
+    (void)result;
+    g_checking = list;
+    g_cond.notify_all();
+    g_cond.wait(lock, [] { return !g_block_check; });
+    return 0;
+}
+
+int attach_network_plane(const struct cni_manager *manager, const struct cni_network_list_conf *list,
+                         struct cni_opt_result **result)
+{
+    (void)manager;
+    (void)list;
+    (void)result;
+    return 0;
+}
+
+int detach_network_plane(const struct cni_manager *manager, const struct cni_network_list_conf *list,
+                         struct cni_opt_result **result)
+{
+    (void)manager;
+    (void)list;
+    (void)result;
+    return 0;
+}
+
+int attach_loopback(const char *id, const char *netns)
+{
+    (void)id;
+    (void)netns;
+    return 0;
+}
+
+int detach_loopback(const char *id, const char *netns)
+{
+    (void)id;
+    (void)netns;
+    return 0;
+}
+
+// results are always empty in this test
+struct network_api_result *network_parse_to_api_result(const char *name, const char *interface,
+                                                       const struct cni_opt_result *cni_result)
+{
+    (void)name;
+    (void)interface;
+    (void)cni_result;
+    return nullptr;
+}
+
+bool network_api_result_list_append(struct network_api_result *result, network_api_result_list *list)
+{
+    (void)result;
+    (void)list;
+    return false;
+}
+
+void free_network_api_result(struct network_api_result *ptr)
+{
+    (void)ptr;
+}
+
+void free_cni_opt_result(struct cni_opt_result *result)
+{
+    (void)result;
+}
+}
+
+TEST(adaptor_cri, test_update_confs_snapshot)
+{
+    set_dir_files({ "neta", "netb" }, true);
+    ASSERT_EQ(adaptor_cni_update_confs(), 0);
+    ASSERT_TRUE(adaptor_cni_check_inited());
+    ASSERT_EQ(check_network("netb"), 0);
+    ASSERT_NE(check_network("netc"), 0);
+
+    // files of current snapshot are given to be reused
+    ASSERT_EQ(adaptor_cni_update_confs(), 0);
+    ASSERT_EQ(g_old_files, g_dir_files);
+
+    // nothing changed, current snapshot is kept
+    set_dir_files({ "netc" }, false);
+    ASSERT_EQ(adaptor_cni_update_confs(), 0);
+    ASSERT_FALSE(is_freed("netb"));
+    ASSERT_EQ(check_network("netb"), 0);
+    ASSERT_NE(check_network("netc"), 0);
+
+    // replaced snapshot is freed if no one uses it
+    set_dir_files({ "netd" }, true);
+    ASSERT_EQ(adaptor_cni_update_confs(), 0);
+    ASSERT_TRUE(is_freed("neta"));
+    ASSERT_TRUE(is_freed("netb"));
+    ASSERT_EQ(check_network("netd"), 0);
+}
+
+TEST(adaptor_cri, test_snapshot_kept_by_user)
+{
+    const struct cni_network_list_conf *checking = nullptr;
+
+    set_dir_files({ "neth" }, true);
+    ASSERT_EQ(adaptor_cni_update_confs(), 0);
+    set_dir_files({}, false);
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_checking = nullptr;
+        g_block_check = true;
+    }
+    std::thread checker([]() { ASSERT_EQ(check_network("neth"), 0); });
+    ASSERT_TRUE(wait_checking());
+    checking = g_checking;
+
+    // snapshot is replaced while in use, its networks are freed only after the user is done
+    set_dir_files({ "neti" }, true);
+    ASSERT_EQ(adaptor_cni_update_confs(), 0);
+    ASSERT_FALSE(is_freed("neth"));
+    ASSERT_STREQ(checking->list->name, "neth");
+    ASSERT_NE(check_network("neth"), 0);
+
+    release_check();
+    checker.join();
+    ASSERT_TRUE(is_freed("neth"));
+    ASSERT_EQ(check_network("neti"), 0);
+}
+
+TEST(adaptor_cri, test_concurrent_update_and_check)
+{
+    std::vector<std::thread> threads;
+    std::vector<std::string> names = { "netj", "netk" };
+
+    set_dir_files(names, true);
+    ASSERT_EQ(adaptor_cni_update_confs(), 0);
+
+    // updates replace the snapshot while networks are checked, run with sanitizers to find races
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&names, i]() {
+            for (int j = 0; j < 200; j++) {
+                if (i == 0) {
+                    set_dir_files(names, true);
+                }
+                if (i < 2) {
+                    ASSERT_EQ(adaptor_cni_update_confs(), 0);
+                } else {
+                    ASSERT_EQ(check_network(names[j % names.size()].c_str()), 0);
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    set_dir_files({}, false);
+}
@@ -0,0 +1,212 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: isulad
+ * Create: 2026-10-17
+ * Description: cni conf files loading unit test
+ ******************************************************************************/
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <gtest/gtest.h>
+
+#include "cni_operate.h"
+#include "utils_file.h"
+
+namespace {
+std::string g_root;
+std::string g_conf_dir;
+
+std::string conf_path(const std::string &name)
+{
+    return g_conf_dir + "/" + name;
+}
+
+// the name of network is 4 characters, so rewriting it keeps the size of file
+void write_conf(const std::string &name, const std::string &net)
+{
+    std::ofstream out(conf_path(name), std::ios::trunc);
+    out << "{\"cniVersion\":\"0.3.1\",\"name\":\"" << net << "\",\"plugins\":[{\"type\":\"bridge\"}]}";
+}
+
+void set_mtime(const std::string &name, const struct timespec &mtime)
+{
+    struct timespec times[2] = { mtime, mtime };
+
+    ASSERT_EQ(utimensat(AT_FDCWD, conf_path(name).c_str(), times, 0), 0);
+}
+
+struct timespec get_mtime(const std::string &name)
+{
+    struct stat st = { 0 };
+
+    EXPECT_EQ(stat(conf_path(name).c_str(), &st), 0);
+    return st.st_mtim;
+}
+
+class loaded_files {
+public:
+    ~loaded_files()
+    {
+        release();
+    }
+
+    int load(loaded_files *old)
+    {
+        struct cni_conf_file **result = nullptr;
+        size_t len = 0;
+        int ret = 0;
+
+        release();
+        ret = get_net_conf_files_from_dir(old != nullptr ? old->m_files.data() : nullptr,
+                                          old != nullptr ? old->m_files.size() : 0, nullptr, &result, &len, &m_changed);
+        for (size_t i = 0; i < len; i++) {
+            m_files.push_back(result[i]);
+        }
+        free(result);
+        return ret;
+    }
+
+    void release()
+    {
+        for (auto file : m_files) {
+            cni_conf_file_ref_dec(file);
+        }
+        m_files.clear();
+    }
+
+    std::vector<std::string> names() const
+    {
+        std::vector<std::string> names;
+
+        for (auto file : m_files) {
+            names.push_back(file->conf->list->name);
+        }
+        return names;
+    }
+
+    std::vector<struct cni_conf_file *> m_files;
+    bool m_changed { false };
+};
+}
+
+class CniOperateUnitTest : public testing::Test {
+protected:
+    static void SetUpTestCase()
+    {
+        char tmpl[] = "/tmp/cni_operate_ut_XXXXXX";
+        const char *bin_paths[] = { "/opt/cni/bin" };
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        g_root = tmpl;
+        g_conf_dir = g_root + "/net.d";
+        ASSERT_EQ(mkdir(g_conf_dir.c_str(), 0700), 0);
+        ASSERT_EQ(cni_manager_store_init((g_root + "/cache").c_str(), g_conf_dir.c_str(), bin_paths, 1), 0);
+    }
+
+    static void TearDownTestCase()
+    {
+        (void)util_recursive_rmdir(g_root.c_str(), 0);
+    }
+
+    void SetUp() override
+    {
+        (void)util_recursive_rmdir(g_conf_dir.c_str(), 0);
+        ASSERT_EQ(mkdir(g_conf_dir.c_str(), 0700), 0);
+    }
+};
+
+TEST_F(CniOperateUnitTest, test_reuse_unchanged_files)
+{
+    loaded_files first;
+    loaded_files second;
+
+    write_conf("20-b.conflist", "netb");
+    write_conf("10-a.conflist", "neta");
+
+    ASSERT_EQ(first.load(nullptr), 0);
+    ASSERT_TRUE(first.m_changed);
+    ASSERT_EQ(first.names(), std::vector<std::string>({ "neta", "netb" }));
+
+    // files not changed are shared instead of being parsed again
+    ASSERT_EQ(second.load(&first), 0);
+    ASSERT_FALSE(second.m_changed);
+    ASSERT_EQ(second.m_files, first.m_files);
+    ASSERT_EQ(first.m_files[0]->refcnt, 2);
+    ASSERT_EQ(first.m_files[1]->refcnt, 2);
+
+    // shared files are kept by the result left
+    first.release();
+    ASSERT_EQ(second.m_files[0]->refcnt, 1);
+    ASSERT_EQ(second.names(), std::vector<std::string>({ "neta", "netb" }));
+}
+
+TEST_F(CniOperateUnitTest, test_removed_and_added_files)
+{
+    loaded_files first;
+    loaded_files second;
+    loaded_files third;
+
+    write_conf("10-a.conflist", "neta");
+    write_conf("20-b.conflist", "netb");
+    ASSERT_EQ(first.load(nullptr), 0);
+
+    ASSERT_EQ(unlink(conf_path("10-a.conflist").c_str()), 0);
+    ASSERT_EQ(second.load(&first), 0);
+    ASSERT_TRUE(second.m_changed);
+    ASSERT_EQ(second.names(), std::vector<std::string>({ "netb" }));
+    ASSERT_EQ(second.m_files[0], first.m_files[1]);
+
+    // added file is loaded, between files reused
+    write_conf("15-c.conflist", "netc");
+    write_conf("30-d.conflist", "netd");
+    ASSERT_EQ(third.load(&second), 0);
+    ASSERT_TRUE(third.m_changed);
+    ASSERT_EQ(third.names(), std::vector<std::string>({ "netc", "netb", "netd" }));
+    ASSERT_EQ(third.m_files[1], second.m_files[0]);
+}
+
+TEST_F(CniOperateUnitTest, test_rewritten_files_with_same_mtime)
+{
+    loaded_files first;
+    loaded_files second;
+    loaded_files third;
+    struct timespec mtime = { 0 };
+
+    write_conf("10-a.conflist", "neta");
+    write_conf("20-b.conflist", "netb");
+    ASSERT_EQ(first.load(nullptr), 0);
+
+    // rewritten in place, with the same size and mtime; ctime changes on the next tick of file system clock
+    mtime = get_mtime("10-a.conflist");
+    usleep(20 * 1000);
+    write_conf("10-a.conflist", "netx");
+    set_mtime("10-a.conflist", mtime);
+    ASSERT_EQ(second.load(&first), 0);
+    ASSERT_TRUE(second.m_changed);
+    ASSERT_EQ(second.names(), std::vector<std::string>({ "netx", "netb" }));
+    ASSERT_NE(second.m_files[0], first.m_files[0]);
+    ASSERT_EQ(second.m_files[1], first.m_files[1]);
+
+    // replaced by another file, with the same size and mtime
+    mtime = get_mtime("20-b.conflist");
+    write_conf("20-b.tmp", "nety");
+    ASSERT_EQ(rename(conf_path("20-b.tmp").c_str(), conf_path("20-b.conflist").c_str()), 0);
+    set_mtime("20-b.conflist", mtime);
+    ASSERT_EQ(third.load(&second), 0);
+    ASSERT_TRUE(third.m_changed);
+    ASSERT_EQ(third.names(), std::vector<std::string>({ "netx", "nety" }));
+    ASSERT_EQ(third.m_files[0], second.m_files[0]);
+}
@@ -14,8 +14,13 @@
  */
 
 #include <limits.h>
+#include <sched.h>
 #include <unistd.h>
+#include <sys/mount.h>
 #include <sys/stat.h>
+#include <string>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 #include "isula_libutils/container_inspect.h"
 #include "network_namespace.h"
@@ -100,3 +105,136 @@ TEST(network_ns_ut, test_get_network_namespace_path)
     free(host_spec1);
     free(settings1);
 }
+
+TEST(network_ns_ut, test_get_network_namespace_link_stats)
+{
+    struct netns_link_stats *stats = nullptr;
+    size_t len = 0;
+    bool found_lo = false;
+
+    ASSERT_NE(get_network_namespace_link_stats(nullptr, &stats, &len), 0);
+    ASSERT_NE(get_network_namespace_link_stats("/tmp/not_exist_netns", &stats, &len), 0);
+
+    // the second call uses the cached netlink socket
+    for (int i = 0; i < 2; i++) {
+        ASSERT_EQ(get_network_namespace_link_stats("/proc/self/ns/net", &stats, &len), 0);
+        found_lo = false;
+        for (size_t j = 0; j < len; j++) {
+            if (strcmp(stats[j].name, "lo") == 0) {
+                found_lo = true;
+            }
+        }
+        free(stats);
+        stats = nullptr;
+        ASSERT_TRUE(found_lo);
+    }
+
+    forget_network_namespace_link_stats("/proc/self/ns/net");
+}
+
+static bool link_stats_has_lo(const char *netns_path, size_t *len)
+{
+    struct netns_link_stats *stats = nullptr;
+    bool found_lo = false;
+
+    *len = 0;
+    if (get_network_namespace_link_stats(netns_path, &stats, len) != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < *len; i++) {
+        if (strcmp(stats[i].name, "lo") == 0) {
+            found_lo = true;
+        }
+    }
+    free(stats);
+    return found_lo;
+}
+
+TEST(network_ns_ut, test_link_stats_same_netns_paths)
+{
+    std::string pid_path = "/proc/" + std::to_string(getpid()) + "/ns/net";
+    size_t len1 = 0;
+    size_t len2 = 0;
+
+    // both paths are the same namespace, they share the socket keyed by its inode
+    ASSERT_TRUE(link_stats_has_lo("/proc/self/ns/net", &len1));
+    ASSERT_TRUE(link_stats_has_lo(pid_path.c_str(), &len2));
+    ASSERT_TRUE(link_stats_has_lo("/proc/self/ns/net", &len2));
+    ASSERT_EQ(len1, len2);
+
+    forget_network_namespace_link_stats("/proc/self/ns/net");
+    forget_network_namespace_link_stats(pid_path.c_str());
+    ASSERT_TRUE(link_stats_has_lo(pid_path.c_str(), &len2));
+    ASSERT_EQ(len1, len2);
+    forget_network_namespace_link_stats(pid_path.c_str());
+}
+
+TEST(network_ns_ut, test_link_stats_concurrent)
+{
+    std::vector<std::thread> threads;
+    std::vector<int> failed(4, 0);
+
+    for (size_t i = 0; i < failed.size(); i++) {
+        threads.emplace_back([&failed, i]() {
+            size_t len = 0;
+            for (int j = 0; j < 20; j++) {
+                if (!link_stats_has_lo("/proc/self/ns/net", &len)) {
+                    failed[i]++;
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (size_t i = 0; i < failed.size(); i++) {
+        ASSERT_EQ(failed[i], 0);
+    }
+    forget_network_namespace_link_stats("/proc/self/ns/net");
+}
+
+// bind mount a new network namespace, which has lo only, on path
+static bool mount_new_netns(const char *path)
+{
+    bool ok = false;
+
+    std::thread t([&ok, path]() {
+        ok = unshare(CLONE_NEWNET) == 0 && mount("/proc/thread-self/ns/net", path, nullptr, MS_BIND, nullptr) == 0;
+    });
+    t.join();
+    return ok;
+}
+
+TEST(network_ns_ut, test_link_stats_netns_path_replaced)
+{
+    const char *netns_path = "/tmp/network_ns_ut_netns";
+    size_t host_len = 0;
+    size_t len = 0;
+    int fd = -1;
+
+    if (geteuid() != 0) {
+        GTEST_SKIP() << "mount network namespace needs root";
+    }
+
+    fd = open(netns_path, O_RDONLY | O_CREAT | O_CLOEXEC, 0644);
+    ASSERT_GE(fd, 0);
+    close(fd);
+
+    ASSERT_EQ(mount("/proc/self/ns/net", netns_path, nullptr, MS_BIND, nullptr), 0);
+    ASSERT_TRUE(link_stats_has_lo(netns_path, &host_len));
+    ASSERT_EQ(umount2(netns_path, MNT_DETACH), 0);
+
+    // the path is mounted with another namespace, its own socket is used
+    ASSERT_TRUE(mount_new_netns(netns_path));
+    ASSERT_TRUE(link_stats_has_lo(netns_path, &len));
+    ASSERT_EQ(len, 1);
+    ASSERT_EQ(umount2(netns_path, MNT_DETACH), 0);
+
+    // the namespace is gone, as the container is stopped
+    ASSERT_FALSE(link_stats_has_lo(netns_path, &len));
+    forget_network_namespace_link_stats(netns_path);
+    ASSERT_TRUE(link_stats_has_lo("/proc/self/ns/net", &len));
+    ASSERT_EQ(len, host_len);
+    forget_network_namespace_link_stats("/proc/self/ns/net");
+    ASSERT_EQ(unlink(netns_path), 0);
+}
@@ -22,11 +22,13 @@
 #include <fcntl.h>
 #include "mock.h"
 #include "isula_rt_ops.h"
+#include "isula_rt_stats.h"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "engine_mock.h"
 #include "isulad_config_mock.h"
 #include "utils.h"
+#include "utils_file.h"
 
 using ::testing::Args;
 using ::testing::ByRef;
@@ -134,6 +136,42 @@ TEST_F(IsulaRtOpsUnitTest, test_rt_isula_status)
     ASSERT_EQ(rt_isula_status("123", "kata-runtime", &params, &status), -1);
 }
 
+TEST_F(IsulaRtOpsUnitTest, test_rt_isula_status_native)
+{
+    rt_status_params_t params = {};
+    struct runtime_container_status_info status = {};
+    std::string workdir = "/tmp/isula_status_ut/123";
+    std::string self_pid = std::to_string(getpid());
+    proc_t *proc = util_get_process_proc_info(getpid());
+    bool frozen = false;
+
+    ASSERT_NE(proc, nullptr);
+    std::string start_time = std::to_string(proc->start_time);
+    free(proc);
+
+    ASSERT_EQ(util_mkdir_p(workdir.c_str(), 0700), 0);
+    ASSERT_EQ(util_write_file((workdir + "/shim-pid").c_str(), self_pid.c_str(), self_pid.length(), 0600), 0);
+    ASSERT_EQ(util_write_file((workdir + "/pid").c_str(), self_pid.c_str(), self_pid.length(), 0600), 0);
+    params.state = "/tmp/isula_status_ut";
+
+    // process in pid file is not the one started, ask the runtime
+    std::string other_time = "1";
+    ASSERT_EQ(util_write_file((workdir + "/start-time").c_str(), other_time.c_str(), other_time.length(), 0600), 0);
+    ASSERT_EQ(rt_isula_status("123", "kata-runtime", &params, &status), -1);
+
+    ASSERT_EQ(util_write_file((workdir + "/start-time").c_str(), start_time.c_str(), start_time.length(), 0600), 0);
+    // running state needs the freezer state of the process
+    if (isula_rt_read_freezer_state(getpid(), &frozen) != 0) {
+        ASSERT_EQ(util_recursive_rmdir("/tmp/isula_status_ut", 0), 0);
+        GTEST_SKIP() << "freezer state of the test process is not readable";
+    }
+    ASSERT_EQ(rt_isula_status("123", "kata-runtime", &params, &status), 0);
+    ASSERT_EQ(status.status, RUNTIME_CONTAINER_STATUS_RUNNING);
+    ASSERT_EQ(status.pid, getpid());
+
+    ASSERT_EQ(util_recursive_rmdir("/tmp/isula_status_ut", 0), 0);
+}
+
 TEST_F(IsulaRtOpsUnitTest, test_rt_isula_exec_resize)
 {
     rt_exec_resize_params_t params = {};
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: events collector unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "events_collector_api.h"
+#include "events_format.h"
+#include "monitord.h"
+#include "container_events_handler.h"
+
+// the same as collector.c
+#define EVENTSLIMIT 64
+#define CLIENT_EVENTS_LIMIT 256
+
+extern "C" {
+int new_monitord(struct monitord_sync_data *msync)
+{
+    *msync->exit_code = 0;
+    (void)sem_post(msync->monitord_sem);
+    return 0;
+}
+
+int container_events_handler_post_events(const struct isulad_events_format *event)
+{
+    (void)event;
+    return 0;
+}
+
+container_t *containers_store_get(const char *id_or_name)
+{
+    (void)id_or_name;
+    return nullptr;
+}
+
+void container_unref(container_t *cont)
+{
+    (void)cont;
+}
+}
+
+namespace {
+// records ids of events written to the stream
+struct recorder {
+    std::mutex mutex;
+    std::vector<std::string> ids;
+    std::atomic<bool> cancelled { false };
+    // the first write blocks until released
+    std::atomic<bool> block_first { false };
+    std::atomic<bool> blocked { false };
+    std::atomic<bool> released { false };
+
+    size_t count()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return ids.size();
+    }
+};
+
+bool is_cancelled(void *context)
+{
+    return ((recorder *)context)->cancelled;
+}
+
+bool write_event(void *writer, void *data)
+{
+    recorder *r = (recorder *)writer;
+    struct isulad_events_format *event = (struct isulad_events_format *)data;
+
+    if (r->block_first && !r->blocked) {
+        r->blocked = true;
+        while (!r->released) {
+            usleep(1000);
+        }
+    }
+    std::lock_guard<std::mutex> lock(r->mutex);
+    r->ids.push_back(event->id != nullptr ? event->id : "");
+    return true;
+}
+
+stream_func_wrapper new_stream(recorder *r)
+{
+    stream_func_wrapper stream = {};
+
+    stream.context = r;
+    stream.is_cancelled = is_cancelled;
+    stream.writer = r;
+    stream.write_func = write_event;
+    return stream;
+}
+
+void post_image_event(const std::string &name)
+{
+    struct monitord_msg msg = {};
+
+    msg.type = MONITORD_MSG_STATE;
+    msg.event_type = IMAGE_EVENT;
+    msg.value = EVENTS_TYPE_IMAGE_PULL;
+    msg.pid = -1;
+    (void)strncpy(msg.name, name.c_str(), sizeof(msg.name) - 1);
+    events_handler(&msg);
+}
+
+types_timestamp_t now()
+{
+    struct timespec ts = { 0 };
+    types_timestamp_t t = {};
+
+    (void)clock_gettime(CLOCK_REALTIME, &ts);
+    t.has_seconds = true;
+    t.seconds = ts.tv_sec;
+    t.has_nanos = true;
+    t.nanos = (int32_t)ts.tv_nsec;
+    return t;
+}
+
+bool wait_count(recorder *r, size_t count)
+{
+    for (int i = 0; i < 5000 && r->count() < count; i++) {
+        usleep(1000);
+    }
+    return r->count() >= count;
+}
+
+// an 'events' client following new events, as isula events does
+class client {
+public:
+    client(const char *name, recorder *r)
+        : m_name(name != nullptr ? strdup(name) : nullptr)
+        , m_stream(new_stream(r))
+    {
+        m_thread = std::thread([this]() {
+            m_ret = add_monitor_client(m_name, &m_since, &m_until, &m_stream);
+        });
+        // no hook to know the client is registered
+        usleep(100 * 1000);
+    }
+
+    int join()
+    {
+        m_thread.join();
+        free(m_name);
+        return m_ret;
+    }
+
+private:
+    char *m_name;
+    types_timestamp_t m_since {};
+    types_timestamp_t m_until {};
+    stream_func_wrapper m_stream;
+    std::thread m_thread;
+    int m_ret { 0 };
+};
+} // namespace
+
+class CollectorUnitTest : public testing::Test {
+protected:
+    static void SetUpTestCase()
+    {
+        ASSERT_EQ(events_module_init(), 0);
+    }
+};
+
+TEST_F(CollectorUnitTest, test_events_by_name)
+{
+    recorder named;
+    recorder all;
+    client named_client("by_name_a", &named);
+    client all_client(nullptr, &all);
+
+    post_image_event("by_name_a");
+    post_image_event("by_name_b");
+    post_image_event("by_name_a");
+
+    // events are sent in order, to clients of the name and clients of all events
+    ASSERT_TRUE(wait_count(&all, 3));
+    ASSERT_TRUE(wait_count(&named, 2));
+    usleep(100 * 1000);
+    ASSERT_EQ(all.ids, std::vector<std::string>({ "by_name_a", "by_name_b", "by_name_a" }));
+    ASSERT_EQ(named.ids, std::vector<std::string>({ "by_name_a", "by_name_a" }));
+
+    named.cancelled = true;
+    all.cancelled = true;
+    ASSERT_EQ(named_client.join(), 0);
+    ASSERT_EQ(all_client.join(), 0);
+}
+
+TEST_F(CollectorUnitTest, test_unregister_client)
+{
+    recorder first;
+    recorder second;
+    recorder other;
+    client first_client("unregister_a", &first);
+    client other_client("unregister_a", &other);
+
+    post_image_event("unregister_a");
+    ASSERT_TRUE(wait_count(&first, 1));
+    ASSERT_TRUE(wait_count(&other, 1));
+    first.cancelled = true;
+    ASSERT_EQ(first_client.join(), 0);
+
+    // the other client of the name still gets events
+    post_image_event("unregister_a");
+    ASSERT_TRUE(wait_count(&other, 2));
+    other.cancelled = true;
+    ASSERT_EQ(other_client.join(), 0);
+    ASSERT_EQ(first.count(), 1);
+
+    // no client of the name left, a new client indexes the name again
+    post_image_event("unregister_a");
+    client second_client("unregister_a", &second);
+    post_image_event("unregister_a");
+    ASSERT_TRUE(wait_count(&second, 1));
+    second.cancelled = true;
+    ASSERT_EQ(second_client.join(), 0);
+    ASSERT_EQ(second.count(), 1);
+}
+
+TEST_F(CollectorUnitTest, test_client_queue_overflow)
+{
+    recorder slow;
+    int i;
+
+    slow.block_first = true;
+    client slow_client("overflow_a", &slow);
+
+    post_image_event("overflow_a");
+    for (i = 0; i < 5000 && !slow.blocked; i++) {
+        usleep(1000);
+    }
+    ASSERT_TRUE(slow.blocked);
+
+    // the queue is full while the client is blocked, later events are dropped
+    for (i = 0; i < CLIENT_EVENTS_LIMIT + 10; i++) {
+        post_image_event("overflow_a");
+    }
+    slow.released = true;
+
+    // events queued before the overflow are sent, then the stream is closed with an error
+    ASSERT_EQ(slow_client.join(), -1);
+    ASSERT_EQ(slow.count(), (size_t)CLIENT_EVENTS_LIMIT + 1);
+}
+
+TEST_F(CollectorUnitTest, test_events_history_ring)
+{
+    types_timestamp_t since = {};
+    types_timestamp_t until = {};
+    recorder r;
+    stream_func_wrapper stream = new_stream(&r);
+    std::vector<std::string> expected;
+    int i;
+
+    for (i = 0; i < EVENTSLIMIT + 8; i++) {
+        post_image_event("ring_" + std::to_string(i));
+    }
+    for (i = 8; i < EVENTSLIMIT + 8; i++) {
+        expected.push_back("ring_" + std::to_string(i));
+    }
+
+    // only the latest EVENTSLIMIT events are kept, replayed in arrival order
+    since.has_seconds = true;
+    since.seconds = 1;
+    until = now();
+    ASSERT_EQ(events_subscribe(nullptr, &since, &until, &stream), 0);
+    ASSERT_EQ(r.ids, expected);
+}
+
+TEST_F(CollectorUnitTest, test_events_since)
+{
+    types_timestamp_t since = {};
+    types_timestamp_t until = {};
+    recorder all;
+    recorder named;
+    stream_func_wrapper all_stream = new_stream(&all);
+    stream_func_wrapper named_stream = new_stream(&named);
+
+    post_image_event("since_old");
+    usleep(10 * 1000);
+    since = now();
+    post_image_event("since_a");
+    post_image_event("since_b");
+    usleep(10 * 1000);
+    until = now();
+    post_image_event("since_late");
+
+    ASSERT_EQ(events_subscribe(nullptr, &since, &until, &all_stream), 0);
+    ASSERT_EQ(all.ids, std::vector<std::string>({ "since_a", "since_b" }));
+    ASSERT_EQ(events_subscribe("since_b", &since, &until, &named_stream), 0);
+    ASSERT_EQ(named.ids, std::vector<std::string>({ "since_b" }));
+
+    // since after until is invalid
+    ASSERT_NE(events_subscribe(nullptr, &until, &since, &all_stream), 0);
+}
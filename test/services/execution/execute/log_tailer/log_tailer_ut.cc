@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: log tailer unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <isula_libutils/logger_json_file.h>
+#include "log_tailer.h"
+
+#define LOG_DIR "/tmp/log_tailer_ut"
+#define LOG_PATH LOG_DIR "/console.log"
+
+namespace {
+std::string make_record(const std::string &log)
+{
+    return "{\"log\":\"" + log + "\\n\",\"stream\":\"stdout\",\"time\":\"2026-10-17T08:00:00.000000000Z\"}\n";
+}
+
+// append count records "prefix<i>" to the log file, return the size of the file
+int64_t append_records(const std::string &prefix, int start, int count)
+{
+    std::ofstream out(LOG_PATH, std::ios::app | std::ios::binary);
+
+    for (int i = start; i < start + count; i++) {
+        out << make_record(prefix + std::to_string(i));
+    }
+    out.close();
+
+    std::ifstream in(LOG_PATH, std::ios::ate | std::ios::binary);
+    return (int64_t)in.tellg();
+}
+
+bool collect_log(void *writer, void *data)
+{
+    std::vector<std::string> *logs = (std::vector<std::string> *)writer;
+    logger_json_file *entry = (logger_json_file *)data;
+
+    logs->push_back(std::string((const char *)entry->log, entry->log_len));
+    return true;
+}
+
+// receive at least count records in 10 seconds
+bool receive(log_follower *follower, std::vector<std::string> &logs, size_t count)
+{
+    stream_func_wrapper stream = {};
+    time_t deadline = 0;
+
+    stream.writer = &logs;
+    stream.write_func = collect_log;
+    deadline = time(nullptr) + 10;
+    while (logs.size() < count && time(nullptr) < deadline) {
+        if (log_follower_send(follower, 100, &stream) < 0) {
+            return false;
+        }
+    }
+
+    return logs.size() >= count;
+}
+
+class LogTailerUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(system("rm -rf " LOG_DIR " && mkdir -p " LOG_DIR " && touch " LOG_PATH), 0);
+    }
+
+    void TearDown() override
+    {
+        ASSERT_EQ(system("rm -rf " LOG_DIR), 0);
+    }
+};
+} // namespace
+
+TEST_F(LogTailerUnitTest, test_follow_new_records)
+{
+    std::vector<std::string> logs;
+    int64_t pos = append_records("old", 0, 3);
+    log_follower *follower = log_tailer_follow("cid", LOG_PATH, pos);
+
+    ASSERT_NE(follower, nullptr);
+    append_records("new", 0, 5);
+    ASSERT_TRUE(receive(follower, logs, 5));
+    ASSERT_EQ(logs.size(), 5U);
+    for (int i = 0; i < 5; i++) {
+        ASSERT_EQ(logs[i], "new" + std::to_string(i) + "\n");
+    }
+
+    log_tailer_unfollow(follower);
+}
+
+TEST_F(LogTailerUnitTest, test_followers_share_tailer)
+{
+    std::vector<std::string> first_logs;
+    std::vector<std::string> second_logs;
+    log_follower *first = log_tailer_follow("cid", LOG_PATH, 0);
+    log_follower *second = nullptr;
+    int64_t pos = 0;
+
+    ASSERT_NE(first, nullptr);
+    pos = append_records("a", 0, 10);
+    ASSERT_TRUE(receive(first, first_logs, 10));
+
+    // joins at the end of the records already read by the shared tailer
+    second = log_tailer_follow("cid", LOG_PATH, pos);
+    ASSERT_NE(second, nullptr);
+    append_records("b", 0, 10);
+    ASSERT_TRUE(receive(first, first_logs, 20));
+    ASSERT_TRUE(receive(second, second_logs, 10));
+    ASSERT_EQ(first_logs.size(), 20U);
+    ASSERT_EQ(second_logs.size(), 10U);
+    ASSERT_EQ(second_logs[0], "b0\n");
+    ASSERT_EQ(second_logs[9], "b9\n");
+
+    log_tailer_unfollow(second);
+    log_tailer_unfollow(first);
+}
+
+TEST_F(LogTailerUnitTest, test_follow_records_dropped_by_shared_tailer)
+{
+    const int count = 3 * LOG_TAILER_BUFFER_LEN;
+    std::vector<std::string> first_logs;
+    std::vector<std::string> second_logs;
+    log_follower *first = log_tailer_follow("cid", LOG_PATH, 0);
+    log_follower *second = nullptr;
+
+    ASSERT_NE(first, nullptr);
+    append_records("r", 0, count);
+    ASSERT_TRUE(receive(first, first_logs, count));
+
+    // the records from offset 0 are not kept by the shared tailer, no gap is allowed
+    second = log_tailer_follow("cid", LOG_PATH, 0);
+    ASSERT_NE(second, nullptr);
+    ASSERT_TRUE(receive(second, second_logs, count));
+    ASSERT_EQ(second_logs.size(), (size_t)count);
+    for (int i = 0; i < count; i++) {
+        ASSERT_EQ(second_logs[i], "r" + std::to_string(i) + "\n");
+    }
+
+    // both still receive new records
+    append_records("n", 0, 1);
+    ASSERT_TRUE(receive(first, first_logs, count + 1));
+    ASSERT_TRUE(receive(second, second_logs, count + 1));
+    ASSERT_EQ(first_logs.back(), "n0\n");
+    ASSERT_EQ(second_logs.back(), "n0\n");
+
+    log_tailer_unfollow(second);
+    log_tailer_unfollow(first);
+}
+
+TEST_F(LogTailerUnitTest, test_long_record_truncated)
+{
+    const size_t count = 200000;
+    std::vector<std::string> logs;
+    std::string long_log;
+    log_follower *follower = log_tailer_follow("cid", LOG_PATH, 0);
+
+    ASSERT_NE(follower, nullptr);
+    // escaped characters are not split by truncation
+    for (size_t i = 0; i < count; i++) {
+        long_log += "\\u001b";
+    }
+    {
+        std::ofstream out(LOG_PATH, std::ios::app | std::ios::binary);
+        out << make_record("before");
+        out << make_record(long_log);
+        out << make_record("after");
+    }
+
+    ASSERT_TRUE(receive(follower, logs, 3));
+    ASSERT_EQ(logs.size(), 3U);
+    ASSERT_EQ(logs[0], "before\n");
+    ASSERT_GT(logs[1].size(), 1024U);
+    ASSERT_LT(logs[1].size(), count);
+    ASSERT_EQ(logs[1].find_first_not_of('\x1b'), std::string::npos);
+    ASSERT_EQ(logs[2], "after\n");
+
+    log_tailer_unfollow(follower);
+}
+
+TEST_F(LogTailerUnitTest, test_follow_invalid)
+{
+    ASSERT_EQ(log_tailer_follow(nullptr, LOG_PATH, 0), nullptr);
+    ASSERT_EQ(log_tailer_follow("cid", nullptr, 0), nullptr);
+    ASSERT_EQ(log_tailer_follow("cid", LOG_DIR "/not-exist/console.log", 0), nullptr);
+    ASSERT_LT(log_follower_send(nullptr, 0, nullptr), 0);
+    log_tailer_unfollow(nullptr);
+}
@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: io copy session unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <gtest/gtest.h>
+#include "io_handler.h"
+
+#define FIFO_DIR "/tmp/io_handler_ut"
+// more than the workers shared by all sessions
+#define BLOCKED_SESSIONS 6
+
+extern "C" {
+char *conf_get_routine_statedir(const char *runtime)
+{
+    (void)runtime;
+    return nullptr;
+}
+}
+
+namespace {
+// function writer of a client, writing blocks while the client is blocked
+struct client {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    std::string data;
+    bool blocked;
+    bool fail;
+    int closed;
+};
+
+void client_init(struct client *c, bool blocked)
+{
+    pthread_mutex_init(&c->mutex, nullptr);
+    pthread_cond_init(&c->cond, nullptr);
+    c->blocked = blocked;
+    c->fail = false;
+    c->closed = 0;
+}
+
+void client_destroy(struct client *c)
+{
+    pthread_cond_destroy(&c->cond);
+    pthread_mutex_destroy(&c->mutex);
+}
+
+ssize_t client_write(void *context, const void *data, size_t len)
+{
+    struct client *c = (struct client *)context;
+
+    pthread_mutex_lock(&c->mutex);
+    while (c->blocked) {
+        pthread_cond_wait(&c->cond, &c->mutex);
+    }
+    if (c->fail) {
+        pthread_mutex_unlock(&c->mutex);
+        return -1;
+    }
+    c->data.append((const char *)data, len);
+    pthread_cond_broadcast(&c->cond);
+    pthread_mutex_unlock(&c->mutex);
+
+    return (ssize_t)len;
+}
+
+int client_close(void *context, char **err)
+{
+    struct client *c = (struct client *)context;
+
+    (void)err;
+    pthread_mutex_lock(&c->mutex);
+    c->closed++;
+    pthread_cond_broadcast(&c->cond);
+    pthread_mutex_unlock(&c->mutex);
+
+    return 0;
+}
+
+void client_release(struct client *c)
+{
+    pthread_mutex_lock(&c->mutex);
+    c->blocked = false;
+    pthread_cond_broadcast(&c->cond);
+    pthread_mutex_unlock(&c->mutex);
+}
+
+// wait for the client to receive len bytes or to be closed
+bool client_wait(struct client *c, size_t len, bool closed, int timeout_seconds)
+{
+    struct timespec deadline = { 0 };
+    bool done = false;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_seconds;
+
+    pthread_mutex_lock(&c->mutex);
+    while (c->data.size() < len || (closed && c->closed == 0)) {
+        if (pthread_cond_timedwait(&c->cond, &c->mutex, &deadline) != 0) {
+            break;
+        }
+    }
+    done = c->data.size() >= len && (!closed || c->closed > 0);
+    pthread_mutex_unlock(&c->mutex);
+
+    return done;
+}
+
+struct io_write_wrapper make_writer(struct client *c)
+{
+    struct io_write_wrapper writer = {};
+
+    writer.context = c;
+    writer.write_func = client_write;
+    writer.close_func = client_close;
+    return writer;
+}
+
+// copy stdout of fifo to client, return the write end of fifo
+int start_session(const std::string &fifo, struct client *c, bool detach, io_copy_session **session)
+{
+    struct io_write_wrapper writer = make_writer(c);
+    const char *fifos[3] = { nullptr, fifo.c_str(), nullptr };
+
+    if (mkfifo(fifo.c_str(), 0600) != 0) {
+        return -1;
+    }
+    if (ready_copy_io_data(-1, detach, nullptr, nullptr, nullptr, -1, &writer, nullptr, fifos, session) != 0) {
+        return -1;
+    }
+
+    return open(fifo.c_str(), O_WRONLY | O_CLOEXEC);
+}
+
+std::string make_data(size_t len)
+{
+    std::string data;
+
+    for (size_t i = 0; i < len; i++) {
+        data.push_back((char)('a' + i % 26));
+    }
+    return data;
+}
+
+struct feeder {
+    int fd;
+    std::string data;
+};
+
+void *feed(void *arg)
+{
+    struct feeder *f = (struct feeder *)arg;
+    size_t off = 0;
+    ssize_t ret = 0;
+
+    while (off < f->data.size()) {
+        ret = write(f->fd, f->data.data() + off, f->data.size() - off);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        off += (size_t)ret;
+    }
+    close(f->fd);
+
+    return nullptr;
+}
+
+// function writer shared by stdout and stderr, which must not be called concurrently
+struct shared_client {
+    std::atomic<int> writing;
+    bool concurrent;
+    std::string data;
+    std::atomic<int> closed;
+};
+
+ssize_t shared_client_write(void *context, const void *data, size_t len)
+{
+    struct shared_client *c = (struct shared_client *)context;
+
+    if (c->writing.fetch_add(1) != 0) {
+        c->concurrent = true;
+    }
+    c->data.append((const char *)data, len);
+    usleep(100);
+    c->writing.fetch_sub(1);
+
+    return (ssize_t)len;
+}
+
+int shared_client_close(void *context, char **err)
+{
+    struct shared_client *c = (struct shared_client *)context;
+
+    (void)err;
+    c->closed++;
+    return 0;
+}
+
+class IoHandlerUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        // fifos closed by the sessions are written in tests
+        signal(SIGPIPE, SIG_IGN);
+        ASSERT_EQ(system("rm -rf " FIFO_DIR " && mkdir -p " FIFO_DIR), 0);
+    }
+
+    void TearDown() override
+    {
+        ASSERT_EQ(system("rm -rf " FIFO_DIR), 0);
+    }
+};
+} // namespace
+
+TEST_F(IoHandlerUnitTest, test_slow_writers_not_block_others)
+{
+    struct client blocked[BLOCKED_SESSIONS];
+    io_copy_session *sessions[BLOCKED_SESSIONS] = { nullptr };
+    int fds[BLOCKED_SESSIONS] = { -1 };
+    struct client fast;
+    io_copy_session *session = nullptr;
+    int fd = -1;
+    int i;
+
+    for (i = 0; i < BLOCKED_SESSIONS; i++) {
+        client_init(&blocked[i], true);
+        fds[i] = start_session(FIFO_DIR "/blocked" + std::to_string(i), &blocked[i], false, &sessions[i]);
+        ASSERT_GE(fds[i], 0);
+        ASSERT_EQ(write(fds[i], "blocked", 7), 7);
+    }
+
+    // clients blocked in writing do not stall the workers copying for other sessions
+    client_init(&fast, false);
+    fd = start_session(FIFO_DIR "/fast", &fast, false, &session);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, "hello", 5), 5);
+    ASSERT_TRUE(client_wait(&fast, 5, false, 5));
+    close(fd);
+    io_copy_session_wait(session, nullptr);
+    ASSERT_EQ(fast.data, "hello");
+    ASSERT_EQ(fast.closed, 1);
+    client_destroy(&fast);
+
+    for (i = 0; i < BLOCKED_SESSIONS; i++) {
+        client_release(&blocked[i]);
+        close(fds[i]);
+        io_copy_session_wait(sessions[i], nullptr);
+        EXPECT_EQ(blocked[i].data, "blocked");
+        EXPECT_EQ(blocked[i].closed, 1);
+        client_destroy(&blocked[i]);
+    }
+}
+
+TEST_F(IoHandlerUnitTest, test_queued_data_written_before_finish)
+{
+    struct client c;
+    struct feeder f;
+    struct io_copy_stats stats = { 0 };
+    io_copy_session *session = nullptr;
+    pthread_t tid;
+
+    client_init(&c, true);
+    f.data = make_data(4 * 1024 * 1024 + 123);
+    f.fd = start_session(FIFO_DIR "/queued", &c, false, &session);
+    ASSERT_GE(f.fd, 0);
+    ASSERT_EQ(pthread_create(&tid, nullptr, feed, &f), 0);
+
+    // reading stops when too much data is queued for the blocked client, nothing is lost
+    usleep(200 * 1000);
+    client_release(&c);
+    pthread_join(tid, nullptr);
+    io_copy_session_wait(session, &stats);
+
+    ASSERT_EQ(c.data.size(), f.data.size());
+    ASSERT_TRUE(c.data == f.data);
+    ASSERT_EQ(stats.stdout_bytes, (uint64_t)f.data.size());
+    ASSERT_EQ(c.closed, 1);
+    client_destroy(&c);
+}
+
+TEST_F(IoHandlerUnitTest, test_detached_session)
+{
+    struct client c;
+    io_copy_session *session = nullptr;
+    int fd = -1;
+
+    client_init(&c, false);
+    fd = start_session(FIFO_DIR "/detached", &c, true, &session);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(session, nullptr);
+    ASSERT_EQ(write(fd, "detached", 8), 8);
+    close(fd);
+
+    ASSERT_TRUE(client_wait(&c, 8, true, 5));
+    pthread_mutex_lock(&c.mutex);
+    EXPECT_EQ(c.data, "detached");
+    EXPECT_EQ(c.closed, 1);
+    pthread_mutex_unlock(&c.mutex);
+    client_destroy(&c);
+}
+
+TEST_F(IoHandlerUnitTest, test_failed_writer_closes_session)
+{
+    struct client c;
+    io_copy_session *session = nullptr;
+    int fd = -1;
+    int i;
+
+    client_init(&c, false);
+    c.fail = true;
+    fd = start_session(FIFO_DIR "/failed", &c, false, &session);
+    ASSERT_GE(fd, 0);
+
+    // the channel is closed when more data is read after the client failed, fifo is still open
+    for (i = 0; i < 500; i++) {
+        pthread_mutex_lock(&c.mutex);
+        bool closed = c.closed > 0;
+        pthread_mutex_unlock(&c.mutex);
+        if (closed) {
+            break;
+        }
+        if (write(fd, "x", 1) != 1) {
+            break;
+        }
+        usleep(10 * 1000);
+    }
+    ASSERT_TRUE(client_wait(&c, 0, true, 5));
+    io_copy_session_wait(session, nullptr);
+    EXPECT_TRUE(c.data.empty());
+    EXPECT_EQ(c.closed, 1);
+    close(fd);
+    client_destroy(&c);
+}
+
+TEST_F(IoHandlerUnitTest, test_shared_writer_not_concurrent)
+{
+    struct shared_client c;
+    struct io_write_wrapper writer = {};
+    const char *fifos[3] = { nullptr, FIFO_DIR "/out", FIFO_DIR "/err" };
+    struct feeder out;
+    struct feeder err;
+    io_copy_session *session = nullptr;
+    pthread_t out_tid;
+    pthread_t err_tid;
+
+    c.writing = 0;
+    c.concurrent = false;
+    c.closed = 0;
+    writer.context = &c;
+    writer.write_func = shared_client_write;
+    writer.close_func = shared_client_close;
+    ASSERT_EQ(mkfifo(fifos[1], 0600), 0);
+    ASSERT_EQ(mkfifo(fifos[2], 0600), 0);
+    // stdout and stderr of exec and health check are written to the same output
+    ASSERT_EQ(ready_copy_io_data(-1, false, nullptr, nullptr, nullptr, -1, &writer, &writer, fifos, &session), 0);
+
+    out.data = std::string(256 * 1024, 'o');
+    err.data = std::string(256 * 1024, 'e');
+    out.fd = open(fifos[1], O_WRONLY | O_CLOEXEC);
+    err.fd = open(fifos[2], O_WRONLY | O_CLOEXEC);
+    ASSERT_GE(out.fd, 0);
+    ASSERT_GE(err.fd, 0);
+    ASSERT_EQ(pthread_create(&out_tid, nullptr, feed, &out), 0);
+    ASSERT_EQ(pthread_create(&err_tid, nullptr, feed, &err), 0);
+    pthread_join(out_tid, nullptr);
+    pthread_join(err_tid, nullptr);
+    io_copy_session_wait(session, nullptr);
+
+    ASSERT_FALSE(c.concurrent);
+    ASSERT_EQ(c.data.size(), out.data.size() + err.data.size());
+    // both writers are closed after all data is written
+    ASSERT_EQ(c.closed, 2);
+}
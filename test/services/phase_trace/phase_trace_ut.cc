@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: phase trace unit test
+ * Author: isulad
+ * Create: 2026-10-17
+ */
+
+#include <stdint.h>
+#include <gtest/gtest.h>
+#include "phase_trace.h"
+
+// values are recorded with an error of at most 1/8 of them
+#define MAX_ERROR(v) ((v) / 8 + 1)
+
+TEST(phase_trace_ut, test_hist_index)
+{
+    uint64_t v;
+
+    // small values have a bucket of their own
+    for (v = 0; v < 8; v++) {
+        ASSERT_EQ(phase_hist_index(v), (size_t)v);
+        ASSERT_EQ(phase_hist_value(phase_hist_index(v)), v);
+    }
+
+    for (v = 1; v < 1000000; v++) {
+        size_t index = phase_hist_index(v);
+
+        ASSERT_GE(phase_hist_index(v), phase_hist_index(v - 1));
+        // v falls in the bucket: above the highest value of the previous bucket, not above its own
+        ASSERT_GE(phase_hist_value(index), v);
+        ASSERT_LT(phase_hist_value(index - 1), v);
+        ASSERT_LE(phase_hist_value(index) - v, MAX_ERROR(v));
+    }
+
+    for (v = 1ULL << 20; v < (1ULL << 36); v = v * 3 / 2) {
+        size_t index = phase_hist_index(v);
+
+        ASSERT_GE(phase_hist_value(index), v);
+        ASSERT_LT(phase_hist_value(index - 1), v);
+    }
+
+    // too large values are kept in the last bucket
+    ASSERT_EQ(phase_hist_index(UINT64_MAX), phase_hist_index(1ULL << 40));
+    ASSERT_EQ(phase_hist_index(1ULL << 40), phase_hist_index((1ULL << 37) + 1));
+}
+
+TEST(phase_trace_ut, test_summary_quantiles)
+{
+    phase_latency_summary_t summary = { 0 };
+    uint64_t v;
+
+    for (v = 1; v <= 1000; v++) {
+        phase_trace_record(PHASE_CREATE_ROOTFS, v);
+    }
+
+    phase_trace_get_summary(PHASE_CREATE_ROOTFS, &summary);
+    ASSERT_EQ(summary.count, 1000U);
+    ASSERT_EQ(summary.sum, 500500U);
+    ASSERT_EQ(summary.max, 1000U);
+    // quantiles are reported as the highest value of the bucket they fall in
+    ASSERT_GE(summary.p50, 500U);
+    ASSERT_LE(summary.p50, 500U + MAX_ERROR(500U));
+    ASSERT_GE(summary.p90, 900U);
+    ASSERT_LE(summary.p90, 900U + MAX_ERROR(900U));
+    ASSERT_GE(summary.p99, 990U);
+    ASSERT_LE(summary.p99, 1000U);
+}
+
+TEST(phase_trace_ut, test_summary_capped_by_max)
+{
+    phase_latency_summary_t summary = { 0 };
+
+    // the bucket of 1001 reaches 1023, quantiles never exceed the max recorded
+    phase_trace_record(PHASE_CREATE_SPEC, 1001);
+    phase_trace_get_summary(PHASE_CREATE_SPEC, &summary);
+    ASSERT_EQ(summary.count, 1U);
+    ASSERT_EQ(summary.p50, 1001U);
+    ASSERT_EQ(summary.p90, 1001U);
+    ASSERT_EQ(summary.p99, 1001U);
+
+    phase_trace_get_summary(PHASE_CREATE_PLUGIN, &summary);
+    ASSERT_EQ(summary.count, 0U);
+    ASSERT_EQ(summary.p99, 0U);
+}
+
+TEST(phase_trace_ut, test_trace_failed_not_recorded)
+{
+    phase_trace_t trace;
+    phase_latency_summary_t summary = { 0 };
+
+    phase_trace_begin(&trace, PHASE_TRACE_STOP, "id");
+    phase_trace_mark(&trace, PHASE_STOP_LOCK);
+    // phases of other operations are ignored
+    phase_trace_mark(&trace, PHASE_START_LOCK);
+    phase_trace_end(&trace, false);
+
+    phase_trace_get_summary(PHASE_STOP_LOCK, &summary);
+    ASSERT_EQ(summary.count, 1U);
+    phase_trace_get_summary(PHASE_START_LOCK, &summary);
+    ASSERT_EQ(summary.count, 0U);
+    phase_trace_get_summary(PHASE_STOP_TOTAL, &summary);
+    ASSERT_EQ(summary.count, 0U);
+
+    phase_trace_begin(&trace, PHASE_TRACE_STOP, "id");
+    phase_trace_end(&trace, true);
+    phase_trace_get_summary(PHASE_STOP_TOTAL, &summary);
+    ASSERT_EQ(summary.count, 1U);
+
+    ASSERT_STREQ(phase_trace_op_name(PHASE_STOP_WAIT), "stop");
+    ASSERT_STREQ(phase_trace_phase_name(PHASE_STOP_WAIT), "wait");
+    ASSERT_EQ(phase_trace_phase_name(PHASE_TRACE_MAX), nullptr);
+}